@@ -23,6 +23,7 @@
 
 #include "common/Foreach.hpp"
 #include "common/Action.hpp"
+#include "common/AccountedComponent.hpp"
 #include "common/FindComponents.hpp"
 
 #include "common/Builder.hpp"
@@ -71,6 +72,7 @@ BasicCommands::commands_description BasicCommands::description()
   ("rm",          value< std::string >()->notifier(boost::bind(&rm,_1)),                                        "remove component")
   ("mv",          value< std::vector<std::string> >()->notifier(&mv)->multitoken(),                             "move/rename component")
   ("tree",        value< std::string >()->implicit_value(std::string())->notifier(boost::bind(&tree,_1)),       "print tree")
+  ("memory",      value< std::string >()->implicit_value(std::string())->notifier(boost::bind(&memory,_1)),     "print memory held by each component")
   ("options",     value< std::string >()->implicit_value(std::string())->notifier(boost::bind(&option_list,_1)),"list options")
   ("call",        value< std::vector<std::string> >()->notifier(boost::bind(&call,_1))->multitoken(),           "call executable options")
   ("export",      value< std::vector<std::string> >()->notifier(boost::bind(&export_env,_1))->multitoken(),     "export a CF environment variable")
@@ -409,6 +411,16 @@ void BasicCommands::tree(const std::string& cpath)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void BasicCommands::memory(const std::string& cpath)
+{
+  if (!cpath.empty())
+    print_memory_tree(*current_component->access_component(URI(cpath)));
+  else
+    print_memory_tree(*current_component);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void BasicCommands::option_list(const std::string& cpath)
 {
   std::string option_list;
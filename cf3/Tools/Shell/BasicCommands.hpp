@@ -46,6 +46,8 @@ public: // functions
 
   static void tree(const std::string& cpath);
 
+  static void memory(const std::string& cpath);
+
   static void option_list(const std::string& cpath);
 
   static void configure(const std::vector<std::string>& params);
@@ -0,0 +1,308 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+#include <boost/test/framework.hpp>
+#include <boost/test/unit_test_suite.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/BoostFilesystem.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "Tools/Testing/Benchmark.hpp"
+
+#ifdef CF3_OS_LINUX
+extern "C"
+{
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace Tools {
+namespace Testing {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Names of the hardware counters, in the order they are reduced over the CPUs
+  const char* counter_names[] = { "cycles", "instructions", "cache_misses" };
+  const Uint nb_counters = 3;
+
+  std::string json_string(const std::string& str)
+  {
+    std::string result = "\"";
+    for(std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+    {
+      if(*it == '"' || *it == '\\')
+        result += '\\';
+      result += *it;
+    }
+    return result + "\"";
+  }
+
+  /// Name of the test executable
+  std::string module_name()
+  {
+    const boost::unit_test::master_test_suite_t& master_suite = boost::unit_test::framework::master_test_suite();
+    return master_suite.argc > 0 ? boost::filesystem::path(master_suite.argv[0]).filename().string() : std::string("benchmark");
+  }
+
+  Real max_over_ranks(const Real local_value)
+  {
+    if(!common::PE::Comm::instance().is_active())
+      return local_value;
+
+    Real result;
+    common::PE::Comm::instance().all_reduce(common::PE::max(), &local_value, 1, &result);
+    return result;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HardwareCounters::HardwareCounters()
+{
+#ifdef CF3_OS_LINUX
+  const Uint configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+  for(Uint i = 0; i != detail::nb_counters; ++i)
+  {
+    perf_event_attr attributes;
+    std::fill(reinterpret_cast<char*>(&attributes), reinterpret_cast<char*>(&attributes) + sizeof(attributes), 0);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = configs[i];
+    attributes.disabled = 1;
+    attributes.inherit = 1; // include threads started by the kernel
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    const int fd = syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+    if(fd < 0)
+      continue;
+
+    m_file_descriptors.push_back(fd);
+    m_names.push_back(detail::counter_names[i]);
+  }
+#endif
+}
+
+HardwareCounters::~HardwareCounters()
+{
+#ifdef CF3_OS_LINUX
+  for(Uint i = 0; i != m_file_descriptors.size(); ++i)
+    close(m_file_descriptors[i]);
+#endif
+}
+
+void HardwareCounters::start()
+{
+#ifdef CF3_OS_LINUX
+  for(Uint i = 0; i != m_file_descriptors.size(); ++i)
+  {
+    ioctl(m_file_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(m_file_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+void HardwareCounters::stop()
+{
+  m_values.clear();
+#ifdef CF3_OS_LINUX
+  for(Uint i = 0; i != m_file_descriptors.size(); ++i)
+  {
+    ioctl(m_file_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+    long long count = 0;
+    if(read(m_file_descriptors[i], &count, sizeof(count)) == sizeof(count))
+      m_values[m_names[i]] = static_cast<Real>(count);
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BenchmarkResult::BenchmarkResult() :
+  nb_ranks(1),
+  nb_threads(1),
+  work(0.),
+  memory_high_water(0.)
+{
+}
+
+Real BenchmarkResult::min_time() const
+{
+  return times.empty() ? 0. : *std::min_element(times.begin(), times.end());
+}
+
+Real BenchmarkResult::mean_time() const
+{
+  return times.empty() ? 0. : std::accumulate(times.begin(), times.end(), 0.) / static_cast<Real>(times.size());
+}
+
+Real BenchmarkResult::max_time() const
+{
+  return times.empty() ? 0. : *std::max_element(times.begin(), times.end());
+}
+
+Real BenchmarkResult::throughput() const
+{
+  const Real time = min_time();
+  return time > 0. ? work / time : 0.;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BenchmarkRegistry& BenchmarkRegistry::instance()
+{
+  static BenchmarkRegistry registry;
+  return registry;
+}
+
+BenchmarkResult& BenchmarkRegistry::run(const std::string& name, const KernelT& kernel, const Real local_work, const std::string& work_unit, const Uint nb_repeats, const Uint nb_threads)
+{
+  common::PE::Comm& comm = common::PE::Comm::instance();
+
+  boost::shared_ptr<BenchmarkResult> result(new BenchmarkResult());
+  result->name = name;
+  result->parameters = m_parameters;
+  result->nb_ranks = comm.size();
+  result->nb_threads = nb_threads;
+  result->work_unit = work_unit;
+
+  HardwareCounters counters;
+  std::vector<Real> local_counts(detail::nb_counters, 0.);
+  std::vector<Real> local_available(detail::nb_counters, 1.);
+  common::Timer timer;
+  for(Uint i = 0; i != nb_repeats; ++i)
+  {
+    if(comm.is_active())
+      comm.barrier();
+    counters.start();
+    timer.restart();
+    kernel();
+    const Real elapsed = timer.elapsed();
+    counters.stop();
+    result->times.push_back(detail::max_over_ranks(elapsed));
+
+    for(Uint j = 0; j != detail::nb_counters; ++j)
+    {
+      std::map<std::string, Real>::const_iterator count_it = counters.values().find(detail::counter_names[j]);
+      if(count_it == counters.values().end())
+        local_available[j] = 0.;
+      else
+        local_counts[j] += count_it->second / static_cast<Real>(nb_repeats);
+    }
+  }
+
+  // A counter is only reported if it worked on all CPUs
+  std::vector<Real> counts = local_counts;
+  std::vector<Real> available = local_available;
+  result->work = local_work;
+  if(comm.is_active())
+  {
+    comm.all_reduce(common::PE::plus(), local_counts, counts);
+    comm.all_reduce(common::PE::min(), local_available, available);
+    comm.all_reduce(common::PE::plus(), &local_work, 1, &result->work);
+  }
+  for(Uint j = 0; j != detail::nb_counters; ++j)
+  {
+    if(available[j] == 1. && nb_repeats != 0)
+      result->counters[detail::counter_names[j]] = counts[j];
+  }
+
+  result->memory_high_water = detail::max_over_ranks(common::OSystem::instance().layer()->memory_high_water());
+
+  if(comm.rank() == 0)
+  {
+    // Label with the parameter values, so the same kernel can be reported for different parameters
+    std::string label = name;
+    for(std::map<std::string, std::string>::const_iterator it = m_parameters.begin(); it != m_parameters.end(); ++it)
+      label += (it == m_parameters.begin() ? " [" : ", ") + it->second;
+    if(!m_parameters.empty())
+      label += "]";
+    std::cout << "<DartMeasurement name=\"" << label << " time\" type=\"numeric/double\">" << result->min_time() << "</DartMeasurement>" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << label << " throughput\" type=\"numeric/double\">" << result->throughput() << "</DartMeasurement>" << std::endl;
+  }
+
+  m_results.push_back(result);
+  return *result;
+}
+
+void BenchmarkRegistry::write_json(const std::string& path) const
+{
+  if(common::PE::Comm::instance().rank() != 0)
+    return;
+
+  std::ofstream out(path.c_str());
+  if(!out.is_open())
+    throw common::FileSystemError(FromHere(), "Failed to open benchmark output file " + path);
+
+  out.precision(12);
+  out << "{\n";
+  out << "  \"module\": " << detail::json_string(detail::module_name()) << ",\n";
+  out << "  \"benchmarks\": [";
+  for(Uint i = 0; i != m_results.size(); ++i)
+  {
+    const BenchmarkResult& result = *m_results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\n";
+    out << "      \"name\": " << detail::json_string(result.name) << ",\n";
+    out << "      \"parameters\": {";
+    for(std::map<std::string, std::string>::const_iterator it = result.parameters.begin(); it != result.parameters.end(); ++it)
+      out << (it == result.parameters.begin() ? "" : ", ") << detail::json_string(it->first) << ": " << detail::json_string(it->second);
+    out << "},\n";
+    out << "      \"nb_ranks\": " << result.nb_ranks << ",\n";
+    out << "      \"nb_threads\": " << result.nb_threads << ",\n";
+    out << "      \"repetitions\": " << result.times.size() << ",\n";
+    out << "      \"time_min\": " << result.min_time() << ",\n";
+    out << "      \"time_mean\": " << result.mean_time() << ",\n";
+    out << "      \"time_max\": " << result.max_time() << ",\n";
+    out << "      \"work\": " << result.work << ",\n";
+    out << "      \"work_unit\": " << detail::json_string(result.work_unit) << ",\n";
+    out << "      \"throughput\": " << result.throughput() << ",\n";
+    out << "      \"memory_high_water\": " << result.memory_high_water << ",\n";
+    out << "      \"counters\": {";
+    for(std::map<std::string, Real>::const_iterator it = result.counters.begin(); it != result.counters.end(); ++it)
+      out << (it == result.counters.begin() ? "" : ", ") << detail::json_string(it->first) << ": " << it->second;
+    out << "}\n";
+    out << "    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void BenchmarkRegistry::write_json() const
+{
+  boost::filesystem::path output_dir = boost::filesystem::current_path();
+  const char* output_env = std::getenv("CF3_BENCHMARK_OUTPUT");
+  if(output_env != 0)
+    output_dir = output_env;
+
+  write_json((output_dir / (detail::module_name() + ".json")).string());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // Testing
+} // Tools
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,133 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Tools_Testing_Benchmark_hpp
+#define cf3_Tools_Testing_Benchmark_hpp
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "common/CF.hpp"
+
+#include "Tools/Testing/LibTesting.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace Tools {
+namespace Testing {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Hardware event counters (cycles, instructions, cache misses) for the calling process, using the Linux perf_event interface.
+/// Counters that can't be opened (other OS, restrictive perf_event_paranoid setting, virtual machine) are left out silently.
+class Testing_API HardwareCounters : boost::noncopyable
+{
+public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  /// Reset and start counting
+  void start();
+
+  /// Stop counting and store the values
+  void stop();
+
+  /// Values counted between the last start() and stop(), by counter name. Empty if no counters are available.
+  const std::map<std::string, Real>& values() const { return m_values; }
+
+private:
+  std::vector<int> m_file_descriptors;
+  std::vector<std::string> m_names;
+  std::map<std::string, Real> m_values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Measurements for a single benchmark kernel, combined over all CPUs
+struct Testing_API BenchmarkResult
+{
+  BenchmarkResult();
+
+  /// Kernel name, e.g. "assembly"
+  std::string name;
+  /// Parameters that identify the run, e.g. the element type and problem size
+  std::map<std::string, std::string> parameters;
+  Uint nb_ranks;
+  Uint nb_threads;
+  /// Wall time of each repetition, taking the slowest CPU
+  std::vector<Real> times;
+  /// Work done in each repetition, summed over all CPUs
+  Real work;
+  /// Unit of work, e.g. "elements"
+  std::string work_unit;
+  /// Hardware counters, averaged over the repetitions and summed over all CPUs
+  std::map<std::string, Real> counters;
+  /// Largest process high-water mark over all CPUs, in bytes
+  Real memory_high_water;
+
+  Real min_time() const;
+  Real mean_time() const;
+  Real max_time() const;
+
+  /// Work units per second, based on the fastest repetition
+  Real throughput() const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Runs benchmark kernels and collects their results, to write them to a JSON file that can be compared
+/// against a stored baseline using tools/compare-benchmarks.py. Each kernel is also reported to CDash
+/// through a DartMeasurement, just like TimedTestFixture does. All functions that run kernels are collective.
+class Testing_API BenchmarkRegistry : boost::noncopyable
+{
+public:
+  typedef boost::function<void ()> KernelT;
+
+  static BenchmarkRegistry& instance();
+
+  /// Parameters added to every result that is recorded after setting them, e.g. the problem size or element type.
+  /// Results are identified by their name and parameters when comparing with a baseline.
+  std::map<std::string, std::string>& parameters() { return m_parameters; }
+
+  /// Time nb_repeats executions of kernel
+  /// @param name Name of the kernel
+  /// @param local_work Work done by this CPU in a single execution of kernel
+  /// @param work_unit Unit of the work, used to label the throughput
+  /// @param nb_threads Number of threads used by the kernel
+  /// @return The result
+  BenchmarkResult& run(const std::string& name, const KernelT& kernel, const Real local_work, const std::string& work_unit, const Uint nb_repeats = 1, const Uint nb_threads = 1);
+
+  const std::vector< boost::shared_ptr<BenchmarkResult> >& results() const { return m_results; }
+
+  /// Write all results to the given file (on rank 0 only)
+  void write_json(const std::string& path) const;
+
+  /// Write all results to "<test module>.json", in the directory given by the environment variable CF3_BENCHMARK_OUTPUT
+  /// or the current directory if it is not set
+  void write_json() const;
+
+private:
+  BenchmarkRegistry() {}
+
+  std::map<std::string, std::string> m_parameters;
+  std::vector< boost::shared_ptr<BenchmarkResult> > m_results;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // Testing
+} // Tools
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Tools_Testing_Benchmark_hpp
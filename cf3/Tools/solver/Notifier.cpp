@@ -4,11 +4,18 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "common/Foreach.hpp"
+#include "common/URI.hpp"
 #include "common/PE/Manager.hpp"
+#include "common/XML/Protocol.hpp"
+#include "common/XML/SignalOptions.hpp"
 
 #include "Tools/solver/Notifier.hpp"
 
 using namespace cf3::common;
+using namespace cf3::common::XML;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -40,35 +47,52 @@ void Notifier::listen_to_event(const std::string & name, bool notifyOnce)
   m_observed_queue->add_notifier(name, &Notifier::new_event, this);
 
   if(notifyOnce)
-    m_once_notifying_events[name] = false;
+    m_once_notifying_events[name] = std::vector<std::string>();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void Notifier::begin_notify()
 {
-  std::map<std::string, bool>::iterator it = m_once_notifying_events.begin();
+  std::map<std::string, std::vector<std::string> >::iterator it = m_once_notifying_events.begin();
 
   for( ; it != m_once_notifying_events.end() ; it++)
-    it->second = false;
+    it->second.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void Notifier::new_event(const std::string & name, SignalArgs & args)
 {
-  std::map<std::string, bool>::iterator it = m_once_notifying_events.find(name);
+  std::map<std::string, std::vector<std::string> >::iterator it = m_once_notifying_events.find(name);
 
-  if( it == m_once_notifying_events.end() || !it->second )
+  // Path affected by the event. Events without a path affect the whole tree
+  std::string path;
+  if( it != m_once_notifying_events.end() && args.has_map( Protocol::Tags::key_options() ) )
   {
-    event_occured(name, args);
-
-    /// @todo Ugly!!! should use a boost::signal2
-    m_manager->new_event(args);
+    SignalOptions options( args );
+    if( options.check("path") )
+      path = options.value<URI>("path").path();
+  }
 
-    if(it != m_once_notifying_events.end())
-      it->second = true;
+  if( it != m_once_notifying_events.end() )
+  {
+    // Skip the event if it is inside a part of the tree that was already notified during this flush
+    BOOST_FOREACH( const std::string& notified, it->second )
+    {
+      const std::string prefix = boost::ends_with(notified, "/") ? notified : notified + "/";
+      if( notified.empty() || path == notified || boost::starts_with(path, prefix) )
+        return;
+    }
   }
+
+  event_occured(name, args);
+
+  /// @todo Ugly!!! should use a boost::signal2
+  m_manager->new_event(args);
+
+  if(it != m_once_notifying_events.end())
+    it->second.push_back(path);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -9,6 +9,9 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <map>
+#include <vector>
+
 #include <boost/signals2.hpp>
 
 #include "common/Handle.hpp"
@@ -49,7 +52,9 @@ namespace solver {
 
     common::NotificationQueue * m_observed_queue;
 
-    std::map<std::string, bool> m_once_notifying_events;
+    /// For each event that is notified once per flush, the paths that were already notified.
+    /// An event is only notified again if its "path" option lies outside of these.
+    std::map<std::string, std::vector<std::string> > m_once_notifying_events;
 
     Handle<common::PE::Manager> m_manager;
 
@@ -0,0 +1,319 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "common/AccountedComponent.hpp"
+#include "common/Component.hpp"
+#include "common/ComponentIterator.hpp"
+#include "common/Foreach.hpp"
+#include "common/MemoryPlacement.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PropertyList.hpp"
+#include "common/TimedComponent.hpp"
+
+#include "common/PE/Comm.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  std::string bytes_str(const Real bytes)
+  {
+    std::ostringstream out;
+    if(bytes < 1024.)
+      out << bytes << " B";
+    else if(bytes < 1024.*1024.)
+      out << bytes/1024. << " KB";
+    else if(bytes < 1024.*1024.*1024.)
+      out << bytes/1024./1024. << " MB";
+    else
+      out << bytes/1024./1024./1024. << " GB";
+    return out.str();
+  }
+
+  /// Values keyed by a list of names, such as the path of a component below the printed root
+  typedef std::map< std::vector<std::string>, Real > KeyedTotalsT;
+
+  /// Add the keys that only exist on other CPUs with a zero value, so the totals have the same keys on all CPUs
+  void gather_keys(KeyedTotalsT& totals)
+  {
+    if(!PE::Comm::instance().is_active() || PE::Comm::instance().size() == 1)
+      return;
+
+    // One key per line, each name preceded by a slash. The extra newline keeps the send buffer from being empty.
+    std::string local_keys;
+    for(KeyedTotalsT::const_iterator it = totals.begin(); it != totals.end(); ++it)
+    {
+      BOOST_FOREACH(const std::string& name, it->first)
+      {
+        local_keys += "/" + name;
+      }
+      local_keys += it->first.empty() ? "/\n" : "\n";
+    }
+    local_keys += "\n";
+
+    std::vector< std::vector<char> > all_keys;
+    PE::Comm::instance().all_gather(std::vector<char>(local_keys.begin(), local_keys.end()), all_keys);
+    BOOST_FOREACH(const std::vector<char>& keys, all_keys)
+    {
+      std::istringstream keys_stream(std::string(keys.begin(), keys.end()));
+      std::string line;
+      while(std::getline(keys_stream, line))
+      {
+        if(line.empty())
+          continue;
+        std::vector<std::string> key;
+        std::string::size_type begin = 1;
+        while(begin < line.size())
+        {
+          const std::string::size_type end = std::min(line.find('/', begin), line.size());
+          key.push_back(line.substr(begin, end - begin));
+          begin = end + 1;
+        }
+        totals.insert(std::make_pair(key, 0.));
+      }
+    }
+  }
+
+  /// Reduce the values of totals over all CPUs, formatted as "sum [min, max]" when running in parallel.
+  /// All CPUs must have the same keys, see gather_keys.
+  void reduce_totals(const KeyedTotalsT& totals, std::vector<std::string>& formatted, std::vector<Real>& sums)
+  {
+    std::vector<Real> local_values;
+    local_values.reserve(totals.size());
+    for(KeyedTotalsT::const_iterator it = totals.begin(); it != totals.end(); ++it)
+      local_values.push_back(it->second);
+
+    formatted.clear();
+    formatted.reserve(totals.size());
+    if(!PE::Comm::instance().is_active() || PE::Comm::instance().size() == 1 || local_values.empty())
+    {
+      sums = local_values;
+      BOOST_FOREACH(const Real bytes, local_values)
+      {
+        formatted.push_back(bytes_str(bytes));
+      }
+      return;
+    }
+
+    std::vector<Real> mins, maxs;
+    PE::Comm::instance().all_reduce(PE::plus(), local_values, sums);
+    PE::Comm::instance().all_reduce(PE::min(), local_values, mins);
+    PE::Comm::instance().all_reduce(PE::max(), local_values, maxs);
+    for(Uint i = 0; i != local_values.size(); ++i)
+      formatted.push_back(bytes_str(sums[i]) + " [" + bytes_str(mins[i]) + ", " + bytes_str(maxs[i]) + "]");
+  }
+
+  /// Reduce a single value, see reduce_totals
+  std::string reduced_bytes_str(const Real local_bytes)
+  {
+    KeyedTotalsT totals;
+    totals[std::vector<std::string>()] = local_bytes;
+    std::vector<std::string> formatted;
+    std::vector<Real> sums;
+    reduce_totals(totals, formatted, sums);
+    return formatted.front();
+  }
+
+  /// Total memory of root and each component below it, keyed by the path relative to root
+  void add_path_totals(const Component& root, std::vector<std::string>& path, KeyedTotalsT& path_totals)
+  {
+    path_totals[path] = root.properties().value<Real>("memory_total");
+    BOOST_FOREACH(const Component& component, root)
+    {
+      path.push_back(component.name());
+      add_path_totals(component, path, path_totals);
+      path.pop_back();
+    }
+  }
+
+  void add_type_totals(const Component& root, KeyedTotalsT& type_totals)
+  {
+    const AccountedComponent* accounted = dynamic_cast<const AccountedComponent*>(&root);
+    if(is_not_null(accounted))
+      type_totals[std::vector<std::string>(1, root.derived_type_name())] += accounted->memory_bytes();
+
+    BOOST_FOREACH(const Component& component, root)
+    {
+      add_type_totals(component, type_totals);
+    }
+  }
+
+  /// Add the pages of the contiguous data of each component to the count for their NUMA node
+  void add_pages_per_node(const Component& root, std::vector<Real>& pages)
+  {
+    const AccountedComponent* accounted = dynamic_cast<const AccountedComponent*>(&root);
+    if(is_not_null(accounted) && is_not_null(accounted->memory_data()))
+    {
+      const std::vector<Uint> node_pages = MemoryPlacement::instance().pages_per_node(accounted->memory_data(), static_cast<std::size_t>(accounted->memory_bytes()));
+      if(node_pages.size() > pages.size())
+        pages.resize(node_pages.size(), 0.);
+      for(Uint i = 0; i != node_pages.size(); ++i)
+        pages[i] += node_pages[i];
+    }
+
+    BOOST_FOREACH(const Component& component, root)
+    {
+      add_pages_per_node(component, pages);
+    }
+  }
+
+  /// Increase of the process high-water mark during the executions of each timed action, keyed by the path relative to root
+  void add_action_high_water(const Component& root, std::vector<std::string>& path, KeyedTotalsT& increases)
+  {
+    if(root.properties().check("memory_high_water_increase"))
+      increases[path] = root.properties().value<Real>("memory_high_water_increase");
+
+    BOOST_FOREACH(const Component& component, root)
+    {
+      path.push_back(component.name());
+      add_action_high_water(component, path, increases);
+      path.pop_back();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+Real store_memory_usage(Component& root)
+{
+  Real total = 0.;
+
+  const AccountedComponent* accounted = dynamic_cast<const AccountedComponent*>(&root);
+  if(is_not_null(accounted))
+  {
+    const Real bytes = accounted->memory_bytes();
+    root.properties()["memory_bytes"] = bytes;
+    total += bytes;
+  }
+
+  BOOST_FOREACH(Component& component, root)
+  {
+    total += store_memory_usage(component);
+  }
+
+  root.properties()["memory_total"] = total;
+  return total;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void print_memory_tree(Component& root, const std::string& prefix)
+{
+  const bool is_root = PE::Comm::instance().rank() == 0;
+
+  store_memory_usage(root);
+  if(is_root)
+  {
+    std::cout << "<DartMeasurement name=\"Memory\" type=\"text/plain\"><![CDATA[<html><body><pre>\n";
+    if(PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+      std::cout << "Memory held by each component, as sum [min, max] over CPUs\n";
+  }
+
+  // The tree may differ between CPUs, so all values are reduced for the union of the components, types and actions
+  std::vector<std::string> path;
+  std::vector<std::string> formatted;
+  std::vector<Real> sums;
+
+  detail::KeyedTotalsT path_totals;
+  detail::add_path_totals(root, path, path_totals);
+  detail::gather_keys(path_totals);
+  detail::reduce_totals(path_totals, formatted, sums);
+  if(is_root)
+  {
+    // The keys are sorted so that each component follows its parent, and empty branches are left out
+    Uint i = 0;
+    for(detail::KeyedTotalsT::const_iterator it = path_totals.begin(); it != path_totals.end(); ++it, ++i)
+    {
+      if(sums[i] == 0. && !it->first.empty())
+        continue;
+      std::cout << prefix << std::string(2*it->first.size(), ' ') << (it->first.empty() ? root.name() : it->first.back()) << ": " << formatted[i] << "\n";
+    }
+  }
+
+  detail::KeyedTotalsT type_totals;
+  detail::add_type_totals(root, type_totals);
+  detail::gather_keys(type_totals);
+  detail::reduce_totals(type_totals, formatted, sums);
+  if(is_root)
+  {
+    std::cout << "Totals by component type:\n";
+    Uint i = 0;
+    for(detail::KeyedTotalsT::const_iterator it = type_totals.begin(); it != type_totals.end(); ++it, ++i)
+      std::cout << "  " << it->first.front() << ": " << formatted[i] << "\n";
+  }
+
+  // Only available if component timing is enabled
+  store_timings(root);
+  detail::KeyedTotalsT action_high_water;
+  detail::add_action_high_water(root, path, action_high_water);
+  detail::gather_keys(action_high_water);
+  std::vector<std::string> action_formatted;
+  std::vector<Real> action_sums;
+  detail::reduce_totals(action_high_water, action_formatted, action_sums);
+
+  // Page placement, summed over the CPUs. The number of NUMA nodes seen may differ between CPUs.
+  std::vector<Real> pages;
+  detail::add_pages_per_node(root, pages);
+  if(PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+  {
+    const Real local_nb_nodes = pages.size();
+    Real nb_nodes = 0.;
+    PE::Comm::instance().all_reduce(PE::max(), &local_nb_nodes, 1, &nb_nodes);
+    pages.resize(static_cast<Uint>(nb_nodes), 0.);
+    std::vector<Real> local_pages = pages;
+    PE::Comm::instance().all_reduce(PE::plus(), local_pages, pages);
+  }
+
+  const std::string usage_str = detail::reduced_bytes_str(OSystem::instance().layer()->memory_usage());
+  const std::string high_water_str = detail::reduced_bytes_str(OSystem::instance().layer()->memory_high_water());
+  if(is_root)
+  {
+    std::cout << "Process memory in use: " << usage_str << "\n";
+    std::cout << "Process high-water mark: " << high_water_str << "\n";
+    std::ostringstream action_out;
+    Uint i = 0;
+    for(detail::KeyedTotalsT::const_iterator it = action_high_water.begin(); it != action_high_water.end(); ++it, ++i)
+    {
+      if(action_sums[i] == 0.)
+        continue;
+      action_out << "  " << root.uri().path();
+      BOOST_FOREACH(const std::string& name, it->first)
+      {
+        action_out << "/" << name;
+      }
+      action_out << ": " << action_formatted[i] << "\n";
+    }
+    if(!action_out.str().empty())
+      std::cout << "Increase of the high-water mark during each action:\n" << action_out.str();
+    if(!pages.empty())
+    {
+      std::cout << "Pages of component data on each NUMA node:";
+      for(Uint i = 0; i != pages.size(); ++i)
+        std::cout << (i == 0 ? " " : ", ") << "node " << i << ": " << pages[i];
+      std::cout << "\n";
+    }
+    std::cout << "</pre></body></html>]]></DartMeasurement>" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+/////////////////////////////////////////////////////////////////////////////////////
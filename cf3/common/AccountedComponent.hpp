@@ -0,0 +1,50 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_AccountedComponent_hpp
+#define cf3_common_AccountedComponent_hpp
+
+#include <string>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+class Component;
+
+/// Pure virtual interface for components that hold data, so their memory use can be reported
+class Common_API AccountedComponent
+{
+public:
+  virtual ~AccountedComponent() {}
+
+  /// Number of bytes of data held by this component, excluding its children
+  virtual Real memory_bytes() const = 0;
+
+  /// Start of the data if it is a single block of memory_bytes() bytes, used to report the page placement.
+  /// Null if the data is not contiguous.
+  virtual const void* memory_data() const { return 0; }
+};
+
+/// Store the memory use in properties for readout. Each component of the tree gets the property "memory_total",
+/// holding the bytes used by it and all its children. Accounted components also get "memory_bytes" for their own data.
+/// @return the total for root
+Real store_memory_usage(Component& root);
+
+/// Print the memory used by each part of the tree, with [min, max, sum] over CPUs, followed by the totals
+/// for each component type, the process high-water mark and the number of pages of contiguous component data
+/// on each NUMA node. This is a collective operation. The trees may differ between CPUs: the components are matched
+/// by their path below root, and siblings are printed in alphabetical order. Each printed line starts with prefix.
+void print_memory_tree(Component& root, const std::string& prefix="");
+
+}
+}
+
+#endif // cf3_common_AccountedComponent_hpp
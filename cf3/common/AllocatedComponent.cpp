@@ -13,6 +13,8 @@
 
 #include "common/AllocatedComponent.hpp"
 #include "common/Action.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
 #include "common/PropertyList.hpp"
 #include "common/Timer.hpp"
 
@@ -25,16 +27,28 @@ namespace common {
 
 struct TimedActionImpl::Implementation
 {
-  Implementation(Action& timed_action) : m_timed_component(timed_action)
+  Implementation(Action& timed_action) :
+    m_high_water_start(0.),
+    m_high_water(0.),
+    m_high_water_increase(0.),
+    m_timed_component(timed_action)
   {
     m_timed_component.properties().add("timer_count", Uint(0));
     m_timed_component.properties().add("timer_minimum", Real(0.));
     m_timed_component.properties().add("timer_mean", Real(0.));
     m_timed_component.properties().add("timer_maximum", Real(0.));
     m_timed_component.properties().add("timer_variance", Real(0.));
+    m_timed_component.properties().add("memory_high_water", Real(0.));
+    m_timed_component.properties().add("memory_high_water_increase", Real(0.));
   }
   
   Timer m_timer;
+
+  /// Process high-water mark at the start of the current execution, after the last execution,
+  /// and the sum of the increases during all executions, which shows which action set the peak
+  Real m_high_water_start;
+  Real m_high_water;
+  Real m_high_water_increase;
   
   boost::accumulators::accumulator_set
   <
@@ -65,12 +79,15 @@ TimedActionImpl::~TimedActionImpl()
 
 void TimedActionImpl::start_timing()
 {
+  m_implementation->m_high_water_start = OSystem::instance().layer()->memory_high_water();
   m_implementation->m_timer.restart();
 }
 
 void TimedActionImpl::stop_timing()
 {
   m_implementation->m_timing_stats(m_implementation->m_timer.elapsed());
+  m_implementation->m_high_water = OSystem::instance().layer()->memory_high_water();
+  m_implementation->m_high_water_increase += m_implementation->m_high_water - m_implementation->m_high_water_start;
 }
 
 void TimedActionImpl::store_timings()
@@ -80,6 +97,8 @@ void TimedActionImpl::store_timings()
   m_implementation->m_timed_component.properties().set("timer_mean", boost::accumulators::mean(m_implementation->m_timing_stats));
   m_implementation->m_timed_component.properties().set("timer_maximum", boost::accumulators::max(m_implementation->m_timing_stats));
   m_implementation->m_timed_component.properties().set("timer_variance", boost::accumulators::lazy_variance(m_implementation->m_timing_stats));
+  m_implementation->m_timed_component.properties().set("memory_high_water", m_implementation->m_high_water);
+  m_implementation->m_timed_component.properties().set("memory_high_water_increase", m_implementation->m_high_water_increase);
 }
 
 #endif
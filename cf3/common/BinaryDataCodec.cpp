@@ -0,0 +1,130 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/BinaryDataCodec.hpp"
+#include "common/StringConversion.hpp"
+#include "common/ThreadPool.hpp"
+
+namespace cf3 {
+namespace common {
+namespace detail {
+
+namespace
+{
+  /// Executes the function for the items in [begin, end)
+  void process_items(const boost::function<void(const Uint)>& f, const Uint begin, const Uint end)
+  {
+    for(Uint i = begin; i != end; ++i)
+      f(i);
+  }
+
+  /// Execute f for each item from 0 to nb_items, distributing the items dynamically over at most nb_threads threads of the pool
+  void parallel_for(const Uint nb_items, const Uint nb_threads, const boost::function<void(const Uint)>& f)
+  {
+    try
+    {
+      ThreadPool::instance().parallel_for(0, nb_items, boost::bind(process_items, boost::cref(f), _1, _2), ThreadPool::DYNAMIC, 1, nb_threads);
+    }
+    catch(ParallelError& e)
+    {
+      throw FileSystemError(FromHere(), "Error processing binary data chunk: " + e.msg());
+    }
+  }
+
+  void compress_chunk(const BinaryDataCodec& codec, const char* data, const std::size_t count, const std::size_t chunk_size, std::vector< std::vector<char> >& chunks, const Uint i)
+  {
+    const std::size_t begin = i*chunk_size;
+    codec.compress(data + begin, std::min(chunk_size, count - begin), chunks[i]);
+  }
+
+  void decompress_chunk(const BinaryDataCodec& codec, const std::vector< std::vector<char> >& compressed, const std::vector<char*>& data, const std::vector<std::size_t>& counts, const Uint i)
+  {
+    codec.decompress(compressed[i].empty() ? 0 : &compressed[i][0], compressed[i].size(), data[i], counts[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+BinaryDataCodec::BinaryDataCodec(const std::string& codec_name, const Uint compression_level) :
+  name(codec_name),
+  level(compression_level)
+{
+  if(name != "zlib" && name != "none")
+    throw BadValue(FromHere(), "Unknown binary data codec " + name + ", valid values are zlib and none");
+
+  if(level > 9)
+    throw BadValue(FromHere(), "Compression level " + to_str(level) + " is out of range, valid values are 0 to 9");
+}
+
+void BinaryDataCodec::compress(const char* data, const std::size_t count, std::vector<char>& result) const
+{
+  result.clear();
+
+  if(name == "none")
+  {
+    result.assign(data, data + count);
+    return;
+  }
+
+  const int zlib_level = level == 0 ? boost::iostreams::zlib::default_compression : static_cast<int>(level);
+  boost::iostreams::filtering_ostream compressing_stream;
+  compressing_stream.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib_params(zlib_level)));
+  compressing_stream.push(boost::iostreams::back_inserter(result));
+  compressing_stream.write(data, count);
+  compressing_stream.reset(); // flushes the compressor
+}
+
+void BinaryDataCodec::decompress(const char* compressed, const std::size_t compressed_count, char* data, const std::size_t count) const
+{
+  if(name == "none")
+  {
+    if(compressed_count != count)
+      throw FileFormatError(FromHere(), "Uncompressed chunk has size " + to_str(static_cast<Uint>(compressed_count)) + " instead of " + to_str(static_cast<Uint>(count)));
+    std::memcpy(data, compressed, count);
+    return;
+  }
+
+  boost::iostreams::filtering_istream decompressing_stream;
+  decompressing_stream.push(boost::iostreams::zlib_decompressor());
+  decompressing_stream.push(boost::iostreams::array_source(compressed, compressed_count));
+  decompressing_stream.read(data, count);
+  if(static_cast<std::size_t>(decompressing_stream.gcount()) != count)
+    throw FileFormatError(FromHere(), "Compressed chunk expanded to " + to_str(static_cast<Uint>(decompressing_stream.gcount())) + " bytes instead of " + to_str(static_cast<Uint>(count)));
+}
+
+void BinaryDataCodec::compress_chunks(const char* data, const std::size_t count, const std::size_t chunk_size, const Uint nb_threads, std::vector< std::vector<char> >& chunks) const
+{
+  cf3_assert(chunk_size != 0);
+  const Uint nb_chunks = (count + chunk_size - 1) / chunk_size;
+  chunks.resize(nb_chunks);
+  parallel_for(nb_chunks, nb_threads, boost::bind(compress_chunk, boost::cref(*this), data, count, chunk_size, boost::ref(chunks), _1));
+}
+
+void BinaryDataCodec::decompress_chunks(const std::vector< std::vector<char> >& compressed, const std::vector<char*>& data, const std::vector<std::size_t>& counts, const Uint nb_threads) const
+{
+  cf3_assert(compressed.size() == data.size());
+  cf3_assert(compressed.size() == counts.size());
+  parallel_for(compressed.size(), nb_threads, boost::bind(decompress_chunk, boost::cref(*this), boost::cref(compressed), boost::cref(data), boost::cref(counts), _1));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+} // detail
+} // common
+} // cf3
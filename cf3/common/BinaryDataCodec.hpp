@@ -0,0 +1,59 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_BinaryDataCodec_hpp
+#define cf3_common_BinaryDataCodec_hpp
+
+#include <string>
+#include <vector>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+namespace detail {
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+/// Compression settings for the chunks of a binary data block
+struct Common_API BinaryDataCodec
+{
+  /// @param codec_name Either "zlib" or "none"
+  /// @param level Compression level for zlib, from 1 (fastest) to 9 (smallest). 0 selects the zlib default.
+  BinaryDataCodec(const std::string& codec_name, const Uint level = 0);
+
+  /// Compress count bytes of data into result, replacing its contents
+  void compress(const char* data, const std::size_t count, std::vector<char>& result) const;
+
+  /// Decompress compressed_count bytes from compressed into exactly count bytes of data
+  /// @throw FileFormatError if the compressed data does not expand to count bytes
+  void decompress(const char* compressed, const std::size_t compressed_count, char* data, const std::size_t count) const;
+
+  /// Compress the data in independent chunks of chunk_size bytes (the last chunk may be smaller), using nb_threads threads
+  void compress_chunks(const char* data, const std::size_t count, const std::size_t chunk_size, const Uint nb_threads, std::vector< std::vector<char> >& chunks) const;
+
+  /// Decompress a sequence of chunks in parallel.
+  /// @param compressed Compressed data of each chunk
+  /// @param data Output location for each chunk
+  /// @param counts Uncompressed size of each chunk
+  void decompress_chunks(const std::vector< std::vector<char> >& compressed, const std::vector<char*>& data, const std::vector<std::size_t>& counts, const Uint nb_threads) const;
+
+  const std::string name;
+  const Uint level;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+} // detail
+} // common
+} // cf3
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_BinaryDataCodec_hpp
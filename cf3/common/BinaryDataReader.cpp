@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 
@@ -16,6 +18,7 @@
 #include "common/Signal.hpp"
 #include "common/PropertyList.hpp"
 #include "common/OptionList.hpp"
+#include "common/BinaryDataCodec.hpp"
 #include "common/BinaryDataReader.hpp"
 #include "common/FindComponents.hpp"
 
@@ -31,13 +34,19 @@ namespace common {
 
 struct BinaryDataReader::Implementation
 {
-  Implementation(const URI& file) :
-    xml_doc(XML::parse_file(file))
+  Implementation(const URI& file, const Uint threads) :
+    xml_doc(XML::parse_file(file)),
+    nb_threads(threads)
   {
     PE::Comm& comm = PE::Comm::instance();
 
     XmlNode cfbinary(xml_doc->content->first_node("cfbinary"));
-    cf3_assert(from_str<Uint>(cfbinary.attribute_value("version")) == version());
+    file_version = from_str<Uint>(cfbinary.attribute_value("version"));
+    if(file_version == 0 || file_version > version())
+      throw FileFormatError(FromHere(), "Unsupported binary data version " + to_str(file_version) + " in file " + file.path());
+
+    // Version 1 files consist of a single zlib stream per block
+    codec.reset(new detail::BinaryDataCodec(file_version == 1 ? std::string("zlib") : cfbinary.attribute_value("codec")));
 
     XmlNode nodes(cfbinary.content->first_node(("nodes")));
     XmlNode node(nodes.content->first_node("node"));
@@ -63,7 +72,7 @@ struct BinaryDataReader::Implementation
 
   Uint version() const
   {
-    static const Uint current_version = 1;
+    static const Uint current_version = 2;
     return current_version;
   }
   
@@ -79,15 +88,12 @@ struct BinaryDataReader::Implementation
     throw SetupError(FromHere(), "Block with index " + to_str(block_idx) + " was not found");
   }
 
-  void read_data_block(char *data, const Uint count, const Uint block_idx)
+  // Position the file at the start of the block data, after checking the prefix
+  void seek_block(const XmlNode& block_node, const Uint block_idx)
   {
     static const std::string block_prefix("__CFDATA_BEGIN");
-    
-    XmlNode block_node = get_block_node(block_idx);
-      
+
     const Uint block_begin = from_str<Uint>(block_node.attribute_value("begin"));
-    const Uint block_end = from_str<Uint>(block_node.attribute_value("end"));
-    const Uint compressed_size = block_end - block_begin - block_prefix.size();
 
     // Check the prefix
     binary_file.seekg(block_begin);
@@ -96,21 +102,136 @@ struct BinaryDataReader::Implementation
     const std::string read_prefix(prefix_buf.begin(), prefix_buf.end());
     if(read_prefix != block_prefix)
       throw SetupError(FromHere(), "Bad block prefix for block " + to_str(block_idx));
-   
-    if(count != 0)
+  }
+
+  void read_data_block(char *data, const Uint count, const Uint block_idx)
+  {
+    XmlNode block_node = get_block_node(block_idx);
+    const Uint nb_rows = from_str<Uint>(block_node.attribute_value("nb_rows"));
+    if(count == 0 || nb_rows == 0)
+      return;
+
+    read_data_rows(data, count / nb_rows, 0, nb_rows, block_idx);
+  }
+
+  void read_data_rows(char* data, const Uint row_bytes, const Uint first_row, const Uint nb_rows, const Uint block_idx)
+  {
+    XmlNode block_node = get_block_node(block_idx);
+    const Uint block_rows = from_str<Uint>(block_node.attribute_value("nb_rows"));
+    if(first_row + nb_rows > block_rows)
+      throw BadValue(FromHere(), "Rows " + to_str(first_row) + " to " + to_str(first_row + nb_rows) + " are out of range for block " + to_str(block_idx) + " with " + to_str(block_rows) + " rows");
+
+    if(nb_rows == 0)
+      return;
+
+    seek_block(block_node, block_idx);
+
+    if(file_version == 1)
+      read_stream_rows(block_node, data, row_bytes, first_row, nb_rows);
+    else
+      read_chunked_rows(block_node, data, row_bytes, first_row, nb_rows);
+  }
+
+  // Read from a block written as a single compressed stream, decompressing up to the last requested row
+  void read_stream_rows(const XmlNode& block_node, char* data, const Uint row_bytes, const Uint first_row, const Uint nb_rows)
+  {
+    static const std::string block_prefix("__CFDATA_BEGIN");
+
+    const Uint block_begin = from_str<Uint>(block_node.attribute_value("begin"));
+    const Uint block_end = from_str<Uint>(block_node.attribute_value("end"));
+    const Uint compressed_size = block_end - block_begin - block_prefix.size();
+
+    // Build a decompressing stream
+    boost::iostreams::filtering_istream decompressing_stream;
+    decompressing_stream.set_auto_close(false);
+    decompressing_stream.push(boost::iostreams::zlib_decompressor());
+    decompressing_stream.push(boost::iostreams::restrict(binary_file, 0, compressed_size));
+
+    // Skip the rows before the requested range
+    std::vector<char> skip_buf(std::min(first_row*row_bytes, 65536u));
+    for(Uint to_skip = first_row*row_bytes; to_skip != 0;)
     {
-      // Build a decompressing stream
-      boost::iostreams::filtering_istream decompressing_stream;
-      decompressing_stream.set_auto_close(false);
-      decompressing_stream.push(boost::iostreams::zlib_decompressor());
-      decompressing_stream.push(boost::iostreams::restrict(binary_file, 0, compressed_size));
-      
-      // Read the data
-      decompressing_stream.read(data, count);
-      decompressing_stream.pop();
+      const Uint skip_count = std::min(to_skip, static_cast<Uint>(skip_buf.size()));
+      decompressing_stream.read(&skip_buf[0], skip_count);
+      to_skip -= skip_count;
+    }
+
+    // Read the data
+    decompressing_stream.read(data, row_bytes*nb_rows);
+    decompressing_stream.pop();
+  }
+
+  // Read from a chunked block, only decompressing the chunks that overlap the requested rows
+  void read_chunked_rows(const XmlNode& block_node, char* data, const Uint row_bytes, const Uint first_row, const Uint nb_rows)
+  {
+    const Uint block_rows = from_str<Uint>(block_node.attribute_value("nb_rows"));
+    const Uint chunk_rows = from_str<Uint>(block_node.attribute_value("chunk_rows"));
+
+    // Chunk index
+    Uint nb_chunks = 0;
+    binary_file.read(reinterpret_cast<char*>(&nb_chunks), sizeof(Uint));
+    std::vector<Uint> chunk_sizes(nb_chunks);
+    if(nb_chunks != 0)
+      binary_file.read(reinterpret_cast<char*>(&chunk_sizes[0]), sizeof(Uint)*nb_chunks);
+
+    const Uint first_chunk = first_row / chunk_rows;
+    const Uint end_chunk = (first_row + nb_rows - 1) / chunk_rows + 1;
+    cf3_assert(end_chunk <= nb_chunks);
+
+    Uint skipped_bytes = 0;
+    for(Uint i = 0; i != first_chunk; ++i)
+      skipped_bytes += chunk_sizes[i];
+    binary_file.seekg(skipped_bytes, std::ios_base::cur);
+
+    const Uint nb_read_chunks = end_chunk - first_chunk;
+    std::vector< std::vector<char> > compressed(nb_read_chunks);
+    std::vector<char*> targets(nb_read_chunks);
+    std::vector<std::size_t> counts(nb_read_chunks);
+
+    // Chunks that are only partially requested are decompressed into a buffer first
+    std::vector<char> first_buffer, last_buffer;
+
+    for(Uint i = 0; i != nb_read_chunks; ++i)
+    {
+      const Uint chunk_idx = first_chunk + i;
+      compressed[i].resize(chunk_sizes[chunk_idx]);
+      if(chunk_sizes[chunk_idx] != 0)
+        binary_file.read(&compressed[i][0], chunk_sizes[chunk_idx]);
+
+      const Uint chunk_begin = chunk_idx*chunk_rows;
+      const Uint chunk_end = std::min(chunk_begin + chunk_rows, block_rows);
+      counts[i] = (chunk_end - chunk_begin)*row_bytes;
+
+      if(chunk_begin < first_row)
+      {
+        first_buffer.resize(counts[i]);
+        targets[i] = &first_buffer[0];
+      }
+      else if(chunk_end > first_row + nb_rows)
+      {
+        last_buffer.resize(counts[i]);
+        targets[i] = &last_buffer[0];
+      }
+      else
+      {
+        targets[i] = data + (chunk_begin - first_row)*row_bytes;
+      }
+    }
+
+    codec->decompress_chunks(compressed, targets, counts, nb_threads);
+
+    // Copy the requested part of the partial chunks
+    if(!first_buffer.empty())
+    {
+      const Uint chunk_begin = first_chunk*chunk_rows;
+      const Uint copy_end = std::min(chunk_begin + chunk_rows, first_row + nb_rows);
+      std::copy(first_buffer.begin() + (first_row - chunk_begin)*row_bytes, first_buffer.begin() + (copy_end - chunk_begin)*row_bytes, data);
+    }
+    if(!last_buffer.empty())
+    {
+      const Uint chunk_begin = (end_chunk - 1)*chunk_rows;
+      std::copy(last_buffer.begin(), last_buffer.begin() + (first_row + nb_rows - chunk_begin)*row_bytes, data + (chunk_begin - first_row)*row_bytes);
     }
-    
-    cf3_assert(binary_file.tellg() == block_end);
   }
 
   // XML document describing all data added
@@ -121,6 +242,15 @@ struct BinaryDataReader::Implementation
 
   // Xml data for the blocks associated with the current rank
   XmlNode my_node;
+
+  // Version of the file that is being read
+  Uint file_version;
+
+  // Compression used in the file
+  boost::scoped_ptr<detail::BinaryDataCodec> codec;
+
+  // Number of threads used for decompression
+  const Uint nb_threads;
 };
   
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -131,6 +261,10 @@ BinaryDataReader::BinaryDataReader ( const std::string& name ) : Component(name)
     .pretty_name("File")
     .description("File name for the output file")
     .attach_trigger(boost::bind(&BinaryDataReader::trigger_file, this));
+
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to decompress the chunks of a block");
 }
 
 BinaryDataReader::~BinaryDataReader()
@@ -172,6 +306,14 @@ void BinaryDataReader::read_data_block(char *data, const Uint count, const Uint
   m_implementation->read_data_block(data, count, block_idx);
 }
 
+void BinaryDataReader::read_data_rows(char* data, const Uint row_bytes, const Uint first_row, const Uint nb_rows, const Uint block_idx)
+{
+  if(is_null(m_implementation.get()))
+    throw SetupError(FromHere(), "No open file for BinaryDataReader at " + uri().path());
+
+  m_implementation->read_data_rows(data, row_bytes, first_row, nb_rows, block_idx);
+}
+
 void BinaryDataReader::trigger_file()
 {
   const URI file_uri = options().value<URI>("file");
@@ -179,7 +321,7 @@ void BinaryDataReader::trigger_file()
   {
     throw SetupError(FromHere(), "Input file " + file_uri.path() + " does not exist");
   }
-  m_implementation.reset(new Implementation(file_uri));
+  m_implementation.reset(new Implementation(file_uri, std::max(1u, options().value<Uint>("nb_threads"))));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
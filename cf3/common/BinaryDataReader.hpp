@@ -45,6 +45,13 @@ public: // functions
     const Uint cols = block_cols(block_idx);
     table.set_row_size(cols);
     table.resize(rows);
+    if(!table.is_row_major())
+    {
+      typename Table<T>::ArrayT row_major(boost::extents[rows][cols]);
+      read_data_block(reinterpret_cast<char*>(row_major.data()), sizeof(T)*rows*cols, block_idx);
+      table.array() = row_major;
+      return;
+    }
     read_data_block(reinterpret_cast<char*>(table.array().data()), sizeof(T)*rows*cols, block_idx);
   }
   
@@ -60,6 +67,38 @@ public: // functions
     read_data_block(reinterpret_cast<char*>(list.array().data()), sizeof(T)*rows, block_idx);
   }
 
+  /// Read nb_rows rows, starting at first_row, from the given block into the supplied table. The table is resized to nb_rows.
+  /// Only the chunks containing the requested rows are read and decompressed.
+  template<typename T>
+  void read_table_rows(Table<T>& table, const Uint block_idx, const Uint first_row, const Uint nb_rows)
+  {
+    if(block_type_name(block_idx) != class_name<T>())
+      throw SetupError(FromHere(), "Block at index " + to_str(block_idx) + " is of type " + block_type_name(block_idx) + " and can't be stored in " + table.type_name());
+
+    const Uint cols = block_cols(block_idx);
+    table.set_row_size(cols);
+    table.resize(nb_rows);
+    if(!table.is_row_major())
+    {
+      typename Table<T>::ArrayT row_major(boost::extents[nb_rows][cols]);
+      read_data_rows(reinterpret_cast<char*>(row_major.data()), sizeof(T)*cols, first_row, nb_rows, block_idx);
+      table.array() = row_major;
+      return;
+    }
+    read_data_rows(reinterpret_cast<char*>(table.array().data()), sizeof(T)*cols, first_row, nb_rows, block_idx);
+  }
+
+  /// Read nb_rows entries, starting at first_row, from the given block into the supplied list. The list is resized to nb_rows.
+  template<typename T>
+  void read_list_rows(List<T>& list, const Uint block_idx, const Uint first_row, const Uint nb_rows)
+  {
+    if(block_type_name(block_idx) != class_name<T>())
+      throw SetupError(FromHere(), "Block at index " + to_str(block_idx) + " is of type " + block_type_name(block_idx) + " and can't be stored in " + list.type_name());
+
+    list.resize(nb_rows);
+    read_data_rows(reinterpret_cast<char*>(list.array().data()), sizeof(T), first_row, nb_rows, block_idx);
+  }
+
   /// Close the current file
   void close();
 
@@ -79,6 +118,9 @@ private:
   // Read aata block from the binary file
   void read_data_block(char* data, const Uint count, const Uint block_idx);
 
+  // Read a range of rows from a data block
+  void read_data_rows(char* data, const Uint row_bytes, const Uint first_row, const Uint nb_rows, const Uint block_idx);
+
   // Trigger on output file change
   void trigger_file();
 
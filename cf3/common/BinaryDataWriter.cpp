@@ -4,20 +4,24 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
-#include <boost/assign/list_of.hpp>
 
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/filter/zlib.hpp>
-#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "common/Log.hpp"
 #include "common/Signal.hpp"
 #include "common/PropertyList.hpp"
 #include "common/OptionList.hpp"
+#include "common/BinaryDataCodec.hpp"
 #include "common/BinaryDataWriter.hpp"
 #include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/OutputQueue.hpp"
 
 #include "common/PE/Comm.hpp"
 
@@ -29,14 +33,49 @@
 namespace cf3 {
 namespace common {
 
+namespace detail
+{
+  /// Finish the files that are still open, as a PE::Comm finalize hook
+  void close_writers_before_finalize()
+  {
+    try
+    {
+      BinaryDataWriter::close_all();
+    }
+    catch(FileSystemError& e)
+    {
+      CFerror << e.what() << CFendl;
+    }
+  }
+
+  /// Writers with an open file, in the order the files were opened. Never destroyed, since
+  /// PE::Comm may be finalized during static destruction. The first call registers the hook that
+  /// closes them when PE::Comm is finalized.
+  std::vector<BinaryDataWriter*>& open_writers()
+  {
+    static std::vector<BinaryDataWriter*>* writers = 0;
+    if(is_null(writers))
+    {
+      writers = new std::vector<BinaryDataWriter*>();
+      PE::Comm::instance().add_finalize_hook(&close_writers_before_finalize);
+    }
+    return *writers;
+  }
+}
+
 struct BinaryDataWriter::Implementation
 {
-  Implementation(const URI& file) :
+  Implementation(const URI& file, const bool async, const detail::BinaryDataCodec& block_codec, const Uint block_chunk_size, const Uint block_nb_threads) :
     filename(build_filename(file, PE::Comm::instance().rank())),
     xml_filename(file),
+    asynchronous(async),
+    codec(block_codec),
+    chunk_size(block_chunk_size),
+    nb_threads(block_nb_threads),
     index(0),
     xml_doc("1.0", "ISO-8859-1"),
-    m_total_count(0)
+    m_total_count(0),
+    m_nb_pending(0)
   {
     const Uint v = version();
     out_file.open(filename, std::ios_base::out | std::ios_base::binary);
@@ -48,6 +87,7 @@ struct BinaryDataWriter::Implementation
     {
       XmlNode cfbinary = xml_doc.add_node("cfbinary");
       cfbinary.set_attribute("version", to_str(version()));
+      cfbinary.set_attribute("codec", codec.name);
       node_xml_data.reserve(comm.size());
       XmlNode node_list = cfbinary.add_node("nodes");
       for(Uint i = 0; i != comm.size(); ++i)
@@ -62,46 +102,95 @@ struct BinaryDataWriter::Implementation
 
   ~Implementation()
   {
-    CFdebug << "wrote a total of " << m_total_count << " bytes with a compression ratio of " << static_cast<Real>(out_file.tellp()) / static_cast<Real>(m_total_count) * 100. << "%" << CFendl;
+    // Never leave the I/O thread with a dangling pointer to this object
+    wait_for_pending();
     out_file.close();
-    if(PE::Comm::instance().rank() == 0)
-      XML::to_file(xml_doc, xml_filename);
-
-    PE::Comm::instance().barrier();
   }
 
+  /// Data describing a single block on the current CPU
+  struct BlockInfo
+  {
+    std::string name;
+    std::string type_name;
+    Uint nb_rows;
+    Uint nb_cols;
+    Uint chunk_rows;
+    Uint begin;
+    Uint end;
+  };
+
   Uint write_data_block(const char* data, const std::streamsize count, const std::string& list_name, const Uint nb_rows, const Uint nb_cols, const std::string& type_name)
   {
     cf3_assert(out_file.is_open());
-    PE::Comm& comm = PE::Comm::instance();
-    // Prefix and suffix markers
-    static const std::string block_prefix("__CFDATA_BEGIN");
 
-    const Uint block_begin = out_file.tellp();
+    const Uint block_idx = index;
 
-    // Write the prefix
-    out_file.write(block_prefix.c_str(), block_prefix.size());
-    
-    if(count != 0)
+    // Chunks hold an integer number of rows, so a range of rows can be read by decompressing only the chunks that contain it
+    const Uint row_bytes = nb_rows == 0 ? 0 : count / nb_rows;
+    const Uint chunk_rows = row_bytes == 0 ? 1 : std::max(1u, chunk_size / row_bytes);
     {
-      // Build a compressed stream
-      boost::iostreams::filtering_ostream compressing_stream;
-      compressing_stream.push(boost::iostreams::zlib_compressor());
-      compressing_stream.push(out_file);
-      
-      // Write the data
-      compressing_stream.write(data, count);
-      compressing_stream.pop();
+      boost::lock_guard<boost::mutex> guard(m_mutex);
+      BlockInfo info;
+      info.name = list_name;
+      info.type_name = type_name;
+      info.nb_rows = nb_rows;
+      info.nb_cols = nb_cols;
+      info.chunk_rows = chunk_rows;
+      info.begin = 0;
+      info.end = 0;
+      m_blocks.push_back(info);
     }
 
-    const Uint block_end = out_file.tellp();
+    if(asynchronous)
+    {
+      // Snapshot the data, so the caller is free to modify it while the I/O thread compresses and writes
+      boost::shared_ptr< std::vector<char> > staging(new std::vector<char>(data, data + count));
+      {
+        boost::lock_guard<boost::mutex> guard(m_mutex);
+        ++m_nb_pending;
+      }
+      OutputQueue::instance().push(boost::bind(&Implementation::write_staged, this, staging, chunk_rows*row_bytes, block_idx));
+    }
+    else
+    {
+      compress_block(data, count, chunk_rows*row_bytes, block_idx);
+    }
+
+    ++index;
+    m_total_count += count;
+
+    return block_idx;
+  }
+
+  /// Wait for the pending blocks, collect the block locations from all CPUs and write the XML file.
+  /// This is a collective operation.
+  void finish()
+  {
+    wait_for_pending();
+
+    PE::Comm& comm = PE::Comm::instance();
+
+    CFdebug << "wrote a total of " << m_total_count << " bytes with a compression ratio of " << static_cast<Real>(out_file.tellp()) / static_cast<Real>(m_total_count) * 100. << "%" << CFendl;
+    out_file.close();
+
+    // Data describing the blocks on the current CPU. The chunk size in rows depends on the row size of the local data,
+    // so it is gathered along with the sizes and offsets.
+    static const Uint block_info_size = 5;
+    const Uint nb_blocks = m_blocks.size();
+    std::vector<Uint> my_block_info;
+    my_block_info.reserve(block_info_size*nb_blocks);
+    BOOST_FOREACH(const BlockInfo& info, m_blocks)
+    {
+      my_block_info.push_back(info.nb_rows);
+      my_block_info.push_back(info.nb_cols);
+      my_block_info.push_back(info.chunk_rows);
+      my_block_info.push_back(info.begin);
+      my_block_info.push_back(info.end);
+    }
 
-    // Data describing the block on the current CPU
-    const std::vector<Uint> my_block_info = boost::assign::list_of(nb_rows)(nb_cols)(block_begin)(block_end);
-    const Uint block_info_size = my_block_info.size();
     std::vector<Uint> global_block_info;
     const Uint root = 0;
-    if(comm.is_active())
+    if(comm.is_active() && nb_blocks != 0)
     {
       comm.gather(my_block_info, global_block_info, root);
     }
@@ -116,27 +205,98 @@ struct BinaryDataWriter::Implementation
       const Uint nb_procs = comm.size();
       for(Uint i = 0; i != nb_procs; ++i)
       {
-        XmlNode block_xml = node_xml_data[i].add_node("block");
-        const Uint j = i*block_info_size;
-        block_xml.set_attribute("name", list_name);
-        block_xml.set_attribute("index", to_str(index));
-        block_xml.set_attribute("type_name", type_name);
-        block_xml.set_attribute("nb_rows", to_str(global_block_info[j]));
-        block_xml.set_attribute("nb_cols", to_str(global_block_info[j+1]));
-        block_xml.set_attribute("begin", to_str(global_block_info[j+2]));
-        block_xml.set_attribute("end", to_str(global_block_info[j+3]));
+        for(Uint block_idx = 0; block_idx != nb_blocks; ++block_idx)
+        {
+          XmlNode block_xml = node_xml_data[i].add_node("block");
+          const Uint j = (i*nb_blocks + block_idx)*block_info_size;
+          block_xml.set_attribute("name", m_blocks[block_idx].name);
+          block_xml.set_attribute("index", to_str(block_idx));
+          block_xml.set_attribute("type_name", m_blocks[block_idx].type_name);
+          block_xml.set_attribute("nb_rows", to_str(global_block_info[j]));
+          block_xml.set_attribute("nb_cols", to_str(global_block_info[j+1]));
+          block_xml.set_attribute("chunk_rows", to_str(global_block_info[j+2]));
+          block_xml.set_attribute("begin", to_str(global_block_info[j+3]));
+          block_xml.set_attribute("end", to_str(global_block_info[j+4]));
+        }
       }
+      XML::to_file(xml_doc, xml_filename);
     }
 
-    ++index;
-    m_total_count += count;
+    comm.barrier();
+
+    if(!m_failure.empty())
+      throw FileSystemError(FromHere(), "Error writing binary data to " + filename + ": " + m_failure);
+  }
+
+  // Compress a block and append it to the binary file. The block consists of the prefix, followed by
+  // the chunk index (number of chunks and the compressed size of each chunk) and the compressed chunks
+  void compress_block(const char* data, const std::streamsize count, const Uint chunk_bytes, const Uint block_idx)
+  {
+    // Prefix and suffix markers
+    static const std::string block_prefix("__CFDATA_BEGIN");
+
+    std::vector< std::vector<char> > chunks;
+    if(count != 0)
+      codec.compress_chunks(data, count, chunk_bytes, nb_threads, chunks);
 
-    return index - 1;
+    std::vector<Uint> chunk_index;
+    chunk_index.reserve(chunks.size() + 1);
+    chunk_index.push_back(chunks.size());
+    BOOST_FOREACH(const std::vector<char>& chunk, chunks)
+    {
+      chunk_index.push_back(chunk.size());
+    }
+
+    const Uint block_begin = out_file.tellp();
+
+    // Write the prefix
+    out_file.write(block_prefix.c_str(), block_prefix.size());
+    out_file.write(reinterpret_cast<const char*>(&chunk_index[0]), sizeof(Uint)*chunk_index.size());
+    BOOST_FOREACH(const std::vector<char>& chunk, chunks)
+    {
+      if(!chunk.empty())
+        out_file.write(&chunk[0], chunk.size());
+    }
+
+    const Uint block_end = out_file.tellp();
+
+    boost::lock_guard<boost::mutex> guard(m_mutex);
+    m_blocks[block_idx].begin = block_begin;
+    m_blocks[block_idx].end = block_end;
+  }
+
+  // Task executed by the I/O thread in asynchronous mode
+  void write_staged(const boost::shared_ptr< std::vector<char> >& staging, const Uint chunk_bytes, const Uint block_idx)
+  {
+    std::string failure;
+    try
+    {
+      compress_block(staging->empty() ? 0 : &(*staging)[0], staging->size(), chunk_bytes, block_idx);
+    }
+    catch(std::exception& e)
+    {
+      failure = e.what();
+    }
+
+    {
+      boost::lock_guard<boost::mutex> guard(m_mutex);
+      if(!failure.empty())
+        m_failure = failure;
+      --m_nb_pending;
+    }
+    m_blocks_written.notify_all();
+  }
+
+  void wait_for_pending()
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while(m_nb_pending != 0)
+      m_blocks_written.wait(lock);
   }
 
   Uint version() const
   {
-    static const Uint current_version = 1;
+    static const Uint current_version = 2;
     return current_version;
   }
 
@@ -152,6 +312,14 @@ struct BinaryDataWriter::Implementation
   const URI xml_filename;
   boost::filesystem::fstream out_file;
 
+  // True if blocks are compressed and written by the OutputQueue
+  const bool asynchronous;
+
+  // Compression settings
+  const detail::BinaryDataCodec codec;
+  const Uint chunk_size;
+  const Uint nb_threads;
+
   // Index of the next block to write
   Uint index;
 
@@ -160,6 +328,15 @@ struct BinaryDataWriter::Implementation
 
   std::vector<XmlNode> node_xml_data;
   Uint m_total_count;
+
+  // Blocks added so far, their location is filled in once they are written
+  std::vector<BlockInfo> m_blocks;
+
+  // Synchronization with the I/O thread
+  boost::mutex m_mutex;
+  boost::condition_variable m_blocks_written;
+  Uint m_nb_pending;
+  std::string m_failure;
 };
   
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -170,23 +347,83 @@ BinaryDataWriter::BinaryDataWriter ( const std::string& name ) : Component(name)
     .pretty_name("File")
     .description("File name for the output file")
     .attach_trigger(boost::bind(&BinaryDataWriter::trigger_file, this));
+
+  options().add("asynchronous", false)
+    .pretty_name("Asynchronous")
+    .description("Copy the data to a staging buffer and compress and write it in the background, using the OutputQueue. The file is complete after close.");
+
+  options().add("codec", std::string("zlib"))
+    .pretty_name("Codec")
+    .description("Compression used for the data chunks: zlib or none");
+
+  options().add("compression_level", 0u)
+    .pretty_name("Compression Level")
+    .description("zlib compression level, from 1 (fastest) to 9 (smallest). 0 selects the zlib default");
+
+  options().add("chunk_size", 1048576u)
+    .pretty_name("Chunk Size")
+    .description("Approximate size in bytes of the independently compressed chunks a data block is split into. Chunks always contain whole rows.");
+
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to compress the chunks of a block");
 }
 
 BinaryDataWriter::~BinaryDataWriter()
 {
-  close();
+  try
+  {
+    close();
+  }
+  catch(FileSystemError& e)
+  {
+    CFerror << e.what() << CFendl;
+  }
 }
 
 void BinaryDataWriter::close()
 {
-  m_implementation.reset();
+  if(is_null(m_implementation.get()))
+    return;
+
+  std::vector<BinaryDataWriter*>& writers = detail::open_writers();
+  writers.erase(std::remove(writers.begin(), writers.end(), this), writers.end());
+
+  // Make sure the implementation is gone, even if finishing the file fails
+  boost::scoped_ptr<Implementation> implementation;
+  implementation.swap(m_implementation);
+  implementation->finish();
+}
+
+void BinaryDataWriter::close_all()
+{
+  std::string failures;
+  while(!detail::open_writers().empty())
+  {
+    try
+    {
+      detail::open_writers().front()->close();
+    }
+    catch(FileSystemError& e)
+    {
+      failures += "\n" + e.msg();
+    }
+  }
+
+  if(!failures.empty())
+    throw FileSystemError(FromHere(), "Error closing binary data files:" + failures);
 }
 
 Uint BinaryDataWriter::write_data_block(const char* data, const std::streamsize count, const std::string& list_name, const Uint nb_rows, const Uint nb_cols, const std::string& type_name)
 {
   if(is_null(m_implementation.get()))
   {
-    m_implementation.reset(new Implementation(options().value<URI>("file")));
+    const detail::BinaryDataCodec codec(options().value<std::string>("codec"), options().value<Uint>("compression_level"));
+    const Uint chunk_size = options().value<Uint>("chunk_size");
+    if(chunk_size == 0)
+      throw SetupError(FromHere(), "Chunk size for " + uri().path() + " must not be zero");
+    m_implementation.reset(new Implementation(options().value<URI>("file"), options().value<bool>("asynchronous"), codec, chunk_size, std::max(1u, options().value<Uint>("nb_threads"))));
+    detail::open_writers().push_back(this);
   }
 
   return m_implementation->write_data_block(data, count, list_name, nb_rows, nb_cols, type_name);
@@ -194,7 +431,7 @@ Uint BinaryDataWriter::write_data_block(const char* data, const std::streamsize
 
 void BinaryDataWriter::trigger_file()
 {
-  m_implementation.reset();
+  close();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
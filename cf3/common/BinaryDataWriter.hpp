@@ -22,6 +22,8 @@ namespace common {
 
   
 /// Component for writing binary data collected into a single file
+/// If the "asynchronous" option is set, appended data is copied and compressed and written by the OutputQueue.
+/// In all cases, the file is only complete after close() has been called (collectively) or the writer is destroyed.
 class Common_API BinaryDataWriter : public Component {
 
 public: // functions
@@ -35,9 +37,16 @@ public: // functions
   static std::string type_name () { return "BinaryDataWriter"; }
 
   /// Append a new data block containing data from the supplied table. An index into the current file is returned
+  /// Tables stored in column-major order are written row by row, like all other tables.
   template<typename T>
   Uint append_data(const Table<T>& table)
   {
+    if(!table.is_row_major())
+    {
+      typename Table<T>::ArrayT row_major(boost::extents[table.size()][table.row_size()]);
+      row_major = table.array();
+      return write_data_block(reinterpret_cast<const char*>(row_major.data()), sizeof(T)*table.row_size()*table.size(), table.name(), table.size(), table.row_size(), class_name<T>());
+    }
     return write_data_block(reinterpret_cast<const char*>(table.array().data()), sizeof(T)*table.row_size()*table.size(), table.name(), table.size(), table.row_size(), class_name<T>());
   }
   
@@ -48,9 +57,17 @@ public: // functions
     return write_data_block(reinterpret_cast<const char*>(list.array().data()), sizeof(T)*list.size(), list.name(), list.size(), 1, class_name<T>());
   }
 
-  /// Close the current file
+  /// Close the current file, waiting for any data that is still being written in the background.
+  /// This is a collective operation.
+  /// @throw FileSystemError if writing any of the blocks failed
   void close();
 
+  /// Close all writers that still have an open file, in the order in which their files were opened.
+  /// Registered to run when PE::Comm is finalized, so files that are completed in the background are finished while MPI is still available.
+  /// This is a collective operation.
+  /// @throw FileSystemError if writing any of the blocks failed. All writers are closed regardless.
+  static void close_all();
+
 private:
   // Write a data block to the binary file
   Uint write_data_block(const char* data, const std::streamsize count, const std::string& list_name, const Uint nb_rows, const Uint nb_cols, const std::string& type_name);
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3.
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <sstream>
 #include <boost/cast.hpp>
 #include <boost/tokenizer.hpp>
@@ -32,6 +33,7 @@
 #include "common/PropertyList.hpp"
 #include "common/ComponentIterator.hpp"
 #include "common/TimedComponent.hpp"
+#include "common/AccountedComponent.hpp"
 #include "common/UUCount.hpp"
 
 
@@ -177,6 +179,17 @@ Component::Component ( const std::string& name ) :
       .pretty_name("Store Timings")
       .description("Store calculated timing information into properties timer_mean, timer_minimum and timer_maximum for the tree starting at this component");
 
+  regist_signal( "store_memory_usage" )
+      .connect( boost::bind(&Component::signal_store_memory_usage, this, _1))
+      .hidden(true)
+      .pretty_name("Store Memory Usage")
+      .description("Store the bytes held by each component into properties memory_total and memory_bytes for the tree starting at this component");
+
+  regist_signal( "print_memory_tree" )
+      .connect( boost::bind(&Component::signal_print_memory_tree, this, _1))
+      .pretty_name("Print Memory Tree")
+      .description("Print the memory held by the tree starting at this component, with min, max and sum over all CPUs. This is a collective operation.");
+
   regist_signal( "clear" )
       .connect( boost::bind( &Component::signal_clear, this, _1 ) )
       .description("removes all sub-components, except for the static ones")
@@ -220,7 +233,7 @@ void Component::rename ( const std::string& name )
   cf3_assert(m_component_lookup.size() == m_components.size());
 
   // notification should be done before the real renaming since the path changes
-  raise_tree_updated_event();
+  raise_tree_updated_event( "renamed", is_not_null(m_parent) ? *m_parent : *this );
 
   if(is_not_null(m_parent))
   {
@@ -301,7 +314,7 @@ Component& Component::add_component ( const boost::shared_ptr<Component>& subcom
 
   subcomp->m_parent = this;
 
-  raise_tree_updated_event();
+  raise_tree_updated_event( "added", *this );
 
   return *subcomp;
 }
@@ -378,7 +391,7 @@ boost::shared_ptr<Component> Component::remove_component ( const std::string& na
     }
     m_components = new_storage;
 
-    raise_tree_updated_event();
+    raise_tree_updated_event( "removed", *this );
 
     return comp;                                   // return it to client
   }
@@ -473,7 +486,7 @@ void Component::move_to ( Component& new_parent )
   cf3_assert(m_parent);
   boost::shared_ptr<Component> this_ptr = m_parent->remove_component( *this );
   new_parent.add_component( this_ptr );
-  raise_tree_updated_event();
+  raise_tree_updated_event( "moved", new_parent );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -709,6 +722,11 @@ void Component::signal_print_info ( SignalArgs& args  ) const
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void Component::write_xml_tree( XmlNode& node, bool put_all_content ) const
+{
+  write_xml_tree( node, put_all_content, 0 );
+}
+
+void Component::write_xml_tree( XmlNode& node, bool put_all_content, const Uint depth, const Uint offset, const Uint limit ) const
 {
   cf3_assert( node.is_valid() );
 
@@ -746,9 +764,25 @@ void Component::write_xml_tree( XmlNode& node, bool put_all_content ) const
         signal_list_options( sf );
       }
 
-      boost_foreach( const Component& c, *this )
+      const Uint nb_children = m_components.size();
+      const Uint children_begin = std::min(offset, nb_children);
+      const Uint children_end = (limit == 0 || limit > nb_children - children_begin) ? nb_children : children_begin + limit;
+
+      // Tell the client what it did not get, so it can fetch the rest on demand
+      if( depth == 1 || children_begin != 0 || children_end != nb_children )
+      {
+        this_node.set_attribute( "nb_children", to_str(nb_children) );
+        if( children_begin != 0 )
+          this_node.set_attribute( "offset", to_str(children_begin) );
+      }
+
+      if( depth != 1 )
       {
-        c.write_xml_tree( this_node, put_all_content );
+        const Uint child_depth = depth == 0 ? 0 : depth - 1;
+        for( Uint i = children_begin; i != children_end; ++i )
+        {
+          m_components[i]->write_xml_tree( this_node, put_all_content, child_depth );
+        }
       }
     }
   }
@@ -758,9 +792,25 @@ void Component::write_xml_tree( XmlNode& node, bool put_all_content ) const
 
 void Component::signal_list_tree( SignalArgs& args ) const
 {
+  // Without options, the complete tree is listed
+  Uint depth = 0;
+  Uint offset = 0;
+  Uint limit = 0;
+  if( args.has_map( Protocol::Tags::key_options() ) )
+  {
+    SignalOptions options( args );
+    if( options.check("depth") )
+      depth = options.value<Uint>("depth");
+    if( options.check("offset") )
+      offset = options.value<Uint>("offset");
+    if( options.check("limit") )
+      limit = options.value<Uint>("limit");
+  }
+
   SignalFrame reply = args.create_reply( uri() );
 
-  write_xml_tree(reply.main_map.content, false);
+  // depth counts the levels below this component, while write_xml_tree counts this component as well
+  write_xml_tree(reply.main_map.content, false, depth == 0 ? 0 : depth + 1, offset, limit);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -1059,9 +1109,13 @@ void Component::signal_signature( SignalArgs & args )
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
-void Component::raise_tree_updated_event ()
+void Component::raise_tree_updated_event ( const std::string& change, const Component& listing )
 {
   SignalFrame frame ( "tree_updated", uri(), uri() );
+  SignalOptions options( frame );
+  options.add( "change", change );
+  options.add( "path", listing.uri() );
+  options.flush();
   EventHandler::instance().raise_event("tree_updated", frame ); // no error if event doesn't exist
 }
 
@@ -1070,7 +1124,7 @@ void Component::raise_tree_updated_event ()
 Component& Component::mark_basic()
 {
   add_tag("basic");
-  raise_tree_updated_event();
+  raise_tree_updated_event( "modified", is_not_null(m_parent) ? *m_parent : *this );
   return *this;
 }
 
@@ -1118,6 +1172,20 @@ void Component::signal_store_timings ( SignalArgs& args )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Component::signal_store_memory_usage ( SignalArgs& args )
+{
+  store_memory_usage(*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Component::signal_print_memory_tree ( SignalArgs& args )
+{
+  print_memory_tree(*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Component::signal_clear ( SignalArgs& args )
 {
   clear();
@@ -311,7 +311,9 @@ public: // functions
   /// moves a component from this component to another
   void signal_move_component ( SignalArgs& args );
 
-  /// lists the sub components and puts them on the xml_tree
+  /// lists the sub components and puts them on the xml_tree.
+  /// The optional options "depth" (number of levels below this component, 0 for all), "offset" and "limit"
+  /// (range of the direct children to list, limit 0 for all) allow clients to fetch large trees in parts.
   void signal_list_tree( SignalArgs& args ) const;
 
   ///  prints tree recursively
@@ -367,6 +369,12 @@ public: // functions
   
   /// Signal to store the timings (if enabled) into properties, i.e. for readout from python or the GUI
   void signal_store_timings( SignalArgs& args );
+
+  /// Signal to store the memory used by the tree into the properties memory_total and memory_bytes
+  void signal_store_memory_usage( SignalArgs& args );
+
+  /// Signal to print the memory used by the tree, aggregated over all CPUs
+  void signal_print_memory_tree( SignalArgs& args );
   
   /// Signal to remove all sub-components
   void signal_clear( SignalArgs& args );
@@ -413,6 +421,14 @@ private: // helper functions
   /// in the node.
   void write_xml_tree( XML::XmlNode& node, bool put_all_content ) const;
 
+  /// writes a part of the underlying component tree to the xml node
+  /// @param depth  Number of levels to write, including this component. 0 writes the complete subtree.
+  /// @param offset Index of the first child of this component to write
+  /// @param limit  Maximum number of children of this component to write. 0 writes all of them.
+  /// Components whose children are not all written get an "nb_children" attribute (and "offset" if it is not 0),
+  /// so a client can request the missing part later.
+  void write_xml_tree( XML::XmlNode& node, bool put_all_content, const Uint depth, const Uint offset = 0, const Uint limit = 0 ) const;
+
   /// Triggered when the "ping" event is raised. Useful to find out what components still exist
   void on_ping_event( SignalArgs& args );
 
@@ -434,7 +450,9 @@ private: // data
 protected: // functions
 
   /// raise event that the path has changed
-  void raise_tree_updated_event();
+  /// @param change  Kind of change: "added", "removed", "renamed", "moved" or "modified"
+  /// @param listing Component whose listing of children is affected by the change
+  void raise_tree_updated_event( const std::string& change, const Component& listing );
 
   /// Friend declarations allow enable_shared_from_this to be private
   template<class T> friend class boost::enable_shared_from_this;
@@ -14,6 +14,8 @@
 #include "common/OSystem.hpp"
 #include "common/OSystemLayer.hpp"
 #include "common/NetworkInfo.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/OutputQueue.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OSystem.hpp"
 #include "common/Group.hpp"
@@ -106,6 +108,13 @@ void Core::initiate ( int argc, char** argv )
   // initiate the logging facility
   Logger::instance().initiate();
 
+  // read the builder index given by the COOLFLUID_PLUGIN_INDEX environment variable,
+  // so indexed plugins are only loaded when one of their builders is needed
+
+  char* index_var = std::getenv("COOLFLUID_PLUGIN_INDEX");
+  if (index_var != NULL)
+    libraries().read_builder_index(URI(index_var, URI::Scheme::FILE));
+
   // load libraries listed in the COOLFLUID_PLUGINS environment variable
 
   char* env_var = std::getenv("COOLFLUID_PLUGINS");
@@ -117,7 +126,12 @@ void Core::initiate ( int argc, char** argv )
     Tokenizer tokens(environment_variable_coolfluid_plugins, sep);
 
     for (Tokenizer::iterator tok_iter = tokens.begin(); tok_iter != tokens.end(); ++tok_iter)
+    {
+      if (libraries().is_indexed(*tok_iter))
+        CFdebug << "Deferring load of indexed plugin " << *tok_iter << CFendl;
+      else
         OSystem::instance().lib_loader()->load_library(*tok_iter);
+    }
   }
 
   // initiate here all the libraries which the kernel was linked to
@@ -130,6 +144,16 @@ void Core::initiate ( int argc, char** argv )
 
 void Core::terminate()
 {
+  // complete any output that is still being written in the background
+  try
+  {
+    OutputQueue::instance().wait();
+  }
+  catch(FileSystemError& e)
+  {
+    CFerror << e.what() << CFendl;
+  }
+
   // terminate all
   if(is_not_null(m_libraries))
     libraries().terminate_all_libraries();
@@ -11,6 +11,7 @@
 
 #include <deque>
 #include "common/BasicExceptions.hpp"
+#include "common/AccountedComponent.hpp"
 #include "common/Component.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Foreach.hpp"
@@ -28,7 +29,7 @@ class DynArrayBufferT;
 /// Component holding a connectivity table with variable row-size per row
 /// @author Willem Deconinck
 template<typename T>
-class DynTable : public common::Component {
+class DynTable : public common::Component, public AccountedComponent {
 
 public:
 
@@ -106,6 +107,15 @@ public:
   /// @return A const reference to the array data
   const ArrayT& array() const { return m_array; }
 
+  /// Bytes allocated for the rows, including their unused capacity
+  virtual Real memory_bytes() const
+  {
+    Real bytes = static_cast<Real>(m_array.capacity()) * sizeof(std::vector<T>);
+    for(typename ArrayT::const_iterator row = m_array.begin(); row != m_array.end(); ++row)
+      bytes += static_cast<Real>(row->capacity()) * sizeof(T);
+    return bytes;
+  }
+
 private: // data
 
   ArrayT m_array;
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/assign/list_of.hpp>
+
 #include "common/Signal.hpp"
 #include "common/OptionT.hpp"
 #include "common/Builder.hpp"
@@ -12,6 +14,9 @@
 #include "common/Log.hpp"
 #include "common/Environment.hpp"
 #include "common/PropertyList.hpp"
+#include "common/MemoryPlacement.hpp"
+#include "common/OutputQueue.hpp"
+#include "common/ThreadPool.hpp"
 
 namespace cf3 {
 namespace common {
@@ -102,6 +107,44 @@ Environment::Environment ( const std::string& name) : Component ( name )
       .mark_basic()
       .attach_trigger(boost::bind(&Environment::trigger_log_level,this));
 
+  options().add("max_pending_outputs", OutputQueue::instance().max_pending())
+      .pretty_name("Max Pending Outputs")
+      .description("Maximum number of output tasks queued for the background I/O thread before writers block")
+      .mark_basic()
+      .attach_trigger(boost::bind(&Environment::trigger_max_pending_outputs,this));
+
+  options().add("nb_threads", ThreadPool::instance().nb_threads())
+      .pretty_name("Number of Threads")
+      .description("Number of threads of the thread pool in each process, including the main thread. Defaults to the cores per MPI rank, or CF3_NB_THREADS if set.")
+      .mark_basic()
+      .attach_trigger(boost::bind(&Environment::trigger_nb_threads,this));
+
+  options().add("pin_threads", ThreadPool::instance().pin_threads())
+      .pretty_name("Pin Threads")
+      .description("If true, bind the worker threads of the thread pool to consecutive cores, offset by the rank within the node. Defaults to CF3_PIN_THREADS if set.")
+      .attach_trigger(boost::bind(&Environment::trigger_pin_threads,this));
+
+  std::vector<boost::any> schedules = boost::assign::list_of
+      (std::string("static"))
+      (std::string("dynamic"))
+      (std::string("work_stealing"));
+  const std::string schedule_names[] = { "static", "dynamic", "work_stealing" };
+  options().add("thread_schedule", schedule_names[ThreadPool::instance().default_schedule()])
+      .pretty_name("Thread Schedule")
+      .description("Default distribution of parallel loop iterations over the threads. Defaults to CF3_THREAD_SCHEDULE if set.")
+      .attach_trigger(boost::bind(&Environment::trigger_thread_schedule,this))
+      .restricted_list() = schedules;
+
+  options().add("first_touch", MemoryPlacement::instance().first_touch())
+      .pretty_name("First Touch")
+      .description("If true, new rows of large tables and lists are initialized by the threads of the thread pool, so their pages are placed on the NUMA node of the threads that use them. Defaults to CF3_FIRST_TOUCH if set.")
+      .attach_trigger(boost::bind(&Environment::trigger_first_touch,this));
+
+  options().add("huge_pages", MemoryPlacement::instance().huge_pages())
+      .pretty_name("Huge Pages")
+      .description("If true, transparent huge pages are requested for new rows of large tables and lists. Defaults to CF3_HUGE_PAGES if set.")
+      .attach_trigger(boost::bind(&Environment::trigger_huge_pages,this));
+
   trigger_log_level();
 
   // signals
@@ -180,5 +223,53 @@ void Environment::trigger_log_level()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Environment::trigger_max_pending_outputs()
+{
+  OutputQueue::instance().set_max_pending(options().value<Uint>("max_pending_outputs"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_nb_threads()
+{
+  ThreadPool::instance().set_nb_threads(options().value<Uint>("nb_threads"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_pin_threads()
+{
+  ThreadPool::instance().set_pin_threads(options().value<bool>("pin_threads"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_thread_schedule()
+{
+  const std::string schedule = options().value<std::string>("thread_schedule");
+  if(schedule == "static")
+    ThreadPool::instance().set_default_schedule(ThreadPool::STATIC);
+  else if(schedule == "dynamic")
+    ThreadPool::instance().set_default_schedule(ThreadPool::DYNAMIC);
+  else
+    ThreadPool::instance().set_default_schedule(ThreadPool::WORK_STEALING);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_first_touch()
+{
+  MemoryPlacement::instance().set_first_touch(options().value<bool>("first_touch"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_huge_pages()
+{
+  MemoryPlacement::instance().set_huge_pages(options().value<bool>("huge_pages"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // common
 } // cf3
@@ -51,6 +51,18 @@ private: // functions
 
   void trigger_log_level();
 
+  void trigger_max_pending_outputs();
+
+  void trigger_nb_threads();
+
+  void trigger_pin_threads();
+
+  void trigger_thread_schedule();
+
+  void trigger_first_touch();
+
+  void trigger_huge_pages();
+
 }; // Environment
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4,10 +4,13 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include "common/Core.hpp"
 #include "common/LibLoader.hpp"
 #include "common/Library.hpp"
 #include "common/Libraries.hpp"
-#include "common/Core.hpp"
+#include "common/Log.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Timer.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -28,15 +31,25 @@ LibLoader::~LibLoader()
 
 void LibLoader::load_library(const std::string& lib)
 {
-//  void* handle =
-      system_load_library(lib);
+  Timer timer;
+  const std::string loaded_file = system_load_library(lib);
+  const Real load_time = timer.elapsed();
 
   /// @todo find a cross-platform way of storing the pointer, maybe using void*
 
+  Libraries& libraries = Core::instance().libraries();
+  Handle<Library> loaded = libraries.library_in_file(loaded_file);
+  if(is_not_null(loaded))
+  {
+    loaded->properties()["library_file"] = loaded_file;
+    loaded->properties()["load_time"] = load_time;
+  }
+  CFdebug << "Loaded library " << loaded_file << " in " << load_time << " s" << CFendl;
+
   // initiate all libraries not yet initiated
   // because loading one library might implicitly load many others
 
-  Core::instance().libraries().initiate_all_libraries();
+  libraries.initiate_all_libraries();
 
 }
 
@@ -45,7 +45,9 @@ public: // methods
   /// virtual destructor
   virtual ~LibLoader();
 
-  /// Loads a library and initiates it
+  /// Loads a library and initiates it.
+  /// The file that was loaded and the time it took are stored as the "library_file"
+  /// and "load_time" properties of the loaded library.
   /// @throw LibLoadingError if loading fails for any reason
   void load_library(const std::string& lib);
 
@@ -56,7 +58,8 @@ public: // methods
   /// class interface to load a library depending on the operating system
   /// and the library loading algorithm
   /// @throw LibLoadingError if loading fails for any reason
-  virtual void system_load_library(const std::string& lib) = 0;
+  /// @return path of the file that was loaded
+  virtual std::string system_load_library(const std::string& lib) = 0;
 
   /// class interface to add paths to search for libraries
   ///
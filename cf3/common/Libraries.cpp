@@ -5,8 +5,10 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 #include <iostream>
+#include <sstream>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
 
 #include "common/Log.hpp"
 #include "common/Signal.hpp"
@@ -15,10 +17,13 @@
 #include "common/Libraries.hpp"
 #include "common/OSystem.hpp"
 #include "common/OptionArray.hpp"
+#include "common/OptionURI.hpp"
 #include "common/LibLoader.hpp"
 #include "common/Foreach.hpp"
 #include "common/FindComponents.hpp"
 #include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Timer.hpp"
 
 #include "common/XML/SignalOptions.hpp"
 #include "common/XML/SignalFrame.hpp"
@@ -30,6 +35,25 @@ using namespace cf3::common::XML;
 namespace cf3 {
 namespace common {
 
+namespace
+{
+  /// Library name for a shared library file name or path, e.g. coolfluid_mesh for /some/path/libcoolfluid_mesh.so
+  std::string file_to_libname( const std::string& file )
+  {
+    std::string result = boost::filesystem::path(file).filename().string();
+
+    const std::string::size_type ext = result.find('.');
+    if( ext != std::string::npos )
+      result.erase(ext);
+
+    if( boost::starts_with(result, "lib") )
+      result.erase(0, 3);
+
+    boost::to_lower(result);
+    return result;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Libraries::Libraries ( const std::string& name) : Component ( name )
@@ -52,6 +76,12 @@ Libraries::Libraries ( const std::string& name) : Component ( name )
     .description("Autoload library given namespace")
     .pretty_name("Load");
 
+  regist_signal( "write_builder_index" )
+    .connect( boost::bind( &Libraries::signal_write_builder_index, this, _1 ) )
+    .signature( boost::bind(&Libraries::signature_write_builder_index, this, _1) )
+    .description("Writes the index of the builders in the loaded plugins, to load them on demand in later runs")
+    .pretty_name("Write Builder Index");
+
   signal("create_component")->hidden(true);
   signal("rename_component")->hidden(true);
   signal("move_component")->hidden(true);
@@ -128,7 +158,97 @@ Handle<Library> Libraries::autoload_library_with_namespace( const std::string& l
 
 Handle<Library> Libraries::autoload_library_with_builder( const std::string& builder_name )
 {
-  return autoload_library_with_namespace(Builder::extract_namespace( builder_name ));
+  const std::string libnamespace = Builder::extract_namespace( builder_name );
+
+  std::map<std::string, std::string>::const_iterator indexed = m_builder_index.find( builder_name );
+  if( indexed == m_builder_index.end() )
+    return autoload_library_with_namespace( libnamespace );
+
+  try // to load the indexed file directly, without searching
+  {
+    CFdebug << "Loading plugin " << indexed->second << " for builder " << builder_name << CFendl;
+    OSystem::instance().lib_loader()->load_library(indexed->second);
+    return Handle<Library>(get_child( libnamespace ));
+  }
+  catch(const std::exception& e)
+  {
+    CFwarn << "Library " << indexed->second << " failed to load with error " << e.what() << CFendl;
+    return Handle<Library>();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Handle<Library> Libraries::library_in_file( const std::string& file )
+{
+  const std::string libname = file_to_libname( file );
+  boost_foreach( Library& lib, find_components<Library>(*this) )
+  {
+    if( namespace_to_libname( lib.name() ) == libname )
+      return lib.handle<Library>();
+  }
+  return Handle<Library>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Libraries::read_builder_index( const URI& file )
+{
+  boost::filesystem::ifstream index_file( file.path() );
+  if( !index_file.is_open() )
+    throw FileSystemError( FromHere(), "Could not open builder index " + file.path() );
+
+  std::string line;
+  Uint line_nb = 0;
+  while( std::getline(index_file, line) )
+  {
+    ++line_nb;
+    boost::trim(line);
+    if( line.empty() || line[0] == '#' )
+      continue;
+
+    std::istringstream line_stream(line);
+    std::string builder_name, library_file;
+    if( !(line_stream >> builder_name >> library_file) )
+      throw FileFormatError( FromHere(), "Line " + to_str(line_nb) + " of builder index " + file.path() + " does not contain a builder and a library" );
+
+    m_builder_index[builder_name] = library_file;
+    m_indexed_libraries.insert( file_to_libname(library_file) );
+  }
+
+  CFdebug << "Read " << m_builder_index.size() << " builders in " << m_indexed_libraries.size() << " libraries from builder index " << file.path() << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Libraries::write_builder_index( const URI& file )
+{
+  boost::filesystem::ofstream index_file( file.path() );
+  if( !index_file.is_open() )
+    throw FileSystemError( FromHere(), "Could not open builder index " + file.path() + " for writing" );
+
+  index_file << "# builder library_file\n";
+  boost_foreach( Library& lib, find_components<Library>(*this) )
+  {
+    if( !lib.properties().check("library_file") )
+      continue;
+
+    const std::string library_file = lib.properties().value<std::string>("library_file");
+    boost_foreach( const Builder& builder, find_components<Builder>(lib) )
+    {
+      index_file << builder.name() << " " << library_file << "\n";
+    }
+  }
+
+  if( !index_file )
+    throw FileSystemError( FromHere(), "Error writing builder index " + file.path() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool Libraries::is_indexed( const std::string& library ) const
+{
+  return m_indexed_libraries.count( file_to_libname(library) ) != 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -137,7 +257,14 @@ void Libraries::initiate_all_libraries()
 {
   boost_foreach( Library& lib, find_components<Library>(*this) )
   {
-    lib.initiate(); // will do nothing if already initiated
+    if( lib.is_initiated() )
+      continue;
+
+    Timer timer;
+    lib.initiate();
+    const Real initiate_time = timer.elapsed();
+    lib.properties()["initiate_time"] = initiate_time;
+    CFdebug << "Initiated library " << lib.name() << " in " << initiate_time << " s" << CFendl;
   }
 }
 
@@ -220,6 +347,24 @@ void Libraries::signature_load ( SignalArgs& args )
       .description("Libraries to load");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void Libraries::signal_write_builder_index ( SignalArgs& args )
+{
+  SignalOptions opts (args);
+  write_builder_index( opts.value<URI>("file") );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Libraries::signature_write_builder_index ( SignalArgs& args )
+{
+  SignalOptions options( args );
+
+  options.add("file", URI("builders.idx", URI::Scheme::FILE))
+      .description("File to write the builder index to");
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -9,6 +9,9 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <map>
+#include <set>
+
 #include "common/BasicExceptions.hpp"
 #include "common/Component.hpp"
 
@@ -20,6 +23,12 @@ class Library;
 ////////////////////////////////////////////////////////////////////////////////
 
 /// Component that defines global environment
+///
+/// Plugin libraries are normally loaded at startup, or by searching the library
+/// search paths when a builder is first requested. Alternatively, a builder index
+/// can be read (see read_builder_index()), mapping each builder to the library file
+/// containing it. Indexed libraries are loaded directly from that file, only when
+/// one of their builders is needed.
 /// @author Quentin Gasper
 class Common_API Libraries : public Component
 {
@@ -68,7 +77,8 @@ public: // functions
     return lib;
   }
 
-  /// calls all the initiate hooks on all the libraries that have not been initiated yet
+  /// calls all the initiate hooks on all the libraries that have not been initiated yet.
+  /// The time spent in each hook is stored in the "initiate_time" property of the library.
   void initiate_all_libraries();
   /// calls all the terminate hooks on all the libraries that have not been terminated yet
   void terminate_all_libraries();
@@ -81,7 +91,8 @@ public: // functions
   /// @param [in] file URI to the shared library to be loaded
   void load_library( const URI& file );
 
-  /// Attempts to load a CF3 plugin library from the builders name
+  /// Attempts to load a CF3 plugin library from the builders name.
+  /// If the builder is in the builder index, the indexed library file is loaded.
   /// @param [in] name of the shared library to be loaded
   /// @throws ValueNotFound in case of library not able to be loaded
   Handle<Library> autoload_library_with_builder( const std::string& builder_name );
@@ -91,6 +102,27 @@ public: // functions
   /// @throws ValueNotFound in case of library not able to be loaded
   Handle<Library> autoload_library_with_namespace( const std::string& libnamespace );
 
+  /// Find the loaded library that is contained in the given shared library file
+  /// @param [in] file path or name of the shared library file, e.g. /some/path/libcoolfluid_mesh.so
+  /// @return null handle if no such library is loaded
+  Handle<Library> library_in_file( const std::string& file );
+
+  /// Read a builder index, as written by write_builder_index().
+  /// Each line contains a builder name and the library file that contains it.
+  /// @throws FileSystemError if the file can't be read
+  /// @throws FileFormatError if a line is malformed
+  void read_builder_index( const URI& file );
+
+  /// Write the builder index for all the libraries that were loaded from a file
+  /// (i.e. plugins, not the libraries the executable is linked to)
+  /// @throws FileSystemError if the file can't be written
+  void write_builder_index( const URI& file );
+
+  /// Checks if a library is in the builder index, in which case loading it can be deferred
+  /// until one of its builders is requested
+  /// @param [in] library path or name of the shared library file
+  bool is_indexed( const std::string& library ) const;
+
   /// @name SIGNALS
   //@{
 
@@ -104,8 +136,21 @@ public: // functions
   /// Signature of the signal to autoload a list of libraries by namespace names
   void signature_load ( SignalArgs& args );
 
+  /// Signal to write the builder index of the loaded plugins
+  void signal_write_builder_index ( SignalArgs& args );
+  /// Signature of the signal to write the builder index
+  void signature_write_builder_index ( SignalArgs& args );
+
   //@} END SIGNALS
 
+private: // data
+
+  /// Library file for each indexed builder
+  std::map<std::string, std::string> m_builder_index;
+
+  /// Library names (as returned by namespace_to_libname) of the files in the index
+  std::set<std::string> m_indexed_libraries;
+
 }; // Libraries
 
 ////////////////////////////////////////////////////////////////////////////////
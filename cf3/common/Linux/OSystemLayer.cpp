@@ -12,6 +12,7 @@
 #include <execinfo.h>    // for backtrace() from glibc
 #include <sys/types.h>   // for getting the PID of the process
 #include <malloc.h>      //  for mallinfo
+#include <sys/resource.h> // for getrusage
 
 
 #include "common/BasicExceptions.hpp"
@@ -134,6 +135,16 @@ Uint OSystemLayer::process_id() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double OSystemLayer::memory_high_water() const
+{
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+    return memory_usage();
+  return static_cast<double>(usage.ru_maxrss) * 1024.; // ru_maxrss is in kilobytes on Linux
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double OSystemLayer::memory_usage() const
 {
   struct mallinfo info;
@@ -52,6 +52,10 @@ public:
   /// @return a double with the memory usage
   virtual double memory_usage() const;
 
+  /// Gets the peak resident set size of the process
+  /// @return the high-water mark in bytes
+  virtual double memory_high_water() const;
+
   /// Regists the signal handlers that will be handled by this class
   virtual void regist_os_signal_handlers();
 
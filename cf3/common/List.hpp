@@ -9,8 +9,10 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/AccountedComponent.hpp"
 #include "common/Component.hpp"
 #include "common/ListBufferT.hpp"
+#include "common/MemoryPlacement.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -37,7 +39,7 @@ namespace common {
 /// @author Tiago Quintino
 
 template <typename ValueT>
-class List : public common::Component
+class List : public common::Component, public AccountedComponent
 {
 public: // typedefs
 
@@ -64,11 +66,13 @@ public: // functions
   /// @returns the component type name
   static std::string type_name () { return "List<"+common::class_name<ValueT>()+">"; }
 
-  /// Resize the array to the given number of rows
+  /// Resize the array to the given number of rows. New rows are placed according to the MemoryPlacement settings.
   /// @param[in] new_size The size allocated after resizing
   void resize(const Uint new_size)
   {
+    const Uint old_size = size();
     m_array.resize(boost::extents[new_size]);
+    place_new_rows(m_array, old_size);
   }
 
   /// Modifiable access to the internal structure
@@ -110,6 +114,12 @@ public: // functions
   /// @return The number of local rows in the array
   Uint size() const { return m_array.size(); }
 
+  /// Bytes used by the list entries
+  virtual Real memory_bytes() const { return static_cast<Real>(m_array.num_elements()) * sizeof(ValueT); }
+
+  /// Start of the list entries
+  virtual const void* memory_data() const { return m_array.data(); }
+
 private: // data
 
   /// storage of the array
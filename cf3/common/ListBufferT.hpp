@@ -14,6 +14,7 @@
 #include "common/Foreach.hpp"
 #include "common/BoostArray.hpp"
 #include "common/BasicExceptions.hpp"
+#include "common/MemoryPlacement.hpp"
 #include "common/StringConversion.hpp"
 
 #include "common/ListBufferIterator.hpp"
@@ -250,6 +251,7 @@ void ListBufferT<T>::flush()
   {
     // make m_array bigger
     m_array.resize(boost::extents[new_size]);
+    place_new_rows(m_array, old_array_size);
 
     // copy each buffer into the array
     Uint array_idx=old_array_size;
@@ -362,6 +364,7 @@ inline void ListBufferT<T>::increase_array_size(const size_t increase)
   Uint old_size = m_array.size();
   Uint new_size = old_size+increase;
   m_array.resize(boost::extents[new_size]);
+  place_new_rows(m_array, old_size);
   for (Uint i_new=old_size; i_new<new_size; ++i_new)
   {
     m_new_array_rows.push_back(i_new);
@@ -12,6 +12,7 @@
 #include <sstream>       // streamstring
 #include <execinfo.h>    // for backtrace() from glibc
 #include <sys/types.h>   // for getting the PID of the process
+#include <sys/resource.h> // for getrusage
 
 
 #include <mach/mach_types.h>
@@ -129,6 +130,16 @@ Uint OSystemLayer::process_id() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double OSystemLayer::memory_high_water() const
+{
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+    return memory_usage();
+  return static_cast<double>(usage.ru_maxrss); // ru_maxrss is in bytes on Mac OS X
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double OSystemLayer::memory_usage() const
 {
 
@@ -0,0 +1,152 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/bind.hpp>
+
+#include "common/MemoryPlacement.hpp"
+#include "common/ThreadPool.hpp"
+
+#ifdef CF3_OS_LINUX
+extern "C"
+{
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  bool env_flag(const char* name)
+  {
+    const char* value = std::getenv(name);
+    return value != 0 && std::string(value) != "0";
+  }
+
+  /// Write zeros to the part of [first, last) that holds the rows [begin_row, end_row)
+  void touch_rows(char* data, const std::size_t row_bytes, char* first, char* last, const Uint begin_row, const Uint end_row)
+  {
+    char* rows_first = std::max(first, data + begin_row*row_bytes);
+    char* rows_last = std::min(last, data + end_row*row_bytes);
+    if(rows_first < rows_last)
+      std::memset(rows_first, 0, rows_last - rows_first);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MemoryPlacement::MemoryPlacement() :
+  m_first_touch(detail::env_flag("CF3_FIRST_TOUCH")),
+  m_huge_pages(detail::env_flag("CF3_HUGE_PAGES")),
+  m_min_bytes(1024*1024)
+{
+}
+
+MemoryPlacement& MemoryPlacement::instance()
+{
+  static MemoryPlacement placement;
+  return placement;
+}
+
+std::size_t MemoryPlacement::page_size()
+{
+#ifdef CF3_OS_LINUX
+  static const std::size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+void MemoryPlacement::place_rows(void* data, const std::size_t row_bytes, const Uint begin_row, const Uint end_row) const
+{
+  if(end_row <= begin_row || (end_row - begin_row)*row_bytes < m_min_bytes)
+    return;
+
+#ifdef CF3_OS_LINUX
+  // Only whole pages can be released, the partial pages at both ends stay where they are
+  const std::size_t page = page_size();
+  char* rows_data = static_cast<char*>(data);
+  const std::size_t first_offset = reinterpret_cast<std::size_t>(rows_data + begin_row*row_bytes);
+  const std::size_t last_offset = reinterpret_cast<std::size_t>(rows_data + end_row*row_bytes);
+  char* first = reinterpret_cast<char*>((first_offset + page - 1) / page * page);
+  char* last = reinterpret_cast<char*>(last_offset / page * page);
+  if(first >= last)
+    return;
+
+  // Blocks of loops nested in pool tasks are not bound to a thread, so re-touching from there would scatter the pages
+  ThreadPool& pool = ThreadPool::instance();
+  const bool first_touch = m_first_touch && pool.nb_threads() > 1 && pool.thread_index() == 0;
+  if(first_touch)
+  {
+    // The released pages read as zeros, and are allocated again on the node of the thread that writes them first
+    madvise(first, last - first, MADV_DONTNEED);
+  }
+#ifdef MADV_HUGEPAGE
+  if(m_huge_pages)
+    madvise(first, last - first, MADV_HUGEPAGE);
+#endif
+  // The loop covers all rows of the array, like the loops that process it later, so each new row is touched by the
+  // thread that gets it in those loops. Only the released pages are written.
+  if(first_touch)
+    pool.parallel_for(0, end_row, boost::bind(detail::touch_rows, rows_data, row_bytes, first, last, _1, _2), ThreadPool::STATIC);
+#endif
+}
+
+std::vector<Uint> MemoryPlacement::pages_per_node(const void* data, const std::size_t bytes) const
+{
+  std::vector<Uint> result;
+#if defined(CF3_OS_LINUX) && defined(__NR_move_pages)
+  if(bytes == 0)
+    return result;
+
+  const std::size_t page = page_size();
+  const std::size_t first = reinterpret_cast<std::size_t>(data) / page * page;
+  const std::size_t last = reinterpret_cast<std::size_t>(data) + bytes;
+
+  // Query in batches, without nodes to move to this only returns the node of each page
+  const std::size_t batch_size = 4096;
+  std::vector<void*> pages;
+  std::vector<int> status;
+  for(std::size_t batch_first = first; batch_first < last; batch_first += batch_size*page)
+  {
+    pages.clear();
+    for(std::size_t address = batch_first; address < last && pages.size() != batch_size; address += page)
+      pages.push_back(reinterpret_cast<void*>(address));
+    status.assign(pages.size(), -1);
+    if(syscall(__NR_move_pages, 0, pages.size(), &pages[0], 0, &status[0], 0) != 0)
+      return std::vector<Uint>();
+
+    for(Uint i = 0; i != status.size(); ++i)
+    {
+      if(status[i] < 0) // not touched yet, or not accessible
+        continue;
+      if(static_cast<Uint>(status[i]) >= result.size())
+        result.resize(status[i] + 1, 0);
+      ++result[status[i]];
+    }
+  }
+#endif
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
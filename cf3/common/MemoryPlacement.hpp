@@ -0,0 +1,117 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_MemoryPlacement_hpp
+#define cf3_common_MemoryPlacement_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/multi_array.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Placement of large arrays on the NUMA nodes, for processes whose threads span several sockets.
+/// Linux places a page on the node of the thread that first touches it, so arrays that are allocated and
+/// zero-filled by the main thread all end up on a single node. With first touch enabled, Table, List,
+/// their buffers and the storage of LSS::TrilinosVector release the pages of newly added rows and initialize
+/// them again in a static ThreadPool loop over all rows of the array. The static schedule always gives block t of
+/// such a loop to the same thread, so the pages of each block end up on the node of the thread that processes that
+/// block in later static loops over all rows that use every thread of the pool. This is only stable if the
+/// threads are pinned (see ThreadPool). Arrays that are resized from within a pool task are not re-touched.
+/// The new rows are still zeroed once by the main thread when the array is resized, since the storage of
+/// boost::multi_array and std::vector value-initializes its elements. Only that serial pass is wasted: its
+/// pages are released before the parallel pass, which decides where they end up.
+/// With huge pages enabled, transparent huge pages are requested for the new rows.
+/// Both only apply to row-major arrays of arithmetic types, for blocks of at least min_bytes().
+/// The settings are taken from the environment variables CF3_FIRST_TOUCH and CF3_HUGE_PAGES (0 or 1) and
+/// the matching options of the Environment.
+class Common_API MemoryPlacement : public boost::noncopyable
+{
+public:
+  /// @return the single instance
+  static MemoryPlacement& instance();
+
+  /// True if new rows are initialized in parallel
+  bool first_touch() const { return m_first_touch; }
+  void set_first_touch(const bool first_touch) { m_first_touch = first_touch; }
+
+  /// True if transparent huge pages are requested for new rows
+  bool huge_pages() const { return m_huge_pages; }
+  void set_huge_pages(const bool huge_pages) { m_huge_pages = huge_pages; }
+
+  /// Smallest block of new rows that is placed, smaller blocks are left as they are
+  std::size_t min_bytes() const { return m_min_bytes; }
+  void set_min_bytes(const std::size_t min_bytes) { m_min_bytes = min_bytes; }
+
+  /// Place the rows [begin_row, end_row) of an array of rows of row_bytes bytes starting at data.
+  /// The rows must hold only zero bytes, as is the case for value-initialized arithmetic types.
+  void place_rows(void* data, const std::size_t row_bytes, const Uint begin_row, const Uint end_row) const;
+
+  /// Number of pages of [data, data + bytes) on each NUMA node, indexed by node. Pages that were never touched
+  /// are not counted. The result is empty if the placement can't be queried.
+  std::vector<Uint> pages_per_node(const void* data, const std::size_t bytes) const;
+
+  /// Size of a (normal) memory page, in bytes
+  static std::size_t page_size();
+
+private:
+  MemoryPlacement();
+
+  bool m_first_touch;
+  bool m_huge_pages;
+  std::size_t m_min_bytes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Place the rows [begin_row, array.size()) of an array that was just resized, see MemoryPlacement
+template<typename ValueT, std::size_t NDIM>
+void place_new_rows(boost::multi_array<ValueT, NDIM>& array, const Uint begin_row)
+{
+  const MemoryPlacement& placement = MemoryPlacement::instance();
+  if(!boost::is_arithmetic<ValueT>::value || (!placement.first_touch() && !placement.huge_pages()))
+    return;
+  if(array.size() <= begin_row || !(array.storage_order() == boost::general_storage_order<NDIM>(boost::c_storage_order())))
+    return;
+
+  const std::size_t row_bytes = array.num_elements() / array.size() * sizeof(ValueT);
+  placement.place_rows(array.data(), row_bytes, begin_row, array.size());
+}
+
+/// Place the entries [begin, vector.size()) of a vector that was just resized, see MemoryPlacement
+template<typename ValueT>
+void place_new_rows(std::vector<ValueT>& vector, const Uint begin)
+{
+  const MemoryPlacement& placement = MemoryPlacement::instance();
+  if(!boost::is_arithmetic<ValueT>::value || (!placement.first_touch() && !placement.huge_pages()))
+    return;
+  if(vector.size() <= begin)
+    return;
+
+  placement.place_rows(&vector[0], sizeof(ValueT), begin, vector.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_MemoryPlacement_hpp
@@ -46,6 +46,13 @@ void OSystemLayer::execute_command(const std::string& call)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+cf3::Real OSystemLayer::memory_high_water () const
+{
+  return memory_usage();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::string OSystemLayer::memory_usage_str () const
 {
   const cf3::Real bytes = memory_usage();
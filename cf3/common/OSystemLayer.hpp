@@ -60,6 +60,10 @@ public: // functions
   /// @return a double with the memory usage in bytes
   virtual cf3::Real memory_usage () const = 0;
 
+  /// Gets the peak memory usage of the process so far
+  /// @return the high-water mark in bytes. The default implementation returns the current memory usage.
+  virtual cf3::Real memory_high_water () const;
+
   /// @returns a string with the memory usage
   /// @post adds the unit of memory (B, KB, MB or GB)
   /// @post  no end of line added
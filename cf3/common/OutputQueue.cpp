@@ -0,0 +1,193 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <deque>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/OutputQueue.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+class OutputQueue::Implementation
+{
+public:
+  Implementation() :
+    max_pending(4),
+    nb_running(0),
+    stop(false)
+  {
+  }
+
+  ~Implementation()
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(mutex);
+      stop = true;
+    }
+    work_available.notify_all();
+    if(is_not_null(io_thread.get()))
+      io_thread->join();
+  }
+
+  void push(const TaskT& task)
+  {
+    boost::unique_lock<boost::mutex> lock(mutex);
+
+    if(is_null(io_thread.get()))
+      io_thread.reset(new boost::thread(boost::bind(&Implementation::run, this)));
+
+    // Back-pressure: the caller waits while the queue is full
+    while(nb_pending() >= max_pending)
+      state_changed.wait(lock);
+
+    tasks.push_back(task);
+    work_available.notify_one();
+  }
+
+  void wait()
+  {
+    std::string errors;
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+      while(nb_pending() != 0)
+        state_changed.wait(lock);
+      errors.swap(failures);
+    }
+
+    if(!errors.empty())
+      throw FileSystemError(FromHere(), "Background output failed:" + errors);
+  }
+
+  // Body of the I/O thread
+  void run()
+  {
+    while(true)
+    {
+      TaskT task;
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while(tasks.empty() && !stop)
+          work_available.wait(lock);
+
+        if(tasks.empty())
+          return;
+
+        task = tasks.front();
+        tasks.pop_front();
+        ++nb_running;
+      }
+
+      std::string failure;
+      try
+      {
+        task();
+      }
+      catch(std::exception& e)
+      {
+        failure = e.what();
+      }
+      catch(...)
+      {
+        failure = "unknown exception";
+      }
+
+      {
+        boost::lock_guard<boost::mutex> guard(mutex);
+        --nb_running;
+        if(!failure.empty())
+          failures += "\n  " + failure;
+      }
+      state_changed.notify_all();
+    }
+  }
+
+  // Must be called with the mutex locked
+  Uint nb_pending() const
+  {
+    return tasks.size() + nb_running;
+  }
+
+  mutable boost::mutex mutex;
+  boost::condition_variable work_available;
+  boost::condition_variable state_changed;
+
+  std::deque<TaskT> tasks;
+  Uint max_pending;
+  Uint nb_running;
+  bool stop;
+  std::string failures;
+
+  boost::scoped_ptr<boost::thread> io_thread;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+OutputQueue::OutputQueue() :
+  m_implementation(new Implementation())
+{
+}
+
+OutputQueue::~OutputQueue()
+{
+}
+
+OutputQueue& OutputQueue::instance()
+{
+  static OutputQueue queue;
+  return queue;
+}
+
+void OutputQueue::push(const TaskT& task)
+{
+  m_implementation->push(task);
+}
+
+void OutputQueue::wait()
+{
+  m_implementation->wait();
+}
+
+Uint OutputQueue::nb_pending() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->nb_pending();
+}
+
+Uint OutputQueue::max_pending() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->max_pending;
+}
+
+void OutputQueue::set_max_pending(const Uint max_pending)
+{
+  if(max_pending == 0)
+    throw BadValue(FromHere(), "The output queue must accept at least one pending task");
+
+  {
+    boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+    m_implementation->max_pending = max_pending;
+  }
+  m_implementation->state_changed.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_OutputQueue_hpp
+#define cf3_common_OutputQueue_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Bounded FIFO of output tasks, executed in order by a single dedicated I/O thread.
+/// Writers that want to overlap their output with computation push a task that only
+/// touches data it owns (i.e. a snapshot of the data to write) and local files.
+/// Tasks must never call MPI or log through CFinfo and friends, since these are not thread-safe.
+/// When max_pending() tasks are waiting, push() blocks until the I/O thread catches up (back-pressure).
+/// Core::terminate() calls wait(), so all output is complete at the end of the run.
+class Common_API OutputQueue : public boost::noncopyable
+{
+public:
+  /// Type of the tasks that can be queued
+  typedef boost::function<void ()> TaskT;
+
+  /// @return the single queue instance
+  static OutputQueue& instance();
+
+  /// Add a task to the queue, blocking if the queue is full. The I/O thread is started on the first call.
+  void push(const TaskT& task);
+
+  /// Block until all queued tasks have completed.
+  /// @throw FileSystemError if any of the tasks completed since the last call to wait failed
+  void wait();
+
+  /// Number of tasks that are queued or executing
+  Uint nb_pending() const;
+
+  /// Maximum number of pending tasks before push() blocks
+  Uint max_pending() const;
+
+  /// Set the maximum number of pending tasks. Must be at least 1.
+  void set_max_pending(const Uint max_pending);
+
+private:
+  OutputQueue();
+  ~OutputQueue();
+
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_OutputQueue_hpp
@@ -97,6 +97,10 @@ void Comm::finalize()
 {
   if( is_initialized() && !is_finalized() ) // then finalized
   {
+    // components that need collective communication to shut down do so while MPI is still available
+    for(Uint i = 0; i != m_finalize_hooks.size(); ++i)
+      m_finalize_hooks[i]();
+
     MPI_CHECK_RESULT(MPI_Finalize,());
     //  CFinfo << "MPI (version " <<  version() << ") -- finalized" << CFendl;
   }
@@ -115,6 +119,13 @@ void Comm::finalize()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Comm::add_finalize_hook(const boost::function<void ()>& hook)
+{
+  m_finalize_hooks.push_back(hook);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Comm::barrier()
 {
   if ( is_active() ) MPI_CHECK_RESULT(MPI_Barrier,(m_comm));
@@ -10,6 +10,8 @@
 
 #include <mpi.h>
 
+#include <boost/function.hpp>
+
 #include "common/StringConversion.hpp"
 #include "common/WorkerStatus.hpp"
 
@@ -73,6 +75,9 @@ public:
   /// Free the PE, careful because some mpi-s fail upon re-init after a proper finalize
   /// @post will have not a valid state
   void finalize();
+  /// Register a function that finalize() calls before MPI is finalized, in the order of registration
+  /// @param hook Function that may use collective communication and must not throw
+  void add_finalize_hook(const boost::function<void ()>& hook);
 
   /// Checks if the PE is initialized ( this is not the opposite of is_finalized )
   bool is_initialized() const;
@@ -326,6 +331,8 @@ private:
 
   Communicator m_comm; ///< comm_world
 
+  std::vector< boost::function<void ()> > m_finalize_hooks; ///< Called by finalize, before MPI_Finalize
+
   WorkerStatus::Type m_current_status; ///< Current status, default value is @c #NOT_RUNNING.
 
 }; // Comm
@@ -595,6 +595,19 @@ void CommPattern::synchronize( const CommWrapper& pobj )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Real CommPattern::memory_bytes() const
+{
+  const Real buffer_items = m_add_buffer.capacity() + m_mov_buffer.capacity() + m_rem_buffer.capacity();
+  const Real map_entries = m_sendCount.capacity() + m_sendMap.capacity() + m_recvCount.capacity() + m_recvMap.capacity();
+  return buffer_items * sizeof(temp_buffer_item)
+    + map_entries * sizeof(CPint)
+    + static_cast<Real>(m_free_lids.capacity()) * sizeof(Uint)
+    + static_cast<Real>(m_ranks.capacity()) * sizeof(int)
+    + static_cast<Real>(m_isUpdatable.capacity()) / 8.;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // having the vectors for the intermediate buf coming from outside allows keeping them and reuse for all synchronize
 void CommPattern::synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf )
 {
@@ -7,6 +7,7 @@
 #ifndef cf3_common_PE_CommPattern_hpp
 #define cf3_common_PE_CommPattern_hpp
 
+#include "common/AccountedComponent.hpp"
 #include "common/Component.hpp"
 #include "common/BoostArray.hpp"
 #include "common/PE/Comm.hpp"
@@ -38,7 +39,7 @@ namespace PE {
   @todo introduce allocate_component
 **/
 
-class Common_API CommPattern: public Component {
+class Common_API CommPattern: public Component, public AccountedComponent {
 
 public:
 
@@ -284,6 +285,9 @@ public:
   /// Return the rank associated with the given local ID
   int rank(const Uint lid) const { return m_ranks[lid]; }
 
+  /// Bytes used by the send and receive maps and the pending changes. The synchronization buffers are temporary.
+  virtual Real memory_bytes() const;
+
   //@} END ACCESSORS
 
 protected: // helper function
@@ -47,14 +47,17 @@ void PosixDlopenLibLoader::set_search_paths(const std::vector< URI >& paths)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void* PosixDlopenLibLoader::call_dlopen(const URI& fpath)
+void* PosixDlopenLibLoader::call_dlopen(const URI& fpath, std::string& loaded_path)
 {
   void* hdl = nullptr;
 
   hdl = dlopen (fpath.path().c_str(), RTLD_LAZY|RTLD_GLOBAL);
 
   if( is_not_null(hdl) )
+  {
     CFdebug << "dlopen() loaded library \'" << fpath.path() << "\'" << CFendl;
+    loaded_path = fpath.path();
+  }
 
   // library name
   if ( is_null(hdl) && !fpath.is_absolute() )
@@ -72,6 +75,7 @@ void* PosixDlopenLibLoader::call_dlopen(const URI& fpath)
       if( hdl != nullptr )
       {
         CFdebug << "dlopen() loaded library \'" << fullqname.path() << "\'" << CFendl;
+        loaded_path = fullqname.path();
         break;
       }
     }
@@ -82,21 +86,22 @@ void* PosixDlopenLibLoader::call_dlopen(const URI& fpath)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void PosixDlopenLibLoader::system_load_library(const std::string& lib)
+std::string PosixDlopenLibLoader::system_load_library(const std::string& lib)
 {
   using namespace boost::filesystem;
   using namespace boost::algorithm;
 
-  if (lib.empty()) return;
+  if (lib.empty()) return std::string();
 
   URI libpath( lib );
 
   // library handler
   void* hdl = nullptr;
+  std::string loaded_path;
 
   // try to load as passed ( still searches in paths )
-  hdl = call_dlopen( libpath );
-  if( is_not_null(hdl) ) return;
+  hdl = call_dlopen( libpath, loaded_path );
+  if( is_not_null(hdl) ) return loaded_path;
 
   // if failed, check if extension is correct then try again
 
@@ -130,10 +135,10 @@ void PosixDlopenLibLoader::system_load_library(const std::string& lib)
   if( !starts_with(filewext,"lib") )
     filewext = "lib" + filewext;
 
-  hdl = call_dlopen( basepath / URI(filewext) );
+  hdl = call_dlopen( basepath / URI(filewext), loaded_path );
 
   // check for success
-  if( is_not_null(hdl) ) return;
+  if( is_not_null(hdl) ) return loaded_path;
 
   // react on failure
   const char * msg = dlerror();
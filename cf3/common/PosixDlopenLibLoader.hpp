@@ -30,8 +30,8 @@ public: // functions
   /// class interface to load a library depending on the operating system
   /// and the library loading algorithm
   /// @throw LibLoadingError if loading fails for any reason
-  ///
-  virtual void system_load_library(const std::string& lib);
+  /// @return path of the file that was loaded
+  virtual std::string system_load_library(const std::string& lib);
 
   /// class interface to add paths to search for libraries
   ///
@@ -39,7 +39,8 @@ public: // functions
 
   protected:
 
-  void* call_dlopen(const URI& fpath);
+  /// @param [out] loaded_path path of the file that was effectively opened, if any
+  void* call_dlopen(const URI& fpath, std::string& loaded_path);
 
   private: // data
 
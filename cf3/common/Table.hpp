@@ -11,11 +11,15 @@
 
 #include <iosfwd>
 
+#include <boost/scoped_ptr.hpp>
+
+#include "common/AccountedComponent.hpp"
 #include "common/Component.hpp"
 
 #include "common/Table_fwd.hpp"
 #include "common/ArrayBufferT.hpp"
 #include "common/LibCommon.hpp"
+#include "common/MemoryPlacement.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -42,7 +46,7 @@ namespace common {
 /// @author Tiago Quintino
 
 template<typename ValueT>
-class Table : public common::Component
+class Table : public common::Component, public AccountedComponent
 {
 public: // typedefs
 
@@ -65,7 +69,7 @@ public: // functions
 
   /// Contructor
   /// @param name of the component
-  Table ( const std::string& name )  : Component ( name ), m_pos(0)
+  Table ( const std::string& name )  : Component ( name ), m_array(new ArrayT()), m_pos(0)
   {  }
 
   /// Get the component type name
@@ -77,23 +81,48 @@ public: // functions
   /// @param[in] nb_cols number of columns in the table.
   void set_row_size(const Uint nb_cols)
   {
-    m_array.resize(boost::extents[size()][nb_cols]);
+    m_array->resize(boost::extents[size()][nb_cols]);
   }
 
-  /// Resize the array to the given number of rows
+  /// Resize the array to the given number of rows. New rows are placed according to the MemoryPlacement settings.
   /// @param[in] nb_rows The number of rows after resizing
   virtual void resize(const Uint nb_rows)
   {
-    m_array.resize(boost::extents[nb_rows][row_size()]);
+    const Uint old_size = size();
+    m_array->resize(boost::extents[nb_rows][row_size()]);
+    place_new_rows(*m_array, old_size);
+  }
+
+  /// Change the storage order of the table, keeping its contents. In the default row-major order the entries
+  /// of a row are contiguous, in column-major order the entries of a column are contiguous. Indexing
+  /// through array() or operator[] is not affected, but code using array().data() must check is_row_major().
+  /// The storage order is kept when the table is resized. References to array() and buffers created before the
+  /// call refer to the old storage and must not be used afterwards.
+  /// @param[in] row_major true to store the rows contiguously
+  void set_row_major(const bool row_major)
+  {
+    if(row_major == is_row_major())
+      return;
+
+    const boost::general_storage_order<2> order = row_major ? boost::general_storage_order<2>(boost::c_storage_order()) : boost::general_storage_order<2>(boost::fortran_storage_order());
+    boost::scoped_ptr<ArrayT> reordered(new ArrayT(boost::extents[size()][row_size()], order));
+    *reordered = *m_array;
+    m_array.swap(reordered);
+  }
+
+  /// True if the entries of each row are contiguous in memory, which is the default
+  bool is_row_major() const
+  {
+    return m_array->storage_order() == boost::general_storage_order<2>(boost::c_storage_order());
   }
 
   /// Modifiable access to the internal structure
   /// @return A reference to the array data
-  ArrayT& array() { return m_array; }
+  ArrayT& array() { return *m_array; }
 
   /// Non-modifiable access to the internal structure
   /// @return A const reference to the array data
-  const ArrayT& array() const { return m_array; }
+  const ArrayT& array() const { return *m_array; }
 
   /// Create a buffer with a given number of entries
   /// @param[in] buffersize the size that the buffer is allocated with
@@ -103,34 +132,34 @@ public: // functions
   {
     // make sure the array has its columnsize defined
     cf3_assert(row_size() > 0);
-    return Buffer(m_array,buffersize);
+    return Buffer(*m_array,buffersize);
   }
 
   typename boost::shared_ptr<Buffer> create_buffer_ptr(const size_t buffersize=16384)
   {
     // make sure the array has its columnsize defined
     cf3_assert(row_size() > 0);
-    return typename boost::shared_ptr<Buffer> ( new Buffer (m_array,buffersize) );
+    return typename boost::shared_ptr<Buffer> ( new Buffer (*m_array,buffersize) );
   }
 
 
   /// Operator to have modifiable access to a table-row
   /// @return A mutable row of the underlying array
-  Row operator[](const Uint idx) { return m_array[idx]; }
+  Row operator[](const Uint idx) { return (*m_array)[idx]; }
 
   /// Operator to have non-modifiable access to a table-row
   /// @return A const row of the underlying array
-  ConstRow operator[](const Uint idx) const { return m_array[idx]; }
+  ConstRow operator[](const Uint idx) const { return (*m_array)[idx]; }
 
   /// Number of rows, excluding rows that may be in the buffer
   /// @return The number of local rows in the array
-  Uint size() const { return m_array.size(); }
+  Uint size() const { return m_array->size(); }
 
   /// Number of columns , or number of elements of one table-row
   /// @return The number of elements in each row, i.e. the number of columns of the array
   /// @note All row_sizes are the same, so an index is not required, but
   /// could be passed to be consistent with DynTable with variable row_sizes
-  Uint row_size(Uint i=0) const { return m_array.shape()[1]; }
+  Uint row_size(Uint i=0) const { return m_array->shape()[1]; }
 
   /// copy a given row into the array, The row type must have the size() function declared
   /// @param[in] array_idx the index of the row that will be set
@@ -140,12 +169,21 @@ public: // functions
   {
     cf3_assert(row.size() == row_size());
 
-    Row row_to_set = m_array[array_idx];
+    Row row_to_set = (*m_array)[array_idx];
 
     for(Uint j=0; j<row.size(); ++j)
       row_to_set[j] = row[j];
   }
 
+  /// Bytes used by the table entries
+  virtual Real memory_bytes() const
+  {
+    return static_cast<Real>(m_array->num_elements()) * sizeof(ValueT);
+  }
+
+  /// Start of the table entries
+  virtual const void* memory_data() const { return m_array->data(); }
+
   /// Set position for the next input by <<
   Table<ValueT>& seekp(const Uint p)
   {
@@ -161,8 +199,8 @@ public: // functions
 
 private: // data
 
-  /// storage of the array
-  ArrayT m_array;
+  /// storage of the array, held by pointer so set_row_major can exchange it for a reordered copy
+  boost::scoped_ptr<ArrayT> m_array;
   /// position when used as output stream
   Uint m_pos;
 };
@@ -0,0 +1,681 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <numeric>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/ThreadPool.hpp"
+#include "common/Timer.hpp"
+
+#ifdef CF3_OS_LINUX
+extern "C"
+{
+  #include <pthread.h>
+  #include <sched.h>
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Value of the first environment variable in names that is set, or default_value if none are set
+  Uint env_uint(const char* names[], const Uint nb_names, const Uint default_value)
+  {
+    for(Uint i = 0; i != nb_names; ++i)
+    {
+      const char* value = std::getenv(names[i]);
+      if(value == 0)
+        continue;
+      try
+      {
+        return boost::lexical_cast<Uint>(value);
+      }
+      catch(boost::bad_lexical_cast&)
+      {
+        throw BadValue(FromHere(), std::string("Environment variable ") + names[i] + " is not an unsigned integer: " + value);
+      }
+    }
+    return default_value;
+  }
+
+  /// Rank within the node, as set by the common MPI launchers
+  Uint local_rank()
+  {
+    const char* names[] = { "OMPI_COMM_WORLD_LOCAL_RANK", "MV2_COMM_WORLD_LOCAL_RANK", "MPI_LOCALRANKID", "SLURM_LOCALID" };
+    return env_uint(names, 4, 0);
+  }
+
+  /// Number of ranks on the node, as set by the common MPI launchers
+  Uint local_size()
+  {
+    const char* names[] = { "OMPI_COMM_WORLD_LOCAL_SIZE", "MV2_COMM_WORLD_LOCAL_SIZE", "MPI_LOCALNRANKS" };
+    return std::max(1u, env_uint(names, 3, 1));
+  }
+
+  Uint nb_cores()
+  {
+    return std::max(1u, boost::thread::hardware_concurrency());
+  }
+
+  Uint default_nb_threads()
+  {
+    const char* names[] = { "CF3_NB_THREADS" };
+    return std::max(1u, env_uint(names, 1, std::max(1u, nb_cores() / local_size())));
+  }
+
+  bool default_pin_threads()
+  {
+    const char* names[] = { "CF3_PIN_THREADS" };
+    return env_uint(names, 1, 0) != 0;
+  }
+
+  ThreadPool::Schedule default_schedule()
+  {
+    const char* value = std::getenv("CF3_THREAD_SCHEDULE");
+    if(value == 0)
+      return ThreadPool::STATIC;
+    const std::string schedule(value);
+    if(schedule == "static")
+      return ThreadPool::STATIC;
+    if(schedule == "dynamic")
+      return ThreadPool::DYNAMIC;
+    if(schedule == "work_stealing")
+      return ThreadPool::WORK_STEALING;
+    throw BadValue(FromHere(), "Unknown thread schedule " + schedule + " in CF3_THREAD_SCHEDULE, use static, dynamic or work_stealing");
+  }
+
+  /// Bind the calling thread to a single core
+  void pin_to_core(const Uint core)
+  {
+#ifdef CF3_OS_LINUX
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core % nb_cores(), &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ThreadPool::TaskGroup::State
+{
+  State() : nb_remaining(0), timing(false) {}
+
+  // Protected by the pool mutex
+  Uint nb_remaining;
+  std::string failures;
+
+  // Started when the first task is queued after a wait
+  Timer timer;
+  bool timing;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class ThreadPool::Implementation
+{
+public:
+  struct Entry
+  {
+    TaskT task;
+    TaskGroup::State* group;
+  };
+
+  Implementation() :
+    nb_threads(detail::default_nb_threads()),
+    pin(detail::default_pin_threads()),
+    schedule(detail::default_schedule()),
+    started(false),
+    stop(false)
+  {
+    statistics.busy_time.assign(nb_threads, 0.);
+  }
+
+  ~Implementation()
+  {
+    stop_workers();
+  }
+
+  // Must be called with the mutex locked
+  void start_workers()
+  {
+    if(started)
+      return;
+
+    started = true;
+    stop = false;
+    worker_tasks.resize(nb_threads);
+    // Only the workers are bound: the caller may be any thread that happens to push work first
+    for(Uint t = 1; t < nb_threads; ++t)
+      workers.push_back(new boost::thread(boost::bind(&Implementation::run, this, t, pin, first_core() + t)));
+  }
+
+  // Lets the workers finish the queued tasks and joins them
+  void stop_workers()
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(mutex);
+      stop = true;
+    }
+    work_available.notify_all();
+    for(Uint t = 0; t != workers.size(); ++t)
+      workers[t].join();
+
+    boost::lock_guard<boost::mutex> guard(mutex);
+    workers.clear();
+    started = false;
+  }
+
+  /// Queue a task. Worker 0 means the shared queue, which is served by all workers, otherwise the task is only
+  /// executed by the worker with the given index.
+  void push(const TaskT& task, TaskGroup::State& group, const Uint worker = 0)
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(mutex);
+      start_workers();
+      cf3_assert(worker < nb_threads);
+      Entry entry;
+      entry.task = task;
+      entry.group = &group;
+      if(worker == 0)
+        tasks.push_back(entry);
+      else
+        worker_tasks[worker].push_back(entry);
+      ++group.nb_remaining;
+      if(!group.timing)
+      {
+        group.timer.restart();
+        group.timing = true;
+      }
+    }
+    // All workers wait on the same condition, so a task for a given worker must wake them all
+    if(worker == 0)
+      work_available.notify_one();
+    else
+      work_available.notify_all();
+    // Waiters of the group may have to run the task themselves
+    state_changed.notify_all();
+  }
+
+  // Execute the queued tasks of the group until it is done. Tasks of other groups are left to the workers and
+  // their own waiters, so a thread never gets stuck in unrelated work.
+  std::string wait(TaskGroup::State& group)
+  {
+    const bool is_worker = is_not_null(thread_index.get());
+    std::string failures;
+    boost::unique_lock<boost::mutex> lock(mutex);
+    while(group.nb_remaining != 0)
+    {
+      std::deque<Entry>::iterator it = tasks.begin();
+      while(it != tasks.end() && it->group != &group)
+        ++it;
+      if(it == tasks.end())
+      {
+        state_changed.wait(lock);
+        continue;
+      }
+      const Entry entry = *it;
+      tasks.erase(it);
+      run_entry(entry, lock);
+    }
+    failures.swap(group.failures);
+
+    // Nested waits in the workers are already counted as busy time
+    if(!is_worker && group.timing)
+      statistics.wall_time += group.timer.elapsed();
+    group.timing = false;
+    return failures;
+  }
+
+  // Body of the worker threads. The tasks for this worker go first.
+  void run(const Uint t, const bool pin_thread, const Uint core)
+  {
+    thread_index.reset(new Uint(t));
+    if(pin_thread)
+      detail::pin_to_core(core);
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+    std::deque<Entry>& own_tasks = worker_tasks[t];
+    while(true)
+    {
+      while(own_tasks.empty() && tasks.empty() && !stop)
+        work_available.wait(lock);
+
+      std::deque<Entry>& queue = own_tasks.empty() ? tasks : own_tasks;
+      if(queue.empty())
+        return;
+
+      const Entry entry = queue.front();
+      queue.pop_front();
+      run_entry(entry, lock);
+    }
+  }
+
+  // Run a task that is counted in its group, with the mutex unlocked. Must be called with the mutex locked.
+  void run_entry(const Entry& entry, boost::unique_lock<boost::mutex>& lock)
+  {
+    lock.unlock();
+
+    Timer timer;
+    std::string failure;
+    try
+    {
+      entry.task();
+    }
+    catch(Exception& e)
+    {
+      failure = e.msg();
+    }
+    catch(std::exception& e)
+    {
+      failure = e.what();
+    }
+    catch(...)
+    {
+      failure = "unknown exception";
+    }
+    const Real elapsed = timer.elapsed();
+
+    lock.lock();
+    const Uint t = is_null(thread_index.get()) ? 0 : *thread_index;
+    if(t < statistics.busy_time.size())
+      statistics.busy_time[t] += elapsed;
+    ++statistics.nb_tasks;
+    if(!failure.empty())
+      entry.group->failures += "\n  " + failure;
+    if(--entry.group->nb_remaining == 0)
+      state_changed.notify_all();
+  }
+
+  Uint first_core() const
+  {
+    return detail::local_rank() * nb_threads;
+  }
+
+  mutable boost::mutex mutex;
+  boost::condition_variable work_available;
+  boost::condition_variable state_changed;
+
+  /// Tasks that can be run by any thread
+  std::deque<Entry> tasks;
+  /// Tasks for each worker, indexed by thread index. Index 0 is not used.
+  std::vector< std::deque<Entry> > worker_tasks;
+  Uint nb_threads;
+  bool pin;
+  Schedule schedule;
+  bool started;
+  bool stop;
+  Statistics statistics;
+
+  boost::ptr_vector<boost::thread> workers;
+
+  // Index of the pool thread, not set for threads outside of the pool
+  boost::thread_specific_ptr<Uint> thread_index;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Remaining range of a thread in a work-stealing loop
+  struct WorkRange
+  {
+    boost::mutex mutex;
+    Uint begin;
+    Uint end;
+  };
+
+  /// State shared by the threads executing a loop
+  struct LoopState
+  {
+    LoopState(const ThreadPool::RangeFunctionT& f_in, const Uint begin_in, const Uint end_in, const Uint nb_threads_in, const Uint grain_size_in) :
+      f(f_in),
+      begin(begin_in),
+      end(end_in),
+      nb_threads(nb_threads_in),
+      grain_size(grain_size_in),
+      next(begin_in),
+      nb_steals(0),
+      ranges(new WorkRange[nb_threads_in])
+    {
+      for(Uint t = 0; t != nb_threads; ++t)
+      {
+        ranges[t].begin = block_begin(t);
+        ranges[t].end = block_begin(t+1);
+      }
+    }
+
+    Uint block_begin(const Uint t) const
+    {
+      return begin + (t*(end - begin))/nb_threads;
+    }
+
+    const ThreadPool::RangeFunctionT& f;
+    const Uint begin;
+    const Uint end;
+    const Uint nb_threads;
+    const Uint grain_size;
+
+    boost::mutex mutex;
+    Uint next;
+    Uint nb_steals;
+
+    boost::scoped_array<WorkRange> ranges;
+  };
+
+  void run_static(LoopState& loop, const Uint t)
+  {
+    const Uint first = loop.block_begin(t);
+    const Uint last = loop.block_begin(t+1);
+    if(first != last)
+      loop.f(first, last);
+  }
+
+  void run_dynamic(LoopState& loop, const Uint)
+  {
+    while(true)
+    {
+      Uint first;
+      {
+        boost::lock_guard<boost::mutex> guard(loop.mutex);
+        first = loop.next;
+        loop.next = std::min(loop.end, loop.next + loop.grain_size);
+      }
+      if(first >= loop.end)
+        return;
+      loop.f(first, std::min(loop.end, first + loop.grain_size));
+    }
+  }
+
+  /// Steal the upper half of the largest remaining range of another thread. Returns false if there is no work left.
+  bool steal(LoopState& loop, const Uint t)
+  {
+    while(true)
+    {
+      // Find the victim, checked again when cutting its range since it may have progressed in the mean time
+      Uint victim = loop.nb_threads;
+      Uint largest = 0;
+      for(Uint v = 0; v != loop.nb_threads; ++v)
+      {
+        if(v == t)
+          continue;
+        Uint remaining;
+        {
+          boost::lock_guard<boost::mutex> guard(loop.ranges[v].mutex);
+          remaining = loop.ranges[v].end - std::min(loop.ranges[v].end, loop.ranges[v].begin);
+        }
+        if(remaining > largest)
+        {
+          largest = remaining;
+          victim = v;
+        }
+      }
+      if(victim == loop.nb_threads)
+        return false;
+
+      Uint first, last;
+      {
+        boost::lock_guard<boost::mutex> guard(loop.ranges[victim].mutex);
+        WorkRange& range = loop.ranges[victim];
+        if(range.begin >= range.end)
+          continue;
+        first = range.begin + (range.end - range.begin) / 2;
+        last = range.end;
+        range.end = first;
+      }
+      {
+        boost::lock_guard<boost::mutex> guard(loop.ranges[t].mutex);
+        loop.ranges[t].begin = first;
+        loop.ranges[t].end = last;
+      }
+      {
+        boost::lock_guard<boost::mutex> guard(loop.mutex);
+        ++loop.nb_steals;
+      }
+      return true;
+    }
+  }
+
+  void run_work_stealing(LoopState& loop, const Uint t)
+  {
+    WorkRange& own = loop.ranges[t];
+    while(true)
+    {
+      Uint first, last;
+      {
+        boost::lock_guard<boost::mutex> guard(own.mutex);
+        first = own.begin;
+        last = std::min(own.end, own.begin + loop.grain_size);
+        own.begin = std::max(own.begin, last);
+      }
+      if(first < last)
+        loop.f(first, last);
+      else if(!steal(loop, t))
+        return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::Statistics::Statistics() :
+  nb_loops(0),
+  nb_tasks(0),
+  nb_steals(0),
+  wall_time(0.)
+{
+}
+
+Real ThreadPool::Statistics::utilization() const
+{
+  if(wall_time <= 0. || busy_time.empty())
+    return 0.;
+  return std::accumulate(busy_time.begin(), busy_time.end(), 0.) / (wall_time * static_cast<Real>(busy_time.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::TaskGroup::TaskGroup() :
+  m_state(new State())
+{
+}
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch(...)
+  {
+  }
+}
+
+void ThreadPool::TaskGroup::run(const TaskT& task)
+{
+  ThreadPool::instance().m_implementation->push(task, *m_state);
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+  const std::string failures = ThreadPool::instance().m_implementation->wait(*m_state);
+  if(!failures.empty())
+    throw ParallelError(FromHere(), "Parallel task failed:" + failures);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool() :
+  m_implementation(new Implementation())
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+ThreadPool& ThreadPool::instance()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+Uint ThreadPool::nb_threads() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->nb_threads;
+}
+
+void ThreadPool::set_nb_threads(const Uint nb_threads)
+{
+  if(nb_threads == 0)
+    throw BadValue(FromHere(), "The thread pool must have at least one thread");
+  if(is_not_null(m_implementation->thread_index.get()))
+    throw IllegalCall(FromHere(), "The number of threads can't be changed from a task running on the thread pool");
+
+  if(nb_threads == this->nb_threads())
+    return;
+
+  m_implementation->stop_workers();
+
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  m_implementation->nb_threads = nb_threads;
+  m_implementation->statistics.busy_time.resize(nb_threads, 0.);
+}
+
+Uint ThreadPool::thread_index() const
+{
+  const Uint* index = m_implementation->thread_index.get();
+  return is_null(index) ? 0 : *index;
+}
+
+bool ThreadPool::pin_threads() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->pin;
+}
+
+void ThreadPool::set_pin_threads(const bool pin)
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  m_implementation->pin = pin;
+}
+
+ThreadPool::Schedule ThreadPool::default_schedule() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->schedule;
+}
+
+void ThreadPool::set_default_schedule(const Schedule schedule)
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  m_implementation->schedule = schedule;
+}
+
+Uint ThreadPool::nb_used_threads(const Uint nb_items, const Uint max_threads) const
+{
+  const Uint pool_threads = nb_threads();
+  return std::max(1u, std::min(nb_items, max_threads == 0 ? pool_threads : std::min(max_threads, pool_threads)));
+}
+
+void ThreadPool::parallel_for(const Uint begin, const Uint end, const RangeFunctionT& f, const Schedule schedule, const Uint grain_size, const Uint max_threads)
+{
+  if(end <= begin)
+    return;
+
+  const Uint nb_items = end - begin;
+  const Uint used_threads = nb_used_threads(nb_items, max_threads);
+  {
+    boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+    ++m_implementation->statistics.nb_loops;
+  }
+
+  if(used_threads == 1)
+  {
+    f(begin, end);
+    return;
+  }
+
+  // Automatic grain size: about 8 chunks per thread, to balance the load without too much locking
+  const Uint grain = grain_size != 0 ? grain_size : std::max(1u, nb_items / (8*used_threads));
+  detail::LoopState loop(f, begin, end, used_threads, grain);
+
+  void (*body)(detail::LoopState&, const Uint) = &detail::run_static;
+  if(schedule == DYNAMIC)
+    body = &detail::run_dynamic;
+  else if(schedule == WORK_STEALING)
+    body = &detail::run_work_stealing;
+
+  // A loop started outside of the pool with the static schedule sends block t to worker t, so loops over the same
+  // range always process a block on the same thread. Blocks of nested loops go to whichever thread is free,
+  // since the workers may be waiting for the loop that started them.
+  Implementation& implementation = *m_implementation;
+  const bool fixed_blocks = schedule == STATIC && is_null(implementation.thread_index.get());
+  TaskGroup group;
+  for(Uint t = 1; t != used_threads; ++t)
+    implementation.push(boost::bind(body, boost::ref(loop), t), *group.m_state, fixed_blocks ? t : 0);
+
+  // The calling thread takes block 0
+  Implementation::Entry caller_entry;
+  caller_entry.task = boost::bind(body, boost::ref(loop), 0u);
+  caller_entry.group = group.m_state.get();
+  {
+    boost::unique_lock<boost::mutex> lock(implementation.mutex);
+    ++group.m_state->nb_remaining;
+    implementation.run_entry(caller_entry, lock);
+  }
+  group.wait();
+
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  m_implementation->statistics.nb_steals += loop.nb_steals;
+}
+
+void ThreadPool::parallel_for(const Uint begin, const Uint end, const RangeFunctionT& f)
+{
+  parallel_for(begin, end, f, default_schedule());
+}
+
+ThreadPool::Statistics ThreadPool::statistics() const
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  return m_implementation->statistics;
+}
+
+void ThreadPool::reset_statistics()
+{
+  boost::lock_guard<boost::mutex> guard(m_implementation->mutex);
+  Statistics& statistics = m_implementation->statistics;
+  statistics = Statistics();
+  statistics.busy_time.assign(m_implementation->nb_threads, 0.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
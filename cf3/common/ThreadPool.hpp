@@ -0,0 +1,186 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_ThreadPool_hpp
+#define cf3_common_ThreadPool_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Pool of worker threads shared by all components that run work in parallel within an MPI rank.
+/// The number of threads defaults to the number of cores divided by the number of ranks on the node, and can
+/// be set through the environment variable CF3_NB_THREADS or the nb_threads option of the Environment.
+/// When pinning is enabled (CF3_PIN_THREADS or the pin_threads option), worker thread t of local rank r is bound
+/// to core r*nb_threads() + t, so the threads of the ranks on a node don't overlap. Core r*nb_threads() is left
+/// for the main thread, which is not bound since the pool does not know which thread that is.
+/// All waiting functions execute the queued tasks of the group they wait for, so it is safe to use the pool from
+/// tasks and loop bodies that are already running on the pool (e.g. an Action executed inside a task group).
+/// Tasks of other groups, e.g. those queued by another thread that uses the pool, are never run by a waiter.
+/// Tasks must not call MPI or log through CFinfo and friends, since these are not thread-safe.
+/// Exceptions thrown by tasks are collected and rethrown as a ParallelError by the waiting thread.
+class Common_API ThreadPool : public boost::noncopyable
+{
+public:
+  /// Type of the tasks that can be run
+  typedef boost::function<void ()> TaskT;
+
+  /// Loop body, called for sub-ranges [begin, end) of the loop range
+  typedef boost::function<void (const Uint, const Uint)> RangeFunctionT;
+
+  /// Distribution of the iterations of a parallel loop over the threads
+  enum Schedule
+  {
+    /// Each thread gets a single contiguous block of iterations. For loops started outside of the pool, block 0 is
+    /// processed by the calling thread and block t by the worker with thread_index() t, so loops over the same range
+    /// with the same number of threads always process a block on the same thread. The blocks of loops nested in
+    /// pool tasks are processed by any free thread.
+    STATIC = 0,
+    /// Threads take chunks of grain_size iterations from a shared counter
+    DYNAMIC = 1,
+    /// Each thread starts with a contiguous block, taking grain_size chunks from it, and steals half the
+    /// remaining work of another thread when it runs out
+    WORK_STEALING = 2
+  };
+
+  /// Utilization counters, accumulated since the last call to reset_statistics()
+  struct Common_API Statistics
+  {
+    Statistics();
+
+    /// Number of parallel loops
+    Uint nb_loops;
+    /// Number of tasks executed, including the tasks used to run loops
+    Uint nb_tasks;
+    /// Number of work-stealing operations
+    Uint nb_steals;
+    /// Wall time spent waiting for loops and task groups to complete, in the threads that started them
+    Real wall_time;
+    /// Time spent running tasks by each thread. Index 0 is used for all threads that are not part of the pool.
+    std::vector<Real> busy_time;
+
+    /// Fraction of the available thread time spent running tasks while waiting for loops and task groups
+    Real utilization() const;
+  };
+
+  /// Set of tasks that is waited for as a whole
+  class Common_API TaskGroup : public boost::noncopyable
+  {
+  public:
+    TaskGroup();
+
+    /// Waits for the remaining tasks, without throwing
+    ~TaskGroup();
+
+    /// Queue a task for execution by the pool
+    void run(const TaskT& task);
+
+    /// Block until all tasks in the group have completed, helping to execute the queued tasks of this group.
+    /// @throw ParallelError if any of the tasks threw an exception
+    void wait();
+
+  private:
+    friend class ThreadPool;
+    struct State;
+    boost::scoped_ptr<State> m_state;
+  };
+
+  /// @return the single pool instance
+  static ThreadPool& instance();
+
+  /// Number of threads that execute work, including the calling thread
+  Uint nb_threads() const;
+
+  /// Index of the calling thread in the pool: 1 to nb_threads()-1 for the workers, 0 for threads outside of the pool
+  Uint thread_index() const;
+
+  /// Set the number of threads. Must be at least 1. Waits for queued tasks before resizing.
+  void set_nb_threads(const Uint nb_threads);
+
+  /// True if the threads are bound to cores
+  bool pin_threads() const;
+
+  /// Bind the threads to cores, using the core numbering described above. Takes effect when the threads are (re)started.
+  void set_pin_threads(const bool pin);
+
+  /// Schedule used by parallel_for if none is given
+  Schedule default_schedule() const;
+  void set_default_schedule(const Schedule schedule);
+
+  /// Run f over the range [begin, end), in sub-ranges that are distributed over the threads according to schedule.
+  /// The calling thread takes part in the work. Blocks until the whole range is done.
+  /// @param grain_size  Number of iterations per chunk for the dynamic and work-stealing schedules, 0 for automatic
+  /// @param max_threads Maximum number of threads to use, 0 to use all threads
+  /// @throw ParallelError if f threw an exception for any of the sub-ranges
+  void parallel_for(const Uint begin, const Uint end, const RangeFunctionT& f, const Schedule schedule, const Uint grain_size = 0, const Uint max_threads = 0);
+
+  /// Run f over the range [begin, end) using the default schedule
+  void parallel_for(const Uint begin, const Uint end, const RangeFunctionT& f);
+
+  /// Reduce the range [begin, end) using f to compute the value for a sub-range and combine to merge values.
+  /// The range is split into one contiguous block per thread, and the block values are combined in order with init,
+  /// so the result is the same for every run with the same number of threads.
+  template<typename T, typename CombineT>
+  T parallel_reduce(const Uint begin, const Uint end, const boost::function<T (const Uint, const Uint)>& f, const T& init, const CombineT& combine, const Uint max_threads = 0)
+  {
+    const Uint nb_blocks = nb_used_threads(end - begin, max_threads);
+    std::vector<T> block_values(nb_blocks, init);
+    parallel_for(0, nb_blocks, boost::bind(&ThreadPool::reduce_blocks<T>, boost::cref(f), begin, end, nb_blocks, boost::ref(block_values), _1, _2), STATIC, 1, nb_blocks);
+
+    T result = init;
+    for(Uint i = 0; i != nb_blocks; ++i)
+      result = combine(result, block_values[i]);
+    return result;
+  }
+
+  /// Number of threads that is used for a loop of nb_items iterations, limited to max_threads (0 means no limit)
+  Uint nb_used_threads(const Uint nb_items, const Uint max_threads = 0) const;
+
+  /// Copy of the utilization counters
+  Statistics statistics() const;
+
+  /// Reset the utilization counters
+  void reset_statistics();
+
+private:
+  ThreadPool();
+  ~ThreadPool();
+
+  template<typename T>
+  static void reduce_blocks(const boost::function<T (const Uint, const Uint)>& f, const Uint begin, const Uint end, const Uint nb_blocks, std::vector<T>& block_values, const Uint first_block, const Uint last_block)
+  {
+    const Uint nb_items = end - begin;
+    for(Uint i = first_block; i != last_block; ++i)
+      block_values[i] = f(begin + (i*nb_items)/nb_blocks, begin + ((i+1)*nb_items)/nb_blocks);
+  }
+
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_ThreadPool_hpp
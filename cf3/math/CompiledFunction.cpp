@@ -0,0 +1,661 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+
+#include "math/CompiledFunction.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Tolerance for the comparison operators, same as FP_EPSILON in fparser/fpconfig.hh
+  const Real comparison_epsilon = 1e-14;
+
+  /// Truth value of a number, as in fparser
+  inline bool truth(const Real value)
+  {
+    return std::abs(value) >= 0.5;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Recursive descent parser, emitting the instructions while parsing
+class CompiledFunction::Compiler
+{
+public:
+  Compiler(CompiledFunction& function, const std::vector<std::string>& variables) :
+    m_function(function),
+    m_branch_depth(0)
+  {
+    for(Uint i = 0; i != variables.size(); ++i)
+    {
+      m_variables[variables[i]] = i;
+      m_is_constant.push_back(false);
+      m_constant_values.push_back(0.);
+    }
+  }
+
+  /// Compile a function and return the register holding the result
+  Uint compile(const std::string& text)
+  {
+    m_text = text;
+    m_position = 0;
+    const Uint result = parse_or();
+    skip_whitespace();
+    if(m_position != m_text.size())
+      syntax_error("unexpected character");
+    return result;
+  }
+
+  /// Store the constant registers and the register count in the function
+  void finish()
+  {
+    m_function.m_nb_registers = m_is_constant.size();
+    m_function.m_constants.clear();
+    for(Uint i = 0; i != m_is_constant.size(); ++i)
+    {
+      if(m_is_constant[i])
+        m_function.m_constants.push_back(std::make_pair(i, m_constant_values[i]));
+    }
+  }
+
+private:
+  void skip_whitespace()
+  {
+    while(m_position != m_text.size() && std::isspace(m_text[m_position]))
+      ++m_position;
+  }
+
+  /// End of the decimal number starting at begin: digits with an optional fraction and exponent.
+  /// Returns begin if there is no number there.
+  Uint scan_number(const Uint begin) const
+  {
+    Uint position = begin;
+    Uint nb_digits = 0;
+    for(; position != m_text.size() && std::isdigit(m_text[position]); ++position)
+      ++nb_digits;
+    if(position != m_text.size() && m_text[position] == '.')
+      for(++position; position != m_text.size() && std::isdigit(m_text[position]); ++position)
+        ++nb_digits;
+    if(nb_digits == 0)
+      return begin;
+
+    if(position != m_text.size() && (m_text[position] == 'e' || m_text[position] == 'E'))
+    {
+      Uint exponent = position + 1;
+      if(exponent != m_text.size() && (m_text[exponent] == '+' || m_text[exponent] == '-'))
+        ++exponent;
+      if(exponent != m_text.size() && std::isdigit(m_text[exponent]))
+      {
+        position = exponent;
+        while(position != m_text.size() && std::isdigit(m_text[position]))
+          ++position;
+      }
+    }
+    return position;
+  }
+
+  /// Consume the given token if it is next in the input
+  bool match(const std::string& token)
+  {
+    skip_whitespace();
+    if(m_text.compare(m_position, token.size(), token) != 0)
+      return false;
+    m_position += token.size();
+    return true;
+  }
+
+  void expect(const std::string& token)
+  {
+    if(!match(token))
+      syntax_error("expected " + token);
+  }
+
+  void syntax_error(const std::string& message) const
+  {
+    throw common::ParsingFailed(FromHere(), "Error compiling function [" + m_text + "] at position " + common::to_str(m_position) + ": " + message);
+  }
+
+  Uint new_register()
+  {
+    m_is_constant.push_back(false);
+    m_constant_values.push_back(0.);
+    return m_is_constant.size() - 1;
+  }
+
+  Uint constant(const Real value)
+  {
+    const Uint result = new_register();
+    m_is_constant[result] = true;
+    m_constant_values[result] = value;
+    return result;
+  }
+
+  /// Add an instruction, or evaluate it right away if all arguments are constant.
+  /// Inside the branches of an if nothing is evaluated, since the branch may not be taken.
+  Uint emit(const OpCode op, const Uint a, const Uint b = 0, const Uint nb_arguments = 1)
+  {
+    const Uint arguments[2] = { a, b };
+    bool is_constant = m_branch_depth == 0;
+    for(Uint i = 0; i != nb_arguments; ++i)
+      is_constant = is_constant && m_is_constant[arguments[i]];
+
+    Instruction instruction;
+    instruction.op = op;
+    instruction.jump[0] = instruction.jump[1] = 0;
+    instruction.arguments[2] = 0;
+
+    if(is_constant)
+    {
+      Real values[3] = { m_constant_values[a], nb_arguments > 1 ? m_constant_values[b] : 0., 0. };
+      instruction.result = 2;
+      instruction.arguments[0] = 0;
+      instruction.arguments[1] = 1;
+      CompiledFunction::execute(instruction, values, 1, 0, 1);
+      return constant(values[2]);
+    }
+
+    instruction.result = new_register();
+    instruction.arguments[0] = a;
+    instruction.arguments[1] = b;
+    m_function.m_program.push_back(instruction);
+    return instruction.result;
+  }
+
+  Uint parse_or()
+  {
+    Uint result = parse_and();
+    while(match("|"))
+      result = emit(Or, result, parse_and(), 2);
+    return result;
+  }
+
+  Uint parse_and()
+  {
+    Uint result = parse_comparison();
+    while(match("&"))
+      result = emit(And, result, parse_comparison(), 2);
+    return result;
+  }
+
+  Uint parse_comparison()
+  {
+    Uint result = parse_additive();
+    while(true)
+    {
+      // Two-character operators must be tried first
+      if(match("!="))
+        result = emit(NotEqual, result, parse_additive(), 2);
+      else if(match("<="))
+        result = emit(LessEqual, result, parse_additive(), 2);
+      else if(match(">="))
+        result = emit(GreaterEqual, result, parse_additive(), 2);
+      else if(match("="))
+        result = emit(Equal, result, parse_additive(), 2);
+      else if(match("<"))
+        result = emit(Less, result, parse_additive(), 2);
+      else if(match(">"))
+        result = emit(Greater, result, parse_additive(), 2);
+      else
+        return result;
+    }
+  }
+
+  Uint parse_additive()
+  {
+    Uint result = parse_multiplicative();
+    while(true)
+    {
+      if(match("+"))
+        result = emit(Add, result, parse_multiplicative(), 2);
+      else if(match("-"))
+        result = emit(Sub, result, parse_multiplicative(), 2);
+      else
+        return result;
+    }
+  }
+
+  Uint parse_multiplicative()
+  {
+    Uint result = parse_unary();
+    while(true)
+    {
+      if(match("*"))
+        result = emit(Mul, result, parse_unary(), 2);
+      else if(match("/"))
+        result = emit(Div, result, parse_unary(), 2);
+      else if(match("%"))
+        result = emit(Mod, result, parse_unary(), 2);
+      else
+        return result;
+    }
+  }
+
+  /// Unary minus binds less tightly than the power, so -x^2 is -(x^2)
+  Uint parse_unary()
+  {
+    skip_whitespace();
+    if(m_position != m_text.size() && m_text[m_position] == '!' && m_text.compare(m_position, 2, "!=") != 0)
+    {
+      ++m_position;
+      return emit(Not, parse_unary());
+    }
+    if(match("-"))
+      return emit(Neg, parse_unary());
+    return parse_power();
+  }
+
+  /// Right associative, with an optionally negated exponent
+  Uint parse_power()
+  {
+    const Uint base = parse_primary();
+    if(!match("^"))
+      return base;
+
+    const Uint exponent = parse_unary();
+    if(m_is_constant[exponent] && !m_is_constant[base])
+    {
+      const Real value = m_constant_values[exponent];
+      if(value == 1.)
+        return base;
+      if(value == 2.)
+        return emit(Square, base);
+      if(value == 0.5)
+        return emit(Sqrt, base);
+      if(value == -1.)
+        return emit(Div, constant(1.), base, 2);
+    }
+    return emit(Pow, base, exponent, 2);
+  }
+
+  Uint parse_primary()
+  {
+    skip_whitespace();
+    if(m_position == m_text.size())
+      syntax_error("unexpected end of function");
+
+    const char c = m_text[m_position];
+    if(c == '(')
+    {
+      ++m_position;
+      const Uint result = parse_or();
+      expect(")");
+      return result;
+    }
+
+    if(std::isdigit(c) || c == '.')
+    {
+      // Only plain decimal numbers are accepted, strtod would also read hexadecimal, inf and nan
+      const Uint number_end = scan_number(m_position);
+      if(number_end == m_position)
+        syntax_error("invalid number");
+      const std::string number = m_text.substr(m_position, number_end - m_position);
+      m_position = number_end;
+      return constant(std::strtod(number.c_str(), 0));
+    }
+
+    if(!std::isalpha(c) && c != '_')
+      syntax_error("unexpected character");
+
+    const Uint name_begin = m_position;
+    while(m_position != m_text.size() && (std::isalnum(m_text[m_position]) || m_text[m_position] == '_'))
+      ++m_position;
+    const std::string name = m_text.substr(name_begin, m_position - name_begin);
+
+    if(match("("))
+      return parse_function(name);
+
+    const std::map<std::string, Uint>::const_iterator variable = m_variables.find(name);
+    if(variable != m_variables.end())
+      return variable->second;
+
+    const std::map<std::string, Real>::const_iterator named_constant = m_function.m_named_constants.find(name);
+    if(named_constant != m_function.m_named_constants.end())
+      return constant(named_constant->second);
+
+    syntax_error("unknown variable " + name);
+    return 0;
+  }
+
+  /// Parse the arguments of a function, after the opening bracket
+  Uint parse_function(const std::string& name)
+  {
+    if(name == "if")
+      return parse_if();
+
+    std::vector<Uint> arguments;
+    if(!match(")"))
+    {
+      arguments.push_back(parse_or());
+      while(match(","))
+        arguments.push_back(parse_or());
+      expect(")");
+    }
+
+    OpCode op;
+    Uint nb_arguments = 1;
+    if(!find_function(name, op, nb_arguments))
+      throw common::NotSupported(FromHere(), "Function " + name + " in [" + m_text + "] is not supported by CompiledFunction");
+    if(arguments.size() != nb_arguments)
+      syntax_error("function " + name + " takes " + common::to_str(nb_arguments) + " arguments");
+
+    return emit(op, arguments[0], nb_arguments > 1 ? arguments[1] : 0, nb_arguments);
+  }
+
+  /// Both branches are emitted after the If instruction, so only the branch that is taken gets evaluated
+  Uint parse_if()
+  {
+    const Uint condition = parse_or();
+    expect(",");
+
+    if(m_is_constant[condition])
+    {
+      // Only the code for the branch that is taken is kept
+      const bool take_then = truth(m_constant_values[condition]);
+      const Uint then_begin = m_function.m_program.size();
+      const Uint then_result = parse_branch(!take_then);
+      if(!take_then)
+        m_function.m_program.resize(then_begin);
+      expect(",");
+      const Uint else_begin = m_function.m_program.size();
+      const Uint else_result = parse_branch(take_then);
+      if(take_then)
+        m_function.m_program.resize(else_begin);
+      expect(")");
+      return take_then ? then_result : else_result;
+    }
+
+    const Uint if_position = m_function.m_program.size();
+    m_function.m_program.push_back(Instruction());
+    const Uint then_result = parse_branch(true);
+    const Uint then_end = m_function.m_program.size();
+    expect(",");
+    const Uint else_result = parse_branch(true);
+    expect(")");
+
+    Instruction& instruction = m_function.m_program[if_position];
+    instruction.op = If;
+    instruction.result = new_register();
+    instruction.arguments[0] = condition;
+    instruction.arguments[1] = then_result;
+    instruction.arguments[2] = else_result;
+    instruction.jump[0] = then_end;
+    instruction.jump[1] = m_function.m_program.size();
+    return instruction.result;
+  }
+
+  /// Parse one of the branches of an if, disabling constant folding if the branch is conditional
+  Uint parse_branch(const bool is_conditional)
+  {
+    if(is_conditional)
+      ++m_branch_depth;
+    const Uint result = parse_or();
+    if(is_conditional)
+      --m_branch_depth;
+    return result;
+  }
+
+  static bool find_function(const std::string& name, OpCode& op, Uint& nb_arguments)
+  {
+    struct FunctionInfo
+    {
+      const char* name;
+      OpCode op;
+      Uint nb_arguments;
+    };
+
+    static const FunctionInfo functions[] =
+    {
+      { "abs", Abs, 1 }, { "acos", Acos, 1 }, { "acosh", Acosh, 1 }, { "asin", Asin, 1 }, { "asinh", Asinh, 1 },
+      { "atan", Atan, 1 }, { "atan2", Atan2, 2 }, { "atanh", Atanh, 1 }, { "cbrt", Cbrt, 1 }, { "ceil", Ceil, 1 },
+      { "cos", Cos, 1 }, { "cosh", Cosh, 1 }, { "cot", Cot, 1 }, { "csc", Csc, 1 }, { "exp", Exp, 1 },
+      { "exp2", Exp2, 1 }, { "floor", Floor, 1 }, { "hypot", Hypot, 2 }, { "int", Int, 1 }, { "log", Log, 1 },
+      { "log2", Log2, 1 }, { "log10", Log10, 1 }, { "max", Max, 2 }, { "min", Min, 2 }, { "pow", Pow, 2 },
+      { "sec", Sec, 1 }, { "sin", Sin, 1 }, { "sinh", Sinh, 1 }, { "sqrt", Sqrt, 1 }, { "tan", Tan, 1 },
+      { "tanh", Tanh, 1 }, { "trunc", Trunc, 1 }
+    };
+
+    const Uint nb_functions = sizeof(functions) / sizeof(FunctionInfo);
+    for(Uint i = 0; i != nb_functions; ++i)
+    {
+      if(name == functions[i].name)
+      {
+        op = functions[i].op;
+        nb_arguments = functions[i].nb_arguments;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  CompiledFunction& m_function;
+  std::string m_text;
+  Uint m_position;
+  std::map<std::string, Uint> m_variables;
+  std::vector<bool> m_is_constant;
+  std::vector<Real> m_constant_values;
+  /// Number of enclosing if branches
+  Uint m_branch_depth;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+const Uint CompiledFunction::batch_size;
+const Uint CompiledFunction::max_stack_registers;
+
+CompiledFunction::CompiledFunction() :
+  m_is_compiled(false),
+  m_nb_variables(0),
+  m_nb_registers(0)
+{
+}
+
+CompiledFunction::CompiledFunction(const std::vector<std::string>& functions, const std::vector<std::string>& variables) :
+  m_is_compiled(false),
+  m_nb_variables(0),
+  m_nb_registers(0)
+{
+  compile(functions, variables);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompiledFunction::add_constant(const std::string& name, const Real value)
+{
+  m_named_constants[name] = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompiledFunction::compile(const std::vector<std::string>& functions, const std::vector<std::string>& variables)
+{
+  m_is_compiled = false;
+  m_program.clear();
+  m_outputs.clear();
+  m_nb_variables = variables.size();
+
+  Compiler compiler(*this, variables);
+  for(Uint i = 0; i != functions.size(); ++i)
+    m_outputs.push_back(compiler.compile(functions[i]));
+  compiler.finish();
+
+  m_is_compiled = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompiledFunction::evaluate(const Real* variables, const Uint variables_stride, Real* results, const Uint results_stride, const Uint nb_points) const
+{
+  cf3_assert(m_is_compiled);
+  if(nb_points == 0)
+    return;
+
+  // Registers are stored per register, with one entry for each point in the batch. They are kept on the stack, so
+  // evaluation is reentrant: large programs use smaller batches, and only a program that doesn't fit on the stack
+  // for a single point needs the heap.
+  Real local_registers[max_stack_registers];
+  std::vector<Real> heap_registers;
+  Real* registers = local_registers;
+  Uint stride = std::min(nb_points, batch_size);
+  if(m_nb_registers*stride > max_stack_registers)
+  {
+    stride = max_stack_registers / m_nb_registers;
+    if(stride == 0)
+    {
+      stride = 1;
+      heap_registers.resize(m_nb_registers);
+      registers = &heap_registers[0];
+    }
+  }
+
+  for(std::vector< std::pair<Uint, Real> >::const_iterator it = m_constants.begin(); it != m_constants.end(); ++it)
+    std::fill(registers + it->first*stride, registers + (it->first+1)*stride, it->second);
+
+  const Uint nb_outputs = m_outputs.size();
+  for(Uint batch_begin = 0; batch_begin < nb_points; batch_begin += stride)
+  {
+    const Uint nb_lanes = std::min(stride, nb_points - batch_begin);
+
+    for(Uint var = 0; var != m_nb_variables; ++var)
+    {
+      Real* variable_register = registers + var*stride;
+      const Real* point_variables = variables + batch_begin*variables_stride + var;
+      for(Uint lane = 0; lane != nb_lanes; ++lane)
+        variable_register[lane] = point_variables[lane*variables_stride];
+    }
+
+    run(0, m_program.size(), registers, stride, 0, nb_lanes);
+
+    for(Uint out = 0; out != nb_outputs; ++out)
+    {
+      const Real* output_register = registers + m_outputs[out]*stride;
+      Real* point_results = results + batch_begin*results_stride + out;
+      for(Uint lane = 0; lane != nb_lanes; ++lane)
+        point_results[lane*results_stride] = output_register[lane];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompiledFunction::run(const Uint first, const Uint last, Real* registers, const Uint stride, const Uint begin, const Uint end) const
+{
+  Uint pc = first;
+  while(pc != last)
+  {
+    const Instruction& instruction = m_program[pc];
+    if(instruction.op != If)
+    {
+      execute(instruction, registers, stride, begin, end);
+      ++pc;
+      continue;
+    }
+
+    // Run each branch only on the consecutive lanes that take it, so the other branch can't raise floating point exceptions
+    const Real* condition = registers + instruction.arguments[0]*stride;
+    Real* result = registers + instruction.result*stride;
+    Uint run_begin = begin;
+    while(run_begin != end)
+    {
+      const bool take_then = truth(condition[run_begin]);
+      Uint run_end = run_begin + 1;
+      while(run_end != end && truth(condition[run_end]) == take_then)
+        ++run_end;
+
+      if(take_then)
+        run(pc+1, instruction.jump[0], registers, stride, run_begin, run_end);
+      else
+        run(instruction.jump[0], instruction.jump[1], registers, stride, run_begin, run_end);
+
+      const Real* branch_result = registers + instruction.arguments[take_then ? 1 : 2]*stride;
+      std::copy(branch_result + run_begin, branch_result + run_end, result + run_begin);
+      run_begin = run_end;
+    }
+    pc = instruction.jump[1];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CompiledFunction::execute(const Instruction& instruction, Real* registers, const Uint stride, const Uint begin, const Uint end)
+{
+  Real* r = registers + instruction.result*stride;
+  const Real* a = registers + instruction.arguments[0]*stride;
+  const Real* b = registers + instruction.arguments[1]*stride;
+
+  switch(instruction.op)
+  {
+  case Add:          for(Uint i = begin; i != end; ++i) r[i] = a[i] + b[i]; break;
+  case Sub:          for(Uint i = begin; i != end; ++i) r[i] = a[i] - b[i]; break;
+  case Mul:          for(Uint i = begin; i != end; ++i) r[i] = a[i] * b[i]; break;
+  case Div:          for(Uint i = begin; i != end; ++i) r[i] = a[i] / b[i]; break;
+  case Mod:          for(Uint i = begin; i != end; ++i) r[i] = std::fmod(a[i], b[i]); break;
+  case Pow:          for(Uint i = begin; i != end; ++i) r[i] = std::pow(a[i], b[i]); break;
+  case Square:       for(Uint i = begin; i != end; ++i) r[i] = a[i] * a[i]; break;
+  case Neg:          for(Uint i = begin; i != end; ++i) r[i] = -a[i]; break;
+  case Not:          for(Uint i = begin; i != end; ++i) r[i] = truth(a[i]) ? 0. : 1.; break;
+  case Equal:        for(Uint i = begin; i != end; ++i) r[i] = std::abs(a[i] - b[i]) <= comparison_epsilon ? 1. : 0.; break;
+  case NotEqual:     for(Uint i = begin; i != end; ++i) r[i] = std::abs(a[i] - b[i]) > comparison_epsilon ? 1. : 0.; break;
+  case Less:         for(Uint i = begin; i != end; ++i) r[i] = a[i] < b[i] - comparison_epsilon ? 1. : 0.; break;
+  case LessEqual:    for(Uint i = begin; i != end; ++i) r[i] = a[i] <= b[i] + comparison_epsilon ? 1. : 0.; break;
+  case Greater:      for(Uint i = begin; i != end; ++i) r[i] = b[i] < a[i] - comparison_epsilon ? 1. : 0.; break;
+  case GreaterEqual: for(Uint i = begin; i != end; ++i) r[i] = b[i] <= a[i] + comparison_epsilon ? 1. : 0.; break;
+  case And:          for(Uint i = begin; i != end; ++i) r[i] = truth(a[i]) && truth(b[i]) ? 1. : 0.; break;
+  case Or:           for(Uint i = begin; i != end; ++i) r[i] = truth(a[i]) || truth(b[i]) ? 1. : 0.; break;
+  case Abs:          for(Uint i = begin; i != end; ++i) r[i] = std::abs(a[i]); break;
+  case Acos:         for(Uint i = begin; i != end; ++i) r[i] = std::acos(a[i]); break;
+  case Acosh:        for(Uint i = begin; i != end; ++i) r[i] = ::acosh(a[i]); break;
+  case Asin:         for(Uint i = begin; i != end; ++i) r[i] = std::asin(a[i]); break;
+  case Asinh:        for(Uint i = begin; i != end; ++i) r[i] = ::asinh(a[i]); break;
+  case Atan:         for(Uint i = begin; i != end; ++i) r[i] = std::atan(a[i]); break;
+  case Atan2:        for(Uint i = begin; i != end; ++i) r[i] = std::atan2(a[i], b[i]); break;
+  case Atanh:        for(Uint i = begin; i != end; ++i) r[i] = ::atanh(a[i]); break;
+  case Cbrt:         for(Uint i = begin; i != end; ++i) r[i] = ::cbrt(a[i]); break;
+  case Ceil:         for(Uint i = begin; i != end; ++i) r[i] = std::ceil(a[i]); break;
+  case Cos:          for(Uint i = begin; i != end; ++i) r[i] = std::cos(a[i]); break;
+  case Cosh:         for(Uint i = begin; i != end; ++i) r[i] = std::cosh(a[i]); break;
+  case Cot:          for(Uint i = begin; i != end; ++i) r[i] = 1. / std::tan(a[i]); break;
+  case Csc:          for(Uint i = begin; i != end; ++i) r[i] = 1. / std::sin(a[i]); break;
+  case Exp:          for(Uint i = begin; i != end; ++i) r[i] = std::exp(a[i]); break;
+  case Exp2:         for(Uint i = begin; i != end; ++i) r[i] = ::exp2(a[i]); break;
+  case Floor:        for(Uint i = begin; i != end; ++i) r[i] = std::floor(a[i]); break;
+  case Hypot:        for(Uint i = begin; i != end; ++i) r[i] = ::hypot(a[i], b[i]); break;
+  case Int:          for(Uint i = begin; i != end; ++i) r[i] = a[i] < 0. ? std::ceil(a[i] - 0.5) : std::floor(a[i] + 0.5); break;
+  case Log:          for(Uint i = begin; i != end; ++i) r[i] = std::log(a[i]); break;
+  case Log2:         for(Uint i = begin; i != end; ++i) r[i] = ::log2(a[i]); break;
+  case Log10:        for(Uint i = begin; i != end; ++i) r[i] = std::log10(a[i]); break;
+  case Max:          for(Uint i = begin; i != end; ++i) r[i] = std::max(a[i], b[i]); break;
+  case Min:          for(Uint i = begin; i != end; ++i) r[i] = std::min(a[i], b[i]); break;
+  case Sec:          for(Uint i = begin; i != end; ++i) r[i] = 1. / std::cos(a[i]); break;
+  case Sin:          for(Uint i = begin; i != end; ++i) r[i] = std::sin(a[i]); break;
+  case Sinh:         for(Uint i = begin; i != end; ++i) r[i] = std::sinh(a[i]); break;
+  case Sqrt:         for(Uint i = begin; i != end; ++i) r[i] = std::sqrt(a[i]); break;
+  case Tan:          for(Uint i = begin; i != end; ++i) r[i] = std::tan(a[i]); break;
+  case Tanh:         for(Uint i = begin; i != end; ++i) r[i] = std::tanh(a[i]); break;
+  case Trunc:        for(Uint i = begin; i != end; ++i) r[i] = ::trunc(a[i]); break;
+  case If:           cf3_assert_desc("If instructions are handled by run", false); break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,161 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_CompiledFunction_hpp
+#define cf3_Math_CompiledFunction_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/Assertions.hpp"
+
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// A set of analytical functions, compiled once into a register program that is
+/// evaluated for batches of points at a time. Each instruction of the program
+/// loops over all points of a batch, so the interpretation overhead is paid once
+/// per batch instead of once per point, and the inner loops can be vectorized.
+///
+/// The syntax and semantics follow the FunctionParser that is used by VectorialFunction:
+/// the operators + - * / % ^ = != < <= > >= & | ! and the real-valued fparser
+/// functions, including the lazy if(condition, then, else).
+///
+/// Evaluation is const and keeps the registers on the stack, so a single instance can be
+/// used from several threads at the same time.
+class Math_API CompiledFunction
+{
+public:
+
+  /// Number of points that are evaluated together
+  static const Uint batch_size = 64;
+
+  /// Number of register values kept on the stack during evaluation. Programs with more than
+  /// max_stack_registers/batch_size registers are evaluated in smaller batches.
+  static const Uint max_stack_registers = 4096;
+
+  /// Empty constructor
+  CompiledFunction();
+
+  /// Compile the given functions in terms of the given variables
+  CompiledFunction(const std::vector<std::string>& functions, const std::vector<std::string>& variables);
+
+  /// Define a named constant, which is used by the functions compiled after this call
+  void add_constant(const std::string& name, const Real value);
+
+  /// Compile the functions
+  /// @throw common::ParsingFailed if a function is not valid
+  /// @throw common::NotSupported for fparser syntax that is not supported by the compiler, such as complex functions
+  void compile(const std::vector<std::string>& functions, const std::vector<std::string>& variables);
+
+  /// @return true if compile was called successfully
+  bool is_compiled() const { return m_is_compiled; }
+
+  /// Number of functions, i.e. the number of results for each point
+  Uint nb_functions() const { return m_outputs.size(); }
+
+  /// Number of variables for each point
+  Uint nb_variables() const { return m_nb_variables; }
+
+  /// Number of instructions in the compiled program, after constant folding
+  Uint nb_instructions() const { return m_program.size(); }
+
+  /// Number of registers needed to evaluate the program
+  Uint nb_registers() const { return m_nb_registers; }
+
+  /// Evaluate the functions for nb_points points.
+  /// @param variables The variables for point i start at variables[i*variables_stride]
+  /// @param results The results for point i are written starting at results[i*results_stride]
+  void evaluate(const Real* variables, const Uint variables_stride, Real* results, const Uint results_stride, const Uint nb_points) const;
+
+  /// Evaluate the functions for a single point
+  /// @param var_values Contiguous storage for the variables, e.g. std::vector<Real> or RealVector
+  /// @param ret_value Storage for the result, indexed using operator[]
+  template <typename var_t, typename ret_t>
+  void evaluate(const var_t& var_values, ret_t& ret_value) const;
+
+private:
+
+  enum OpCode
+  {
+    Add, Sub, Mul, Div, Mod, Pow, Square, Neg, Not,
+    Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, And, Or,
+    Abs, Acos, Acosh, Asin, Asinh, Atan, Atan2, Atanh, Cbrt, Ceil, Cos, Cosh, Cot, Csc,
+    Exp, Exp2, Floor, Hypot, Int, Log, Log2, Log10, Max, Min, Sec, Sin, Sinh, Sqrt, Tan, Tanh, Trunc,
+    /// Lazy conditional. The then-branch is stored after the instruction, up to jump[0], followed by the else-branch up to jump[1]
+    If
+  };
+
+  struct Instruction
+  {
+    OpCode op;
+    Uint result;
+    Uint arguments[3];
+    Uint jump[2];
+  };
+
+  class Compiler;
+  friend class Compiler;
+
+  /// Apply a single (non-If) instruction to the lanes [begin, end)
+  static void execute(const Instruction& instruction, Real* registers, const Uint stride, const Uint begin, const Uint end);
+
+  /// Run the instructions [first, last) on the lanes [begin, end)
+  void run(const Uint first, const Uint last, Real* registers, const Uint stride, const Uint begin, const Uint end) const;
+
+  bool m_is_compiled;
+  Uint m_nb_variables;
+  Uint m_nb_registers;
+  std::vector<Instruction> m_program;
+  /// Register and value for each constant, filled before the program is run
+  std::vector< std::pair<Uint, Real> > m_constants;
+  /// Register holding the result of each function
+  std::vector<Uint> m_outputs;
+  /// Named constants, available to the functions
+  std::map<std::string, Real> m_named_constants;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename var_t, typename ret_t>
+void CompiledFunction::evaluate(const var_t& var_values, ret_t& ret_value) const
+{
+  cf3_assert(m_is_compiled);
+  cf3_assert(static_cast<Uint>(var_values.size()) == m_nb_variables);
+
+  const Uint nb_results = m_outputs.size();
+  Real local_results[16];
+  std::vector<Real> heap_results;
+  Real* results = local_results;
+  if(nb_results > 16)
+  {
+    heap_results.resize(nb_results);
+    results = &heap_results[0];
+  }
+
+  evaluate(m_nb_variables == 0 ? 0 : &var_values[0], m_nb_variables, results, nb_results, 1);
+
+  for(Uint i = 0; i != nb_results; ++i)
+    ret_value[i] = results[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Math_CompiledFunction_hpp
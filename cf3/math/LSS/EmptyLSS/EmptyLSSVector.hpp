@@ -184,6 +184,20 @@ public:
   
   void scale ( const Real alpha ) {}
 
+  void axpby ( const Vector& source, const Real alpha, const Real beta ) {}
+
+  void waxpby ( const Real alpha, const Vector& x, const Real beta, const Vector& y ) {}
+
+  void multiply ( const Vector& a, const Vector& b ) {}
+
+  void divide ( const Vector& a, const Vector& b ) {}
+
+  Real dot ( const Vector& other ) const { return 0.; }
+
+  void dot ( const std::vector<Vector const*>& others, std::vector<Real>& results ) const { results.assign(others.size(), 0.); }
+
+  Real norm2 () const { return 0.; }
+
   void sync() {}
 
   //@} END MISCELLANEOUS
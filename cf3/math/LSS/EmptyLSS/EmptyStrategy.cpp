@@ -42,6 +42,7 @@ void EmptyStrategy::set_solution(const Handle< Vector >& solution)
 
 void EmptyStrategy::solve()
 {
+  publish_telemetry(SolveTelemetry());
 }
 
 } // namespace LSS
@@ -107,6 +107,18 @@ public:
   /// @warning Structural symmetry is not checked, incorrect results will appear if you use this on a non structurally symmetric matrix
   virtual void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs) = 0;
 
+  /// Apply a set of dirichlet boundary conditions, preserving symmetry. Equivalent to calling symmetric_dirichlet
+  /// for each entry, in order, but implementations may process the whole set at once.
+  /// @pre The matrix must be structurally symmetric
+  virtual void symmetric_dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, LSS::Vector& rhs)
+  {
+    cf3_assert(blockrows.size() == ieqs.size());
+    cf3_assert(blockrows.size() == values.size());
+    const Uint nb_bcs = blockrows.size();
+    for(Uint i = 0; i != nb_bcs; ++i)
+      symmetric_dirichlet(blockrows[i], ieqs[i], values[i], rhs);
+  }
+
   /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
   virtual void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from) = 0;
 
@@ -0,0 +1,155 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/assign/list_of.hpp>
+
+#include "common/BinaryDataWriter.hpp"
+#include "common/OptionList.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PropertyList.hpp"
+
+#include "math/LSS/SolutionStrategy.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+SolveTelemetry::SolveTelemetry() :
+  iterations(0),
+  relative_residual(-1.),
+  setup_time(0.),
+  solve_time(0.),
+  preconditioner_rebuilt(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+SolutionStrategy::SolutionStrategy(const std::string& name) :
+  Component(name),
+  m_telemetry_capacity(1000),
+  m_solve_count(0),
+  m_preconditioner_rebuilds(0)
+{
+  options().add("telemetry_writer", m_telemetry_writer)
+    .pretty_name("Telemetry Writer")
+    .description("If set, the telemetry of each solve is appended to the file of this writer, as a single-row table followed by the residuals")
+    .link_to(&m_telemetry_writer);
+
+  options().add("telemetry_capacity", m_telemetry_capacity)
+    .pretty_name("Telemetry Capacity")
+    .description("Number of solves kept in the Telemetry table. The oldest solves are overwritten. Changing this clears the table.")
+    .link_to(&m_telemetry_capacity);
+
+  m_telemetry = create_static_component< common::Table<Real> >("Telemetry");
+  m_telemetry->set_row_size(telemetry_columns().size());
+
+  m_last_solve = create_static_component< common::Table<Real> >("LastSolve");
+  m_last_solve->set_row_size(telemetry_columns().size());
+  m_last_solve->resize(1);
+
+  m_residuals = create_static_component< common::List<Real> >("Residuals");
+
+  properties().add("solve_count", 0u);
+  properties().add("iterations", 0u);
+  properties().add("final_residual", 0.);
+  properties().add("final_relative_residual", 0.);
+  properties().add("residuals", std::vector<Real>());
+  properties().add("setup_time", 0.);
+  properties().add("solve_time", 0.);
+  properties().add("preconditioner_rebuilds", 0u);
+  properties().add("memory", 0.);
+}
+
+SolutionStrategy::~SolutionStrategy()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Handle< common::Table<Real> const > SolutionStrategy::telemetry() const
+{
+  return Handle< common::Table<Real> const >(m_telemetry);
+}
+
+Uint SolutionStrategy::last_telemetry_row() const
+{
+  cf3_assert(m_solve_count != 0);
+  return (m_solve_count - 1) % m_telemetry->size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::vector<std::string>& SolutionStrategy::telemetry_columns()
+{
+  static const std::vector<std::string> columns = boost::assign::list_of
+    ("solve_count")("iterations")("final_residual")("final_relative_residual")("setup_time")("solve_time")("preconditioner_rebuilds")("memory");
+  return columns;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void SolutionStrategy::publish_telemetry(const SolveTelemetry& telemetry)
+{
+  const Uint solve_count = ++m_solve_count;
+  if(telemetry.preconditioner_rebuilt)
+    ++m_preconditioner_rebuilds;
+  const Real final_residual = telemetry.residuals.empty() ? -1. : telemetry.residuals.back();
+  const Real memory = common::OSystem::instance().layer()->memory_usage()/1024./1024.;
+
+  properties()["solve_count"] = solve_count;
+  properties()["iterations"] = telemetry.iterations;
+  properties()["final_residual"] = final_residual;
+  properties()["final_relative_residual"] = telemetry.relative_residual;
+  properties()["residuals"] = telemetry.residuals;
+  properties()["setup_time"] = telemetry.setup_time;
+  properties()["solve_time"] = telemetry.solve_time;
+  properties()["preconditioner_rebuilds"] = m_preconditioner_rebuilds;
+  properties()["memory"] = memory;
+
+  common::Table<Real>::Row row = m_last_solve->array()[0];
+  row[0] = solve_count;
+  row[1] = telemetry.iterations;
+  row[2] = final_residual;
+  row[3] = telemetry.relative_residual;
+  row[4] = telemetry.setup_time;
+  row[5] = telemetry.solve_time;
+  row[6] = m_preconditioner_rebuilds;
+  row[7] = memory;
+
+  // The table is allocated once for its full capacity, and cleared if the capacity changed
+  const Uint capacity = std::max(m_telemetry_capacity, 1u);
+  if(m_telemetry->size() != capacity)
+  {
+    m_telemetry->resize(0);
+    m_telemetry->resize(capacity);
+  }
+  m_telemetry->set_row(last_telemetry_row(), row);
+
+  if(is_not_null(m_telemetry_writer))
+  {
+    const Uint nb_residuals = telemetry.residuals.size();
+    m_residuals->resize(nb_residuals);
+    for(Uint i = 0; i != nb_residuals; ++i)
+      (*m_residuals)[i] = telemetry.residuals[i];
+
+    m_telemetry_writer->append_data(*m_last_solve);
+    m_telemetry_writer->append_data(*m_residuals);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
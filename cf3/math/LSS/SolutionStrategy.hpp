@@ -10,6 +10,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "common/Component.hpp"
+#include "common/List.hpp"
+#include "common/Table.hpp"
 
 #include "math/LSS/LibLSS.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
@@ -25,11 +27,41 @@
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
+namespace common { class BinaryDataWriter; }
 namespace math {
 namespace LSS {
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Statistics about a single solve, as reported by a SolutionStrategy
+struct LSS_API SolveTelemetry
+{
+  SolveTelemetry();
+
+  /// Number of iterations, zero for direct solvers
+  Uint iterations;
+  /// Norms of the true residual b - Ax known to the strategy after the solve, with the final residual last. May be empty.
+  /// This is not a per-iteration history: the Trilinos solver managers only report the relative residual below.
+  std::vector<Real> residuals;
+  /// Final residual relative to the initial one, as reported by the solver (e.g. the achieved tolerance), or -1 if unknown
+  Real relative_residual;
+  /// Wall clock time in seconds spent building the solver and preconditioner
+  Real setup_time;
+  /// Wall clock time in seconds spent in the solve itself
+  Real solve_time;
+  /// True if the preconditioner or factorization was rebuilt for this solve
+  bool preconditioner_rebuilt;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Base class for the linear system solvers. After each solve, the strategy publishes its SolveTelemetry as the properties
+/// solve_count, iterations, final_residual, final_relative_residual, residuals, setup_time, solve_time, preconditioner_rebuilds
+/// and memory (in MB), and as a row in the "Telemetry" table. The final residual is the last of the true residual norms and
+/// the final relative residual is the one reported by the solver; either is -1 if the strategy doesn't know it.
+/// The table is a ring buffer of telemetry_capacity rows: solve n (counting from 1) is stored in row (n-1) % telemetry_capacity,
+/// and rows that were not used yet have solve_count 0. If the telemetry_writer option is set, the row and the residuals
+/// are also appended to the binary file of the writer, which keeps all solves.
 class LSS_API SolutionStrategy : public common::Component
 {
 public:
@@ -38,9 +70,9 @@ public:
   static std::string type_name () { return "SolutionStrategy"; }
 
   /// Default constructor
-  SolutionStrategy(const std::string& name) : Component(name)
-  {
-  }
+  SolutionStrategy(const std::string& name);
+
+  virtual ~SolutionStrategy();
 
   /// Set the system matrix for the linear system to solve
   virtual void set_matrix(const Handle<LSS::Matrix>& matrix) = 0;
@@ -56,6 +88,32 @@ public:
 
   virtual Real compute_residual() = 0;
 
+  /// Ring buffer with one row per solve, with the columns listed in telemetry_columns()
+  Handle< common::Table<Real> const > telemetry() const;
+
+  /// Row of the last solve in the telemetry table. Only valid if at least one solve was done.
+  Uint last_telemetry_row() const;
+
+  /// Number of solves published so far
+  Uint solve_count() const { return m_solve_count; }
+
+  /// Names of the columns of the telemetry table, which are also the names of the corresponding properties
+  static const std::vector<std::string>& telemetry_columns();
+
+protected:
+  /// Publish the telemetry for the solve that just finished. To be called at the end of solve() by the concrete strategies.
+  void publish_telemetry(const SolveTelemetry& telemetry);
+
+private:
+  Handle< common::Table<Real> > m_telemetry;
+  /// Single-row table and residual history for the binary log
+  Handle< common::Table<Real> > m_last_solve;
+  Handle< common::List<Real> > m_residuals;
+  Handle<common::BinaryDataWriter> m_telemetry_writer;
+  Uint m_telemetry_capacity;
+  Uint m_solve_count;
+  Uint m_preconditioner_rebuilds;
+
 }; // end of class SolutionStrategy
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,283 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/StringConversion.hpp"
+
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/StaticCondensation.hpp"
+#include "math/LSS/Vector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < StaticCondensation, common::Component, LibLSS > StaticCondensation_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+StaticCondensation::StaticCondensation(const std::string& name) :
+  common::Component(name),
+  m_neq(0),
+  m_matrix_pending(false),
+  m_rhs_pending(false)
+{
+}
+
+StaticCondensation::~StaticCondensation()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StaticCondensation::set_interior_nodes(const Uint nb_blockrows, const std::vector<Uint>& interior_nodes)
+{
+  m_element_of_node.assign(nb_blockrows, -1);
+  m_elements.clear();
+
+  // Each interior node gets its own storage, nodes interior to the same element are merged on the first add_values
+  m_elements.resize(interior_nodes.size());
+  const Uint nb_interior = interior_nodes.size();
+  for(Uint i = 0; i != nb_interior; ++i)
+  {
+    if(interior_nodes[i] >= nb_blockrows)
+      throw common::BadValue(FromHere(), "Interior node " + common::to_str(interior_nodes[i]) + " is out of range for a system with " + common::to_str(nb_blockrows) + " block rows");
+    m_element_of_node[interior_nodes[i]] = i;
+  }
+
+  m_neq = 0;
+  m_matrix_pending = false;
+  m_rhs_pending = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+bool StaticCondensation::contains_interior_node(const std::vector<Uint>& blockrows) const
+{
+  BOOST_FOREACH(const Uint blockrow, blockrows)
+  {
+    cf3_assert(blockrow < m_element_of_node.size());
+    if(m_element_of_node[blockrow] >= 0)
+      return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+bool StaticCondensation::add_values(const BlockAccumulator& values)
+{
+  const Uint nb_nodes = values.indices.size();
+  int element_idx = -1;
+  for(Uint i = 0; i != nb_nodes && element_idx < 0; ++i)
+  {
+    cf3_assert(values.indices[i] < m_element_of_node.size());
+    element_idx = m_element_of_node[values.indices[i]];
+  }
+
+  if(element_idx < 0)
+    return false;
+
+  const Uint neq = values.mat.rows() / nb_nodes;
+  if(m_neq == 0)
+    m_neq = neq;
+  else if(neq != m_neq)
+    throw common::BadValue(FromHere(), "Block with " + common::to_str(neq) + " equations per node added to " + uri().path() + ", expected " + common::to_str(m_neq));
+
+  Element& element = m_elements[element_idx];
+  if(element.indices.empty())
+  {
+    element.indices = values.indices;
+    element.matrix.setZero(values.mat.rows(), values.mat.cols());
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      const bool is_interior = m_element_of_node[values.indices[i]] >= 0;
+      if(is_interior)
+        m_element_of_node[values.indices[i]] = element_idx;
+      std::vector<Uint>& dofs = is_interior ? element.interior_dofs : element.boundary_dofs;
+      for(Uint eq = 0; eq != neq; ++eq)
+        dofs.push_back(i*neq + eq);
+    }
+  }
+
+  if(values.indices == element.indices)
+  {
+    element.matrix += values.mat;
+  }
+  else
+  {
+    // The block uses a subset or a different ordering of the element nodes
+    std::vector<Uint> positions(nb_nodes);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      const std::vector<Uint>::const_iterator found = std::find(element.indices.begin(), element.indices.end(), values.indices[i]);
+      if(found == element.indices.end())
+        throw common::BadValue(FromHere(), "Block row " + common::to_str(values.indices[i]) + " does not belong to the element of an interior node in " + uri().path());
+      positions[i] = found - element.indices.begin();
+    }
+
+    for(Uint i = 0; i != nb_nodes; ++i)
+      for(Uint ieq = 0; ieq != neq; ++ieq)
+        for(Uint j = 0; j != nb_nodes; ++j)
+          for(Uint jeq = 0; jeq != neq; ++jeq)
+            element.matrix(positions[i]*neq + ieq, positions[j]*neq + jeq) += values.mat(i*neq + ieq, j*neq + jeq);
+  }
+
+  m_matrix_pending = true;
+  m_rhs_pending = true;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StaticCondensation::condense(Matrix& matrix, Vector& rhs)
+{
+  if(!is_pending())
+    return;
+
+  BOOST_FOREACH(Element& element, m_elements)
+  {
+    // Elements that were never condensed only need the RHS elimination after the next matrix assembly
+    if(element.indices.empty() || (!m_matrix_pending && element.interior_inverse.size() == 0))
+      continue;
+
+    const Uint nb_interior = element.interior_dofs.size();
+    const Uint nb_boundary = element.boundary_dofs.size();
+    m_block.resize(element.indices.size(), m_neq);
+    m_block.indices = element.indices;
+
+    if(m_matrix_pending)
+    {
+      RealMatrix a_ii(nb_interior, nb_interior);
+      RealMatrix a_ib(nb_interior, nb_boundary);
+      RealMatrix a_bi(nb_boundary, nb_interior);
+      RealMatrix schur(nb_boundary, nb_boundary);
+      for(Uint i = 0; i != nb_interior; ++i)
+      {
+        for(Uint j = 0; j != nb_interior; ++j)
+          a_ii(i, j) = element.matrix(element.interior_dofs[i], element.interior_dofs[j]);
+        for(Uint j = 0; j != nb_boundary; ++j)
+          a_ib(i, j) = element.matrix(element.interior_dofs[i], element.boundary_dofs[j]);
+      }
+      for(Uint i = 0; i != nb_boundary; ++i)
+      {
+        for(Uint j = 0; j != nb_interior; ++j)
+          a_bi(i, j) = element.matrix(element.boundary_dofs[i], element.interior_dofs[j]);
+        for(Uint j = 0; j != nb_boundary; ++j)
+          schur(i, j) = element.matrix(element.boundary_dofs[i], element.boundary_dofs[j]);
+      }
+
+      element.interior_inverse = a_ii.inverse();
+      element.recovery_matrix = element.interior_inverse * a_ib;
+      element.rhs_operator = a_bi * element.interior_inverse;
+      schur -= a_bi * element.recovery_matrix;
+
+      // The interior rows become identity rows, decoupled from the boundary
+      m_block.mat.setZero();
+      for(Uint i = 0; i != nb_boundary; ++i)
+        for(Uint j = 0; j != nb_boundary; ++j)
+          m_block.mat(element.boundary_dofs[i], element.boundary_dofs[j]) = schur(i, j);
+      BOOST_FOREACH(const Uint dof, element.interior_dofs)
+      {
+        m_block.mat(dof, dof) = 1.;
+      }
+      matrix.add_values(m_block);
+    }
+
+    // Move the interior RHS to the boundary, leaving zero in the interior rows
+    rhs.get_rhs_values(m_block);
+    RealVector r_i(nb_interior);
+    for(Uint i = 0; i != nb_interior; ++i)
+      r_i[i] = m_block.rhs[element.interior_dofs[i]];
+
+    element.recovery_rhs = element.interior_inverse * r_i;
+    const RealVector boundary_update = element.rhs_operator * r_i;
+
+    for(Uint i = 0; i != nb_boundary; ++i)
+      m_block.rhs[element.boundary_dofs[i]] = -boundary_update[i];
+    for(Uint i = 0; i != nb_interior; ++i)
+      m_block.rhs[element.interior_dofs[i]] = -r_i[i];
+    rhs.add_rhs_values(m_block);
+  }
+
+  m_matrix_pending = false;
+  m_rhs_pending = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StaticCondensation::recover(Vector& solution)
+{
+  // Boundary nodes may be ghosts
+  solution.sync();
+
+  BOOST_FOREACH(const Element& element, m_elements)
+  {
+    if(element.indices.empty() || element.recovery_rhs.size() == 0)
+      continue;
+
+    const Uint nb_interior = element.interior_dofs.size();
+    const Uint nb_boundary = element.boundary_dofs.size();
+    m_block.resize(element.indices.size(), m_neq);
+    m_block.indices = element.indices;
+    solution.get_sol_values(m_block);
+
+    RealVector x_b(nb_boundary);
+    for(Uint i = 0; i != nb_boundary; ++i)
+      x_b[i] = m_block.sol[element.boundary_dofs[i]];
+
+    const RealVector x_i = element.recovery_rhs - element.recovery_matrix * x_b;
+    for(Uint i = 0; i != nb_interior; ++i)
+      m_block.sol[element.interior_dofs[i]] = x_i[i];
+
+    solution.set_sol_values(m_block);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StaticCondensation::reset_matrix()
+{
+  BOOST_FOREACH(Element& element, m_elements)
+  {
+    element.matrix.setZero();
+  }
+  m_matrix_pending = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StaticCondensation::reset_rhs()
+{
+  m_rhs_pending = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint StaticCondensation::nb_elements() const
+{
+  Uint result = 0;
+  BOOST_FOREACH(const Element& element, m_elements)
+  {
+    if(!element.indices.empty())
+      ++result;
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
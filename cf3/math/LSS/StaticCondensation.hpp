@@ -0,0 +1,122 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_StaticCondensation_hpp
+#define cf3_Math_LSS_StaticCondensation_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file StaticCondensation.hpp Element-by-element elimination of interior nodes
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class Matrix;
+class Vector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Eliminates nodes that are interior to a single element (i.e. the bubble node of LagrangeP2B elements) from a linear system.
+/// Element matrices that contain an interior node are stored instead of being added to the matrix. Before solving, the Schur
+/// complement A_bb - A_bi*inv(A_ii)*A_ib of each element is added to the matrix, the interior rows are replaced by identity rows and
+/// the interior RHS entries are moved to the boundary nodes. After the solve, recover computes the interior values from the boundary values.
+/// The interior block rows remain part of the system, but they are decoupled from the rest.
+class LSS_API StaticCondensation : public common::Component
+{
+public:
+  /// name of the type
+  static std::string type_name () { return "StaticCondensation"; }
+
+  StaticCondensation(const std::string& name);
+  ~StaticCondensation();
+
+  /// Set the block rows to eliminate. Each of them must be used by a single element only. This clears all stored element matrices.
+  /// @param nb_blockrows Total number of block rows in the system
+  void set_interior_nodes(const Uint nb_blockrows, const std::vector<Uint>& interior_nodes);
+
+  /// True if one of the given block rows is eliminated
+  bool contains_interior_node(const std::vector<Uint>& blockrows) const;
+
+  /// Add the values to the stored element matrix, if the block contains an interior node.
+  /// @return false if there is no interior node in the block, in which case it must be added to the system matrix as usual
+  bool add_values(const BlockAccumulator& values);
+
+  /// True if the matrix or RHS changed since the last condense
+  bool is_pending() const { return m_matrix_pending || m_rhs_pending; }
+
+  /// Add the Schur complements of the element matrices that were added since the last reset_matrix to the matrix,
+  /// and move the interior entries of the RHS to the boundary nodes
+  void condense(Matrix& matrix, Vector& rhs);
+
+  /// Compute the interior values of the solution from the boundary values
+  void recover(Vector& solution);
+
+  /// Zero the stored element matrices, to be called when the system matrix is reset
+  void reset_matrix();
+
+  /// Mark the RHS for elimination at the next condense, to be called when the RHS is reset
+  void reset_rhs();
+
+  /// Number of elements for which a matrix is stored
+  Uint nb_elements() const;
+
+private:
+  /// Data stored for each element
+  struct Element
+  {
+    /// Block rows of the element nodes
+    std::vector<Uint> indices;
+    /// Equation numbers (position in the element matrix) of the interior and boundary unknowns
+    std::vector<Uint> interior_dofs;
+    std::vector<Uint> boundary_dofs;
+    /// Accumulated element matrix
+    RealMatrix matrix;
+    /// A_bi*inv(A_ii), to eliminate the interior RHS
+    RealMatrix rhs_operator;
+    /// inv(A_ii), and inv(A_ii)*A_ib for the recovery
+    RealMatrix interior_inverse;
+    RealMatrix recovery_matrix;
+    /// inv(A_ii)*r_i, for the recovery
+    RealVector recovery_rhs;
+  };
+
+  /// Element storage
+  std::vector<Element> m_elements;
+
+  /// Index in m_elements for each block row, or -1 if it is not an interior node
+  std::vector<int> m_element_of_node;
+
+  /// Number of equations per node, taken from the first element matrix
+  Uint m_neq;
+
+  bool m_matrix_pending;
+  bool m_rhs_pending;
+
+  /// Work storage
+  BlockAccumulator m_block;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_StaticCondensation_hpp
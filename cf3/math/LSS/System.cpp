@@ -25,6 +25,7 @@
 #include "math/LSS/Matrix.hpp"
 #include "math/LSS/Vector.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/StaticCondensation.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -190,11 +191,14 @@ void LSS::System::destroy()
     remove_component("Solution");
   if(is_not_null(get_child("RHS")))
     remove_component("RHS");
+  if(is_not_null(get_child("StaticCondensation")))
+    remove_component("StaticCondensation");
 
   m_solution_strategy.reset();
   m_mat.reset();
   m_sol.reset();
   m_rhs.reset();
+  m_static_condensation.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -202,7 +206,12 @@ void LSS::System::destroy()
 void LSS::System::solve()
 {
   cf3_assert(is_created());
+  if(!m_dirichlet_blockrows.empty())
+    throw common::SetupError(FromHere(), "Queued dirichlet conditions must be applied with apply_queued_dirichlet before solving " + uri().path());
+  condense();
   m_solution_strategy->solve();
+  if(is_not_null(m_static_condensation))
+    m_static_condensation->recover(*m_sol);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -210,6 +219,8 @@ void LSS::System::solve()
 void LSS::System::set_values(const LSS::BlockAccumulator& values)
 {
   cf3_assert(is_created());
+  if(is_not_null(m_static_condensation) && m_static_condensation->contains_interior_node(values.indices))
+    throw common::NotSupported(FromHere(), "Values for condensed interior nodes can only be added to " + uri().path());
   m_mat->set_values(values);
   m_sol->set_sol_values(values);
   m_rhs->set_rhs_values(values);
@@ -220,7 +231,8 @@ void LSS::System::set_values(const LSS::BlockAccumulator& values)
 void LSS::System::add_values(const LSS::BlockAccumulator& values)
 {
   cf3_assert(is_created());
-  m_mat->add_values(values);
+  if(is_null(m_static_condensation) || !m_static_condensation->add_values(values))
+    m_mat->add_values(values);
   m_sol->add_sol_values(values);
   m_rhs->add_rhs_values(values);
 }
@@ -240,6 +252,7 @@ void LSS::System::get_values(LSS::BlockAccumulator& values)
 void LSS::System::dirichlet(const Uint iblockrow, const Uint ieq, const Real value, const bool preserve_symmetry)
 {
   cf3_assert(is_created());
+  condense();
 
   if (preserve_symmetry)
   {
@@ -256,9 +269,59 @@ void LSS::System::dirichlet(const Uint iblockrow, const Uint ieq, const Real val
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+void LSS::System::dirichlet(const std::vector<Uint>& iblockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, const bool preserve_symmetry)
+{
+  cf3_assert(is_created());
+  cf3_assert(iblockrows.size() == ieqs.size());
+  cf3_assert(iblockrows.size() == values.size());
+  condense();
+
+  const Uint nb_bcs = iblockrows.size();
+  if (preserve_symmetry)
+  {
+    m_mat->symmetric_dirichlet(iblockrows, ieqs, values, *m_rhs);
+  }
+  else
+  {
+    for (Uint i=0; i<nb_bcs; ++i)
+    {
+      m_mat->set_row(iblockrows[i],ieqs[i],1.,0.);
+      m_rhs->set_value(iblockrows[i],ieqs[i],values[i]);
+    }
+  }
+
+  for (Uint i=0; i<nb_bcs; ++i)
+    m_sol->set_value(iblockrows[i],ieqs[i],values[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::queue_dirichlet(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  m_dirichlet_blockrows.push_back(iblockrow);
+  m_dirichlet_eqs.push_back(ieq);
+  m_dirichlet_values.push_back(value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::apply_queued_dirichlet(const bool preserve_symmetry)
+{
+  if (m_dirichlet_blockrows.empty())
+    return;
+
+  dirichlet(m_dirichlet_blockrows, m_dirichlet_eqs, m_dirichlet_values, preserve_symmetry);
+  m_dirichlet_blockrows.clear();
+  m_dirichlet_eqs.clear();
+  m_dirichlet_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void LSS::System::periodicity (const Uint iblockrow_to, const Uint iblockrow_from)
 {
   cf3_assert(is_created());
+  condense();
   LSS::BlockAccumulator ba;
   const int neq=m_mat->neq();
   ba.resize(2,neq);
@@ -313,6 +376,37 @@ void LSS::System::reset(Real reset_to)
   m_mat->reset(reset_to);
   m_sol->reset(reset_to);
   m_rhs->reset(reset_to);
+  if(is_not_null(m_static_condensation))
+  {
+    m_static_condensation->reset_matrix();
+    m_static_condensation->reset_rhs();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::set_static_condensation(const std::vector<Uint>& interior_blockrows)
+{
+  cf3_assert(is_created());
+  if(interior_blockrows.empty())
+  {
+    if(is_not_null(m_static_condensation))
+      remove_component(*m_static_condensation);
+    m_static_condensation.reset();
+    return;
+  }
+
+  if(is_null(m_static_condensation))
+    m_static_condensation = create_component<StaticCondensation>("StaticCondensation");
+  m_static_condensation->set_interior_nodes(m_mat->blockrow_size(), interior_blockrows);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::condense()
+{
+  if(is_not_null(m_static_condensation) && m_static_condensation->is_pending())
+    m_static_condensation->condense(*m_mat, *m_rhs);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
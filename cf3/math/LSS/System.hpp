@@ -54,6 +54,8 @@ namespace math {
 class VariablesDescriptor;
 namespace LSS {
 
+class StaticCondensation;
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 class LSS_API System : public common::Component {
@@ -90,6 +92,7 @@ public:
 
   /// solving the system
   /// @todo action for it
+  /// @throw common::SetupError if there are dirichlet conditions that were queued but not applied
   void solve();
 
   //@} END SOLVE THE SYSTEM
@@ -110,6 +113,17 @@ public:
   /// When preserve_symmetry is true than blockrow*numequations+eq column is is zeroed by moving it to the right hand side (however this usually results in performance penalties).
   void dirichlet(const Uint iblockrow, const Uint ieq, const Real value, const bool preserve_symmetry=false);
 
+  /// Apply dirichlet-type boundary conditions to a set of degrees of freedom in one call.
+  /// Entry i sets equation ieqs[i] of block row iblockrows[i] to values[i].
+  /// The result is the same as calling dirichlet for each entry, but the matrix, rhs and solution are updated in one sweep.
+  void dirichlet(const std::vector<Uint>& iblockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, const bool preserve_symmetry=false);
+
+  /// Queue a dirichlet-type boundary condition, to be applied together with the other queued conditions by apply_queued_dirichlet
+  void queue_dirichlet(const Uint iblockrow, const Uint ieq, const Real value);
+
+  /// Apply all the dirichlet conditions queued since the last call, using the batched dirichlet function
+  void apply_queued_dirichlet(const bool preserve_symmetry=false);
+
   /// Applying periodicity by adding one line to another and dirichlet-style fixing it to
   /// Note that prerequisite for this is to work that the matrix sparsity should be compatible (same nonzero pattern for the two block rows).
   /// Note that only structural symmetry can be preserved (again, if sparsity input was symmetric).
@@ -127,6 +141,11 @@ public:
   /// Reset Matrix
   void reset(Real reset_to=0.);
 
+  /// Eliminate the given block rows by static condensation. Each of them must be interior to a single element.
+  /// Element matrices containing these rows are then stored and condensed before the first dirichlet condition or solve,
+  /// and the interior values of the solution are recovered after each solve. An empty list disables the condensation.
+  void set_static_condensation(const std::vector<Uint>& interior_blockrows);
+
   //@} END EFFICCIENT ACCESS
 
   /// @name MISCELLANEOUS
@@ -153,6 +172,9 @@ public:
   /// Accessor to the solution strategy
   Handle<LSS::SolutionStrategy> solution_strategy() { return m_solution_strategy; }
 
+  /// Accessor to the static condensation, null if it is not used
+  Handle<LSS::StaticCondensation> static_condensation() { return m_static_condensation; }
+
   /// Accessor to the state of create
   const bool is_created();
 
@@ -185,6 +207,17 @@ private:
   /// Strategy for the solution
   Handle<LSS::SolutionStrategy> m_solution_strategy;
 
+  /// Elimination of element-interior nodes, if any
+  Handle<LSS::StaticCondensation> m_static_condensation;
+
+  /// Add the condensed element matrices to the system, if there are any pending
+  void condense();
+
+  /// Dirichlet conditions queued by queue_dirichlet
+  std::vector<Uint> m_dirichlet_blockrows;
+  std::vector<Uint> m_dirichlet_eqs;
+  std::vector<Real> m_dirichlet_values;
+
 }; // end of class System
 
 ////////////////////////////////////////////////////////////////////////////////////////////
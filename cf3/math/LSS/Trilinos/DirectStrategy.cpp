@@ -24,6 +24,7 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/Timer.hpp"
 
 #include "ParameterList.hpp"
 #include "TrilinosVector.hpp"
@@ -86,14 +87,24 @@ struct DirectStrategy::Implementation
     return 0;
   }
 
-  void solve()
+  SolveTelemetry solve()
   {
+    SolveTelemetry telemetry;
+    common::Timer timer;
+
     if(is_null(m_solver.get()))
     {
       setup_solver();
+      telemetry.preconditioner_rebuilt = true;
     }
 
+    telemetry.setup_time = timer.elapsed();
+    timer.restart();
+
     m_solver->Solve();
+
+    telemetry.solve_time = timer.elapsed();
+    return telemetry;
   }
 
   Real compute_residual()
@@ -164,7 +175,7 @@ void DirectStrategy::set_matrix(const Handle< Matrix >& matrix)
 
 void DirectStrategy::solve()
 {
-  m_implementation->solve();
+  publish_telemetry(m_implementation->solve());
 }
 
 void DirectStrategy::on_parameters_changed_event(common::SignalArgs& args)
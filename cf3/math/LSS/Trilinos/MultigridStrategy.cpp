@@ -0,0 +1,997 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
+
+#include "Amesos.h"
+#include "Amesos_BaseSolver.h"
+
+#include "BelosLinearProblem.hpp"
+#include "BelosEpetraAdapter.hpp"
+#include "BelosBlockCGSolMgr.hpp"
+#include "BelosBlockGmresSolMgr.hpp"
+
+#include "Epetra_CrsMatrix.h"
+#include "Epetra_Import.h"
+#include "Epetra_LinearProblem.h"
+#include "Epetra_Map.h"
+#include "Epetra_Operator.h"
+#include "Epetra_Vector.h"
+
+#include "EpetraExt_MatrixMatrix.h"
+
+#include "Teuchos_ConfigDefs.hpp"
+#include "Teuchos_RCP.hpp"
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/EventHandler.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/Signal.hpp"
+#include "common/Timer.hpp"
+
+#include "ParameterList.hpp"
+#include "TrilinosVector.hpp"
+#include "TrilinosCrsMatrix.hpp"
+#include "MultigridStrategy.hpp"
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+common::ComponentBuilder<MultigridStrategy, SolutionStrategy, LibLSS> MultigridStrategy_builder;
+
+namespace detail
+{
+
+/// Settings for the multigrid hierarchy
+struct MultigridSettings
+{
+  Uint max_levels;
+  Uint coarse_size;
+  Real aggregation_threshold;
+  Real prolongator_damping;
+  std::string smoother;
+  Uint smoother_sweeps;
+  Real jacobi_damping;
+  std::string coarse_solver;
+  bool single_precision;
+};
+
+/// Copy of the local part of an Epetra_CrsMatrix, with the values stored in single precision. The vectors stay in double precision,
+/// so only the matrix storage and bandwidth is halved and the products are accumulated in double precision.
+struct SinglePrecisionCrs
+{
+  SinglePrecisionCrs()
+  {
+  }
+
+  explicit SinglePrecisionCrs(const Epetra_CrsMatrix& matrix)
+  {
+    const int nb_rows = matrix.NumMyRows();
+    row_offsets.reserve(nb_rows+1);
+    columns.reserve(matrix.NumMyNonzeros());
+    values.reserve(matrix.NumMyNonzeros());
+    row_offsets.push_back(0);
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      int nb_entries;
+      double* row_values;
+      int* row_columns;
+      TRILINOS_THROW(matrix.ExtractMyRowView(row, nb_entries, row_values, row_columns));
+      for(int i = 0; i != nb_entries; ++i)
+      {
+        columns.push_back(row_columns[i]);
+        values.push_back(static_cast<float>(row_values[i]));
+      }
+      row_offsets.push_back(columns.size());
+    }
+
+    if(matrix.Importer() != 0)
+      importer = Teuchos::rcp(new Epetra_Import(*matrix.Importer()));
+  }
+
+  /// Copy x to x_column, which also holds the ghost entries
+  void import(const Epetra_Vector& x, Epetra_Vector& x_column) const
+  {
+    if(importer.is_null())
+      TRILINOS_THROW(x_column.Update(1., x, 0.))
+    else
+      TRILINOS_THROW(x_column.Import(x, *importer, Insert))
+  }
+
+  /// y = A*x, with x given on the column map
+  void multiply(const Epetra_Vector& x_column, Epetra_Vector& y) const
+  {
+    const int nb_rows = row_offsets.size() - 1;
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      Real result = 0.;
+      for(int j = row_offsets[row]; j != row_offsets[row+1]; ++j)
+        result += values[j] * x_column[columns[j]];
+      y[row] = result;
+    }
+  }
+
+  /// y_column = A^T*x, with y_column on the column map. The ghost contributions still need to be exported to their owners.
+  void multiply_transpose(const Epetra_Vector& x, Epetra_Vector& y_column) const
+  {
+    TRILINOS_THROW(y_column.PutScalar(0.));
+    const int nb_rows = row_offsets.size() - 1;
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      const Real x_row = x[row];
+      for(int j = row_offsets[row]; j != row_offsets[row+1]; ++j)
+        y_column[columns[j]] += values[j] * x_row;
+    }
+  }
+
+  std::vector<int> row_offsets;
+  /// Local column indices, as in the original matrix
+  std::vector<int> columns;
+  std::vector<float> values;
+  /// Importer from the domain map to the column map, null if they are the same
+  Teuchos::RCP<Epetra_Import> importer;
+};
+
+/// Aggregation multigrid V-cycle, applied through ApplyInverse so it can be used as preconditioner
+class MultigridPreconditioner : public Epetra_Operator
+{
+public:
+  MultigridPreconditioner(TrilinosCrsMatrix& matrix, const MultigridSettings& settings) :
+    m_settings(settings)
+  {
+    if(m_settings.smoother != "Jacobi" && m_settings.smoother != "GaussSeidel")
+      throw common::BadValue(FromHere(), "Unknown multigrid smoother " + m_settings.smoother + ", expected Jacobi or GaussSeidel");
+
+    if(m_settings.max_levels == 0)
+      throw common::BadValue(FromHere(), "The multigrid hierarchy needs at least one level");
+
+    // Number the owned nodes of the fine level, periodic nodes share their matrix rows
+    const Teuchos::RCP<Epetra_CrsMatrix> fine_matrix = matrix.epetra_matrix();
+    const int nb_rows = fine_matrix->NumMyRows();
+    const Uint neq = matrix.neq();
+    const Uint nb_local_nodes = matrix.blockcol_size();
+    std::vector<int> row_node(nb_rows, -1);
+    std::vector<int> row_eq(nb_rows, -1);
+    int nb_nodes = 0;
+    for(Uint inode = 0; inode != nb_local_nodes; ++inode)
+    {
+      const int first_row = matrix.matrix_index(inode, 0);
+      if(first_row >= nb_rows || row_node[first_row] >= 0)
+        continue;
+      for(Uint ieq = 0; ieq != neq; ++ieq)
+      {
+        const int row = matrix.matrix_index(inode, ieq);
+        row_node[row] = nb_nodes;
+        row_eq[row] = ieq;
+      }
+      ++nb_nodes;
+    }
+
+    add_level(fine_matrix, row_node, row_eq, nb_nodes);
+
+    while(m_levels.size() < m_settings.max_levels && static_cast<Uint>(m_levels.back().matrix->NumGlobalRows()) > m_settings.coarse_size)
+    {
+      Level& fine = m_levels.back();
+      std::vector<int> aggregate_of_node;
+      const int nb_aggregates = aggregate(fine, aggregate_of_node);
+
+      Epetra_Map coarse_map(-1, nb_aggregates*static_cast<int>(neq), 0, fine.matrix->Comm());
+      if(coarse_map.NumGlobalElements() == 0 || coarse_map.NumGlobalElements() >= fine.matrix->NumGlobalRows())
+        break;
+
+      fine.prolongator = build_prolongator(fine, aggregate_of_node, neq, coarse_map);
+
+      // Galerkin coarse operator P^T*A*P
+      Epetra_CrsMatrix ap(Copy, fine.matrix->RowMap(), 0);
+      TRILINOS_THROW(EpetraExt::MatrixMatrix::Multiply(*fine.matrix, false, *fine.prolongator, false, ap));
+      Teuchos::RCP<Epetra_CrsMatrix> coarse_matrix = Teuchos::rcp(new Epetra_CrsMatrix(Copy, coarse_map, 0));
+      TRILINOS_THROW(EpetraExt::MatrixMatrix::Multiply(*fine.prolongator, true, ap, false, *coarse_matrix));
+
+      // Coarse rows are numbered by aggregate, then by equation
+      const int nb_coarse_rows = coarse_matrix->NumMyRows();
+      std::vector<int> coarse_row_node(nb_coarse_rows);
+      std::vector<int> coarse_row_eq(nb_coarse_rows);
+      for(int row = 0; row != nb_coarse_rows; ++row)
+      {
+        coarse_row_node[row] = row / static_cast<int>(neq);
+        coarse_row_eq[row] = row % static_cast<int>(neq);
+      }
+
+      add_level(coarse_matrix, coarse_row_node, coarse_row_eq, nb_aggregates);
+    }
+
+    if(m_settings.single_precision)
+    {
+      // The cycle only uses the single precision copies, except for the direct solve on the coarsest level.
+      // The fine matrix is owned by the system, so keeping a reference costs nothing.
+      const Uint nb_levels = m_levels.size();
+      for(Uint i = 0; i != nb_levels; ++i)
+      {
+        Level& level = m_levels[i];
+        level.matrix_single = SinglePrecisionCrs(*level.matrix);
+        if(i+1 != nb_levels)
+        {
+          level.prolongator_single = SinglePrecisionCrs(*level.prolongator);
+          level.prolongator_column = Teuchos::rcp(new Epetra_Vector(level.prolongator->ColMap()));
+          level.prolongator.reset();
+        }
+        const bool keep_matrix = i == 0 || (i+1 == nb_levels && !m_settings.coarse_solver.empty() && nb_levels > 1);
+        if(!keep_matrix)
+          level.matrix.reset();
+      }
+    }
+
+    // Direct solve on the coarsest level, unless the hierarchy has only one level
+    if(m_levels.size() > 1 && !m_settings.coarse_solver.empty())
+    {
+      Amesos factory;
+      if(!factory.Query(m_settings.coarse_solver))
+        throw common::SetupError(FromHere(), "Coarse solver " + m_settings.coarse_solver + " is not available.");
+
+      Level& coarsest = m_levels.back();
+      m_coarse_problem.SetOperator(coarsest.matrix.get());
+      m_coarse_problem.SetLHS(coarsest.x.get());
+      m_coarse_problem.SetRHS(coarsest.b.get());
+      m_coarse_solver.reset(factory.Create(m_settings.coarse_solver, m_coarse_problem));
+      TRILINOS_THROW(m_coarse_solver->SymbolicFactorization());
+      TRILINOS_THROW(m_coarse_solver->NumericFactorization());
+    }
+  }
+
+  Uint nb_levels() const
+  {
+    return m_levels.size();
+  }
+
+  Uint level_size(const Uint level) const
+  {
+    cf3_assert(level < m_levels.size());
+    return m_levels[level].global_rows;
+  }
+
+  int SetUseTranspose(bool UseTranspose)
+  {
+    return UseTranspose ? -1 : 0;
+  }
+
+  int Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+  {
+    return m_levels.front().matrix->Apply(X, Y);
+  }
+
+  int ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+  {
+    if(X.NumVectors() != Y.NumVectors())
+      return -1;
+
+    const Level& fine = m_levels.front();
+    for(int i = 0; i != X.NumVectors(); ++i)
+    {
+      // X and Y may be the same vector
+      fine.b->Update(1., *X(i), 0.);
+      cycle(0);
+      Y(i)->Update(1., *fine.x, 0.);
+    }
+
+    return 0;
+  }
+
+  double NormInf() const
+  {
+    return 0.;
+  }
+
+  const char* Label() const
+  {
+    return "cf3 aggregation multigrid";
+  }
+
+  bool UseTranspose() const
+  {
+    return false;
+  }
+
+  bool HasNormInf() const
+  {
+    return false;
+  }
+
+  const Epetra_Comm& Comm() const
+  {
+    return m_levels.front().matrix->Comm();
+  }
+
+  const Epetra_Map& OperatorDomainMap() const
+  {
+    return m_levels.front().matrix->OperatorDomainMap();
+  }
+
+  const Epetra_Map& OperatorRangeMap() const
+  {
+    return m_levels.front().matrix->OperatorRangeMap();
+  }
+
+private:
+  /// Data for one level of the hierarchy
+  struct Level
+  {
+    Teuchos::RCP<Epetra_CrsMatrix> matrix;
+    /// Interpolation from the next coarser level, null on the coarsest level
+    Teuchos::RCP<Epetra_CrsMatrix> prolongator;
+    /// Node and equation for each local row
+    std::vector<int> row_node;
+    std::vector<int> row_eq;
+    int nb_nodes;
+    /// Local column index of the diagonal entry of each row, or -1 if there is none
+    std::vector<int> diagonal_column;
+    Teuchos::RCP<Epetra_Vector> diagonal;
+    Teuchos::RCP<Epetra_Vector> inverse_diagonal;
+    /// Solution, RHS and residual work vectors
+    Teuchos::RCP<Epetra_Vector> x;
+    Teuchos::RCP<Epetra_Vector> b;
+    Teuchos::RCP<Epetra_Vector> r;
+    /// Solution including the ghost entries, for Gauss-Seidel
+    Teuchos::RCP<Epetra_Vector> x_column;
+    int global_rows;
+    /// Single precision storage, used instead of matrix and prolongator if single_precision is set
+    SinglePrecisionCrs matrix_single;
+    SinglePrecisionCrs prolongator_single;
+    /// Work vector on the column map of the prolongator
+    Teuchos::RCP<Epetra_Vector> prolongator_column;
+  };
+
+  void add_level(const Teuchos::RCP<Epetra_CrsMatrix>& matrix, const std::vector<int>& row_node, const std::vector<int>& row_eq, const int nb_nodes)
+  {
+    m_levels.push_back(Level());
+    Level& level = m_levels.back();
+    level.matrix = matrix;
+    level.row_node = row_node;
+    level.row_eq = row_eq;
+    level.nb_nodes = nb_nodes;
+    level.global_rows = matrix->NumGlobalRows();
+
+    const Epetra_Map& row_map = matrix->RowMap();
+    level.diagonal = Teuchos::rcp(new Epetra_Vector(row_map));
+    level.inverse_diagonal = Teuchos::rcp(new Epetra_Vector(row_map));
+    level.x = Teuchos::rcp(new Epetra_Vector(row_map));
+    level.b = Teuchos::rcp(new Epetra_Vector(row_map));
+    level.r = Teuchos::rcp(new Epetra_Vector(row_map));
+    level.x_column = Teuchos::rcp(new Epetra_Vector(matrix->ColMap()));
+
+    TRILINOS_THROW(matrix->ExtractDiagonalCopy(*level.diagonal));
+    const int nb_rows = matrix->NumMyRows();
+    level.diagonal_column.resize(nb_rows);
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      const Real diag = (*level.diagonal)[row];
+      (*level.inverse_diagonal)[row] = diag == 0. ? 0. : 1. / diag;
+      level.diagonal_column[row] = matrix->ColMap().LID(row_map.GID(row));
+    }
+  }
+
+  /// Uncoupled aggregation of the owned nodes, based on the strong connections in the matrix graph
+  /// @return the number of aggregates
+  int aggregate(const Level& level, std::vector<int>& aggregate_of_node) const
+  {
+    const Epetra_CrsMatrix& matrix = *level.matrix;
+    const Epetra_Vector& diagonal = *level.diagonal;
+    const int nb_rows = matrix.NumMyRows();
+    const Real threshold = m_settings.aggregation_threshold;
+
+    std::vector< std::vector<int> > neighbours(level.nb_nodes);
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      const int node = level.row_node[row];
+      int nb_entries;
+      double* values;
+      int* columns;
+      TRILINOS_THROW(matrix.ExtractMyRowView(row, nb_entries, values, columns));
+      for(int i = 0; i != nb_entries; ++i)
+      {
+        // Connections to ghost nodes are ignored, so aggregates never cross process boundaries
+        const int col_row = matrix.RowMap().LID(matrix.ColMap().GID(columns[i]));
+        if(col_row < 0)
+          continue;
+        const int other_node = level.row_node[col_row];
+        if(other_node == node)
+          continue;
+        if(std::abs(values[i]) > threshold * std::sqrt(std::abs(diagonal[row] * diagonal[col_row])))
+          neighbours[node].push_back(other_node);
+      }
+    }
+
+    // Nodes without strong connections, such as Dirichlet nodes, are left out of the coarse levels
+    std::vector<bool> is_isolated(level.nb_nodes);
+    for(int node = 0; node != level.nb_nodes; ++node)
+    {
+      std::sort(neighbours[node].begin(), neighbours[node].end());
+      neighbours[node].erase(std::unique(neighbours[node].begin(), neighbours[node].end()), neighbours[node].end());
+      is_isolated[node] = neighbours[node].empty();
+    }
+    for(int node = 0; node != level.nb_nodes; ++node)
+    {
+      std::vector<int>& node_neighbours = neighbours[node];
+      std::vector<int> connected;
+      connected.reserve(node_neighbours.size());
+      for(std::vector<int>::const_iterator it = node_neighbours.begin(); it != node_neighbours.end(); ++it)
+      {
+        if(!is_isolated[*it])
+          connected.push_back(*it);
+      }
+      node_neighbours.swap(connected);
+    }
+
+    aggregate_of_node.assign(level.nb_nodes, -1);
+    int nb_aggregates = 0;
+
+    // Phase 1: a node and its neighbours form an aggregate if none of them is aggregated yet
+    for(int node = 0; node != level.nb_nodes; ++node)
+    {
+      if(is_isolated[node] || aggregate_of_node[node] >= 0)
+        continue;
+      bool free_neighbourhood = true;
+      for(std::vector<int>::const_iterator it = neighbours[node].begin(); it != neighbours[node].end() && free_neighbourhood; ++it)
+        free_neighbourhood = aggregate_of_node[*it] < 0;
+      if(!free_neighbourhood)
+        continue;
+      aggregate_of_node[node] = nb_aggregates;
+      for(std::vector<int>::const_iterator it = neighbours[node].begin(); it != neighbours[node].end(); ++it)
+        aggregate_of_node[*it] = nb_aggregates;
+      ++nb_aggregates;
+    }
+
+    // Phase 2: remaining nodes join the aggregate of a neighbour from phase 1
+    const std::vector<int> phase_one_aggregates = aggregate_of_node;
+    for(int node = 0; node != level.nb_nodes; ++node)
+    {
+      if(is_isolated[node] || aggregate_of_node[node] >= 0)
+        continue;
+      for(std::vector<int>::const_iterator it = neighbours[node].begin(); it != neighbours[node].end(); ++it)
+      {
+        if(phase_one_aggregates[*it] >= 0)
+        {
+          aggregate_of_node[node] = phase_one_aggregates[*it];
+          break;
+        }
+      }
+    }
+
+    // Phase 3: whatever is left forms new aggregates with its free neighbours
+    for(int node = 0; node != level.nb_nodes; ++node)
+    {
+      if(is_isolated[node] || aggregate_of_node[node] >= 0)
+        continue;
+      aggregate_of_node[node] = nb_aggregates;
+      for(std::vector<int>::const_iterator it = neighbours[node].begin(); it != neighbours[node].end(); ++it)
+      {
+        if(aggregate_of_node[*it] < 0)
+          aggregate_of_node[*it] = nb_aggregates;
+      }
+      ++nb_aggregates;
+    }
+
+    return nb_aggregates;
+  }
+
+  /// Piecewise constant interpolation from the aggregates, smoothed with a damped Jacobi step if prolongator_damping is not zero
+  Teuchos::RCP<Epetra_CrsMatrix> build_prolongator(const Level& level, const std::vector<int>& aggregate_of_node, const Uint neq, const Epetra_Map& coarse_map) const
+  {
+    const Epetra_CrsMatrix& matrix = *level.matrix;
+    const int nb_rows = matrix.NumMyRows();
+    Teuchos::RCP<Epetra_CrsMatrix> tentative = Teuchos::rcp(new Epetra_CrsMatrix(Copy, matrix.RowMap(), 1, true));
+    const double one = 1.;
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      const int aggregate = aggregate_of_node[level.row_node[row]];
+      if(aggregate < 0)
+        continue;
+      int row_gid = matrix.RowMap().GID(row);
+      int col_gid = coarse_map.GID(aggregate*static_cast<int>(neq) + level.row_eq[row]);
+      TRILINOS_THROW(tentative->InsertGlobalValues(row_gid, 1, &one, &col_gid));
+    }
+    TRILINOS_THROW(tentative->FillComplete(coarse_map, matrix.RangeMap()));
+
+    if(m_settings.prolongator_damping == 0.)
+      return tentative;
+
+    const Real max_eigenvalue = estimate_max_eigenvalue(level);
+    if(max_eigenvalue <= 0.)
+      return tentative;
+
+    // P = (I - omega/lambda_max * D^-1 * A) * P_tentative
+    Epetra_CrsMatrix smoothing(Copy, matrix.RowMap(), 0);
+    TRILINOS_THROW(EpetraExt::MatrixMatrix::Multiply(matrix, false, *tentative, false, smoothing));
+    TRILINOS_THROW(smoothing.LeftScale(*level.inverse_diagonal));
+
+    Epetra_CrsMatrix* smoothed = 0;
+    TRILINOS_THROW(EpetraExt::MatrixMatrix::Add(*tentative, false, 1., smoothing, false, -m_settings.prolongator_damping / max_eigenvalue, smoothed));
+    Teuchos::RCP<Epetra_CrsMatrix> result = Teuchos::rcp(smoothed);
+    if(!result->Filled())
+      TRILINOS_THROW(result->FillComplete(coarse_map, matrix.RangeMap()));
+
+    return result;
+  }
+
+  /// Power iteration estimate of the largest eigenvalue of D^-1*A
+  Real estimate_max_eigenvalue(const Level& level) const
+  {
+    Epetra_Vector v(level.matrix->RowMap());
+    Epetra_Vector w(level.matrix->RowMap());
+    TRILINOS_THROW(v.Random());
+    Real result = 0.;
+    for(Uint i = 0; i != 10; ++i)
+    {
+      double norm;
+      TRILINOS_THROW(v.Norm2(&norm));
+      if(norm == 0.)
+        return 0.;
+      TRILINOS_THROW(v.Scale(1. / norm));
+      TRILINOS_THROW(level.matrix->Multiply(false, v, w));
+      TRILINOS_THROW(w.Multiply(1., *level.inverse_diagonal, w, 0.));
+      TRILINOS_THROW(w.Norm2(&result));
+      std::swap(v, w);
+    }
+    return result;
+  }
+
+  void smooth(const Level& level) const
+  {
+    for(Uint sweep = 0; sweep != m_settings.smoother_sweeps; ++sweep)
+    {
+      if(m_settings.smoother == "Jacobi")
+      {
+        compute_residual(level);
+        TRILINOS_THROW(level.x->Multiply(m_settings.jacobi_damping, *level.inverse_diagonal, *level.r, 1.));
+      }
+      else
+      {
+        gauss_seidel(level);
+      }
+    }
+  }
+
+  /// Symmetric Gauss-Seidel sweep on the owned rows, using the ghost values from before the sweep
+  void gauss_seidel(const Level& level) const
+  {
+    Epetra_Vector& x_column = *level.x_column;
+    const SinglePrecisionCrs& matrix_single = level.matrix_single;
+    if(m_settings.single_precision)
+      matrix_single.import(*level.x, x_column);
+    else if(level.matrix->Importer() != 0)
+      TRILINOS_THROW(x_column.Import(*level.x, *level.matrix->Importer(), Insert))
+    else
+      TRILINOS_THROW(x_column.Update(1., *level.x, 0.))
+
+    const Epetra_Vector& b = *level.b;
+    const Epetra_Vector& inverse_diagonal = *level.inverse_diagonal;
+    const int nb_rows = b.MyLength();
+    for(int i = 0; i != 2*nb_rows; ++i)
+    {
+      const int row = i < nb_rows ? i : 2*nb_rows - 1 - i;
+      const int diagonal_column = level.diagonal_column[row];
+      if(diagonal_column < 0)
+        continue;
+      Real residual = b[row];
+      if(m_settings.single_precision)
+      {
+        for(int j = matrix_single.row_offsets[row]; j != matrix_single.row_offsets[row+1]; ++j)
+          residual -= matrix_single.values[j] * x_column[matrix_single.columns[j]];
+      }
+      else
+      {
+        int nb_entries;
+        double* values;
+        int* columns;
+        TRILINOS_THROW(level.matrix->ExtractMyRowView(row, nb_entries, values, columns));
+        for(int j = 0; j != nb_entries; ++j)
+          residual -= values[j] * x_column[columns[j]];
+      }
+      x_column[diagonal_column] += residual * inverse_diagonal[row];
+    }
+
+    Epetra_Vector& x = *level.x;
+    for(int row = 0; row != nb_rows; ++row)
+    {
+      if(level.diagonal_column[row] >= 0)
+        x[row] = x_column[level.diagonal_column[row]];
+    }
+  }
+
+  /// level.r = level.b - A*level.x
+  void compute_residual(const Level& level) const
+  {
+    if(m_settings.single_precision)
+    {
+      level.matrix_single.import(*level.x, *level.x_column);
+      level.matrix_single.multiply(*level.x_column, *level.r);
+    }
+    else
+    {
+      TRILINOS_THROW(level.matrix->Multiply(false, *level.x, *level.r));
+    }
+    TRILINOS_THROW(level.r->Update(1., *level.b, -1.));
+  }
+
+  /// coarse.b = P^T*level.r
+  void restrict_residual(const Level& level, const Level& coarse) const
+  {
+    if(!m_settings.single_precision)
+    {
+      TRILINOS_THROW(level.prolongator->Multiply(true, *level.r, *coarse.b));
+      return;
+    }
+
+    const SinglePrecisionCrs& prolongator = level.prolongator_single;
+    prolongator.multiply_transpose(*level.r, *level.prolongator_column);
+    if(prolongator.importer.is_null())
+    {
+      TRILINOS_THROW(coarse.b->Update(1., *level.prolongator_column, 0.));
+    }
+    else
+    {
+      TRILINOS_THROW(coarse.b->PutScalar(0.));
+      TRILINOS_THROW(coarse.b->Export(*level.prolongator_column, *prolongator.importer, Add));
+    }
+  }
+
+  /// level.r = P*coarse.x
+  void interpolate_correction(const Level& level, const Level& coarse) const
+  {
+    if(m_settings.single_precision)
+    {
+      level.prolongator_single.import(*coarse.x, *level.prolongator_column);
+      level.prolongator_single.multiply(*level.prolongator_column, *level.r);
+    }
+    else
+    {
+      TRILINOS_THROW(level.prolongator->Multiply(false, *coarse.x, *level.r));
+    }
+  }
+
+  /// V-cycle starting at the given level, solving for level.x using level.b
+  void cycle(const Uint level_idx) const
+  {
+    const Level& level = m_levels[level_idx];
+    TRILINOS_THROW(level.x->PutScalar(0.));
+
+    if(level_idx+1 == m_levels.size())
+    {
+      if(m_coarse_solver.get() != 0)
+        TRILINOS_THROW(m_coarse_solver->Solve())
+      else
+        smooth(level);
+      return;
+    }
+
+    smooth(level);
+
+    // Restrict the residual
+    const Level& coarse = m_levels[level_idx+1];
+    compute_residual(level);
+    restrict_residual(level, coarse);
+
+    cycle(level_idx+1);
+
+    // Interpolate the correction
+    interpolate_correction(level, coarse);
+    TRILINOS_THROW(level.x->Update(1., *level.r, 1.));
+
+    smooth(level);
+  }
+
+  const MultigridSettings m_settings;
+  std::vector<Level> m_levels;
+  Epetra_LinearProblem m_coarse_problem;
+  boost::scoped_ptr<Amesos_BaseSolver> m_coarse_solver;
+};
+
+} // namespace detail
+
+struct MultigridStrategy::Implementation
+{
+  typedef Epetra_MultiVector MV;
+  typedef Epetra_Operator OP;
+
+  Implementation(common::Component& self) :
+    m_self(self),
+    m_solver_parameter_list(Teuchos::createParameterList()),
+    m_krylov_solver("CG"),
+    m_reuse_hierarchy(false)
+  {
+    m_settings.max_levels = 10;
+    m_settings.coarse_size = 1000;
+    m_settings.aggregation_threshold = 0.;
+    m_settings.prolongator_damping = 4./3.;
+    m_settings.smoother = "GaussSeidel";
+    m_settings.smoother_sweeps = 1;
+    m_settings.jacobi_damping = 2./3.;
+    m_settings.coarse_solver = "Amesos_Klu";
+    m_settings.single_precision = false;
+
+    self.options().add("krylov_solver", m_krylov_solver)
+      .pretty_name("Krylov Solver")
+      .description("Outer Krylov solver, preconditioned by the multigrid cycle. One of CG, GMRES or FGMRES (flexible GMRES, right preconditioned)")
+      .link_to(&m_krylov_solver)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this))
+      .mark_basic();
+
+    self.options().add("reuse_hierarchy", m_reuse_hierarchy)
+      .pretty_name("Reuse Hierarchy")
+      .description("Keep the multigrid levels between solves. Set this if the matrix does not change.")
+      .link_to(&m_reuse_hierarchy)
+      .mark_basic();
+
+    self.options().add("max_levels", m_settings.max_levels)
+      .pretty_name("Max Levels")
+      .description("Maximum number of levels, including the fine level")
+      .link_to(&m_settings.max_levels)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this))
+      .mark_basic();
+
+    self.options().add("coarse_size", m_settings.coarse_size)
+      .pretty_name("Coarse Size")
+      .description("Coarsening stops when the global number of rows is at most this size")
+      .link_to(&m_settings.coarse_size)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this));
+
+    self.options().add("aggregation_threshold", m_settings.aggregation_threshold)
+      .pretty_name("Aggregation Threshold")
+      .description("Connections with |a_ij| <= threshold*sqrt(|a_ii*a_jj|) are ignored when aggregating")
+      .link_to(&m_settings.aggregation_threshold)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this));
+
+    self.options().add("prolongator_damping", m_settings.prolongator_damping)
+      .pretty_name("Prolongator Damping")
+      .description("Damping factor for the Jacobi smoothing of the prolongator, scaled by the inverse of the largest eigenvalue of D^-1*A. Zero gives plain aggregation.")
+      .link_to(&m_settings.prolongator_damping)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this));
+
+    self.options().add("smoother", m_settings.smoother)
+      .pretty_name("Smoother")
+      .description("Smoother used on each level. One of Jacobi or GaussSeidel (symmetric, applied to the local rows)")
+      .link_to(&m_settings.smoother)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this))
+      .mark_basic();
+
+    self.options().add("smoother_sweeps", m_settings.smoother_sweeps)
+      .pretty_name("Smoother Sweeps")
+      .description("Number of pre- and post-smoothing sweeps")
+      .link_to(&m_settings.smoother_sweeps)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this))
+      .mark_basic();
+
+    self.options().add("jacobi_damping", m_settings.jacobi_damping)
+      .pretty_name("Jacobi Damping")
+      .description("Damping factor for the Jacobi smoother")
+      .link_to(&m_settings.jacobi_damping)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this));
+
+    self.options().add("coarse_solver", m_settings.coarse_solver)
+      .pretty_name("Coarse Solver")
+      .description("Amesos solver type for the coarsest level. If empty, the coarsest level is smoothed only.")
+      .link_to(&m_settings.coarse_solver)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this));
+
+    self.options().add("single_precision", m_settings.single_precision)
+      .pretty_name("Single Precision")
+      .description("Store the matrices and prolongators of the multigrid cycle in single precision. The outer Krylov solver "
+                   "stays in double precision, so the final accuracy is unchanged. Use FGMRES if the cycle is not accurate enough for CG.")
+      .link_to(&m_settings.single_precision)
+      .attach_trigger(boost::bind(&Implementation::reset_solver, this))
+      .mark_basic();
+
+    // Default solver parameters
+    m_solver_parameter_list->set( "Verbosity", Belos::Errors | Belos::Warnings | Belos::FinalSummary );
+    m_solver_parameter_list->set( "Block Size", 1 );
+    m_solver_parameter_list->set( "Maximum Iterations", 500 );
+    m_solver_parameter_list->set( "Convergence Tolerance", 1.0e-8 );
+
+    update_parameters();
+  }
+
+  /// @return true if the multigrid hierarchy was rebuilt
+  bool setup_solver()
+  {
+    if(is_null(m_matrix))
+      throw common::SetupError(FromHere(), "Null matrix for " + m_self.uri().path());
+
+    if(is_null(m_rhs))
+      throw common::SetupError(FromHere(), "Null RHS for " + m_self.uri().path());
+
+    if(is_null(m_solution))
+      throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
+
+    const bool rebuild = m_preconditioner.is_null() || !m_reuse_hierarchy;
+    if(rebuild)
+    {
+      m_preconditioner = Teuchos::rcp(new detail::MultigridPreconditioner(*m_matrix, m_settings));
+      CFdebug << "Multigrid hierarchy for " << m_self.uri().path() << " has " << m_preconditioner->nb_levels() << " levels" << CFendl;
+    }
+
+    if(m_solver.is_null())
+    {
+      m_problem = Teuchos::rcp( new Belos::LinearProblem<Real,MV,OP>(m_matrix->epetra_matrix(), m_solution->epetra_vector(), m_rhs->epetra_vector()) );
+
+      if(m_krylov_solver == "CG")
+        m_solver = Teuchos::rcp(new Belos::BlockCGSolMgr<Real,MV,OP>(m_problem, m_solver_parameter_list));
+      else if(m_krylov_solver == "GMRES")
+        m_solver = Teuchos::rcp(new Belos::BlockGmresSolMgr<Real,MV,OP>(m_problem, m_solver_parameter_list));
+      else if(m_krylov_solver == "FGMRES")
+      {
+        // Flexible GMRES stores the preconditioned directions, so the preconditioner may vary between iterations
+        Teuchos::RCP<Teuchos::ParameterList> flexible_parameters = Teuchos::rcp(new Teuchos::ParameterList(*m_solver_parameter_list));
+        flexible_parameters->set("Flexible Gmres", true);
+        m_solver = Teuchos::rcp(new Belos::BlockGmresSolMgr<Real,MV,OP>(m_problem, flexible_parameters));
+      }
+      else
+        throw common::BadValue(FromHere(), "Unknown Krylov solver " + m_krylov_solver + " for " + m_self.uri().path() + ", expected CG, GMRES or FGMRES");
+    }
+
+    // Flexible GMRES only supports right preconditioning
+    const Teuchos::RCP<Belos::EpetraPrecOp> preconditioner = Teuchos::rcp(new Belos::EpetraPrecOp(m_preconditioner));
+    if(m_krylov_solver == "FGMRES")
+      m_problem->setRightPrec(preconditioner);
+    else
+      m_problem->setLeftPrec(preconditioner);
+    return rebuild;
+  }
+
+  SolveTelemetry solve()
+  {
+    SolveTelemetry telemetry;
+    common::Timer timer;
+
+    telemetry.preconditioner_rebuilt = setup_solver();
+
+    if(!m_problem->setProblem())
+      throw common::SetupError(FromHere(), "Error setting up Belos problem");
+
+    telemetry.setup_time = timer.elapsed();
+    timer.restart();
+
+    if(m_solver->solve() != Belos::Converged)
+      CFwarn << "Multigrid solve for " << m_self.uri().path() << " did not converge after " << m_solver->getNumIters() << " iterations" << CFendl;
+
+    telemetry.solve_time = timer.elapsed();
+    telemetry.iterations = m_solver->getNumIters();
+
+    // Belos does not give the residual of each iteration, so only the true final residual is reported
+    telemetry.residuals.push_back(compute_residual());
+    return telemetry;
+  }
+
+  Real compute_residual()
+  {
+    if(is_null(m_matrix) || is_null(m_rhs) || is_null(m_solution))
+      throw common::SetupError(FromHere(), "Incomplete system for " + m_self.uri().path());
+
+    const Epetra_Vector& rhs = *m_rhs->epetra_vector();
+    Epetra_Vector residual(rhs.Map());
+    TRILINOS_THROW(m_matrix->epetra_matrix()->Multiply(false, *m_solution->epetra_vector(), residual));
+    TRILINOS_THROW(residual.Update(1., rhs, -1.));
+    Real result;
+    TRILINOS_THROW(residual.Norm2(&result));
+    return result;
+  }
+
+  void update_parameters()
+  {
+    if(is_not_null(m_solver_parameters))
+      m_self.remove_component("SolverParameters");
+
+    m_solver_parameters = m_self.create_component<ParameterList>("SolverParameters");
+    m_solver_parameters->mark_basic();
+    m_solver_parameters->set_parameter_list(*m_solver_parameter_list);
+  }
+
+  void reset_solver()
+  {
+    m_solver.reset();
+    m_problem.reset();
+    m_preconditioner.reset();
+  }
+
+  common::Component& m_self;
+  Teuchos::RCP<Teuchos::ParameterList> m_solver_parameter_list;
+
+  Teuchos::RCP<detail::MultigridPreconditioner> m_preconditioner;
+  Teuchos::RCP< Belos::LinearProblem<Real,MV,OP> > m_problem;
+  Teuchos::RCP< Belos::SolverManager<Real,MV,OP> > m_solver;
+
+  Handle<TrilinosCrsMatrix> m_matrix;
+  Handle<TrilinosVector> m_rhs;
+  Handle<TrilinosVector> m_solution;
+  Handle<ParameterList> m_solver_parameters;
+
+  detail::MultigridSettings m_settings;
+  std::string m_krylov_solver;
+  bool m_reuse_hierarchy;
+};
+
+MultigridStrategy::MultigridStrategy(const string& name) :
+  SolutionStrategy(name),
+  m_implementation(new Implementation(*this))
+{
+  common::Core::instance().event_handler().connect_to_event("trilinos_parameters_changed", this, &MultigridStrategy::on_parameters_changed_event);
+}
+
+MultigridStrategy::~MultigridStrategy()
+{
+}
+
+Real MultigridStrategy::compute_residual()
+{
+  return m_implementation->compute_residual();
+}
+
+void MultigridStrategy::set_rhs(const Handle< Vector >& rhs)
+{
+  m_implementation->m_rhs = Handle<TrilinosVector>(rhs);
+  m_implementation->reset_solver();
+}
+
+void MultigridStrategy::set_solution(const Handle< Vector >& solution)
+{
+  m_implementation->m_solution = Handle<TrilinosVector>(solution);
+  m_implementation->reset_solver();
+}
+
+void MultigridStrategy::set_matrix(const Handle< Matrix >& matrix)
+{
+  m_implementation->m_matrix = Handle<TrilinosCrsMatrix>(matrix);
+  if(is_null(m_implementation->m_matrix) && is_not_null(matrix))
+    throw common::NotSupported(FromHere(), "MultigridStrategy only supports TrilinosCrsMatrix, got " + matrix->derived_type_name());
+  m_implementation->reset_solver();
+}
+
+void MultigridStrategy::solve()
+{
+  publish_telemetry(m_implementation->solve());
+}
+
+Uint MultigridStrategy::nb_levels() const
+{
+  return m_implementation->m_preconditioner.is_null() ? 0 : m_implementation->m_preconditioner->nb_levels();
+}
+
+Uint MultigridStrategy::level_size(const Uint level) const
+{
+  if(m_implementation->m_preconditioner.is_null())
+    throw common::SetupError(FromHere(), "No multigrid hierarchy in " + uri().path());
+  return m_implementation->m_preconditioner->level_size(level);
+}
+
+void MultigridStrategy::on_parameters_changed_event(common::SignalArgs& args)
+{
+  common::XML::SignalOptions options(args);
+  const common::URI parameters_uri = options.value<common::URI>("parameters_uri");
+
+  if(boost::starts_with(parameters_uri.path(), uri().path()))
+  {
+    CFdebug << "Acting on trilinos_parameters_changed event from paramater list " << parameters_uri.string() << CFendl;
+    m_implementation->reset_solver();
+  }
+  else
+  {
+    CFdebug << "Ignoring trilinos_parameters_changed event from paramater list " << parameters_uri.string() << CFendl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
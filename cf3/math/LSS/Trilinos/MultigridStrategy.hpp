@@ -0,0 +1,65 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_MultigridStrategy_hpp
+#define cf3_Math_LSS_MultigridStrategy_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/scoped_ptr.hpp>
+
+#include "math/LSS/SolutionStrategy.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ *  @file MultigridStrategy.hpp Solution strategy using an aggregation multigrid V-cycle as preconditioner for a Krylov solver
+ **/
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+/// Multigrid preconditioned Krylov solver. The coarse levels are built by agglomerating the nodes of the mesh, using the
+/// node connectivity that is stored in the sparsity pattern of the matrix. All equations of a node end up in the same aggregate.
+/// The grid transfer uses a (smoothed) piecewise constant prolongator P, and the coarse matrices are computed as P^T*A*P.
+/// Each level is smoothed using damped Jacobi or symmetric Gauss-Seidel, and the coarsest level is solved using Amesos.
+/// With the single_precision option, the cycle uses single precision copies of the matrices and prolongators, while the vectors
+/// and the outer Krylov solver remain in double precision. Only TrilinosCrsMatrix is supported.
+class LSS_API MultigridStrategy : public SolutionStrategy
+{
+public:
+  MultigridStrategy(const std::string& name);
+  ~MultigridStrategy();
+
+  /// name of the type
+  static std::string type_name () { return "MultigridStrategy"; }
+
+  void set_matrix(const Handle<LSS::Matrix>& matrix);
+  void set_rhs(const Handle<LSS::Vector>& rhs);
+  void set_solution(const Handle<LSS::Vector>& solution);
+  void solve();
+  Real compute_residual();
+
+  /// Number of levels in the current hierarchy, including the fine level. Zero before the first solve.
+  Uint nb_levels() const;
+
+  /// Global number of rows on the given level
+  Uint level_size(const Uint level) const;
+
+private:
+  void on_parameters_changed_event(common::SignalArgs& args);
+  /// Hide the implementation to avoid pulling in lots of Trilinos headers
+  struct Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_MultigridStrategy_hpp
@@ -40,6 +40,7 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/Timer.hpp"
 #include <common/Table.hpp>
 #include <common/List.hpp>
 
@@ -157,17 +158,28 @@ struct RCGStrategy::Implementation
     return 0;
   }
 
-  void solve()
+  SolveTelemetry solve()
   {
+    SolveTelemetry telemetry;
+    common::Timer timer;
+
     if(is_null(m_solver.get()))
     {
       setup_solver();
+      telemetry.preconditioner_rebuilt = true;
     }
 
     if(!m_problem->setProblem())
       throw common::SetupError(FromHere(), "Error setting up Belos problem");
 
+    telemetry.setup_time = timer.elapsed();
+    timer.restart();
+
     m_solver->solve();
+
+    telemetry.solve_time = timer.elapsed();
+    telemetry.iterations = m_solver->getNumIters();
+    return telemetry;
   }
 
   Real compute_residual()
@@ -256,7 +268,7 @@ void RCGStrategy::set_matrix(const Handle< Matrix >& matrix)
 
 void RCGStrategy::solve()
 {
-  m_implementation->solve();
+  publish_telemetry(m_implementation->solve());
 }
 
 void RCGStrategy::on_parameters_changed_event(common::SignalArgs& args)
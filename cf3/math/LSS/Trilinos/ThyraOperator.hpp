@@ -9,6 +9,7 @@
 
 #include "Teuchos_RCP.hpp"
 #include "Thyra_LinearOpBase.hpp"
+#include "Thyra_PreconditionerBase.hpp"
 
 #include "common/CF.hpp"
 
@@ -25,6 +26,10 @@ public:
   
   /// Writable access to the matrix
   virtual Teuchos::RCP<Thyra::LinearOpBase<Real> > thyra_operator() = 0;
+
+  /// Preconditioner supplied by the operator itself, for operators the solver can't build one from.
+  /// Null by default.
+  virtual Teuchos::RCP<const Thyra::PreconditionerBase<Real> > thyra_preconditioner() const { return Teuchos::null; }
 };
 
 } // namespace LSS
@@ -31,6 +31,7 @@
 #include "Stratimikos_DefaultLinearSolverBuilder.hpp"
 
 #include "common/Assertions.hpp"
+#include "common/Foreach.hpp"
 #include "common/Builder.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/Log.hpp"
@@ -69,7 +70,8 @@ TrilinosCrsMatrix::TrilinosCrsMatrix(const std::string& name) :
   m_num_my_elements(0),
   m_p2m(0),
   m_converted_indices(0),
-  m_comm(common::PE::Comm::instance().communicator())
+  m_comm(common::PE::Comm::instance().communicator()),
+  m_column_index_matrix(nullptr)
 {
   properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
 }
@@ -139,6 +141,12 @@ void TrilinosCrsMatrix::create_blocked(common::PE::CommPattern& cp, const Variab
   TRILINOS_THROW(m_mat->FillComplete());
   TRILINOS_THROW(m_mat->OptimizeStorage());
 
+  // The dirichlet column index and cache depend on the sparsity
+  m_column_index_matrix = nullptr;
+  m_dirichlet_cache_begin.clear();
+  m_dirichlet_cache_values.clear();
+  m_dirichlet_cached_columns.clear();
+
   // set class properties
   m_is_created=true;
   m_neq=total_nb_eq;
@@ -153,6 +161,13 @@ void TrilinosCrsMatrix::destroy()
   {
     m_mat.reset();
   }
+  m_column_index_matrix = nullptr;
+  m_column_offsets.clear();
+  m_column_rows.clear();
+  m_column_positions.clear();
+  m_dirichlet_cache_begin.clear();
+  m_dirichlet_cache_values.clear();
+  m_dirichlet_cached_columns.clear();
   m_p2m.resize(0);
   m_p2m.reserve(0);
   m_neq=0;
@@ -323,81 +338,128 @@ void TrilinosCrsMatrix::get_column_and_replace_to_zero(const Uint iblockcol, Uin
 
 void TrilinosCrsMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs)
 {
-  // We assume that we have an epetra RHS with the same storage structure as the matrix!
-  Epetra_Vector& epetra_rhs = *dynamic_cast<TrilinosVector&>(rhs).epetra_vector();
+  symmetric_dirichlet(std::vector<Uint>(1, blockrow), std::vector<Uint>(1, ieq), std::vector<Real>(1, value), rhs);
+}
 
-  int num_entries;
-  Real* extracted_values;
-  int* extracted_indices;
+////////////////////////////////////////////////////////////////////////////////////////////
 
-  const int bc_col = m_p2m[blockrow*m_neq+ieq];
+void TrilinosCrsMatrix::symmetric_dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, Vector& rhs)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(blockrows.size() == ieqs.size());
+  cf3_assert(blockrows.size() == values.size());
 
-  m_dirichlet_nodes.push_back(std::make_pair(blockrow, ieq));
+  if(m_column_index_matrix != m_mat.get())
+    build_column_index();
 
-  const Uint nb_connected_nodes = m_starting_indices[blockrow+1] - m_starting_indices[blockrow];
-  std::vector<int> row_indices; row_indices.reserve(m_neq*nb_connected_nodes);
-  const Uint conn_start = m_starting_indices[blockrow];
-  const Uint conn_end = m_starting_indices[blockrow+1];
-  for(Uint i = conn_start; i != conn_end; ++i)
-  {
-    for(Uint j = 0; j != m_neq; ++j)
-    {
-      row_indices.push_back(m_p2m[m_node_connectivity[i]*m_neq+j]);
-    }
-  }
-  
-  DirichletEntryT& cached_col_values = m_symmetric_dirichlet_values[bc_col];
+  // We assume that we have an epetra RHS with the same storage structure as the matrix!
+  Epetra_Vector& epetra_rhs = *dynamic_cast<TrilinosVector&>(rhs).epetra_vector();
+  Real* rhs_values;
+  TRILINOS_THROW(epetra_rhs.ExtractView(&rhs_values));
+
+  int* row_offsets;
+  int* col_indices;
+  Real* mat_values;
+  TRILINOS_THROW(m_mat->ExtractCrsDataPointers(row_offsets, col_indices, mat_values));
 
-  if(cached_col_values.empty())
+  const Uint nb_bcs = blockrows.size();
+  m_dirichlet_nodes.reserve(m_dirichlet_nodes.size() + nb_bcs);
+  for(Uint bc = 0; bc != nb_bcs; ++bc)
   {
-    BOOST_FOREACH(const int other_row, row_indices)
-    {
-      if(other_row >= m_num_my_elements)
-        continue;
+    const Real value = values[bc];
+    const int bc_col = m_p2m[blockrows[bc]*m_neq+ieqs[bc]];
+    const int col_begin = m_column_offsets[bc_col];
+    const int col_end = m_column_offsets[bc_col+1];
+
+    m_dirichlet_nodes.push_back(std::make_pair(blockrows[bc], ieqs[bc]));
 
-      TRILINOS_THROW(m_mat->ExtractMyRowView(other_row, num_entries, extracted_values, extracted_indices));
-      const int nb_entries_const = num_entries;
-      Uint i;
-      if(other_row != bc_col)
+    int& cache_begin = m_dirichlet_cache_begin[bc_col];
+    if(cache_begin < 0)
+    {
+      // Move the column to the RHS, caching the values
+      cache_begin = m_dirichlet_cache_values.size();
+      m_dirichlet_cached_columns.push_back(bc_col);
+      for(int i = col_begin; i != col_end; ++i)
       {
-        for(i = 0; i != nb_entries_const; )
+        const int other_row = m_column_rows[i];
+        Real& entry = mat_values[m_column_positions[i]];
+        if(other_row == bc_col)
         {
-          if(extracted_indices[i] == bc_col)
-          {
-            cached_col_values[other_row] = extracted_values[i];
-            epetra_rhs[other_row] -= extracted_values[i] * value;
-            extracted_values[i] = 0;
-            break;
-          }
-          ++i;
+          m_dirichlet_cache_values.push_back(0.);
+          continue;
         }
-        cf3_assert(i != nb_entries_const);
+        m_dirichlet_cache_values.push_back(entry);
+        rhs_values[other_row] -= entry * value;
+        entry = 0.;
       }
-      else
+
+      // The row of the BC becomes the identity
+      if(bc_col < m_num_my_elements)
       {
-        for(i = 0; i != nb_entries_const; ++i)
-        {
-          if(extracted_indices[i] == bc_col)
-          {
-            extracted_values[i] = 1.;
-          }
-          else
-          {
-            extracted_values[i] = 0;
-          }
-        }
+        const int row_end = row_offsets[bc_col+1];
+        for(int i = row_offsets[bc_col]; i != row_end; ++i)
+          mat_values[i] = col_indices[i] == bc_col ? 1. : 0.;
       }
     }
+    else // Reuse the cached values, if the matrix wasn't reset since the previous BC application
+    {
+      const Real* cached_values = &m_dirichlet_cache_values[cache_begin];
+      for(int i = col_begin; i != col_end; ++i)
+        rhs_values[m_column_rows[i]] -= cached_values[i-col_begin] * value;
+    }
+
+    rhs.set_value(blockrows[bc], ieqs[bc], value);
   }
-  else // Reuse the cached values, if the matrix wasn't reset since the previous BC application
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosCrsMatrix::build_column_index()
+{
+  cf3_assert(m_is_created);
+
+  if(!m_mat->StorageOptimized())
+    TRILINOS_THROW(m_mat->OptimizeStorage());
+
+  int* row_offsets;
+  int* col_indices;
+  Real* mat_values;
+  TRILINOS_THROW(m_mat->ExtractCrsDataPointers(row_offsets, col_indices, mat_values));
+
+  const int nb_rows = m_mat->NumMyRows();
+  const int nb_cols = m_mat->NumMyCols();
+  const int nb_nonzeros = row_offsets[nb_rows];
+
+  // Count the entries in each column
+  m_column_offsets.assign(nb_cols+1, 0);
+  for(int i = 0; i != nb_nonzeros; ++i)
+    ++m_column_offsets[col_indices[i]+1];
+  for(int col = 0; col != nb_cols; ++col)
+    m_column_offsets[col+1] += m_column_offsets[col];
+
+  // Fill in the rows and positions, by increasing row number within each column
+  m_column_rows.resize(nb_nonzeros);
+  m_column_positions.resize(nb_nonzeros);
+  std::vector<int> column_fill(m_column_offsets.begin(), m_column_offsets.end()-1);
+  for(int row = 0; row != nb_rows; ++row)
   {
-    for(DirichletEntryT::const_iterator it = cached_col_values.begin(); it != cached_col_values.end(); ++it)
+    const int row_end = row_offsets[row+1];
+    for(int i = row_offsets[row]; i != row_end; ++i)
     {
-      epetra_rhs[it->first] -= it->second * value;
+      const int idx = column_fill[col_indices[i]]++;
+      m_column_rows[idx] = row;
+      m_column_positions[idx] = i;
     }
   }
 
-  rhs.set_value(blockrow, ieq, value);
+  if(m_dirichlet_cache_begin.size() != static_cast<Uint>(nb_cols))
+  {
+    m_dirichlet_cache_begin.assign(nb_cols, -1);
+    m_dirichlet_cache_values.clear();
+    m_dirichlet_cached_columns.clear();
+  }
+
+  m_column_index_matrix = m_mat.get();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -508,7 +570,12 @@ void TrilinosCrsMatrix::reset(Real reset_to)
   CFdebug << "Resetting CrsMatrix to " << reset_to << CFendl;
   TRILINOS_THROW(m_mat->PutScalar(reset_to));
 
-  m_symmetric_dirichlet_values.clear();
+  BOOST_FOREACH(const int col, m_dirichlet_cached_columns)
+  {
+    m_dirichlet_cache_begin[col] = -1;
+  }
+  m_dirichlet_cache_values.clear();
+  m_dirichlet_cached_columns.clear();
   m_dirichlet_nodes.clear();
 }
 
@@ -531,7 +598,11 @@ void TrilinosCrsMatrix::clone_to(Matrix &other)
   other_ptr->m_converted_indices = m_converted_indices;
   other_ptr->m_node_connectivity = m_node_connectivity;
   other_ptr->m_starting_indices = m_starting_indices;
-  other_ptr->m_symmetric_dirichlet_values = m_symmetric_dirichlet_values;
+  // The copy gets its own column index, built on first use, but shares the cached values
+  other_ptr->m_column_index_matrix = nullptr;
+  other_ptr->m_dirichlet_cache_begin = m_dirichlet_cache_begin;
+  other_ptr->m_dirichlet_cache_values = m_dirichlet_cache_values;
+  other_ptr->m_dirichlet_cached_columns = m_dirichlet_cached_columns;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -634,6 +705,27 @@ void TrilinosCrsMatrix::print_native(ostream& stream)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+Real TrilinosCrsMatrix::memory_bytes() const
+{
+  Real bytes = 0.;
+  if(!m_mat.is_null())
+  {
+    // Values and local column indices of the nonzeros, and the row offsets
+    bytes += static_cast<Real>(m_mat->NumMyNonzeros()) * (sizeof(double) + sizeof(int));
+    bytes += static_cast<Real>(m_mat->NumMyRows() + 1) * sizeof(int);
+  }
+
+  const Real int_entries = m_p2m.capacity() + m_converted_indices.capacity() + m_node_connectivity.capacity() + m_starting_indices.capacity()
+    + m_column_offsets.capacity() + m_column_rows.capacity() + m_column_positions.capacity()
+    + m_dirichlet_cache_begin.capacity() + m_dirichlet_cached_columns.capacity();
+  bytes += int_entries * sizeof(int);
+  bytes += static_cast<Real>(m_dirichlet_cache_values.capacity()) * sizeof(Real);
+  bytes += static_cast<Real>(m_dirichlet_nodes.capacity()) * sizeof(std::pair<Uint,Uint>);
+  return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosCrsMatrix::blocked_var_gids ( const VariablesDescriptor& var_descriptor, std::vector< std::vector< int > >& var_gids )
 {
   cf3_assert(var_descriptor.size() == m_neq);
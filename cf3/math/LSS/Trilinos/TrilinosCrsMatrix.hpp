@@ -13,6 +13,7 @@
 #include <Epetra_CrsMatrix.h>
 #include <Teuchos_RCP.hpp>
 
+#include "common/AccountedComponent.hpp"
 #include "math/LSS/LibLSS.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
 #include "math/LSS/Vector.hpp"
@@ -37,7 +38,7 @@ namespace LSS {
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
-class LSS_API TrilinosCrsMatrix : public LSS::Matrix, public ThyraOperator {
+class LSS_API TrilinosCrsMatrix : public LSS::Matrix, public ThyraOperator, public common::AccountedComponent {
 public:
 
   /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
@@ -101,6 +102,11 @@ public:
 
   virtual void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs);
 
+  /// Apply a set of symmetric dirichlet conditions in one sweep over the matrix values.
+  /// The entries in the column of each BC are found through a transposed index of the sparsity,
+  /// which is built on the first call after the sparsity changes.
+  virtual void symmetric_dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, Vector& rhs);
+
   /// Get the nodes and equations for all dirichlet boundary conditions that have been applied so far
   const std::vector< std::pair< Uint, Uint > >& get_dirichlet_nodes( ) const;
 
@@ -138,6 +144,9 @@ public:
   /// Accessor to the state of create
   const bool is_created() { return m_is_created; }
 
+  /// Bytes used by the stored nonzeros, the index mappings and the cached column and Dirichlet data
+  virtual Real memory_bytes() const;
+
   /// Accessor to the number of equations
   const Uint neq() { cf3_assert(m_is_created); return m_neq; }
 
@@ -226,10 +235,25 @@ private:
   /// Copy of the connectivity data
   std::vector<int> m_node_connectivity, m_starting_indices;
 
-  /// Cache matrix values in case of symmetric dirichlet, so they can be applied multiple times even if the matrix is not changed
-  typedef std::map<int, Real> DirichletEntryT;
-  typedef std::map<int, DirichletEntryT> DirichletMapT;
-  DirichletMapT m_symmetric_dirichlet_values;
+  /// Build the transposed column index (m_column_offsets, m_column_rows and m_column_positions) for the current matrix
+  void build_column_index();
+
+  /// Matrix for which the column index was built
+  const Epetra_CrsMatrix* m_column_index_matrix;
+
+  /// Transposed sparsity: the entries of local column c are m_column_offsets[c] to m_column_offsets[c+1] in
+  /// m_column_rows (the local row) and m_column_positions (the position in the CRS value array)
+  std::vector<int> m_column_offsets;
+  std::vector<int> m_column_rows;
+  std::vector<int> m_column_positions;
+
+  /// Cache matrix values in case of symmetric dirichlet, so they can be applied multiple times even if the matrix is not changed.
+  /// The values for column c start at m_dirichlet_cache_begin[c] in m_dirichlet_cache_values, in the order of the column index,
+  /// or m_dirichlet_cache_begin[c] is -1 if the column is not cached.
+  std::vector<int> m_dirichlet_cache_begin;
+  std::vector<Real> m_dirichlet_cache_values;
+  /// Columns that are in the cache
+  std::vector<int> m_dirichlet_cached_columns;
 
   std::vector< std::pair<Uint,Uint> > m_dirichlet_nodes;
 }; // end of class Matrix
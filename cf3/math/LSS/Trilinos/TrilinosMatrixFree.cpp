@@ -0,0 +1,579 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Epetra_Map.h>
+#include <Epetra_MultiVector.h>
+#include <Epetra_Vector.h>
+
+#include "Thyra_DefaultDiagonalLinearOp.hpp"
+#include "Thyra_DefaultPreconditioner.hpp"
+#include "Thyra_EpetraLinearOp.hpp"
+#include "Thyra_EpetraThyraWrappers.hpp"
+
+#include "common/Action.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+
+#include "math/LSS/Trilinos/TrilinosMatrixFree.hpp"
+#include "math/LSS/Trilinos/TrilinosVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file TrilinosMatrixFree.cpp implementation of LSS::TrilinosMatrixFree
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+/// Epetra interface to the matrix-free product, so it can be used by the Trilinos solvers
+class MatrixFreeEpetraOperator : public Epetra_Operator
+{
+public:
+  MatrixFreeEpetraOperator(TrilinosMatrixFree& matrix, const Epetra_Map& map) :
+    m_matrix(matrix),
+    m_map(map)
+  {
+  }
+
+  int SetUseTranspose(bool use_transpose)
+  {
+    return use_transpose ? -1 : 0;
+  }
+
+  int Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+  {
+    // X and Y may be the same, but X is copied to the input vector first
+    for(int k = 0; k != X.NumVectors(); ++k)
+    {
+      TRILINOS_THROW(m_matrix.input_vector().epetra_vector()->Update(1., *X(k), 0.));
+      m_matrix.compute_product();
+      TRILINOS_THROW(Y(k)->Update(1., *m_matrix.result_vector().epetra_vector(), 0.));
+    }
+    return 0;
+  }
+
+  int ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+  {
+    return -1;
+  }
+
+  double NormInf() const
+  {
+    return 0.;
+  }
+
+  const char* Label() const
+  {
+    return "TrilinosMatrixFree";
+  }
+
+  bool UseTranspose() const
+  {
+    return false;
+  }
+
+  bool HasNormInf() const
+  {
+    return false;
+  }
+
+  const Epetra_Comm& Comm() const
+  {
+    return m_map.Comm();
+  }
+
+  const Epetra_Map& OperatorDomainMap() const
+  {
+    return m_map;
+  }
+
+  const Epetra_Map& OperatorRangeMap() const
+  {
+    return m_map;
+  }
+
+private:
+  TrilinosMatrixFree& m_matrix;
+  const Epetra_Map& m_map;
+};
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::TrilinosMatrixFree, LSS::Matrix, LSS::LibLSS > TrilinosMatrixFree_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+TrilinosMatrixFree::TrilinosMatrixFree(const std::string& name) :
+  LSS::Matrix(name),
+  m_computing_product(false),
+  m_is_created(false),
+  m_neq(0),
+  m_blockrow_size(0)
+{
+  properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
+
+  options().add("operator_action", m_operator_action)
+    .pretty_name("Operator Action")
+    .description("Action that adds the element matrices of the system. It is executed again for each matrix-vector product.")
+    .link_to(&m_operator_action)
+    .mark_basic();
+
+  options().add("jacobi_preconditioner", true)
+    .pretty_name("Jacobi Preconditioner")
+    .description("Supply the inverse of the assembled diagonal as preconditioner to the solver. If false, the solver must be configured without preconditioner, since there is no matrix to build one from.");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+TrilinosMatrixFree::~TrilinosMatrixFree()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::create(common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  create_work_vectors(solution, rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  create_work_vectors(solution, rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::create_work_vectors(Vector& solution, Vector& rhs)
+{
+  if(m_is_created)
+    destroy();
+
+  TrilinosVector* solution_ptr = dynamic_cast<TrilinosVector*>(&solution);
+  if(is_null(solution_ptr))
+    throw common::SetupError(FromHere(), "TrilinosMatrixFree needs a TrilinosVector as solution, but a " + solution.derived_type_name() + " was supplied instead.");
+
+  m_rhs = Handle<TrilinosVector>(rhs.handle());
+  if(is_null(m_rhs.get()))
+    throw common::SetupError(FromHere(), "TrilinosMatrixFree needs a TrilinosVector as RHS, but a " + rhs.derived_type_name() + " was supplied instead.");
+
+  m_x = create_component<TrilinosVector>("ProductInput");
+  m_result = create_component<TrilinosVector>("ProductResult");
+  m_rhs_backup = create_component<TrilinosVector>("RHSBackup");
+  m_diagonal = create_component<TrilinosVector>("Diagonal");
+  m_inverse_diagonal = create_component<TrilinosVector>("InverseDiagonal");
+
+  solution_ptr->clone_to(*m_x);
+  solution_ptr->clone_to(*m_result);
+  solution_ptr->clone_to(*m_rhs_backup);
+  solution_ptr->clone_to(*m_diagonal);
+  solution_ptr->clone_to(*m_inverse_diagonal);
+
+  m_diagonal->reset(0.);
+
+  m_neq = solution_ptr->neq();
+  m_blockrow_size = solution_ptr->blockrow_size();
+
+  const Epetra_Map& map = dynamic_cast<const Epetra_Map&>(m_x->epetra_vector()->Map());
+  m_epetra_operator = Teuchos::rcp(new detail::MatrixFreeEpetraOperator(*this, map));
+
+  m_is_created = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::destroy()
+{
+  m_epetra_operator = Teuchos::null;
+
+  if(is_not_null(m_x.get()))
+  {
+    remove_component("ProductInput");
+    remove_component("ProductResult");
+    remove_component("RHSBackup");
+    remove_component("Diagonal");
+    remove_component("InverseDiagonal");
+  }
+
+  m_x.reset();
+  m_result.reset();
+  m_rhs_backup.reset();
+  m_diagonal.reset();
+  m_inverse_diagonal.reset();
+  m_rhs.reset();
+
+  m_dirichlet_rows.clear();
+  m_dirichlet_columns.clear();
+
+  m_neq = 0;
+  m_blockrow_size = 0;
+  m_is_created = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_value(const Uint icol, const Uint irow, const Real value)
+{
+  throw common::NotSupported(FromHere(), "set_value is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_value(const Uint icol, const Uint irow, const Real value)
+{
+  throw common::NotSupported(FromHere(), "add_value is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_value(const Uint icol, const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  if(icol != irow)
+    throw common::NotSupported(FromHere(), "Only diagonal values can be read from the matrix-free operator " + uri().path());
+
+  m_diagonal->get_value(irow, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_values(const BlockAccumulator& values)
+{
+  throw common::NotSupported(FromHere(), "Element matrices can only be added to the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+
+  const Uint size = values.size();
+  m_element_values.indices = values.indices;
+  m_element_values.sol.resize(size);
+  m_element_values.rhs.resize(size);
+
+  if(m_computing_product)
+  {
+    m_x->get_sol_values(m_element_values);
+    m_element_values.rhs.noalias() = values.mat * m_element_values.sol;
+    m_result->add_rhs_values(m_element_values);
+  }
+  else
+  {
+    m_element_values.rhs = values.mat.diagonal();
+    m_diagonal->add_rhs_values(m_element_values);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_values(BlockAccumulator& values)
+{
+  throw common::NotSupported(FromHere(), "get_values is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(m_is_created);
+
+  // The boundary conditions in the operator action were recorded when the system was assembled
+  if(m_computing_product)
+    return;
+
+  if(offdiagval != 0.)
+    throw common::NotSupported(FromHere(), "The matrix-free operator " + uri().path() + " only supports rows with zero off-diagonal values");
+
+  const Uint row = iblockrow*m_neq+ieq;
+  m_dirichlet_rows[row] = diagval;
+  m_diagonal->set_value(row, diagval);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  throw common::NotSupported(FromHere(), "get_column_and_replace_to_zero is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs)
+{
+  symmetric_dirichlet(std::vector<Uint>(1, blockrow), std::vector<Uint>(1, ieq), std::vector<Real>(1, value), rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::symmetric_dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, Vector& rhs)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(blockrows.size() == ieqs.size());
+  cf3_assert(blockrows.size() == values.size());
+
+  // Applying the conditions again would run a nested pass, overwriting the input and result of the running product
+  if(m_computing_product)
+    return;
+
+  const Uint nb_bcs = blockrows.size();
+
+  // Columns of the new conditions, multiplied with the values. Eliminated columns are zero in the input.
+  m_x->reset(0.);
+  for(Uint bc = 0; bc != nb_bcs; ++bc)
+    m_x->set_value(blockrows[bc], ieqs[bc], values[bc]);
+  m_x->sync();
+
+  m_result->reset(0.);
+  operator_pass();
+
+  for(Uint bc = 0; bc != nb_bcs; ++bc)
+  {
+    const Uint row = blockrows[bc]*m_neq+ieqs[bc];
+    m_dirichlet_rows[row] = 1.;
+    m_dirichlet_columns.insert(row);
+    m_diagonal->set_value(row, 1.);
+  }
+
+  // Move the columns to the RHS, except for the rows that are replaced
+  for(std::map<Uint, Real>::const_iterator it = m_dirichlet_rows.begin(); it != m_dirichlet_rows.end(); ++it)
+    m_result->set_value(it->first, 0.);
+  rhs.update(*m_result, -1.);
+
+  for(Uint bc = 0; bc != nb_bcs; ++bc)
+    rhs.set_value(blockrows[bc], ieqs[bc], values[bc]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  throw common::NotSupported(FromHere(), "tie_blockrow_pairs is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_diagonal(const std::vector<Real>& diag)
+{
+  throw common::NotSupported(FromHere(), "set_diagonal is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_diagonal(const std::vector<Real>& diag)
+{
+  throw common::NotSupported(FromHere(), "add_diagonal is not supported by the matrix-free operator " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_diagonal(std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  // Ghost rows only got the contributions of the local elements
+  m_diagonal->sync();
+
+  const Uint nb_rows = m_blockrow_size*m_neq;
+  diag.resize(nb_rows);
+  for(Uint i = 0; i != nb_rows; ++i)
+    m_diagonal->get_value(i, diag[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+
+  // The operator action may reset the system as well
+  if(m_computing_product)
+    return;
+
+  if(reset_to != 0.)
+    throw common::NotSupported(FromHere(), "The matrix-free operator " + uri().path() + " can only be reset to zero");
+
+  m_diagonal->reset(0.);
+  m_dirichlet_rows.clear();
+  m_dirichlet_columns.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(common::LogStream& stream)
+{
+  stream << "Matrix-free operator " << uri().path() << " with " << m_blockrow_size << " block rows of " << m_neq << " equations" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(std::ostream& stream)
+{
+  stream << "Matrix-free operator " << uri().path() << " with " << m_blockrow_size << " block rows of " << m_neq << " equations" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(const std::string& filename, std::ios_base::openmode mode)
+{
+  throw common::NotSupported(FromHere(), "The matrix-free operator " + uri().path() + " has no entries to write to " + filename);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print_native(std::ostream& stream)
+{
+  print(stream);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::clone_to(Matrix& other)
+{
+  throw common::NotSupported(FromHere(), "The matrix-free operator " + uri().path() + " can not be cloned");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::apply(const Handle<Vector>& y, const Handle<Vector const>& x, const Real alpha, const Real beta)
+{
+  cf3_assert(m_is_created);
+  m_x->assign(*x);
+  compute_product();
+  y->axpby(*m_result, alpha, beta);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
+{
+  get_diagonal(values);
+  const Uint nb_rows = values.size();
+  row_indices.resize(nb_rows);
+  col_indices.resize(nb_rows);
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    row_indices[i] = i;
+    col_indices[i] = i;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< const Thyra::LinearOpBase< Real > > TrilinosMatrixFree::thyra_operator() const
+{
+  return Thyra::epetraLinearOp(m_epetra_operator);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< Thyra::LinearOpBase< Real > > TrilinosMatrixFree::thyra_operator()
+{
+  return Thyra::nonconstEpetraLinearOp(m_epetra_operator);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< const Thyra::PreconditionerBase< Real > > TrilinosMatrixFree::thyra_preconditioner() const
+{
+  if(!options().value<bool>("jacobi_preconditioner"))
+    return Teuchos::null;
+
+  cf3_assert(m_is_created);
+
+  // Rows without diagonal entry are left unscaled
+  const Uint nb_rows = m_blockrow_size*m_neq;
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    Real diag;
+    m_diagonal->get_value(i, diag);
+    m_inverse_diagonal->set_value(i, diag == 0. ? 1. : 1./diag);
+  }
+
+  return Thyra::unspecifiedPrec<Real>(Thyra::diagonal<Real>(m_inverse_diagonal->thyra_vector()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::compute_product()
+{
+  cf3_assert(m_is_created);
+  m_x->sync();
+
+  // Dirichlet rows are replaced by the diagonal value times the input
+  std::vector<Real> dirichlet_inputs;
+  dirichlet_inputs.reserve(m_dirichlet_rows.size());
+  for(std::map<Uint, Real>::const_iterator it = m_dirichlet_rows.begin(); it != m_dirichlet_rows.end(); ++it)
+  {
+    Real input;
+    m_x->get_value(it->first, input);
+    dirichlet_inputs.push_back(input);
+  }
+
+  // Columns of symmetric dirichlet conditions are eliminated
+  BOOST_FOREACH(const Uint column, m_dirichlet_columns)
+  {
+    m_x->set_value(column, 0.);
+  }
+
+  m_result->reset(0.);
+  operator_pass();
+
+  // Ghost rows only got the contributions of the local elements
+  m_result->sync();
+
+  Uint i = 0;
+  for(std::map<Uint, Real>::const_iterator it = m_dirichlet_rows.begin(); it != m_dirichlet_rows.end(); ++it, ++i)
+    m_result->set_value(it->first, it->second * dirichlet_inputs[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::operator_pass()
+{
+  if(is_null(m_operator_action.get()))
+    throw common::SetupError(FromHere(), "No operator_action configured for matrix-free operator " + uri().path());
+  if(m_computing_product)
+    throw common::SetupError(FromHere(), "The operator_action of matrix-free operator " + uri().path() + " uses the operator itself");
+
+  m_rhs_backup->assign(*m_rhs);
+  m_computing_product = true;
+  try
+  {
+    m_operator_action->execute();
+  }
+  catch(...)
+  {
+    m_computing_product = false;
+    m_rhs->assign(*m_rhs_backup);
+    throw;
+  }
+  m_computing_product = false;
+  m_rhs->assign(*m_rhs_backup);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
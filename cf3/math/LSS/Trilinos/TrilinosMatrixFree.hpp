@@ -0,0 +1,251 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_TrilinosMatrixFree_hpp
+#define cf3_Math_LSS_TrilinosMatrixFree_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <set>
+
+#include <Epetra_Operator.h>
+#include <Teuchos_RCP.hpp>
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Vector.hpp"
+#include "math/LSS/Matrix.hpp"
+
+#include "ThyraOperator.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file TrilinosMatrixFree.hpp definition of LSS::TrilinosMatrixFree
+
+  Matrix-free operator: no matrix entries are stored, the product with a vector is computed
+  by executing the assembly action again, with the element matrices multiplied with the element
+  values of the vector on the fly.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common { class Action; }
+namespace math {
+namespace LSS {
+
+class TrilinosVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Matrix that is never stored. The "operator_action" option points to the action that assembles
+/// the system (usually a Proto expression adding element matrices to the system matrix). Outside of
+/// a product, add_values only accumulates the diagonal, which is used as Jacobi preconditioner.
+/// To compute y = A*x, the operator action is executed again and each element matrix it adds is
+/// multiplied with the element values of x and added to y. The RHS of the system is restored after
+/// each pass, so the operator action may assemble the RHS as well.
+/// Dirichlet conditions are stored as a list of rows (and, for the symmetric variant, columns) and
+/// applied after each product. Conditions that the operator action applies during a product are
+/// ignored, since they were recorded when the system was assembled.
+class LSS_API TrilinosMatrixFree : public LSS::Matrix, public ThyraOperator {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "TrilinosMatrixFree"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "Trilinos"; }
+
+  /// Accessor to the flag if matrix, solution and rhs are tied together or not
+  const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs) { return false; }
+
+  /// Default constructor
+  TrilinosMatrixFree(const std::string& name);
+
+  ~TrilinosMatrixFree();
+
+  /// Setup the work vectors, using the layout of the solution. The connectivity is not used.
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+  void create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Not supported, there are no stored entries
+  void set_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Not supported, there are no stored entries
+  void add_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Only diagonal entries can be read
+  void get_value(const Uint icol, const Uint irow, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Not supported, element matrices can only be added
+  void set_values(const BlockAccumulator& values);
+
+  /// Accumulate the diagonal, or multiply with the element values of the input vector during a product
+  void add_values(const BlockAccumulator& values);
+
+  /// Not supported, there are no stored entries
+  void get_values(BlockAccumulator& values);
+
+  /// Mark the row as dirichlet row. Only a zero offdiagval is supported.
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Not supported, there are no stored entries
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs);
+
+  /// The contribution of the columns to the RHS is computed using a single pass of the operator action
+  void symmetric_dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& ieqs, const std::vector<Real>& values, Vector& rhs);
+
+  /// Not supported
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Not supported, the diagonal follows from the element matrices
+  void set_diagonal(const std::vector<Real>& diag);
+
+  /// Not supported, the diagonal follows from the element matrices
+  void add_diagonal(const std::vector<Real>& diag);
+
+  /// Get the diagonal, as accumulated during the last assembly
+  void get_diagonal(std::vector<Real>& diag);
+
+  /// Reset the diagonal and the dirichlet conditions. Only resetting to zero is supported.
+  void reset(Real reset_to=0.);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() { cf3_assert(m_is_created); return m_blockrow_size; }
+
+  /// Accessor to the number of block columns
+  const Uint blockcol_size() { cf3_assert(m_is_created); return m_blockrow_size; }
+
+  void clone_to(Matrix& other);
+
+  //@} END MISCELLANEOUS
+
+  /// @name LINEAR ALGEBRA
+  //@{
+
+  /// Compute y = alpha*A*x + beta*y
+  void apply(const Handle<Vector>& y, const Handle<Vector const>& x, const Real alpha = 1., const Real beta = 0.);
+
+  //@} END LINEAR ALGEBRA
+
+  /// @name TEST ONLY
+  //@{
+
+  /// Only the diagonal is exported
+  void debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+  virtual Teuchos::RCP< const Thyra::LinearOpBase< Real > > thyra_operator() const;
+  virtual Teuchos::RCP< Thyra::LinearOpBase< Real > > thyra_operator();
+
+  /// Inverse of the diagonal, if the jacobi_preconditioner option is set
+  virtual Teuchos::RCP< const Thyra::PreconditionerBase< Real > > thyra_preconditioner() const;
+
+  /// Compute m_result = A*m_x. The owned entries of m_x must be set, ghosts are synchronized here.
+  void compute_product();
+
+  /// Work vector holding the input of a product
+  TrilinosVector& input_vector() { return *m_x; }
+
+  /// Work vector holding the result of a product
+  TrilinosVector& result_vector() { return *m_result; }
+
+private:
+
+  /// Execute the operator action, with all element matrices multiplied with m_x and added to m_result.
+  /// @throw common::SetupError if it is called again from the operator action
+  void operator_pass();
+
+  /// Create the work vectors, with the same layout as the solution
+  void create_work_vectors(LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// Action that adds the element matrices to this matrix
+  Handle<common::Action> m_operator_action;
+
+  /// RHS of the system, saved and restored around each pass of the operator action
+  Handle<TrilinosVector> m_rhs;
+  Handle<TrilinosVector> m_rhs_backup;
+
+  /// Input and result of a product
+  Handle<TrilinosVector> m_x;
+  Handle<TrilinosVector> m_result;
+
+  /// Diagonal, accumulated during assembly
+  Handle<TrilinosVector> m_diagonal;
+
+  /// Inverse diagonal, for the preconditioner
+  Handle<TrilinosVector> m_inverse_diagonal;
+
+  /// Epetra wrapper calling compute_product
+  Teuchos::RCP<Epetra_Operator> m_epetra_operator;
+
+  /// True while the operator action is executed for a product
+  bool m_computing_product;
+
+  /// Work storage for the element values
+  BlockAccumulator m_element_values;
+
+  /// Dirichlet rows (as blockrow*neq+ieq), with their diagonal value
+  std::map<Uint, Real> m_dirichlet_rows;
+
+  /// Rows that were set using symmetric_dirichlet, for which the column is eliminated as well
+  std::set<Uint> m_dirichlet_columns;
+
+  bool m_is_created;
+  Uint m_neq;
+  Uint m_blockrow_size;
+}; // end of class TrilinosMatrixFree
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_TrilinosMatrixFree_hpp
@@ -8,6 +8,7 @@
 
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/for_each.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/bind.hpp>
 
 #include "Teuchos_ConfigDefs.hpp"
@@ -27,6 +28,7 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/Timer.hpp"
 
 #include "ParameterList.hpp"
 #include "ThyraVector.hpp"
@@ -131,7 +133,7 @@ struct TrilinosStratimikosStrategy::Implementation
     m_iteration_count = 0;
   }
 
-  void solve()
+  SolveTelemetry solve()
   {
     if(is_null(m_matrix))
       throw common::SetupError(FromHere(), "Null matrix for " + m_self.uri().path());
@@ -142,6 +144,9 @@ struct TrilinosStratimikosStrategy::Implementation
     if(is_null(m_solution))
       throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
 
+    SolveTelemetry telemetry;
+    common::Timer timer;
+
     if(m_lows.is_null())
     {
       if(m_self.options().option("print_settings").value<bool>())
@@ -151,15 +156,25 @@ struct TrilinosStratimikosStrategy::Implementation
     }
 
     
-    if(m_iteration_count % m_preconditioner_reset == 0)
+    Teuchos::RCP< const Thyra::PreconditionerBase<Real> > operator_preconditioner = m_matrix->thyra_preconditioner();
+    if(!operator_preconditioner.is_null())
+    {
+      Thyra::initializePreconditionedOp<Real>(*m_lows_factory, m_matrix->thyra_operator(), operator_preconditioner, m_lows.ptr());
+      telemetry.preconditioner_rebuilt = true;
+    }
+    else if(m_iteration_count % m_preconditioner_reset == 0)
     {
       Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+      telemetry.preconditioner_rebuilt = true;
     }
     else
     {
       Thyra::initializeAndReuseOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
     }
 
+    telemetry.setup_time = timer.elapsed();
+    timer.restart();
+
     Teuchos::RCP< Thyra::VectorBase<Real> const > b = m_rhs->thyra_vector();
     Teuchos::RCP< Thyra::VectorBase<Real> > x = m_solution->thyra_vector();
     
@@ -167,16 +182,37 @@ struct TrilinosStratimikosStrategy::Implementation
     {
       Thyra::SolveStatus<double> status = Thyra::solve<double>(*m_lows, Thyra::NOTRANS, *b, x.ptr());
       CFinfo << "Thyra::solve finished with status " << status.message << CFendl;
+
+      // The iteration count is reported by the solver adapters, e.g. as "Belos/Iteration Count"
+      if(!status.extraParameters.is_null())
+      {
+        const Teuchos::ParameterList& extra_parameters = *status.extraParameters;
+        for(Teuchos::ParameterList::ConstIterator it = extra_parameters.begin(); it != extra_parameters.end(); ++it)
+        {
+          if(boost::ends_with(extra_parameters.name(it), "Iteration Count"))
+            telemetry.iterations = Teuchos::getValue<int>(extra_parameters.entry(it));
+        }
+      }
+      if(status.achievedTol != Thyra::SolveStatus<double>::unknownTolerance())
+        telemetry.relative_residual = status.achievedTol;
     }
     catch(std::exception& e)
     {
       std::cout << e.what() << std::endl;
     }
+
+    telemetry.solve_time = timer.elapsed();
     
     if(m_self.options().option("compute_residual").value<bool>())
-      CFinfo << "Solver residual: " << compute_residual() << CFendl;
+    {
+      const Real residual = compute_residual();
+      CFinfo << "Solver residual: " << residual << CFendl;
+      telemetry.residuals.push_back(residual);
+    }
     
     ++m_iteration_count;
+
+    return telemetry;
   }
 
   Real compute_residual()
@@ -267,7 +303,7 @@ void TrilinosStratimikosStrategy::set_solution(const Handle< Vector >& solution)
 
 void TrilinosStratimikosStrategy::solve()
 {
-  m_implementation->solve();
+  publish_telemetry(m_implementation->solve());
 }
 
 Real TrilinosStratimikosStrategy::compute_residual()
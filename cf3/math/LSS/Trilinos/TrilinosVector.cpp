@@ -6,12 +6,18 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 #include "common/Assertions.hpp"
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
+#include "common/MemoryPlacement.hpp"
 #include "common/OptionList.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/Signal.hpp"
+#include "common/ThreadPool.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 #include "math/LSS/Trilinos/TrilinosDetail.hpp"
@@ -41,6 +47,67 @@ common::ComponentBuilder < LSS::TrilinosVector, LSS::Vector, LSS::LibLSS > Trili
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+  /// Smallest number of entries handled by each thread in the vector kernels, so short vectors don't pay for the threads
+  const Uint min_entries_per_thread = 16384;
+
+  /// Maximum number of threads for a kernel over nb_entries entries. Large vectors use the whole pool.
+  Uint kernel_threads(const Uint nb_entries)
+  {
+    return std::max(1u, nb_entries / min_entries_per_thread);
+  }
+
+  Real* entries(std::vector<Real>& data)
+  {
+    return data.empty() ? 0 : &data[0];
+  }
+
+  const Real* entries(const std::vector<Real>& data)
+  {
+    return data.empty() ? 0 : &data[0];
+  }
+
+  /// w += alpha*x on [begin, end)
+  void axpy_range(Real* w, const Real alpha, const Real* x, const Uint begin, const Uint end)
+  {
+    for(Uint i = begin; i != end; ++i)
+      w[i] += alpha*x[i];
+  }
+
+  /// w = alpha*x + beta*y on [begin, end), w may be the same as x or y
+  void waxpby_range(Real* w, const Real alpha, const Real* x, const Real beta, const Real* y, const Uint begin, const Uint end)
+  {
+    for(Uint i = begin; i != end; ++i)
+      w[i] = alpha*x[i] + beta*y[i];
+  }
+
+  /// w = a*b on [begin, end)
+  void multiply_range(Real* w, const Real* a, const Real* b, const Uint begin, const Uint end)
+  {
+    for(Uint i = begin; i != end; ++i)
+      w[i] = a[i]*b[i];
+  }
+
+  /// w = a/b on [begin, end)
+  void divide_range(Real* w, const Real* a, const Real* b, const Uint begin, const Uint end)
+  {
+    for(Uint i = begin; i != end; ++i)
+      w[i] = a[i]/b[i];
+  }
+
+  /// Sum of a*b on [begin, end)
+  Real dot_range(const Real* a, const Real* b, const Uint begin, const Uint end)
+  {
+    Real sum = 0.;
+    for(Uint i = begin; i != end; ++i)
+      sum += a[i]*b[i];
+    return sum;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 TrilinosVector::TrilinosVector(const std::string& name) :
   LSS::Vector(name),
   m_neq(0),
@@ -79,6 +146,7 @@ void TrilinosVector::create_blocked(common::PE::CommPattern& cp, const Variables
   create_map_data(cp, vars, m_p2m, myglobalelements, my_ranks, nmyglobalelements, periodic_links_nodes, periodic_links_active);
 
   m_data.resize(myglobalelements.size());
+  common::place_new_rows(m_data, 0);
 
   std::vector<Uint> gids(myglobalelements.begin(), myglobalelements.end()); // need Uint data for GIDs
 
@@ -311,6 +379,59 @@ void TrilinosVector::set( boost::multi_array<Real, 2>& data)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+void TrilinosVector::get_block(boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(vector_offset + nb_eqs <= m_neq);
+  const Uint nb_rows = is_null(node_map) ? data.size() : node_map->size();
+  cf3_assert(nb_rows <= data.size());
+  cf3_assert(nb_rows == 0 || data_offset + nb_eqs <= data.shape()[1]);
+  const int* p2m = m_p2m.empty() ? 0 : &m_p2m[0];
+  const Real* vec_data = m_data.empty() ? 0 : &m_data[0];
+  // The entries of a row are only contiguous for row-major tables, so both strides are used
+  const boost::multi_array<Real, 2>::index row_stride = data.strides()[0];
+  const boost::multi_array<Real, 2>::index column_stride = data.strides()[1];
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    const int blockrow = is_null(node_map) ? static_cast<int>(i) : (*node_map)[i];
+    if(blockrow < 0)
+      continue;
+    cf3_assert(static_cast<Uint>(blockrow) < m_blockrow_size);
+    const int* row_map = p2m + blockrow*m_neq + vector_offset;
+    Real* row = data.data() + i*row_stride + data_offset*column_stride;
+    for(Uint j = 0; j != nb_eqs; ++j)
+      row[j*column_stride] = vec_data[row_map[j]];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::set_block(const boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(vector_offset + nb_eqs <= m_neq);
+  const Uint nb_rows = is_null(node_map) ? data.size() : node_map->size();
+  cf3_assert(nb_rows <= data.size());
+  cf3_assert(nb_rows == 0 || data_offset + nb_eqs <= data.shape()[1]);
+  const int* p2m = m_p2m.empty() ? 0 : &m_p2m[0];
+  Real* vec_data = m_data.empty() ? 0 : &m_data[0];
+  const boost::multi_array<Real, 2>::index row_stride = data.strides()[0];
+  const boost::multi_array<Real, 2>::index column_stride = data.strides()[1];
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    const int blockrow = is_null(node_map) ? static_cast<int>(i) : (*node_map)[i];
+    if(blockrow < 0)
+      continue;
+    cf3_assert(static_cast<Uint>(blockrow) < m_blockrow_size);
+    const int* row_map = p2m + blockrow*m_neq + vector_offset;
+    const Real* row = data.data() + i*row_stride + data_offset*column_stride;
+    for(Uint j = 0; j != nb_eqs; ++j)
+      vec_data[row_map[j]] = row[j*column_stride];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosVector::print(common::LogStream& stream)
 {
   if (m_is_created)
@@ -369,6 +490,15 @@ void TrilinosVector::print_native(ostream& stream)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+Real TrilinosVector::memory_bytes() const
+{
+  // The epetra vector is a view on m_data
+  return static_cast<Real>(m_data.capacity()) * sizeof(Real)
+    + static_cast<Real>(m_p2m.capacity() + m_converted_indices.capacity()) * sizeof(int);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosVector::debug_data(std::vector<Real>& values)
 {
   cf3_assert(m_is_created);
@@ -413,7 +543,10 @@ void TrilinosVector::clone_to(Vector &other)
   if(is_null(other_ptr))
     throw common::SetupError(FromHere(), "clone_to method of TrilinosVector needs another TrilinosVector, but a " + other.derived_type_name() + " was supplied instead.");
 
-  other_ptr->m_data = m_data;
+  // The copy is written to zeroed entries, which are placed like those of this vector
+  other_ptr->m_data.assign(m_data.size(), 0.);
+  common::place_new_rows(other_ptr->m_data, 0);
+  std::copy(m_data.begin(), m_data.end(), other_ptr->m_data.begin());
   other_ptr->m_vec = Teuchos::rcp(new Epetra_Vector(View, *m_map, &other_ptr->m_data[0]));
   other_ptr->m_map = m_map;
   other_ptr->m_neq = m_neq;
@@ -482,6 +615,120 @@ void TrilinosVector::scale ( const Real alpha )
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+
+// The element-wise operations are single loops over contiguous storage, so the compiler can vectorize them.
+// They run on the ThreadPool with the static schedule over all entries. Vectors that are large enough to use every
+// thread of the pool then process each block on the thread that placed it when first touch is enabled (see
+// common::MemoryPlacement); this does not hold for products called from within pool tasks, whose blocks go to any
+// free thread. Ghost entries are included, so the result is consistent without a sync if the arguments were.
+
+void TrilinosVector::axpby ( const Vector& source, const Real alpha, const Real beta )
+{
+  const Real* x = entries(compatible_vector(source, "axpby").m_data);
+  Real* w = entries(m_data);
+  const Uint size = m_data.size();
+
+  if(beta == 1.)
+    common::ThreadPool::instance().parallel_for(0, size, boost::bind(axpy_range, w, alpha, x, _1, _2), common::ThreadPool::STATIC, 0, kernel_threads(size));
+  else
+    common::ThreadPool::instance().parallel_for(0, size, boost::bind(waxpby_range, w, alpha, x, beta, w, _1, _2), common::ThreadPool::STATIC, 0, kernel_threads(size));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::waxpby ( const Real alpha, const Vector& x, const Real beta, const Vector& y )
+{
+  const Real* x_data = entries(compatible_vector(x, "waxpby").m_data);
+  const Real* y_data = entries(compatible_vector(y, "waxpby").m_data);
+  const Uint size = m_data.size();
+
+  common::ThreadPool::instance().parallel_for(0, size, boost::bind(waxpby_range, entries(m_data), alpha, x_data, beta, y_data, _1, _2), common::ThreadPool::STATIC, 0, kernel_threads(size));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::multiply ( const Vector& a, const Vector& b )
+{
+  const Real* a_data = entries(compatible_vector(a, "multiply").m_data);
+  const Real* b_data = entries(compatible_vector(b, "multiply").m_data);
+  const Uint size = m_data.size();
+
+  common::ThreadPool::instance().parallel_for(0, size, boost::bind(multiply_range, entries(m_data), a_data, b_data, _1, _2), common::ThreadPool::STATIC, 0, kernel_threads(size));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::divide ( const Vector& a, const Vector& b )
+{
+  const Real* a_data = entries(compatible_vector(a, "divide").m_data);
+  const Real* b_data = entries(compatible_vector(b, "divide").m_data);
+  const Uint size = m_data.size();
+
+  common::ThreadPool::instance().parallel_for(0, size, boost::bind(divide_range, entries(m_data), a_data, b_data, _1, _2), common::ThreadPool::STATIC, 0, kernel_threads(size));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real TrilinosVector::dot ( const Vector& other ) const
+{
+  std::vector<Vector const*> others(1, &other);
+  std::vector<Real> results;
+  dot(others, results);
+  return results.front();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::dot ( const std::vector<Vector const*>& others, std::vector<Real>& results ) const
+{
+  const Uint nb_vectors = others.size();
+  // Only the owned entries, which come first, take part in the sum
+  const Uint nb_owned = m_map->NumMyElements();
+  const Real* v = entries(m_data);
+
+  // The local sums are combined in a fixed order, so they only depend on the number of threads
+  std::vector<Real> local_results(nb_vectors, 0.);
+  for(Uint j = 0; j != nb_vectors; ++j)
+  {
+    const Real* x = entries(compatible_vector(*others[j], "dot").m_data);
+    local_results[j] = common::ThreadPool::instance().parallel_reduce<Real>(0, nb_owned, boost::bind(dot_range, v, x, _1, _2), 0., std::plus<Real>(), kernel_threads(nb_owned));
+  }
+
+  results.resize(nb_vectors);
+  if(nb_vectors != 0)
+    m_comm.SumAll(&local_results[0], &results[0], nb_vectors);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real TrilinosVector::norm2 () const
+{
+  const Uint nb_owned = m_map->NumMyElements();
+  const Real* v = entries(m_data);
+
+  Real local_sum = common::ThreadPool::instance().parallel_reduce<Real>(0, nb_owned, boost::bind(dot_range, v, v, _1, _2), 0., std::plus<Real>(), kernel_threads(nb_owned));
+
+  Real sum = 0.;
+  m_comm.SumAll(&local_sum, &sum, 1);
+  return std::sqrt(sum);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const TrilinosVector& TrilinosVector::compatible_vector ( const Vector& other, const std::string& operation ) const
+{
+  TrilinosVector const* other_ptr = dynamic_cast<TrilinosVector const*>(&other);
+
+  if(is_null(other_ptr))
+    throw common::SetupError(FromHere(), operation + " method of TrilinosVector needs another TrilinosVector, but a " + other.derived_type_name() + " was supplied instead.");
+
+  if(other_ptr->m_data.size() != m_data.size())
+    throw common::SetupError(FromHere(), operation + " method of TrilinosVector got a vector with incorrect size");
+
+  return *other_ptr;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
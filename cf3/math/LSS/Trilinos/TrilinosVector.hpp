@@ -15,6 +15,7 @@
 #include <Epetra_Vector.h>
 #include <Teuchos_RCP.hpp>
 
+#include "common/AccountedComponent.hpp"
 #include "math/LSS/LibLSS.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
 #include "math/LSS/Vector.hpp"
@@ -47,7 +48,7 @@ namespace LSS {
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
-class LSS_API TrilinosVector : public LSS::Vector, public ThyraVector {
+class LSS_API TrilinosVector : public LSS::Vector, public ThyraVector, public common::AccountedComponent {
 public:
 
   /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
@@ -125,6 +126,12 @@ public:
   /// Copies the contents of the table into the LSS::Vector.
   void set( boost::multi_array<Real, 2>& data);
 
+  /// Copy a block of equations to a table, reading the data array directly
+  void get_block(boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs);
+
+  /// Copy a block of equations from a table, writing the data array directly
+  void set_block(const boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs);
+
   //@} END EFFICCIENT ACCESS
 
   /// @name MISCELLANEOUS
@@ -144,6 +151,9 @@ public:
   /// Accessor to the state of create
   const bool is_created() { return m_is_created; };
 
+  /// Bytes used by the vector data and the index mapping
+  virtual Real memory_bytes() const;
+
   /// Accessor to the number of equations
   const Uint neq() { return m_neq; };
 
@@ -163,6 +173,20 @@ public:
   
   void scale ( const Real alpha );
 
+  void axpby ( const Vector& source, const Real alpha, const Real beta );
+
+  void waxpby ( const Real alpha, const Vector& x, const Real beta, const Vector& y );
+
+  void multiply ( const Vector& a, const Vector& b );
+
+  void divide ( const Vector& a, const Vector& b );
+
+  Real dot ( const Vector& other ) const;
+
+  void dot ( const std::vector<Vector const*>& others, std::vector<Real>& results ) const;
+
+  Real norm2 () const;
+
   void sync();
 
   //@} END MISCELLANEOUS
@@ -183,6 +207,10 @@ public:
   
 private:
 
+  /// Cast the argument of a vector operation to a TrilinosVector with the same layout as this one
+  /// @throw SetupError if the vector has a different type or size
+  const TrilinosVector& compatible_vector(const Vector& other, const std::string& operation) const;
+
   /// Actual vector data. The epetra vector is a view for this that omits the ghost nodes
   std::vector<Real> m_data;
   
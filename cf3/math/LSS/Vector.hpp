@@ -113,6 +113,38 @@ public:
   /// Copies the contents of the table into the LSS::Vector.
   virtual void set( boost::multi_array<Real, 2>& data) = 0;
 
+  /// Copy a block of equations to a table in one pass. Row i of data receives equations [vector_offset, vector_offset+nb_eqs)
+  /// of block row (*node_map)[i] in its columns [data_offset, data_offset+nb_eqs). Rows with a negative map entry are skipped.
+  /// If node_map is null, row i maps to block row i.
+  virtual void get_block(boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs)
+  {
+    const Uint nb_rows = is_null(node_map) ? data.size() : node_map->size();
+    cf3_assert(nb_rows <= data.size());
+    for(Uint i = 0; i != nb_rows; ++i)
+    {
+      const int blockrow = is_null(node_map) ? static_cast<int>(i) : (*node_map)[i];
+      if(blockrow < 0)
+        continue;
+      for(Uint j = 0; j != nb_eqs; ++j)
+        get_value(blockrow, vector_offset+j, data[i][data_offset+j]);
+    }
+  }
+
+  /// Copy a block of equations from a table in one pass. This is the reverse of get_block.
+  virtual void set_block(const boost::multi_array<Real, 2>& data, const boost::multi_array<int, 1>* node_map, const Uint data_offset, const Uint vector_offset, const Uint nb_eqs)
+  {
+    const Uint nb_rows = is_null(node_map) ? data.size() : node_map->size();
+    cf3_assert(nb_rows <= data.size());
+    for(Uint i = 0; i != nb_rows; ++i)
+    {
+      const int blockrow = is_null(node_map) ? static_cast<int>(i) : (*node_map)[i];
+      if(blockrow < 0)
+        continue;
+      for(Uint j = 0; j != nb_eqs; ++j)
+        set_value(blockrow, vector_offset+j, data[i][data_offset+j]);
+    }
+  }
+
   //@} END EFFICCIENT ACCESS
 
   /// @name MISCELLANEOUS
@@ -153,6 +185,33 @@ public:
   /// this *= alpha
   virtual void scale(const Real alpha) = 0;
 
+  /// Combined scale and update, i.e.:
+  /// this = alpha*source + beta*this
+  virtual void axpby(const Vector& source, const Real alpha, const Real beta) = 0;
+
+  /// Overwrite this vector with a linear combination of two others, i.e.:
+  /// this = alpha*x + beta*y
+  /// This vector may be one of the arguments.
+  virtual void waxpby(const Real alpha, const Vector& x, const Real beta, const Vector& y) = 0;
+
+  /// Element-wise product, i.e.:
+  /// this[i] = a[i]*b[i]
+  virtual void multiply(const Vector& a, const Vector& b) = 0;
+
+  /// Element-wise quotient, i.e.:
+  /// this[i] = a[i]/b[i]
+  virtual void divide(const Vector& a, const Vector& b) = 0;
+
+  /// Dot product with another vector, summed over all processes. Ghost entries are not counted.
+  virtual Real dot(const Vector& other) const = 0;
+
+  /// Dot products of this vector with each of the others, using a single global reduction.
+  /// results is resized to others.size()
+  virtual void dot(const std::vector<Vector const*>& others, std::vector<Real>& results) const = 0;
+
+  /// Euclidean norm over all processes
+  virtual Real norm2() const = 0;
+
   /// Update any stored ghost nodes
   virtual void sync() = 0;
 
@@ -8,6 +8,7 @@
 #include "common/PropertyList.hpp"
 #include "common/Builder.hpp"
 
+#include "math/LSS/StaticCondensation.hpp"
 #include "math/LSS/System.hpp"
 
 #include "ZeroLSS.hpp"
@@ -66,12 +67,16 @@ void ZeroLSS::execute ()
   {
     CFdebug << "Resetting matrix " << m_lss->matrix()->uri().string() << CFendl;
     m_lss->matrix()->reset();
+    if(is_not_null(m_lss->static_condensation()))
+      m_lss->static_condensation()->reset_matrix();
   }
 
   if(reset_rhs)
   {
     CFdebug << "Resetting RHS " << m_lss->rhs()->uri().string() << CFendl;
     m_lss->rhs()->reset();
+    if(is_not_null(m_lss->static_condensation()))
+      m_lss->static_condensation()->reset_rhs();
   }
 
   if(reset_solution)
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/algorithm/string/trim.hpp>
 #include <boost/tokenizer.hpp>
 
 #include "common/Log.hpp"
@@ -62,6 +63,7 @@ void VectorialFunction::clear()
 {
   m_is_parsed = false;
   m_result.resize(0);
+  m_compiled = CompiledFunction();
   for(Uint i = 0; i < m_parsers.size(); i++) {
       delete_ptr(m_parsers[i]);
   }
@@ -173,6 +175,25 @@ void VectorialFunction::parse()
     }
   }
 
+  // Compile for faster evaluation, keeping the parsers for the syntax the compiler does not support
+  std::vector<std::string> variable_names;
+  boost::char_separator<char> sep(",");
+  typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+  tokenizer tok (m_vars,sep);
+  for (tokenizer::iterator el=tok.begin(); el!=tok.end(); ++el)
+    variable_names.push_back(boost::algorithm::trim_copy(*el));
+
+  try
+  {
+    m_compiled.add_constant("pi", Consts::pi());
+    m_compiled.compile(m_functions, variable_names);
+  }
+  catch(common::Exception& e)
+  {
+    CFdebug << "VectorialFunction: using the function parser for " << m_functions.size() << " functions: " << e.what() << CFendl;
+    m_compiled = CompiledFunction();
+  }
+
   m_result.resize(m_functions.size());
   m_is_parsed = true;
 }
@@ -184,6 +205,12 @@ RealVector& VectorialFunction::operator()( const VariablesT& var_values)
   cf3_assert(m_is_parsed);
   cf3_assert(var_values.size() == m_nbvars);
 
+  if(m_compiled.is_compiled())
+  {
+    m_compiled.evaluate(var_values, m_result);
+    return m_result;
+  }
+
   // evaluate and store the functions line by line in the result vector
   std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
   std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
@@ -201,6 +228,12 @@ RealVector& VectorialFunction::operator()( const RealVector& var_values)
   cf3_assert(m_is_parsed);
   cf3_assert(var_values.size() == m_nbvars);
 
+  if(m_compiled.is_compiled())
+  {
+    m_compiled.evaluate(var_values, m_result);
+    return m_result;
+  }
+
   // evaluate and store the functions line by line in the result vector
   std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
   std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
@@ -213,6 +246,26 @@ RealVector& VectorialFunction::operator()( const RealVector& var_values)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void VectorialFunction::evaluate_batch( const Real* variables, const Uint variables_stride, Real* results, const Uint results_stride, const Uint nb_points) const
+{
+  cf3_assert(m_is_parsed);
+
+  if(m_compiled.is_compiled())
+  {
+    m_compiled.evaluate(variables, variables_stride, results, results_stride, nb_points);
+    return;
+  }
+
+  const Uint nb_funcs = m_parsers.size();
+  for(Uint pt = 0; pt != nb_points; ++pt)
+  {
+    for(Uint i = 0; i != nb_funcs; ++i)
+      results[pt*results_stride + i] = m_parsers[i]->Eval(variables + pt*variables_stride);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // math
 } // cf3
 
@@ -13,6 +13,7 @@
 
 #include "common/BasicExceptions.hpp"
 
+#include "math/CompiledFunction.hpp"
 #include "math/LibMath.hpp"
 #include "math/MatrixTypes.hpp"
 
@@ -25,7 +26,10 @@ namespace cf3 {
 ////////////////////////////////////////////////////////////////////////////////
 
 /// This class represents an analytical function that
-/// defines the values for a vector field
+/// defines the values for a vector field.
+/// The functions are checked using FunctionParser and then compiled into a
+/// CompiledFunction, which is used for the evaluation. Functions using syntax that
+/// the compiler does not support are evaluated by FunctionParser instead.
 /// @author Tiago Quintino
 class Math_API VectorialFunction {
 
@@ -59,6 +63,11 @@ public: // functions
   template <typename var_t, typename ret_t>
   void evaluate( const var_t& var_values, ret_t& ret_value) const;
 
+  /// Evaluate the Vectorial Function for a batch of points. This is reentrant if is_compiled() is true.
+  /// @param variables the variables for point i start at variables[i*variables_stride]
+  /// @param results the results for point i are written starting at results[i*results_stride]
+  void evaluate_batch( const Real* variables, const Uint variables_stride, Real* results, const Uint results_stride, const Uint nb_points) const;
+
   /// Evaluate the Vectorial Function given the values of the variables
   /// and return it in the stored result. This function allows this class to work
   /// as a functor.
@@ -74,6 +83,9 @@ public: // functions
   /// @return if the VectorialFunctionParser has been parsed yet.
   bool is_parsed() const { return m_is_parsed; }
 
+  /// @return if the functions are evaluated using the CompiledFunction
+  bool is_compiled() const { return m_compiled.is_compiled(); }
+
   /// sets the function strings to be parsed
   void functions( const std::vector<std::string>& functions );
 
@@ -125,6 +137,9 @@ private: // data
   /// storage of the result for using the class as functor
   RealVector m_result;
 
+  /// compiled version of the functions, used for evaluation when available
+  CompiledFunction m_compiled;
+
 }; // VectorialFunction
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -135,6 +150,12 @@ void VectorialFunction::evaluate(const var_t& var_values, ret_t& ret_value) cons
   cf3_assert(m_is_parsed);
   cf3_assert(var_values.size() == m_nbvars);
 
+  if(m_compiled.is_compiled())
+  {
+    m_compiled.evaluate(var_values, ret_value);
+    return;
+  }
+
   // evaluate and store the functions line by line in the vector
   std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
   std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
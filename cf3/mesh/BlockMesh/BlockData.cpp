@@ -37,6 +37,7 @@
 #include "mesh/Region.hpp"
 #include "mesh/ElementData.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/StructuredBlocks.hpp"
 
 #include "mesh/LagrangeP1/Hexa3D.hpp"
 #include "mesh/LagrangeP1/Line1D.hpp"
@@ -507,6 +508,30 @@ struct BlockArrays::Implementation
     }
   }
 
+  /// Add the lattice of node indices of a block to its structured description
+  void add_structured_block(const Table<Uint>::ConstRow& segments, const Uint block_idx, StructuredBlocks& structured_blocks)
+  {
+    const std::vector<Uint> block_segments(segments.begin(), segments.end());
+    std::vector<Uint> lattice_nodes;
+    if(segments.size() == 3)
+    {
+      lattice_nodes.reserve((segments[XX]+1)*(segments[YY]+1)*(segments[ZZ]+1));
+      for(Uint k = 0; k <= segments[ZZ]; ++k)
+        for(Uint j = 0; j <= segments[YY]; ++j)
+          for(Uint i = 0; i <= segments[XX]; ++i)
+            lattice_nodes.push_back(to_local(block_list[block_idx][i][j][k].global_idx()));
+    }
+    else
+    {
+      cf3_assert(segments.size() == 2);
+      lattice_nodes.reserve((segments[XX]+1)*(segments[YY]+1));
+      for(Uint j = 0; j <= segments[YY]; ++j)
+        for(Uint i = 0; i <= segments[XX]; ++i)
+          lattice_nodes.push_back(to_local(block_list[block_idx][i][j].global_idx()));
+    }
+    structured_blocks.add_block(block_segments, lattice_nodes);
+  }
+
   /// Create the block coordinates
   template<typename ET>
   void fill_block_coordinates_3d(Table<Real>& mesh_coords, const Uint block_idx)
@@ -1271,6 +1296,15 @@ BlockArrays::BlockArrays(const std::string& name) :
   options().add("overlap", 1u).pretty_name("Overlap")
     .description("Number of cell layers to overlap across parallel partitions. Ignored in serial runs");
 
+  options().add("structured_blocks", false).pretty_name("Structured Blocks")
+    .description("Keep the lattice structure of the blocks as a StructuredBlocks component in the volume elements, "
+                 "and derive the connectivity from it");
+
+  options().add("keep_connectivity", true).pretty_name("Keep Connectivity")
+    .description("With structured_blocks, also store the unstructured connectivity of the volume elements. "
+                 "Without it, only code that uses the block lattice (such as the Proto element loops) works on the volume elements. "
+                 "Only possible in serial runs");
+
   options().add("block_regions", std::vector<std::string>())
     .pretty_name("Block Regions")
     .description("For each block, the region it belongs to. Leave empty to assign each block to the region \"interior\"")
@@ -1656,20 +1690,47 @@ void BlockArrays::create_mesh(Mesh& mesh)
 
   Dictionary& geometry_dict = mesh.geometry_fields();
 
+  const bool structured = options().value<bool>("structured_blocks");
+  const bool keep_connectivity = !structured || options().value<bool>("keep_connectivity");
+  if(!keep_connectivity && nb_procs > 1)
+    throw SetupError(FromHere(), "The connectivity of structured blocks is needed in parallel runs, set keep_connectivity to true");
+
   std::map<std::string, Elements*> elements_map;
+  std::map<std::string, StructuredBlocks*> structured_map;
   for(ElementsDistT::const_iterator it = elements_dist.begin(); it != elements_dist.end(); ++it)
   {
     const std::vector<Uint>& region_elements_dist = it->second;
     Elements& volume_elements = mesh.topology().create_region(it->first).create_elements(dimensions == 3 ? "cf3.mesh.LagrangeP1.Hexa3D" : "cf3.mesh.LagrangeP1.Quad2D", geometry_dict);
     volume_elements.resize(region_elements_dist[rank+1]-region_elements_dist[rank]);
     elements_map[it->first] = &volume_elements;
+    if(structured)
+    {
+      StructuredBlocks& structured_blocks = *volume_elements.create_component<StructuredBlocks>(StructuredBlocks::default_name());
+      structured_blocks.initialize(dimensions);
+      structured_map[it->first] = &structured_blocks;
+    }
   }
 
   // Set the connectivity, this also updates ghost node indices
   std::map<std::string, Uint> element_idx_map; // global element index per region
   for(Uint block_idx = blocks_begin; block_idx != blocks_end; ++block_idx)
   {
-    m_implementation->add_block(block_subdivisions[block_idx], block_idx, elements_map[m_implementation->block_regions[block_idx]]->geometry_space().connectivity(), element_idx_map[m_implementation->block_regions[block_idx]]);
+    const std::string& region_name = m_implementation->block_regions[block_idx];
+    if(structured)
+      m_implementation->add_structured_block(block_subdivisions[block_idx], block_idx, *structured_map[region_name]);
+    else
+      m_implementation->add_block(block_subdivisions[block_idx], block_idx, elements_map[region_name]->geometry_space().connectivity(), element_idx_map[region_name]);
+  }
+
+  // Structured blocks compute the connectivity from their lattice, or leave it empty
+  for(std::map<std::string, StructuredBlocks*>::const_iterator it = structured_map.begin(); it != structured_map.end(); ++it)
+  {
+    Connectivity& connectivity = elements_map[it->first]->geometry_space().connectivity();
+    cf3_assert(connectivity.size() == it->second->nb_elements());
+    if(keep_connectivity)
+      it->second->fill_connectivity(connectivity);
+    else
+      it->second->clear_connectivity(connectivity);
   }
 
   const Uint nodes_begin = m_implementation->nodes_dist[rank];
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
 
 #include "common/Signal.hpp"
@@ -44,6 +46,15 @@ Field::Field ( const std::string& name  ) :
   properties()["date"] = boost::gregorian::to_iso_extended_string(boost::gregorian::day_clock::local_day());
   properties()["time"] = 0.;
   properties()["step"] = 0u;
+
+  std::vector<boost::any> layouts = boost::assign::list_of
+      (std::string("AoS"))
+      (std::string("SoA"));
+  options().add("layout", std::string("AoS"))
+      .pretty_name("Layout")
+      .description("Memory layout of the data. AoS stores the variables of each node together, SoA stores each column contiguously.")
+      .attach_trigger(boost::bind(&Field::trigger_layout, this))
+      .restricted_list() = layouts;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -264,21 +275,21 @@ Field& Field::coordinates() const
 
 Field::Ref Field::ref()
 {
-  return Ref( &array()[0][0], size(), row_size(), Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(row_size(),row_size()-1));
+  return Ref( &array()[0][0], size(), row_size(), Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(array().strides()[0],array().strides()[1]));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 Field::Ref  Field::col(const Uint c)
 {
-  return Ref( &array()[0][c], size(), 1, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(row_size(),0) );
+  return Ref( &array()[0][c], size(), 1, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(array().strides()[0],array().strides()[1]) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 Field::RowArrayRef  Field::row(const Uint r)
 {
-  return RowArrayRef( &array()[r][0], 1, row_size() );
+  return RowArrayRef( &array()[r][0], 1, row_size(), Eigen::InnerStride<Eigen::Dynamic>(array().strides()[1]) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -292,14 +303,15 @@ Real& Field::scalar(const Uint r)
 
 Field::RowVectorRef Field::vector(const Uint r)
 {
-  return RowVectorRef( &array()[r][0], 1, row_size() );
+  return RowVectorRef( &array()[r][0], 1, row_size(), Eigen::InnerStride<Eigen::Dynamic>(array().strides()[1]) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 Field::RowTensorRef Field::tensor(const Uint r)
 {
-  return RowTensorRef( &array()[r][0],  sqrt(row_size()), sqrt(row_size()));
+  const Uint dim = sqrt(row_size());
+  return RowTensorRef( &array()[r][0], dim, dim, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(dim*array().strides()[1],array().strides()[1]));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -318,5 +330,12 @@ VarType Field::var_type() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Field::trigger_layout()
+{
+  set_row_major(options().value<std::string>("layout") == "AoS");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
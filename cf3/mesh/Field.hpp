@@ -30,6 +30,11 @@ namespace mesh {
 /// Field component class
 /// This class stores fields which can be applied
 /// to fields (Field)
+///
+/// The "layout" option selects how the data is stored. The default "AoS" layout stores all
+/// variables of a node together, the "SoA" layout stores each column contiguously, which is
+/// faster for kernels that only touch a few of the variables. Indexing and the Eigen accessors
+/// work for both layouts, only code using array().data() directly needs to check is_row_major().
 /// @author Willem Deconinck, Tiago Quintino
 class Mesh_API Field : public common::Table<Real> {
 
@@ -44,13 +49,13 @@ public: // typedefs
   typedef Eigen::Block<Ref, Eigen::Dynamic, 1, false, true> RefCol;
 
   typedef Eigen::Array<Real,1,Eigen::Dynamic,Eigen::RowMajor> RowArrayStorage ;
-  typedef Eigen::Map< RowArrayStorage , Eigen::Unaligned > RowArrayRef ;
+  typedef Eigen::Map< RowArrayStorage , Eigen::Unaligned, Eigen::InnerStride<Eigen::Dynamic> > RowArrayRef ;
 
   typedef Eigen::Matrix<Real,1,Eigen::Dynamic,Eigen::RowMajor> RowVectorStorage ;
-  typedef Eigen::Map< RowVectorStorage , Eigen::Unaligned > RowVectorRef ;
+  typedef Eigen::Map< RowVectorStorage , Eigen::Unaligned, Eigen::InnerStride<Eigen::Dynamic> > RowVectorRef ;
 
   typedef Eigen::Matrix<Real,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowTensorStorage ;
-  typedef Eigen::Map< RowTensorStorage , Eigen::Unaligned > RowTensorRef ;
+  typedef Eigen::Map< RowTensorStorage , Eigen::Unaligned, Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic> > RowTensorRef ;
 
 private: // typedefs
 
@@ -319,6 +324,9 @@ public: // functions
 
 private:
 
+  /// Apply the storage order selected by the layout option
+  void trigger_layout();
+
   Handle<Dictionary> m_dict;
 
   Handle< common::PE::CommPattern > m_comm_pattern;
@@ -0,0 +1,138 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Table.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "mesh/InterpolationMatrix.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+InterpolationMatrix::InterpolationMatrix() :
+  m_row_offsets(1, 0u)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::clear()
+{
+  m_row_offsets.assign(1, 0u);
+  m_columns.clear();
+  m_weights.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::reserve(const Uint nb_rows, const Uint nb_nonzeros)
+{
+  m_row_offsets.reserve(nb_rows+1);
+  m_columns.reserve(nb_nonzeros);
+  m_weights.reserve(nb_nonzeros);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::add_row(const std::vector<Uint>& points, const std::vector<Real>& weights)
+{
+  if(points.size() != weights.size())
+    throw BadValue(FromHere(), "Interpolation row has " + to_str(static_cast<Uint>(points.size())) + " points but " + to_str(static_cast<Uint>(weights.size())) + " weights");
+
+  m_columns.insert(m_columns.end(), points.begin(), points.end());
+  m_weights.insert(m_weights.end(), weights.begin(), weights.end());
+  m_row_offsets.push_back(m_columns.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::apply_rows(const Table<Real>* source, const std::vector<Uint>* vars, Real* result, const Uint result_begin_row, const Uint begin_row, const Uint end_row) const
+{
+  const Uint nb_vars = vars->size();
+  if(nb_vars == 0)
+    return;
+
+  // Strides in the storage order of the source, so both field layouts are supported
+  const Uint row_stride = source->array().strides()[0];
+  const Uint col_stride = source->array().strides()[1];
+  const Real* source_data = source->array().data();
+  const Uint* var_idx = &(*vars)[0];
+
+  // If the variables are a contiguous range of columns, the inner loop is a plain axpy that the compiler can vectorize
+  bool contiguous = col_stride == 1;
+  for(Uint v = 1; v != nb_vars; ++v)
+  {
+    if(var_idx[v] != var_idx[0] + v)
+    {
+      contiguous = false;
+      break;
+    }
+  }
+
+  for(Uint row = begin_row; row != end_row; ++row)
+  {
+    Real* result_row = result + (row-result_begin_row)*nb_vars;
+    std::fill(result_row, result_row + nb_vars, 0.);
+
+    const Uint row_end = m_row_offsets[row+1];
+    for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+    {
+      cf3_assert(m_columns[i] < source->size());
+      const Real w = m_weights[i];
+      const Real* source_row = source_data + m_columns[i]*row_stride;
+      if(contiguous)
+      {
+        const Real* source_vars = source_row + var_idx[0];
+        for(Uint v = 0; v != nb_vars; ++v)
+          result_row[v] += w * source_vars[v];
+      }
+      else
+      {
+        for(Uint v = 0; v != nb_vars; ++v)
+          result_row[v] += w * source_row[var_idx[v]*col_stride];
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::apply(const Table<Real>& source, const std::vector<Uint>& vars, Real* result, const Uint begin_row, const Uint end_row, const Uint nb_threads) const
+{
+  cf3_assert(begin_row <= end_row);
+  cf3_assert(end_row <= nb_rows());
+
+  // Each thread gets a contiguous range of rows, writing to a disjoint part of the result
+  ThreadPool::instance().parallel_for(begin_row, end_row, boost::bind(&InterpolationMatrix::apply_rows, this, &source, &vars, result, begin_row, _1, _2), ThreadPool::STATIC, 0, nb_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InterpolationMatrix::apply(const Table<Real>& source, const std::vector<Uint>& vars, std::vector<Real>& result, const Uint nb_threads) const
+{
+  result.resize(nb_rows()*vars.size());
+  if(result.empty())
+    return;
+  apply(source, vars, &result[0], 0, nb_rows(), nb_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
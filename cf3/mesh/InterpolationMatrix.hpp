@@ -0,0 +1,88 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_InterpolationMatrix_hpp
+#define cf3_mesh_InterpolationMatrix_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include "common/Table_fwd.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Interpolation weights in compressed row storage (CSR)
+///
+/// Each row of the matrix interpolates one target point as a weighted sum of
+/// rows (points) of a source table. Applying the matrix to a set of variables is a
+/// sparse matrix times dense block product: all variables of a source row are
+/// processed together, so each stored weight is loaded only once.
+/// This is meant to store the result of APointInterpolator::compute_storage()
+/// for points that are interpolated repeatedly.
+class Mesh_API InterpolationMatrix
+{
+public:
+
+  InterpolationMatrix();
+
+  /// Remove all rows
+  void clear();
+
+  /// Reserve memory for the given number of rows and non-zero weights
+  void reserve(const Uint nb_rows, const Uint nb_nonzeros);
+
+  /// Append a row, interpolating from the given source points using the given weights
+  void add_row(const std::vector<Uint>& points, const std::vector<Real>& weights);
+
+  /// Number of rows, i.e. interpolated points
+  Uint nb_rows() const { return m_row_offsets.size() - 1; }
+
+  /// Number of stored weights
+  Uint nb_nonzeros() const { return m_columns.size(); }
+
+  /// Interpolate the given variables for rows [begin_row, end_row).
+  /// @param [in]  source  Table to interpolate from
+  /// @param [in]  vars    Columns of source to interpolate
+  /// @param [out] result  Storage for (end_row-begin_row)*vars.size() values, stored row by row
+  /// @param [in]  nb_threads  Maximum number of threads of the common::ThreadPool used to process the rows, 0 to use all threads
+  void apply(const common::Table<Real>& source, const std::vector<Uint>& vars, Real* result, const Uint begin_row, const Uint end_row, const Uint nb_threads = 1) const;
+
+  /// Interpolate the given variables for all rows.
+  /// The result vector is resized to nb_rows()*vars.size() if needed, so it can be reused between calls without reallocating.
+  void apply(const common::Table<Real>& source, const std::vector<Uint>& vars, std::vector<Real>& result, const Uint nb_threads = 1) const;
+
+  /// Start of each row in columns() and weights(), with one extra entry for the end of the last row
+  const std::vector<Uint>& row_offsets() const { return m_row_offsets; }
+
+  /// Source point for each stored weight
+  const std::vector<Uint>& columns() const { return m_columns; }
+
+  /// Stored weights
+  const std::vector<Real>& weights() const { return m_weights; }
+
+private:
+  /// Serial kernel for rows [begin_row, end_row), where result holds the rows starting at result_begin_row
+  void apply_rows(const common::Table<Real>* source, const std::vector<Uint>* vars, Real* result, const Uint result_begin_row, const Uint begin_row, const Uint end_row) const;
+
+  std::vector<Uint> m_row_offsets;
+  std::vector<Uint> m_columns;
+  std::vector<Real> m_weights;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_InterpolationMatrix_hpp
@@ -4,6 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <limits>
+
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 
@@ -17,6 +20,10 @@
 #include "common/XML/SignalOptions.hpp"
 #include "common/PE/debug.hpp"
 
+#include "math/BoundingBox.hpp"
+
+#include "mesh/BoundingBox.hpp"
+#include "mesh/Dictionary.hpp"
 #include "mesh/Interpolator.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
@@ -43,8 +50,8 @@ Interpolator::Interpolator(const std::string &name) :
   m_expect_recv(0),
   m_stored_element(0),
   m_stored_stencil(0),
-  m_stored_source_field_points(0),
-  m_stored_source_field_weights(0),
+  m_send_offsets(0),
+  m_recv_offsets(0),
   m_source_vars(0),
   m_target_vars(0)
 
@@ -53,116 +60,225 @@ Interpolator::Interpolator(const std::string &name) :
       .description("Flag to store weights and stencils used for faster interpolation in the future")
       .pretty_name("Store");
 
+  options().add("nb_threads", 0u)
+      .description("Maximum number of threads used to apply the stored weights, 0 to use the whole thread pool")
+      .pretty_name("Number of Threads");
+
   m_point_interpolator = Handle<APointInterpolator>(create_component<PointInterpolator>("point_interpolator"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Exchange variable-sized messages between all ranks in a single collective operation.
+/// send[pid] is sent to rank pid, recv[pid] is received from rank pid
 template <typename T>
-void Interpolator_send_receive(const Uint send_to_pid, std::vector<T>& send, const Uint receive_from_pid, std::vector<T>& receive)
+void Interpolator_all_to_all(const std::vector< std::vector<T> >& send, std::vector< std::vector<T> >& recv)
 {
-  if (send_to_pid == PE::Comm::instance().rank() &&
-      receive_from_pid == PE::Comm::instance().rank())
-  {
-    receive = send;
-      return;
-  }
-  size_t recv_size;
-  size_t send_size = send.size();
-  MPI_Sendrecv(&send_size, 1, PE::get_mpi_datatype<size_t>(), (int)send_to_pid, 0,
-               &recv_size, 1, PE::get_mpi_datatype<size_t>(), (int)receive_from_pid, 0,
-               PE::Comm::instance().communicator(), MPI_STATUS_IGNORE);
-  receive.resize(recv_size);
-  MPI_Sendrecv(&send[0], (int)send.size(), PE::get_mpi_datatype<T>(), (int)send_to_pid, 0,
-               &receive[0], (int)receive.size(), PE::get_mpi_datatype<T>(), (int)receive_from_pid, 0,
-               PE::Comm::instance().communicator(), MPI_STATUS_IGNORE);
+  if (PE::Comm::instance().is_active())
+    PE::Comm::instance().all_to_all(send, recv);
+  else
+    recv = send;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-
-void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coords)
+/// Point-to-point exchange in which both sides know the message sizes in advance, so
+/// only the ranks that effectively share data communicate.
+/// The values for rank pid are send[ send_offsets[pid]*stride : send_offsets[pid+1]*stride ],
+/// and are received in the same way in recv, which must be sized already.
+void Interpolator_exchange_with_neighbours(const std::vector<Real>& send, const std::vector<Uint>& send_offsets,
+                                           std::vector<Real>& recv, const std::vector<Uint>& recv_offsets, const Uint stride)
 {
-  m_dict  = dict.handle<Dictionary>();
-  m_table = target_coords.handle< Table<Real> >();
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_procs = send_offsets.size()-1;
+  std::vector<MPI_Request> requests; requests.reserve(2*nb_procs);
 
-  cf3_assert(m_point_interpolator);
-  m_point_interpolator->options().set("dict", const_cast<Dictionary*>(m_dict.get())->handle<Dictionary>());
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    const Uint recv_begin = recv_offsets[pid]*stride;
+    const Uint recv_size = recv_offsets[pid+1]*stride - recv_begin;
+    if (recv_size == 0)
+      continue;
 
-  Uint nb_coords = target_coords.size();
-  Uint dim = target_coords.row_size();
+    if (pid == rank)
+    {
+      const Uint send_begin = send_offsets[pid]*stride;
+      cf3_assert(send_offsets[pid+1]*stride - send_begin == recv_size);
+      std::copy(send.begin()+send_begin, send.begin()+send_begin+recv_size, recv.begin()+recv_begin);
+      continue;
+    }
 
-  std::vector<Uint> not_found; not_found.reserve(nb_coords);
-  for (Uint i=0; i<nb_coords; ++i)
-    not_found.push_back(i);
+    requests.push_back(MPI_Request());
+    MPI_CHECK_RESULT(MPI_Irecv, (&recv[recv_begin], (int)recv_size, PE::get_mpi_datatype<Real>(), (int)pid, 0,
+                                 PE::Comm::instance().communicator(), &requests.back()));
+  }
 
-  m_proc.resize(nb_coords,-1);
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    const Uint send_begin = send_offsets[pid]*stride;
+    const Uint send_size = send_offsets[pid+1]*stride - send_begin;
+    if (send_size == 0 || pid == rank)
+      continue;
+
+    requests.push_back(MPI_Request());
+    MPI_CHECK_RESULT(MPI_Isend, (const_cast<Real*>(&send[send_begin]), (int)send_size, PE::get_mpi_datatype<Real>(), (int)pid, 0,
+                                 PE::Comm::instance().communicator(), &requests.back()));
+  }
 
-  m_proc.clear();
-  m_expect_recv.clear();
-  m_stored_element.clear();
-  m_stored_stencil.clear();
-  m_stored_source_field_points.clear();
-  m_stored_source_field_weights.clear();
+  if (!requests.empty())
+    MPI_CHECK_RESULT(MPI_Waitall, ((int)requests.size(), &requests[0], MPI_STATUSES_IGNORE));
+}
 
-  m_expect_recv.resize(PE::Comm::instance().size());
-  m_stored_element.resize(PE::Comm::instance().size());
-  m_stored_stencil.resize(PE::Comm::instance().size());
-  m_stored_source_field_points.resize(PE::Comm::instance().size());
-  m_stored_source_field_weights.resize(PE::Comm::instance().size());
+////////////////////////////////////////////////////////////////////////////////
 
+/// Distribute the target coordinates over the ranks that may be able to interpolate them.
+/// The local bounding boxes of the source mesh are exchanged, and each point is sent to the ranks
+/// whose box contains it. Points outside all boxes are sent to the rank with the nearest box.
+/// @param [out] send_coords  coordinates to send to each rank
+/// @param [out] send_ids     index in target_coords of each point sent to each rank
+void Interpolator_route_coordinates(const Dictionary& dict, const Table<Real>& target_coords,
+                                    std::vector< std::vector<Real> >& send_coords, std::vector< std::vector<Uint> >& send_ids)
+{
+  const Uint nb_procs = PE::Comm::instance().size();
+  const Uint nb_coords = target_coords.size();
+  const Uint dim = target_coords.row_size();
 
-  // Now find missing on other procs.
-  for (Uint pid=0; pid<PE::Comm::instance().size(); pid++)
+  // Local bounding box of the source, slightly enlarged to avoid missing points on the boundary through round-off
+  math::BoundingBox local_box;
+  Handle<Mesh const> mesh = find_parent_component_ptr<Mesh>(dict);
+  if (is_not_null(mesh) && mesh->local_bounding_box()->dim() == dim)
+  {
+    local_box.define(*mesh->local_bounding_box());
+  }
+  else
   {
-    // Trade my requests with processor send and recv
-    const Uint pid_send_coords = (PE::Comm::instance().rank() + pid) %
-                                  PE::Comm::instance().size();
-    const Uint pid_recv_coords = (PE::Comm::instance().size() + PE::Comm::instance().rank() - pid) %
-                                  PE::Comm::instance().size();
+    const Field& coordinates = dict.coordinates();
+    std::vector<Real> box_min(dim,  std::numeric_limits<Real>::max());
+    std::vector<Real> box_max(dim, -std::numeric_limits<Real>::max());
+    for (Uint n=0; n<coordinates.size(); ++n)
+    {
+      for (Uint d=0; d<dim; ++d)
+      {
+        box_min[d] = std::min(box_min[d], coordinates[n][d]);
+        box_max[d] = std::max(box_max[d], coordinates[n][d]);
+      }
+    }
+    local_box.define(box_min, box_max);
+  }
+  const Real tolerance = 1e-8 * (local_box.max() - local_box.min()).norm();
 
-    std::vector<Real> send_coords; send_coords.reserve(not_found.size()*target_coords.row_size());
-    std::vector<Real> received_coords;
+  std::vector<Real> my_box(2*dim);
+  for (Uint d=0; d<dim; ++d)
+  {
+    my_box[d]     = local_box.min()[d] - tolerance;
+    my_box[dim+d] = local_box.max()[d] + tolerance;
+  }
+  std::vector<Real> boxes;
+  if (PE::Comm::instance().is_active())
+    PE::Comm::instance().all_gather(my_box, boxes);
+  else
+    boxes = my_box;
+
+  send_coords.assign(nb_procs, std::vector<Real>());
+  send_ids.assign(nb_procs, std::vector<Uint>());
 
-    // fill in coords to send
-    boost_foreach (const Uint t, not_found)
+  for (Uint t=0; t<nb_coords; ++t)
+  {
+    bool contained = false;
+    Uint nearest_pid = 0;
+    Real nearest_distance = std::numeric_limits<Real>::max();
+    for (Uint pid=0; pid<nb_procs; ++pid)
     {
-      boost_foreach (const Real& xyz, target_coords[t])
+      const Real* box_min = &boxes[2*dim*pid];
+      const Real* box_max = box_min + dim;
+      Real distance = 0.;
+      for (Uint d=0; d<dim; ++d)
+      {
+        const Real x = target_coords[t][d];
+        const Real outside = std::max(box_min[d] - x, x - box_max[d]);
+        if (outside > 0.)
+          distance += outside*outside;
+      }
+
+      if (distance == 0.)
       {
-        send_coords.push_back(xyz);
+        contained = true;
+        send_ids[pid].push_back(t);
+        send_coords[pid].insert(send_coords[pid].end(), target_coords[t].begin(), target_coords[t].end());
+      }
+      else if (distance < nearest_distance)
+      {
+        nearest_distance = distance;
+        nearest_pid = pid;
       }
     }
 
-    // send coords, and receive coords
-    Interpolator_send_receive(pid_send_coords,   send_coords,
-                              pid_recv_coords,   received_coords);
+    if (!contained)
+    {
+      send_ids[nearest_pid].push_back(t);
+      send_coords[nearest_pid].insert(send_coords[nearest_pid].end(), target_coords[t].begin(), target_coords[t].end());
+    }
+  }
+}
 
-    Uint nb_received_coords = received_coords.size()/dim;
+////////////////////////////////////////////////////////////////////////////////
 
-    // Find interpolated
+/// Order in which candidate ranks are considered when a point is found on several of them:
+/// this rank first, then the others by increasing rank
+std::vector<Uint> Interpolator_rank_preference()
+{
+  const Uint rank = PE::Comm::instance().rank();
+  std::vector<Uint> order(1, rank);
+  for (Uint pid=0; pid<PE::Comm::instance().size(); ++pid)
+  {
+    if (pid != rank)
+      order.push_back(pid);
+  }
+  return order;
+}
 
-    m_stored_element[pid_recv_coords].clear();
-    m_stored_stencil[pid_recv_coords].clear();
-    m_stored_source_field_points[pid_recv_coords].clear();
-    m_stored_source_field_weights[pid_recv_coords].clear();
+////////////////////////////////////////////////////////////////////////////////
 
-    m_stored_element[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_stencil[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_source_field_points[pid_recv_coords].reserve(nb_received_coords);
-    m_stored_source_field_weights[pid_recv_coords].reserve(nb_received_coords);
+void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coords)
+{
+  m_dict  = dict.handle<Dictionary>();
+  m_table = target_coords.handle< Table<Real> >();
 
-    std::vector<Uint> send_found_coords;  send_found_coords.reserve(nb_received_coords);
+  cf3_assert(m_point_interpolator);
+  m_point_interpolator->options().set("dict", const_cast<Dictionary*>(m_dict.get())->handle<Dictionary>());
 
-    Uint dim = target_coords.row_size();
-    RealVector t_point(dim);
-    SpaceElem element;
-    std::vector<SpaceElem> stencil;
-    std::vector<Uint> points;
-    std::vector<Real> weights;
+  const Uint nb_procs = PE::Comm::instance().size();
+  const Uint nb_coords = target_coords.size();
+  const Uint dim = target_coords.row_size();
 
+  // Send each coordinate to the ranks that may contain it
+  std::vector< std::vector<Real> > send_coords;
+  std::vector< std::vector<Uint> > send_ids;
+  Interpolator_route_coordinates(dict, target_coords, send_coords, send_ids);
+
+  std::vector< std::vector<Real> > received_coords;
+  Interpolator_all_to_all(send_coords, received_coords);
+
+  m_proc.assign(nb_coords, -1);
+  m_expect_recv.assign(nb_procs, std::vector<Uint>());
+  m_stored_element.assign(nb_procs, std::vector<SpaceElem>());
+  m_stored_stencil.assign(nb_procs, std::vector< std::vector<SpaceElem> >());
+  std::vector< std::vector< std::vector<Uint> > > found_points(nb_procs);
+  std::vector< std::vector< std::vector<Real> > > found_weights(nb_procs);
+
+  // Compute the interpolation storage for the received coordinates that are inside this rank
+  std::vector< std::vector<Uint> > send_found(nb_procs);
+  RealVector t_point(dim);
+  SpaceElem element;
+  std::vector<SpaceElem> stencil;
+  std::vector<Uint> points;
+  std::vector<Real> weights;
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    const Uint nb_received_coords = received_coords[pid].size()/dim;
     for (Uint t=0; t<nb_received_coords; ++t)
     {
-      t_point = RealVector::MapType(&received_coords[t*dim],dim);
+      t_point = RealVector::MapType(&received_coords[pid][t*dim],dim);
       bool interpolation_possible_on_this_proc =
           m_point_interpolator->compute_storage(t_point,
                                                 element,
@@ -172,100 +288,93 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
 
       if (interpolation_possible_on_this_proc)
       {
-        m_stored_element[pid_recv_coords].push_back(element);
-        m_stored_stencil[pid_recv_coords].push_back(stencil);
-        m_stored_source_field_points[pid_recv_coords].push_back(points);
-        m_stored_source_field_weights[pid_recv_coords].push_back(weights);
+        m_stored_element[pid].push_back(element);
+        m_stored_stencil[pid].push_back(stencil);
+        found_points[pid].push_back(points);
+        found_weights[pid].push_back(weights);
 
         // mark found
-        send_found_coords.push_back(t);
+        send_found[pid].push_back(t);
       }
-
     }
+  }
 
-    std::vector<Uint> recv_found_coords;
-
-    const Uint pid_send_back = pid_recv_coords;
-    const Uint pid_recv_back = pid_send_coords;
-
-    Interpolator_send_receive (pid_send_back, send_found_coords,
-                               pid_recv_back, recv_found_coords);
-
-    m_expect_recv[pid_recv_back].reserve(recv_found_coords.size());
+  std::vector< std::vector<Uint> > recv_found;
+  Interpolator_all_to_all(send_found, recv_found);
 
-    boost_foreach(const Uint i, recv_found_coords)
+  // A point may have been found on several ranks: keep only one of them, and tell the
+  // ranks which of their found points are effectively requested
+  std::vector< std::vector<Uint> > send_selected(nb_procs);
+  boost_foreach (const Uint pid, Interpolator_rank_preference())
+  {
+    for (Uint i=0; i<recv_found[pid].size(); ++i)
     {
-      cf3_assert(i<not_found.size());
-      const Uint t = not_found[i];
+      cf3_assert(recv_found[pid][i]<send_ids[pid].size());
+      const Uint t = send_ids[pid][ recv_found[pid][i] ];
       cf3_assert(t<nb_coords);
-      m_proc[t] = pid_recv_back;
-      m_expect_recv[pid_recv_back].push_back(t);
+      if (m_proc[t] < 0)
+      {
+        m_proc[t] = pid;
+        m_expect_recv[pid].push_back(t);
+        send_selected[pid].push_back(i);
+      }
     }
+  }
+
+  std::vector< std::vector<Uint> > recv_selected;
+  Interpolator_all_to_all(send_selected, recv_selected);
 
-    not_found.clear();
-    for (Uint t=0; t<nb_coords; ++t)
+  // Keep only the selected points, and assemble their weights into one matrix,
+  // with the rows for each requesting processor stored contiguously
+  m_stored_weights.clear();
+  m_send_offsets.assign(1, 0u);
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    const std::vector<Uint>& selected = recv_selected[pid];
+    for (Uint i=0; i<selected.size(); ++i)
     {
-      if (m_proc[t]<0)
-        not_found.push_back(t);
+      cf3_assert(selected[i] >= i);
+      m_stored_element[pid][i] = m_stored_element[pid][selected[i]];
+      m_stored_stencil[pid][i] = m_stored_stencil[pid][selected[i]];
+      m_stored_weights.add_row(found_points[pid][selected[i]], found_weights[pid][selected[i]]);
     }
+    m_stored_element[pid].resize(selected.size());
+    m_stored_stencil[pid].resize(selected.size());
+    m_send_offsets.push_back(m_stored_weights.nb_rows());
   }
+
+  m_recv_offsets.assign(1, 0u);
+  for (Uint pid=0; pid<nb_procs; ++pid)
+    m_recv_offsets.push_back(m_recv_offsets.back() + m_expect_recv[pid].size());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void Interpolator::stored_interpolation(const Field& source_field, Table<Real>& target)
 {
-  // Do interpolation on processors that can do the interpolation,
-  // and send back an array of interpolated values
-  for (Uint pid=0; pid<PE::Comm::instance().size(); pid++)
-  {
-    // Trade my requests with processor send and recv
-    const Uint pid_send_interpolated = (PE::Comm::instance().size() + PE::Comm::instance().rank() - pid) %
-                                        PE::Comm::instance().size();
-    const Uint pid_recv_interpolated = (PE::Comm::instance().rank() + pid) %
-                                        PE::Comm::instance().size();
-
-    // number of points to be interpolated
-    const Uint nb_points = m_stored_element[pid_send_interpolated].size();
-
-    // number of variables for each point to be interpolated
-    const Uint nb_vars = m_source_vars.size();
-
-    // storage for interpolated variables, which will be sent to the pid that reqests it (pid_recv_interpolated)
-    std::vector<Real> interpolated; interpolated.reserve(nb_points*nb_vars);
+  const Uint nb_procs = PE::Comm::instance().size();
 
-    // Interpolation points and weights
-    const std::vector< std::vector<Uint> >& s_points  = m_stored_source_field_points[pid_send_interpolated];
-    const std::vector< std::vector<Real> >& s_weights = m_stored_source_field_weights[pid_send_interpolated];
+  // number of variables for each point to be interpolated
+  const Uint nb_vars = m_source_vars.size();
 
-    // Do interpolation
-    for (Uint t=0; t<nb_points; ++t)
-    {
-      for (Uint v=0; v<nb_vars; ++v)
-      {
-        interpolated.push_back(0.);
-        for (Uint s=0; s<s_points[t].size(); ++s)
-        {
-          cf3_assert(s_points[t][s]<source_field.size());
-          interpolated.back() += source_field[ s_points[t][s] ][ m_source_vars[v] ] * s_weights[t][s];
-        }
-      }
-    }
+  // Do interpolation for the points requested by other processors, in one sparse
+  // matrix product. The rows are ordered by requesting processor, so the result
+  // can be sent directly from the buffer.
+  m_stored_weights.apply(source_field, m_source_vars, m_send_buffer, options().value<Uint>("nb_threads"));
 
-    // Send/Receive interpolated variables
-    std::vector<Real> recv_interpolated;
-    Interpolator_send_receive(pid_send_interpolated   , interpolated,
-                              pid_recv_interpolated   , recv_interpolated);
+  // Only exchange with the processors that share points with this one
+  m_recv_buffer.resize(m_recv_offsets.back()*nb_vars);
+  Interpolator_exchange_with_neighbours(m_send_buffer, m_send_offsets, m_recv_buffer, m_recv_offsets, nb_vars);
 
-    // Fill the target_field with received interpolated variables from requested processor
-    Uint it=0;
-    boost_foreach( const Uint t, m_expect_recv[pid_recv_interpolated] )
+  // Fill the target_field with received interpolated variables from requested processor
+  Uint it=0;
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    boost_foreach( const Uint t, m_expect_recv[pid] )
     {
+      cf3_assert(t<target.size());
       for (Uint v=0; v<nb_vars; ++v)
-      {
-        cf3_assert(t<target.size());
-        target[t][ m_target_vars[v] ] = recv_interpolated[it++];
-      }
+        target[t][ m_target_vars[v] ] = m_recv_buffer[it++];
     }
   }
 }
@@ -281,96 +390,67 @@ void Interpolator::unstored_interpolation(const Field& source_field, const commo
   cf3_assert(m_point_interpolator);
   m_point_interpolator->options().set("dict", const_cast<Dictionary*>(&source_field.dict())->handle<Dictionary>());
 
+  const Uint nb_procs = PE::Comm::instance().size();
   const Uint nb_coords = target_coords.size();
   const Uint dim = target_coords.row_size();
 
-  std::vector<int> not_found; not_found.reserve(nb_coords);
-  for (Uint i=0; i<nb_coords; ++i)
-    not_found.push_back(i);
+  // number of variables for each point to be interpolated
+  const Uint nb_vars = m_source_vars.size();
 
-  // Now find missing on other procs.
-  for (Uint pid=0; pid<PE::Comm::instance().size(); pid++)
-  {
-    // Trade my requests with processor send and recv
-    const Uint pid_send_coords = (PE::Comm::instance().rank() + pid) %
-                                  PE::Comm::instance().size();
-    const Uint pid_recv_coords = (PE::Comm::instance().size() + PE::Comm::instance().rank() - pid) %
-                                  PE::Comm::instance().size();
-
-    std::vector<Real> send_coords; send_coords.reserve(not_found.size()*target_coords.row_size());
-    std::vector<Uint>  unknown_ids; unknown_ids.reserve(not_found.size());
-    std::vector<Real> received_coords;
-
-    // fill in coords to send
-    boost_foreach (const int t, not_found)
-    {
-      if (t>=0)
-      {
-        unknown_ids.push_back(t);
-        boost_foreach (const Real& xyz, target_coords[t])
-        {
-          send_coords.push_back(xyz);
-        }
-      }
-    }
-
-    // send coords, and receive coords
-    Interpolator_send_receive(pid_send_coords,   send_coords,
-                              pid_recv_coords,   received_coords);
-
-    Uint nb_received_coords = received_coords.size()/dim;
-
-    // Find interpolated
-
-    std::vector<Uint> send_found_coords;  send_found_coords.reserve(nb_received_coords);
-
-    // number of variables for each point to be interpolated
-    const Uint nb_vars = m_source_vars.size();
+  // Send each coordinate to the ranks that may contain it
+  std::vector< std::vector<Real> > send_coords;
+  std::vector< std::vector<Uint> > send_ids;
+  Interpolator_route_coordinates(source_field.dict(), target_coords, send_coords, send_ids);
 
-    // storage for interpolated variables, which will be sent to the pid that reqests it (pid_recv_interpolated)
-    std::vector<Real> send_interpolated; send_interpolated.reserve(nb_received_coords*nb_vars);
-
-    Uint dim = target_coords.row_size();
-    RealVector t_point(dim);
-    RealVector t_val(source_field.row_size());
+  std::vector< std::vector<Real> > received_coords;
+  Interpolator_all_to_all(send_coords, received_coords);
 
+  // Interpolate the received coordinates that are inside this rank
+  std::vector< std::vector<Uint> > send_found(nb_procs);
+  std::vector< std::vector<Real> > send_interpolated(nb_procs);
+  RealVector t_point(dim);
+  RealVector t_val(source_field.row_size());
+  for (Uint pid=0; pid<nb_procs; ++pid)
+  {
+    const Uint nb_received_coords = received_coords[pid].size()/dim;
+    send_interpolated[pid].reserve(nb_received_coords*nb_vars);
     for (Uint t=0; t<nb_received_coords; ++t)
     {
-      t_point = RealVector::MapType(&received_coords[t*dim],dim);
+      t_point = RealVector::MapType(&received_coords[pid][t*dim],dim);
       bool interpolation_possible_on_this_proc =
           m_point_interpolator->interpolate(source_field,t_point,t_val);
       if (interpolation_possible_on_this_proc)
       {
         // mark found
-        send_found_coords.push_back(t);
+        send_found[pid].push_back(t);
 
         for (Uint v=0; v<nb_vars; ++v)
-          send_interpolated.push_back(t_val[ m_source_vars[v] ] );
+          send_interpolated[pid].push_back(t_val[ m_source_vars[v] ] );
       }
     }
+  }
 
-    std::vector<Uint> recv_found_coords;
-    std::vector<Real> recv_interpolated;
-
-    const Uint pid_send_back = pid_recv_coords;
-    const Uint pid_recv_back = pid_send_coords;
-
-    Interpolator_send_receive (pid_send_back, send_found_coords,
-                               pid_recv_back, recv_found_coords);
-    Interpolator_send_receive (pid_send_back, send_interpolated,
-                               pid_recv_back, recv_interpolated);
+  std::vector< std::vector<Uint> > recv_found;
+  std::vector< std::vector<Real> > recv_interpolated;
+  Interpolator_all_to_all(send_found, recv_found);
+  Interpolator_all_to_all(send_interpolated, recv_interpolated);
 
-    Uint it=0;
-    boost_foreach(const Uint i, recv_found_coords)
+  // Points found on several ranks take the value from the preferred rank
+  std::vector<bool> found(nb_coords, false);
+  boost_foreach (const Uint pid, Interpolator_rank_preference())
+  {
+    for (Uint i=0; i<recv_found[pid].size(); ++i)
     {
-      cf3_assert(i<unknown_ids.size());
-      const int t = unknown_ids[i];
-      not_found[t] = -1;
-      cf3_assert_desc(common::to_str(t)+'<'+common::to_str(nb_coords),t<(int)nb_coords);
+      cf3_assert(recv_found[pid][i]<send_ids[pid].size());
+      const Uint t = send_ids[pid][ recv_found[pid][i] ];
+      cf3_assert_desc(common::to_str(t)+'<'+common::to_str(nb_coords),t<nb_coords);
+      if (found[t])
+        continue;
+      found[t] = true;
       for (Uint v=0; v<nb_vars; ++v)
       {
         cf3_assert(t<target.size());
-        target[t][ m_target_vars[v] ] = recv_interpolated[it++];
+        target[t][ m_target_vars[v] ] = recv_interpolated[pid][i*nb_vars+v];
       }
     }
   }
@@ -10,6 +10,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "mesh/AInterpolator.hpp"
+#include "mesh/InterpolationMatrix.hpp"
 #include "mesh/Space.hpp"
 
 namespace cf3 {
@@ -27,6 +28,10 @@ class APointInterpolator;
 /// mesh as the source, depending on concrete implementations
 /// The interpolation also works with parallel distributed fields. Interpolation
 /// is delegated to the processor that has the necessary source values.
+/// Target coordinates are only sent to the processors whose local bounding box
+/// contains them. When the interpolation is stored, repeated interpolations only
+/// communicate with the processors that effectively share points, and the stored
+/// weights are applied as a single sparse matrix product into reused buffers.
 /// @author Willem Deconinck
 class Mesh_API Interpolator : public AInterpolator {
 
@@ -81,8 +86,17 @@ private: // data
   std::vector< std::vector< Uint                   > > m_expect_recv;
   std::vector< std::vector< SpaceElem              > > m_stored_element;
   std::vector< std::vector< std::vector<SpaceElem> > > m_stored_stencil;
-  std::vector< std::vector< std::vector<Uint>      > > m_stored_source_field_points;
-  std::vector< std::vector< std::vector<Real>      > > m_stored_source_field_weights;
+
+  /// Stored weights, with the rows requested by each processor stored contiguously
+  InterpolationMatrix m_stored_weights;
+  /// First row in m_stored_weights for each processor, with one extra entry for the end
+  std::vector<Uint> m_send_offsets;
+  /// First position in m_expect_recv for each processor, with one extra entry for the end
+  std::vector<Uint> m_recv_offsets;
+
+  // Communication buffers, kept between stored interpolations
+  std::vector<Real> m_send_buffer;
+  std::vector<Real> m_recv_buffer;
 
   // store variable indices in table rows
   std::vector<Uint> m_source_vars;
@@ -33,6 +33,7 @@
 #include "mesh/Region.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/StructuredBlocks.hpp"
 
 namespace cf3 {
 namespace mesh {
@@ -177,6 +178,7 @@ MeshAdaptor::MeshAdaptor(mesh::Mesh &mesh)
   node_elem_connectivity_needs_rebuild = false;
   elem_flush_required = false;
   node_flush_required = false;
+  entries_removed = false;
 
   m_mesh = mesh.handle<Mesh>();
 }
@@ -210,6 +212,16 @@ void MeshAdaptor::finish()
   restore_element_node_connectivity();
   cf3_assert( ! is_node_connectivity_global );
 
+  if (entries_removed)
+  {
+    boost_foreach(const Handle<Entities>& entities, m_mesh->elements())
+    {
+      if (is_not_null(entities) && is_not_null(entities->get_child(StructuredBlocks::default_name())))
+        entities->remove_component(StructuredBlocks::default_name());
+    }
+    entries_removed = false;
+  }
+
   m_mesh->raise_mesh_changed();
 
   // Change following flags as "raise_mesh_changed" took care of this
@@ -410,6 +422,7 @@ void MeshAdaptor::remove_element(const Uint entities_idx, const Uint elem_loc_id
   cf3_assert(elem_loc_idx < element_glb_idx[entities_idx]->total_allocated());
   element_glb_idx[entities_idx]->rm_row(elem_loc_idx);
   element_rank[entities_idx]->rm_row(elem_loc_idx);
+  entries_removed = true;
   for (Uint space_idx=0; space_idx<element_connected_nodes[entities_idx].size(); ++space_idx)
     element_connected_nodes[entities_idx][space_idx]->rm_row(elem_loc_idx);
   added_elements[entities_idx].erase(m_mesh->elements()[entities_idx]->glb_idx()[elem_loc_idx]);
@@ -456,6 +469,7 @@ void MeshAdaptor::remove_node(const Uint dict_idx, const Uint node_loc_idx)
   cf3_assert(node_loc_idx < node_glb_idx[dict_idx]->total_allocated());
   node_glb_idx[dict_idx]->rm_row(node_loc_idx);
   node_rank[dict_idx]->rm_row(node_loc_idx);
+  entries_removed = true;
   for (Uint fields_idx=0; fields_idx<node_field_values[dict_idx].size(); ++fields_idx)
     node_field_values[dict_idx][fields_idx]->rm_row(node_loc_idx);
   added_nodes[dict_idx].erase(m_mesh->dictionaries()[dict_idx]->glb_idx()[node_loc_idx]);
@@ -64,6 +64,8 @@ public:
 
   /// @brief Apply the changes the mesh adaptor for changes and fix inconsistent state
   ///
+  /// If nodes or elements were removed, structured descriptions of the entities (StructuredBlocks) are removed,
+  /// since the local numbering they rely on has changed. Appending nodes or elements keeps them valid.
   /// @post Mesh is back in consistent state!
   void finish();
 
@@ -248,6 +250,9 @@ private:
   /// @brief flag if there are still nodes that need to be flush
   bool node_flush_required;
 
+  /// @brief flag if nodes or elements were removed, which changes the local numbering
+  bool entries_removed;
+
   /// @brief bookkeeping of added and removed elements
   std::vector< std::set<boost::uint64_t> > added_elements;
 
@@ -19,6 +19,7 @@
 #include "common/StringConversion.hpp"
 #include "common/DynTable.hpp"
 #include "common/List.hpp"
+#include "common/PropertyList.hpp"
 
 #include "common/XML/Protocol.hpp"
 #include "common/XML/SignalOptions.hpp"
@@ -29,6 +30,9 @@
 #include "mesh/Region.hpp"
 #include "mesh/MeshAdaptor.hpp"
 #include "mesh/MeshElements.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/ShapeFunction.hpp"
 
 namespace cf3 {
 namespace mesh {
@@ -43,7 +47,8 @@ namespace mesh {
 MeshPartitioner::MeshPartitioner ( const std::string& name ) :
     MeshTransformer(name),
     m_base(0),
-    m_nb_parts(PE::Comm::instance().size())
+    m_nb_parts(PE::Comm::instance().size()),
+    m_vertex_weights("ElementType")
 {
   options().add("nb_parts", m_nb_parts)
       .description("Total number of partitions (e.g. number of processors)")
@@ -51,6 +56,18 @@ MeshPartitioner::MeshPartitioner ( const std::string& name ) :
       .link_to(&m_nb_parts)
       .mark_basic();
 
+  std::vector<boost::any> weight_types;
+  weight_types.push_back(std::string("Uniform"));
+  weight_types.push_back(std::string("ElementType"));
+  weight_types.push_back(std::string("Measured"));
+  options().add("vertex_weights", m_vertex_weights)
+      .description("Weight of the elements in the partitioning graph. Uniform: every element counts as 1. "
+                   "ElementType: estimated from the number of DOF and quadrature points of the element. "
+                   "Measured: ElementType estimate scaled with the measured costs stored in the mesh metadata")
+      .pretty_name("Vertex Weights")
+      .link_to(&m_vertex_weights)
+      .restricted_list() = weight_types;
+
   m_global_to_local = create_static_component<common::Map<Uint,Uint> >("global_to_local");
   m_lookup = create_static_component<UnifiedData >("lookup");
 
@@ -188,6 +205,7 @@ void MeshPartitioner::initialize(Mesh& mesh)
   m_elements_to_export.resize(m_nb_parts,std::vector< std::vector<Uint> >(mesh.elements().size()));
 
   build_global_to_local_index(mesh);
+  compute_object_weights(mesh);
   build_graph();
 
 //  mesh.update_statistics();
@@ -270,6 +288,75 @@ void MeshPartitioner::build_global_to_local_index(Mesh& mesh)
 
 //////////////////////////////////////////////////////////////////////////////
 
+Real MeshPartitioner::estimated_cost(const Entities& entities)
+{
+  Uint nb_dofs = 0;
+  Uint order = 0;
+  boost_foreach(const Handle<Space>& space, entities.spaces())
+  {
+    nb_dofs = std::max(nb_dofs, space->shape_function().nb_nodes());
+    order = std::max(order, space->shape_function().order());
+  }
+
+  Real nb_quadrature_points = 1.;
+  for(Uint d = 0; d != entities.element_type().dimensionality(); ++d)
+    nb_quadrature_points *= static_cast<Real>(order + 1);
+
+  return static_cast<Real>(nb_dofs) * nb_quadrature_points;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::string MeshPartitioner::measured_cost_key(const Component& region)
+{
+  std::string path;
+  for(Handle<Component const> comp = region.handle(); is_not_null(comp) && is_null(Handle<Mesh const>(comp)); comp = comp->parent())
+    path = "/" + comp->name() + path;
+  return "measured_cost:" + path;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void MeshPartitioner::compute_object_weights(const Mesh& mesh)
+{
+  const std::vector< Handle<Component> >& components = m_lookup->components();
+  m_object_weight_per_component.assign(components.size(), 1.);
+  if(m_vertex_weights == "Uniform")
+    return;
+
+  for(Uint comp_idx = 0; comp_idx != components.size(); ++comp_idx)
+  {
+    Handle<Entities const> entities(components[comp_idx]);
+    if(is_null(entities))
+      continue;
+
+    Real weight = estimated_cost(*entities);
+
+    if(m_vertex_weights == "Measured")
+    {
+      // The measured factors of all enclosing regions add up, since each of them was timed by different actions
+      Real measured_factor = 0.;
+      bool found = false;
+      for(Handle<Component const> comp = entities->parent(); is_not_null(comp) && is_null(Handle<Mesh const>(comp)); comp = comp->parent())
+      {
+        const std::string key = measured_cost_key(*comp);
+        if(mesh.metadata().check(key))
+        {
+          measured_factor += mesh.metadata().properties().value<Real>(key);
+          found = true;
+        }
+      }
+      if(found)
+        weight *= measured_factor;
+    }
+
+    // Nodes have weight 1, elements should never weigh less
+    m_object_weight_per_component[comp_idx] = std::max(weight, 1.);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void MeshPartitioner::show_changes()
 {
   Uint nb_changes(0);
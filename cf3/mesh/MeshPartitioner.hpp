@@ -101,6 +101,23 @@ public: // functions
   template <typename VectorT>
   void list_of_connected_procs_in_part(const Uint part, VectorT& proc_per_neighbor) const;
 
+  /// Weight of each object owned by the part, in the same order as list_of_objects_owned_by_part.
+  /// Nodes have weight 1, elements get the weight computed for their Entities according to the vertex_weights option.
+  template <typename WeightsT>
+  void list_of_object_weights_in_part(const Uint part, WeightsT& obj_weights) const;
+
+  /// @return true unless the vertex_weights option is Uniform
+  bool has_object_weights() const { return m_vertex_weights != "Uniform"; }
+
+  /// Estimated cost of processing one element, relative to a node. This is the number of DOF for the
+  /// highest order space of the entities, multiplied with the (order+1)^dimensionality quadrature points
+  /// needed to integrate on such an element.
+  static Real estimated_cost(const Entities& entities);
+
+  /// Metadata key used to store the measured cost of the elements in the given region,
+  /// as a factor relative to the estimated_cost. The key is relative to the mesh, so it stays valid after a reload.
+  static std::string measured_cost_key(const Component& region);
+
 
 public: // functions
 
@@ -139,6 +156,9 @@ protected: // functions
   
   Uint periodic_target_node(Uint node) const;
 
+  /// Compute the weight of the objects of each component in m_lookup
+  void compute_object_weights(const Mesh& mesh);
+
 protected: // data
 
   /// nodes_to_export[part][loc_node_idx]
@@ -167,6 +187,12 @@ private: // data
 
   Handle< UnifiedData > m_lookup;
 
+  /// How the vertex weights are computed: Uniform, ElementType or Measured
+  std::string m_vertex_weights;
+
+  /// Weight of a single object, for each component in m_lookup
+  std::vector<Real> m_object_weight_per_component;
+
   std::vector< std::pair<bool, Uint > > m_periodic_links;
   std::vector< std::vector<Uint> > m_inverse_periodic_links;
 };
@@ -196,6 +222,27 @@ void MeshPartitioner::list_of_objects_owned_by_part(const Uint part, VectorT& ob
 
 //////////////////////////////////////////////////////////////////////////////
 
+template <typename WeightsT>
+void MeshPartitioner::list_of_object_weights_in_part(const Uint part, WeightsT& obj_weights) const
+{
+  // declaration for boost::tie
+  Uint comp_idx;
+  Uint loc_idx;
+
+  Uint idx=0;
+  foreach_container((const Uint glb_obj)(const Uint loc_obj),*m_global_to_local)
+  {
+    if (part_of_obj(glb_obj) == part)
+    {
+      boost::tie(comp_idx,loc_idx) = m_lookup->location_idx(loc_obj);
+      if(!(glb_obj < m_end_node_per_part[part] && m_periodic_links[loc_idx].first))
+        obj_weights[idx++] = m_object_weight_per_component[comp_idx];
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 template <typename VectorT>
 Uint MeshPartitioner::nb_connected_objects_in_part(const Uint part, VectorT& nb_connections_per_obj) const
 {
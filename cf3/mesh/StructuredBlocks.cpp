@@ -0,0 +1,141 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/StructuredBlocks.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  using namespace common;
+
+ComponentBuilder<StructuredBlocks, Component, LibMesh> StructuredBlocks_Builder;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  // Nodes shared with the previous element in the i-direction, for quads and hexahedra
+  const Uint row_shared_current[4] = {0, 3, 4, 7};
+  const Uint row_shared_previous[4] = {1, 2, 5, 6};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StructuredBlocks::StructuredBlocks(const std::string& name) :
+  Component(name),
+  m_dimension(3),
+  m_first_element(1, 0)
+{
+}
+
+StructuredBlocks::~StructuredBlocks()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Handle<StructuredBlocks const> StructuredBlocks::find(const Entities& entities)
+{
+  return Handle<StructuredBlocks const>(entities.get_child(default_name()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StructuredBlocks::initialize(const Uint dimension)
+{
+  if(dimension != 2 && dimension != 3)
+    throw BadValue(FromHere(), "Structured blocks must be 2D or 3D, got dimension " + to_str(dimension));
+
+  m_dimension = dimension;
+  m_segments.clear();
+  m_first_element.assign(1, 0);
+  m_first_node.clear();
+  m_lattice_nodes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StructuredBlocks::add_block(const std::vector<Uint>& segments, const std::vector<Uint>& lattice_nodes)
+{
+  if(segments.size() != m_dimension)
+    throw BadValue(FromHere(), "Expected " + to_str(m_dimension) + " segment counts for a block, got " + to_str(segments.size()));
+
+  Uint nb_elements = 1;
+  Uint nb_nodes = 1;
+  for(Uint d = 0; d != 3; ++d)
+  {
+    const Uint nb_segments = d < m_dimension ? segments[d] : 1;
+    if(nb_segments == 0)
+      throw BadValue(FromHere(), "Structured blocks can not be empty");
+    m_segments.push_back(nb_segments);
+    nb_elements *= nb_segments;
+    if(d < m_dimension)
+      nb_nodes *= nb_segments + 1;
+  }
+
+  if(lattice_nodes.size() != nb_nodes)
+    throw BadValue(FromHere(), "Expected " + to_str(nb_nodes) + " lattice nodes for a block, got " + to_str(lattice_nodes.size()));
+
+  m_first_node.push_back(m_lattice_nodes.size());
+  m_lattice_nodes.insert(m_lattice_nodes.end(), lattice_nodes.begin(), lattice_nodes.end());
+  m_first_element.push_back(m_first_element.back() + nb_elements);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const Uint* StructuredBlocks::row_shared_current() const
+{
+  return detail::row_shared_current;
+}
+
+const Uint* StructuredBlocks::row_shared_previous() const
+{
+  return detail::row_shared_previous;
+}
+
+const Uint* StructuredBlocks::row_new_nodes() const
+{
+  // The new nodes are exactly the ones the next element shares
+  return detail::row_shared_previous;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StructuredBlocks::fill_connectivity(Connectivity& connectivity) const
+{
+  connectivity.set_row_size(nb_element_nodes());
+  connectivity.resize(nb_elements());
+  const Uint nb_elems = nb_elements();
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+  {
+    Connectivity::Row row = connectivity[elem];
+    element_nodes(elem, row);
+  }
+}
+
+void StructuredBlocks::clear_connectivity(Connectivity& connectivity) const
+{
+  connectivity.set_row_size(0);
+  connectivity.resize(nb_elements());
+}
+
+bool StructuredBlocks::has_connectivity(const Table<Uint>& connectivity)
+{
+  return connectivity.row_size() != 0 || connectivity.size() == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,185 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_StructuredBlocks_hpp
+#define cf3_mesh_StructuredBlocks_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <vector>
+
+#include "common/Assertions.hpp"
+#include "common/Component.hpp"
+#include "common/Table.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+class Connectivity;
+class Entities;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Lattice description of entities that consist of structured blocks of LagrangeP1 quads or hexahedra.
+/// Each block is stored as its number of segments in each direction and the node index of each lattice point,
+/// so the element-node connectivity can be computed on the fly. The elements of a block are numbered with i
+/// running fastest, followed by j and k, and the blocks follow each other in the entities.
+///
+/// Entities with this description normally still have their unstructured connectivity, so they work with all code
+/// that expects it. Code that knows about the structure can use it to exploit the unit-stride ordering, e.g. an element
+/// shares half its nodes with the previous element in the same row. Any unstructured change to the entities
+/// (migration, overlap growth) invalidates the description, so MeshAdaptor removes it.
+/// To save memory, the connectivity can be left empty (see has_connectivity()), in which case only code that uses
+/// the lattice (such as the Proto element loops) works on the entities, until fill_connectivity() is called.
+class Mesh_API StructuredBlocks : public common::Component
+{
+public:
+
+  /// Contructor
+  /// @param name of the component
+  StructuredBlocks ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~StructuredBlocks();
+
+  /// Get the class name
+  static std::string type_name () { return "StructuredBlocks"; }
+
+  /// Name of the StructuredBlocks child of structured entities
+  static std::string default_name() { return "structured_blocks"; }
+
+  /// @return the structured description of the given entities, or a null handle if they are unstructured
+  static Handle<StructuredBlocks const> find(const Entities& entities);
+
+  /// Set the dimension, either 2 (quads) or 3 (hexahedra). Removes all blocks.
+  void initialize(const Uint dimension);
+
+  /// Append a block to the description
+  /// @param segments Number of elements in each direction
+  /// @param lattice_nodes Node index for each lattice point, with i running fastest. Size is the product of (segments[d] + 1)
+  void add_block(const std::vector<Uint>& segments, const std::vector<Uint>& lattice_nodes);
+
+  Uint dimension() const { return m_dimension; }
+
+  /// Number of nodes per element
+  Uint nb_element_nodes() const { return m_dimension == 3 ? 8 : 4; }
+
+  Uint nb_blocks() const { return m_first_element.size() - 1; }
+
+  /// Total number of elements in all blocks
+  Uint nb_elements() const { return m_first_element.back(); }
+
+  /// Number of segments of block b in direction d
+  Uint segments(const Uint block, const Uint direction) const { return m_segments[block*3 + direction]; }
+
+  /// Index of the first element of the block
+  Uint first_element(const Uint block) const { return m_first_element[block]; }
+
+  /// Block containing the element
+  Uint block(const Uint element_idx) const
+  {
+    cf3_assert(element_idx < nb_elements());
+    return std::upper_bound(m_first_element.begin(), m_first_element.end(), element_idx) - m_first_element.begin() - 1;
+  }
+
+  /// True if the element follows its i-direction neighbour, i.e. element_idx-1 shares the nodes row_shared_previous()
+  bool continues_row(const Uint element_idx) const
+  {
+    if(element_idx >= nb_elements())
+      return false;
+    const Uint b = block(element_idx);
+    return (element_idx - m_first_element[b]) % m_segments[b*3] != 0;
+  }
+
+  /// Local nodes of an element that coincide with row_shared_previous() of the previous element in a row
+  const Uint* row_shared_current() const;
+
+  /// Local nodes of the previous element in a row, matching row_shared_current()
+  const Uint* row_shared_previous() const;
+
+  /// Local nodes of an element that are not shared with the previous element in a row
+  const Uint* row_new_nodes() const;
+
+  /// Number of entries in row_shared_current(), row_shared_previous() and row_new_nodes()
+  Uint nb_row_shared_nodes() const { return nb_element_nodes() / 2; }
+
+  /// Lattice entry of the first node of an element
+  /// @param nx Set to the lattice stride in the j-direction of the block of the element
+  /// @param nxy Set to the lattice stride in the k-direction of the block of the element
+  /// The next element in the same row starts at the next lattice entry, see continues_row()
+  const Uint* element_lattice(const Uint element_idx, Uint& nx, Uint& nxy) const
+  {
+    const Uint b = block(element_idx);
+    const Uint* segs = &m_segments[b*3];
+    nx = segs[0] + 1;
+    nxy = nx * (segs[1] + 1);
+    Uint local = element_idx - m_first_element[b];
+    const Uint i = local % segs[0]; local /= segs[0];
+    const Uint j = local % segs[1];
+    const Uint k = local / segs[1];
+    return &m_lattice_nodes[m_first_node[b] + i + j*nx + k*nxy];
+  }
+
+  /// Read the nodes of the element starting at the given lattice entry, in the LagrangeP1 Quad2D or Hexa3D ordering
+  template<typename RowT>
+  void lattice_element_nodes(const Uint* lattice, const Uint nx, const Uint nxy, RowT& nodes) const
+  {
+    nodes[0] = lattice[0];
+    nodes[1] = lattice[1];
+    nodes[2] = lattice[nx+1];
+    nodes[3] = lattice[nx];
+    if(m_dimension == 3)
+    {
+      nodes[4] = lattice[nxy];
+      nodes[5] = lattice[nxy+1];
+      nodes[6] = lattice[nxy+nx+1];
+      nodes[7] = lattice[nxy+nx];
+    }
+  }
+
+  /// Compute the nodes of an element, in the LagrangeP1 Quad2D or Hexa3D ordering
+  template<typename RowT>
+  void element_nodes(const Uint element_idx, RowT& nodes) const
+  {
+    Uint nx, nxy;
+    const Uint* lattice = element_lattice(element_idx, nx, nxy);
+    lattice_element_nodes(lattice, nx, nxy, nodes);
+  }
+
+  /// Expand the structured description into an unstructured connectivity table, resized to nb_elements()
+  void fill_connectivity(Connectivity& connectivity) const;
+
+  /// Leave the connectivity table without columns, keeping only its number of rows as the number of elements
+  void clear_connectivity(Connectivity& connectivity) const;
+
+  /// True if the connectivity holds the element nodes, false if it was left empty by clear_connectivity()
+  static bool has_connectivity(const common::Table<Uint>& connectivity);
+
+private:
+  Uint m_dimension;
+  /// Segments in each direction, 3 entries per block. The Z entry is 1 in 2D.
+  std::vector<Uint> m_segments;
+  /// First element of each block, with nb_elements() as last entry
+  std::vector<Uint> m_first_element;
+  /// Offset of each block in m_lattice_nodes
+  std::vector<Uint> m_first_node;
+  /// Node index of each lattice point, per block
+  std::vector<Uint> m_lattice_nodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_StructuredBlocks_hpp
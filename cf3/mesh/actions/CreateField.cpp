@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/assign/list_of.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -214,15 +216,38 @@ Handle<Field> CreateField::create_field(const std::string& name, Dictionary& dic
 
   // Evaluate function
 
-  std::vector<Real> params(var_names.size());
-  for (Uint pt=0; pt<new_field.size(); ++pt)
+  // The results are written in place, a chunk of points at a time, if the rows of the new field are contiguous.
+  // Otherwise they go through a buffer.
+  const Uint nb_vars = var_names.size();
+  const Uint nb_funcs = new_field.row_size();
+  const Uint chunk_size = 1024;
+  const bool in_place = new_field.is_row_major();
+  std::vector<Real> params(chunk_size*nb_vars);
+  std::vector<Real> results(in_place ? 0 : chunk_size*nb_funcs);
+  for (Uint chunk_begin=0; chunk_begin<new_field.size(); chunk_begin+=chunk_size)
   {
-    for (Uint v=0; v<params.size(); ++v)
+    const Uint chunk_end = std::min(new_field.size(), chunk_begin+chunk_size);
+    for (Uint pt=chunk_begin; pt<chunk_end; ++pt)
+    {
+      for (Uint v=0; v<nb_vars; ++v)
+      {
+        params[(pt-chunk_begin)*nb_vars+v] = (*var_arrays[v])[pt][var_array_idx[v]];
+      }
+    }
+    if(in_place)
+    {
+      vectorial_function.evaluate_batch(&params[0], nb_vars, &new_field.array()[chunk_begin][0], nb_funcs, chunk_end-chunk_begin);
+      continue;
+    }
+
+    vectorial_function.evaluate_batch(&params[0], nb_vars, &results[0], nb_funcs, chunk_end-chunk_begin);
+    for (Uint pt=chunk_begin; pt<chunk_end; ++pt)
     {
-      params[v] = (*var_arrays[v])[pt][var_array_idx[v]];
+      for (Uint f=0; f<nb_funcs; ++f)
+      {
+        new_field[pt][f] = results[(pt-chunk_begin)*nb_funcs+f];
+      }
     }
-    Table<Real>::ArrayT::reference ref = new_field.array()[pt];
-    vectorial_function.evaluate(params,ref);
   }
 
   return new_field.handle<Field>();
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 
@@ -17,7 +19,6 @@
 #include "common/PropertyList.hpp"
 #include "common/Signal.hpp"
 #include "common/XML/SignalOptions.hpp"
-#include "math/AnalyticalFunction.hpp"
 
 #include "mesh/actions/InitFieldFunction.hpp"
 #include "mesh/Elements.hpp"
@@ -185,37 +186,59 @@ void InitFieldFunction::execute()
     }
   }
 
-  // create the functions
-  std::vector<math::AnalyticalFunction> functions(option_functions.size());
-  for (Uint f=0; f<functions.size(); ++f)
+  if (option_functions.empty())
+    return;
+
+  // check: columns must be of index smaller than index of field
+  for (Uint f=0; f<option_functions.size(); ++f)
   {
-    // check: columns must be of index smaller than index of field
     if (cols[f] >= m_field->row_size()) throw SetupError(FromHere(), "Specified column ["+to_str(cols[f])+"] doesn't exist. (field has only "+to_str(m_field->row_size())+" cols)");
-    functions[f].parse(option_functions[f],variable_names);
   }
 
+  // create the functions
+  math::VectorialFunction functions;
+  functions.functions(option_functions);
+  functions.variables(variable_names);
+  functions.parse();
+
   std::vector<Real> constants;
   constants.push_back( options().value<Real>("time") );
 
-  std::vector<Real> variables(variable_names.size());
+  // Evaluate the functions for chunks of points at a time
+  const Uint nb_vars = variable_names.size();
+  const Uint nb_funcs = option_functions.size();
+  const Uint chunk_size = 1024;
+  std::vector<Real> variables(chunk_size*nb_vars);
+  std::vector<Real> results(chunk_size*nb_funcs);
 
-  for (Uint pt=0; pt<dict.size(); ++pt)
+  for (Uint chunk_begin=0; chunk_begin<dict.size(); chunk_begin+=chunk_size)
   {
+    const Uint chunk_end = std::min(dict.size(), chunk_begin+chunk_size);
+
     // Assemble variables per point
-    Uint c=0;
-    for (Uint j=0; j<field_comps.size(); ++j, ++c)
-    {
-      variables[c] = field_comps[j]->array()[pt][field_cols[j]];
-    }
-    for (Uint j=0; j<constants.size(); ++j, ++c)
+    for (Uint pt=chunk_begin; pt<chunk_end; ++pt)
     {
-      variables[c] = constants[j];
+      Real* point_variables = &variables[(pt-chunk_begin)*nb_vars];
+      Uint c=0;
+      for (Uint j=0; j<field_comps.size(); ++j, ++c)
+      {
+        point_variables[c] = field_comps[j]->array()[pt][field_cols[j]];
+      }
+      for (Uint j=0; j<constants.size(); ++j, ++c)
+      {
+        point_variables[c] = constants[j];
+      }
     }
 
     // Evaluate functions
-    for (Uint f=0; f<cols.size(); ++f)
+    functions.evaluate_batch(&variables[0], nb_vars, &results[0], nb_funcs, chunk_end-chunk_begin);
+
+    for (Uint pt=chunk_begin; pt<chunk_end; ++pt)
     {
-      m_field->array()[pt][f] = functions[f](variables);
+      for (Uint f=0; f<nb_funcs; ++f)
+      {
+        m_field->array()[pt][f] = results[(pt-chunk_begin)*nb_funcs + f];
+      }
     }
   }
 }
@@ -52,6 +52,11 @@ LoadBalance::LoadBalance( const std::string& name ) :
     "  Usage: LoadBalance Regions:array[uri]=region1,region2\n\n";
   properties()["description"] = desc;
 
+  options().add("vertex_weights", std::string("ElementType"))
+      .description("Weight of the elements for the partitioner: Uniform, ElementType or Measured. "
+                   "Measured uses the per-region costs stored in the mesh metadata by a previous run")
+      .pretty_name("Vertex Weights");
+
 #if (defined CF3_HAVE_PTSCOTCH)
   // no configuration necessary
 #elif (defined CF3_HAVE_ZOLTAN)
@@ -92,6 +97,7 @@ void LoadBalance::execute()
     CFwarn << "  Skipping mesh partitioning. (No partitioner available)" << CFendl;
 #else
     CFinfo << "  + partitioning and migrating ..." << CFendl;
+    m_partitioner->options().set("vertex_weights", options().value<std::string>("vertex_weights"));
     m_partitioner->transform(mesh);
     CFinfo << "  + partitioning and migrating ... done" << CFendl;
 #endif
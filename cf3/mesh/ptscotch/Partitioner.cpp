@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 // coolfluid
 #include "common/Builder.hpp"
 #include "common/OptionList.hpp"
@@ -83,7 +85,20 @@ void Partitioner::build_graph()
 
   cf3_assert(edgelocsiz >= vertloctab[vertlocnbr]);
 
-  list_of_connected_objects_in_part(Comm::instance().rank(),edgeloctab);
+  // Edges all have unit weight, so no arc loads are passed to PT-Scotch
+  std::vector<Real> edge_weights(total_nb_edges);
+  list_of_connected_objects_in_part(Comm::instance().rank(),edgeloctab,edge_weights);
+
+  // PT-Scotch vertex loads are integers, the weights are relative to a node of weight 1
+  veloloctab.clear();
+  if (has_object_weights())
+  {
+    std::vector<Real> obj_weights(vertlocnbr);
+    list_of_object_weights_in_part(Comm::instance().rank(),obj_weights);
+    veloloctab.resize(vertlocnbr);
+    for (int i=0; i<vertlocnbr; ++i)
+      veloloctab[i] = std::max(static_cast<SCOTCH_Num>(obj_weights[i] + 0.5), static_cast<SCOTCH_Num>(1));
+  }
 
   if (SCOTCH_dgraphBuild(&graph,
                          baseval,
@@ -91,7 +106,7 @@ void Partitioner::build_graph()
                          vertlocmax,          // max number of local vertices to be created (for creation of procvrttab)
                          &vertloctab[0],  // local adjacency index array (size = vertlocnbr+1 if vendloctab matches or is null)
                          &vertloctab[1],  //   (optional) local adjacency end index array
-                         NULL, //veloloctab,  //   (optional) local vertex load array
+                         veloloctab.empty() ? NULL : &veloloctab[0],  //   (optional) local vertex load array
                          NULL,  //vlblocltab,  //   (optional) local vertex label array (size = vertlocnbr+1)
                          edgelocnbr,      // total number of arcs (twice number of edges)
                          edgelocsiz,      // minimum size of the edge array required to encompass all used adjacency values (at least equal to the max of vendloctab entries)
@@ -48,6 +48,16 @@ Partitioner::Partitioner ( const std::string& name ) :
       .description("Internal zoltan debug level (0 to 10)")
       .pretty_name("Debug Level");
 
+  std::vector<boost::any> approaches;
+  approaches.push_back(std::string("PARTITION"));
+  approaches.push_back(std::string("REPARTITION"));
+  approaches.push_back(std::string("REFINE"));
+  options().add("approach", std::string("PARTITION"))
+      .description("Zoltan load balancing approach: PARTITION from scratch, "
+                   "REPARTITION or REFINE the current distribution to keep the migration low")
+      .pretty_name("Approach")
+      .restricted_list() = approaches;
+
   float version;
   int error_code = Zoltan_Initialize(Core::instance().argc(),Core::instance().argv(),&version);
   cf3_assert_desc("Could not initialize zoltan", error_code == ZOLTAN_OK);
@@ -158,7 +168,7 @@ void Partitioner::set_partitioning_params()
   // HIER (for hybrid hierarchical partitioning)
   // NONE (for no load balancing).
 
-  zoltan_handle().Set_Param( "LB_APPROACH", "PARTITION");
+  zoltan_handle().Set_Param( "LB_APPROACH", options()["approach"].value<std::string>());
   // The desired load balancing approach. Only LB_METHOD = HYPERGRAPH or GRAPH
   // uses the LB_APPROACH parameter. Valid values are
   //   PARTITION (Partition "from scratch," not taking into account the current data distribution;
@@ -219,6 +229,7 @@ void Partitioner::set_partitioning_params()
   // 2 = full checking. (CHECK_GRAPH==2 is very slow and should be used only during debugging).
 
   zoltan_handle().Set_Param("EDGE_WEIGHT_DIM", "1");
+  zoltan_handle().Set_Param("OBJ_WEIGHT_DIM", has_object_weights() ? "1" : "0");
 
   /// zoltan Query functions
 
@@ -248,7 +259,8 @@ void Partitioner::query_list_of_objects(void *data, int sizeGID, int sizeLID,
   *ierr = ZOLTAN_OK;
 
   p.list_of_objects_owned_by_part(PE::Comm::instance().rank(),globalID);
-
+  if (wgt_dim > 0)
+    p.list_of_object_weights_in_part(PE::Comm::instance().rank(),obj_wgts);
 
   // for debugging
 #if 0
@@ -32,5 +32,135 @@ Variables::~Variables()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+  /// Copy a table row to a vector
+  void copy_row(const Table<Real>::ConstRow row, RealVector& vec)
+  {
+    const Uint row_size = row.size();
+    for(Uint j = 0; j != row_size; ++j)
+      vec[j] = row[j];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::compute_variables_row(const Properties& p, Table<Real>::Row vars)
+{
+  RealVector vars_vec(vars.size());
+  compute_variables(p, vars_vec);
+  const Uint row_size = vars.size();
+  for(Uint j = 0; j != row_size; ++j)
+    vars[j] = vars_vec[j];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::convert_batch(const Table<Real>& coords, const Table<Real>& sol, const Uint begin, const Uint end, Properties& p, Variables& output_vars, Table<Real>& output)
+{
+  RealVector coord(coords.row_size());
+  RealVector vars(sol.row_size());
+  const RealMatrix grad_vars = RealMatrix::Zero(sol.row_size(), coords.row_size());
+  for(Uint i = begin; i != end; ++i)
+  {
+    detail::copy_row(coords[i], coord);
+    detail::copy_row(sol[i], vars);
+    compute_properties(coord, vars, grad_vars, p);
+    output_vars.compute_variables_row(p, output[i]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::flux_batch(const Table<Real>& coords, const Table<Real>& sol, const Uint begin, const Uint end, Properties& p, Real* flux)
+{
+  const Uint ndim = coords.row_size();
+  const Uint neqs = sol.row_size();
+  RealVector coord(ndim);
+  RealVector vars(neqs);
+  const RealMatrix grad_vars = RealMatrix::Zero(neqs, ndim);
+  RealMatrix point_flux(neqs, ndim);
+  for(Uint i = begin; i != end; ++i)
+  {
+    detail::copy_row(coords[i], coord);
+    detail::copy_row(sol[i], vars);
+    compute_properties(coord, vars, grad_vars, p);
+    this->flux(p, point_flux);
+    Eigen::Map<RealMatrix>(flux + (i-begin)*neqs*ndim, neqs, ndim) = point_flux;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::flux_batch(const Table<Real>& coords, const Table<Real>& sol, const Uint begin, const Uint end, const Real* directions, Properties& p, Real* flux)
+{
+  const Uint ndim = coords.row_size();
+  const Uint neqs = sol.row_size();
+  RealVector coord(ndim);
+  RealVector vars(neqs);
+  const RealMatrix grad_vars = RealMatrix::Zero(neqs, ndim);
+  RealVector direction(ndim);
+  RealVector point_flux(neqs);
+  for(Uint i = begin; i != end; ++i)
+  {
+    detail::copy_row(coords[i], coord);
+    detail::copy_row(sol[i], vars);
+    compute_properties(coord, vars, grad_vars, p);
+    direction = Eigen::Map<const RealVector>(directions + (i-begin)*ndim, ndim);
+    this->flux(p, direction, point_flux);
+    Eigen::Map<RealVector>(flux + (i-begin)*neqs, neqs) = point_flux;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::flux_jacobian_eigen_values_batch(const Table<Real>& coords, const Table<Real>& sol, const Uint begin, const Uint end, const Real* directions, Properties& p, Real* evalues)
+{
+  const Uint ndim = coords.row_size();
+  const Uint neqs = sol.row_size();
+  RealVector coord(ndim);
+  RealVector vars(neqs);
+  const RealMatrix grad_vars = RealMatrix::Zero(neqs, ndim);
+  RealVector direction(ndim);
+  RealVector point_evalues(neqs);
+  for(Uint i = begin; i != end; ++i)
+  {
+    detail::copy_row(coords[i], coord);
+    detail::copy_row(sol[i], vars);
+    compute_properties(coord, vars, grad_vars, p);
+    direction = Eigen::Map<const RealVector>(directions + (i-begin)*ndim, ndim);
+    flux_jacobian_eigen_values(p, direction, point_evalues);
+    Eigen::Map<RealVector>(evalues + (i-begin)*neqs, neqs) = point_evalues;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Variables::flux_jacobian_eigen_structure_batch(const Table<Real>& coords, const Table<Real>& sol, const Uint begin, const Uint end, const Real* directions, Properties& p, Real* Rv, Real* Lv, Real* evalues)
+{
+  const Uint ndim = coords.row_size();
+  const Uint neqs = sol.row_size();
+  RealVector coord(ndim);
+  RealVector vars(neqs);
+  const RealMatrix grad_vars = RealMatrix::Zero(neqs, ndim);
+  RealVector direction(ndim);
+  RealMatrix point_Rv(neqs, neqs);
+  RealMatrix point_Lv(neqs, neqs);
+  RealVector point_evalues(neqs);
+  for(Uint i = begin; i != end; ++i)
+  {
+    detail::copy_row(coords[i], coord);
+    detail::copy_row(sol[i], vars);
+    compute_properties(coord, vars, grad_vars, p);
+    direction = Eigen::Map<const RealVector>(directions + (i-begin)*ndim, ndim);
+    flux_jacobian_eigen_structure(p, direction, point_Rv, point_Lv, point_evalues);
+    Eigen::Map<RealMatrix>(Rv + (i-begin)*neqs*neqs, neqs, neqs) = point_Rv;
+    Eigen::Map<RealMatrix>(Lv + (i-begin)*neqs*neqs, neqs, neqs) = point_Lv;
+    Eigen::Map<RealVector>(evalues + (i-begin)*neqs, neqs) = point_evalues;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // physics
 } // cf3
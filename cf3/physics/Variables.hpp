@@ -12,6 +12,7 @@
 #include <boost/scoped_ptr.hpp>
 
 #include "common/Component.hpp"
+#include "common/Table.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 #include "math/MatrixTypes.hpp"
@@ -107,6 +108,69 @@ public: // functions
 
   //@} END INTERFACE
 
+  /// @name BATCHED INTERFACE
+  /// Evaluate rows [begin, end) of the table sol, holding the variables of this set. For each row, the properties
+  /// are computed into p from the matching row of coords and a zero gradient, followed by the requested quantity.
+  /// p is scratch storage created by PhysModel::create_properties, so it holds the model constants.
+  /// Directions and results are stored point by point, using a fixed number of values for each point and
+  /// column-major order for matrices. The default implementations loop over the pointwise interface, VariablesT
+  /// overrides them with loops over the static functions that use only fixed-size temporaries.
+  //@{
+
+  /// compute the variables of this set from the properties, storing them in a table row
+  virtual void compute_variables_row (const physics::Properties& p,
+                                      common::Table<Real>::Row vars);
+
+  /// convert rows [begin, end) of sol to the variables of output_vars, e.g. from primitive to conservative variables.
+  /// The result is stored in the same rows of output.
+  virtual void convert_batch (const common::Table<Real>& coords,
+                              const common::Table<Real>& sol,
+                              const Uint begin,
+                              const Uint end,
+                              physics::Properties& p,
+                              Variables& output_vars,
+                              common::Table<Real>& output);
+
+  /// compute the physical flux, neqs x ndim values per point
+  virtual void flux_batch (const common::Table<Real>& coords,
+                           const common::Table<Real>& sol,
+                           const Uint begin,
+                           const Uint end,
+                           physics::Properties& p,
+                           Real* flux);
+
+  /// compute the physical flux in the given directions (ndim values per point), neqs values per point
+  virtual void flux_batch (const common::Table<Real>& coords,
+                           const common::Table<Real>& sol,
+                           const Uint begin,
+                           const Uint end,
+                           const Real* directions,
+                           physics::Properties& p,
+                           Real* flux);
+
+  /// compute the eigen values of the flux jacobians in the given directions, neqs values per point
+  virtual void flux_jacobian_eigen_values_batch (const common::Table<Real>& coords,
+                                                 const common::Table<Real>& sol,
+                                                 const Uint begin,
+                                                 const Uint end,
+                                                 const Real* directions,
+                                                 physics::Properties& p,
+                                                 Real* evalues);
+
+  /// decompose the eigen structure of the flux jacobians in the given directions,
+  /// neqs x neqs values per point for Rv and Lv and neqs values per point for evalues
+  virtual void flux_jacobian_eigen_structure_batch (const common::Table<Real>& coords,
+                                                    const common::Table<Real>& sol,
+                                                    const Uint begin,
+                                                    const Uint end,
+                                                    const Real* directions,
+                                                    physics::Properties& p,
+                                                    Real* Rv,
+                                                    Real* Lv,
+                                                    Real* evalues);
+
+  //@} END BATCHED INTERFACE
+
 }; // Variables
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -230,9 +294,163 @@ public:
 
   virtual math::VariablesDescriptor& description() { return *m_description; }
 
+  /// compute the variables from the properties, storing them in a table row
+  virtual void compute_variables_row (const physics::Properties& p,
+                                      common::Table<Real>::Row vars)
+  {
+    typename PHYS::MODEL::Properties const& cp =
+        static_cast<typename PHYS::MODEL::Properties const&>( p );
+
+    typename BatchTypes::SolV v;
+    PHYS::compute_variables( cp, v );
+    for(Uint j = 0; j != BatchTypes::neqs; ++j)
+      vars[j] = v[j];
+  }
+
+  /// convert rows [begin, end) of sol to the variables of output_vars
+  virtual void convert_batch (const common::Table<Real>& coords,
+                              const common::Table<Real>& sol,
+                              const Uint begin,
+                              const Uint end,
+                              physics::Properties& p,
+                              Variables& output_vars,
+                              common::Table<Real>& output)
+  {
+    typename PHYS::MODEL::Properties& cp =
+        static_cast<typename PHYS::MODEL::Properties&>( p );
+
+    BatchTypes point;
+    for(Uint i = begin; i != end; ++i)
+    {
+      point.compute_properties( coords[i], sol[i], cp );
+      output_vars.compute_variables_row( cp, output[i] );
+    }
+  }
+
+  /// compute the physical flux for rows [begin, end) of sol
+  virtual void flux_batch (const common::Table<Real>& coords,
+                           const common::Table<Real>& sol,
+                           const Uint begin,
+                           const Uint end,
+                           physics::Properties& p,
+                           Real* flux)
+  {
+    typename PHYS::MODEL::Properties& cp =
+        static_cast<typename PHYS::MODEL::Properties&>( p );
+
+    BatchTypes point;
+    for(Uint i = begin; i != end; ++i)
+    {
+      point.compute_properties( coords[i], sol[i], cp );
+      Eigen::Map<typename BatchTypes::SolM> point_flux( flux + (i-begin)*BatchTypes::neqs*BatchTypes::ndim );
+      PHYS::flux( cp, point_flux );
+    }
+  }
+
+  /// compute the physical flux in the given directions for rows [begin, end) of sol
+  virtual void flux_batch (const common::Table<Real>& coords,
+                           const common::Table<Real>& sol,
+                           const Uint begin,
+                           const Uint end,
+                           const Real* directions,
+                           physics::Properties& p,
+                           Real* flux)
+  {
+    typename PHYS::MODEL::Properties& cp =
+        static_cast<typename PHYS::MODEL::Properties&>( p );
+
+    BatchTypes point;
+    for(Uint i = begin; i != end; ++i)
+    {
+      point.compute_properties( coords[i], sol[i], cp );
+      const Eigen::Map<const typename BatchTypes::GeoV> direction( directions + (i-begin)*BatchTypes::ndim );
+      Eigen::Map<typename BatchTypes::SolV> point_flux( flux + (i-begin)*BatchTypes::neqs );
+      PHYS::flux( cp, direction, point_flux );
+    }
+  }
+
+  /// compute the eigen values of the flux jacobians for rows [begin, end) of sol
+  virtual void flux_jacobian_eigen_values_batch (const common::Table<Real>& coords,
+                                                 const common::Table<Real>& sol,
+                                                 const Uint begin,
+                                                 const Uint end,
+                                                 const Real* directions,
+                                                 physics::Properties& p,
+                                                 Real* evalues)
+  {
+    typename PHYS::MODEL::Properties& cp =
+        static_cast<typename PHYS::MODEL::Properties&>( p );
+
+    BatchTypes point;
+    for(Uint i = begin; i != end; ++i)
+    {
+      point.compute_properties( coords[i], sol[i], cp );
+      const Eigen::Map<const typename BatchTypes::GeoV> direction( directions + (i-begin)*BatchTypes::ndim );
+      Eigen::Map<typename BatchTypes::SolV> point_evalues( evalues + (i-begin)*BatchTypes::neqs );
+      PHYS::flux_jacobian_eigen_values( cp, direction, point_evalues );
+    }
+  }
+
+  /// decompose the eigen structure of the flux jacobians for rows [begin, end) of sol
+  virtual void flux_jacobian_eigen_structure_batch (const common::Table<Real>& coords,
+                                                    const common::Table<Real>& sol,
+                                                    const Uint begin,
+                                                    const Uint end,
+                                                    const Real* directions,
+                                                    physics::Properties& p,
+                                                    Real* Rv,
+                                                    Real* Lv,
+                                                    Real* evalues)
+  {
+    typename PHYS::MODEL::Properties& cp =
+        static_cast<typename PHYS::MODEL::Properties&>( p );
+
+    BatchTypes point;
+    for(Uint i = begin; i != end; ++i)
+    {
+      point.compute_properties( coords[i], sol[i], cp );
+      const Eigen::Map<const typename BatchTypes::GeoV> direction( directions + (i-begin)*BatchTypes::ndim );
+      Eigen::Map<typename BatchTypes::JacM> point_Rv( Rv + (i-begin)*BatchTypes::neqs*BatchTypes::neqs );
+      Eigen::Map<typename BatchTypes::JacM> point_Lv( Lv + (i-begin)*BatchTypes::neqs*BatchTypes::neqs );
+      Eigen::Map<typename BatchTypes::SolV> point_evalues( evalues + (i-begin)*BatchTypes::neqs );
+      PHYS::flux_jacobian_eigen_structure( cp, direction, point_Rv, point_Lv, point_evalues );
+    }
+  }
+
 private:
   boost::shared_ptr<math::VariablesDescriptor> m_description;
 
+  /// Fixed-size storage for the input of a single point in the batched functions.
+  /// This is a member class, so it is only instantiated once PHYS is complete.
+  struct BatchTypes
+  {
+    enum { ndim = PHYS::MODEL::_ndim };
+    enum { neqs = PHYS::MODEL::_neqs };
+
+    typedef Eigen::Matrix<Real, ndim, 1>    GeoV;
+    typedef Eigen::Matrix<Real, neqs, 1>    SolV;
+    typedef Eigen::Matrix<Real, neqs, ndim> SolM;
+    typedef Eigen::Matrix<Real, neqs, neqs> JacM;
+
+    BatchTypes() { grad_vars.setZero(); }
+
+    /// Copy the rows into fixed-size storage and compute the properties, with zero gradient
+    void compute_properties(const common::Table<Real>::ConstRow coords_row,
+                            const common::Table<Real>::ConstRow sol_row,
+                            typename PHYS::MODEL::Properties& cp)
+    {
+      for(Uint j = 0; j != ndim; ++j)
+        coord[j] = coords_row[j];
+      for(Uint j = 0; j != neqs; ++j)
+        sol[j] = sol_row[j];
+      PHYS::compute_properties( coord, sol, grad_vars, cp );
+    }
+
+    GeoV coord;
+    SolV sol;
+    SolM grad_vars;
+  };
+
 }; // VariablesT
 
 ////////////////////////////////////////////////////////////////////////////////
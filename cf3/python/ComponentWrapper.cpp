@@ -20,6 +20,7 @@
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 #include "common/TimedComponent.hpp"
+#include "common/AccountedComponent.hpp"
 #include "common/TypeInfo.hpp"
 #include "common/Signal.hpp"
 #include "common/UUCount.hpp"
@@ -380,6 +381,16 @@ void print_timing_tree(ComponentWrapper& self)
   cf3::common::print_timing_tree(self.component());
 }
 
+void print_memory_tree(ComponentWrapper& self)
+{
+  cf3::common::print_memory_tree(self.component());
+}
+
+Real store_memory_usage(ComponentWrapper& self)
+{
+  return cf3::common::store_memory_usage(self.component());
+}
+
 void configure_option_recursively(ComponentWrapper& self, const std::string& option_name, const boost::python::object& value)
 {
     self.component().configure_option_recursively(option_name, python_to_any(value));
@@ -705,6 +716,8 @@ void def_component()
     .def("access_component", access_component_uri)
     .def("access_component", access_component_str)
     .def("print_timing_tree", print_timing_tree)
+    .def("print_memory_tree", print_memory_tree, "Print the memory held by each component of the tree, over all CPUs. This is a collective operation")
+    .def("store_memory_usage", store_memory_usage, "Store the bytes held by each component into the properties memory_total and memory_bytes, returning the total")
     .add_property("options", component_options)
     .add_property("properties", component_properties)
     .add_property("children", component_children)
@@ -0,0 +1,208 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Builder.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/TimedComponent.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/System.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshTransformer.hpp"
+
+#include "solver/Solver.hpp"
+#include "solver/actions/DynamicLoadBalance.hpp"
+#include "solver/actions/StoreMeasuredCosts.hpp"
+
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < DynamicLoadBalance, common::Action, LibActions > DynamicLoadBalance_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+DynamicLoadBalance::DynamicLoadBalance ( const std::string& name ) :
+  solver::Action(name),
+  m_nb_executions(0),
+  m_previous_time(0.)
+{
+  options().add("actions", std::vector<URI>())
+      .pretty_name("Actions")
+      .description("Timed actions that measure the work of each process. If empty, all solver actions below the parent of this component are used")
+      .mark_basic();
+
+  options().add("check_interval", 10u)
+      .pretty_name("Check Interval")
+      .description("Number of executions between two checks of the imbalance")
+      .mark_basic();
+
+  options().add("imbalance_threshold", 0.1)
+      .pretty_name("Imbalance Threshold")
+      .description("Repartition when the time of the slowest process exceeds the average by this fraction")
+      .mark_basic();
+
+  options().add("vertex_weights", std::string("Measured"))
+      .pretty_name("Vertex Weights")
+      .description("Weights used by the partitioner: Uniform, ElementType or Measured");
+
+  properties().add("imbalance", 0.);
+  properties().add("nb_repartitions", 0u);
+
+  m_store_costs = create_static_component<StoreMeasuredCosts>("StoreMeasuredCosts");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector< Handle<solver::Action> > DynamicLoadBalance::monitored_actions()
+{
+  std::vector< Handle<solver::Action> > result;
+  const std::vector<URI> action_uris = options().value< std::vector<URI> >("actions");
+  if(action_uris.empty())
+  {
+    if(is_not_null(parent()))
+    {
+      // Only the leaf actions, since the time of an action that contains other actions includes theirs
+      boost_foreach(solver::Action& action, find_components_recursively<solver::Action>(*parent()))
+      {
+        if(&action != this && is_null(find_component_ptr_recursively<solver::Action>(action)))
+          result.push_back(action.handle<solver::Action>());
+      }
+    }
+  }
+  else
+  {
+    boost_foreach(const URI& action_uri, action_uris)
+    {
+      Handle<solver::Action> action(access_component(action_uri));
+      if(is_null(action))
+        throw SetupError(FromHere(), "Component at " + action_uri.path() + " is not a solver action");
+      result.push_back(action);
+    }
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real DynamicLoadBalance::monitored_time()
+{
+  Real result = 0.;
+  boost_foreach(const Handle<solver::Action>& action, monitored_actions())
+  {
+    TimedComponent* timed_action = dynamic_cast<TimedComponent*>(action.get());
+    if(is_null(timed_action))
+      continue;
+    timed_action->store_timings();
+    if(action->properties().check("timer_mean"))
+      result += action->properties().value<Real>("timer_mean") * static_cast<Real>(action->properties().value<Uint>("timer_count"));
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void DynamicLoadBalance::execute()
+{
+  PE::Comm& comm = PE::Comm::instance();
+  if(!comm.is_active() || comm.size() < 2)
+    return;
+
+  const Uint check_interval = options().value<Uint>("check_interval");
+  if(check_interval == 0 || ++m_nb_executions % check_interval != 0)
+    return;
+
+  const Real current_time = monitored_time();
+  const Real step_time = current_time - m_previous_time;
+  m_previous_time = current_time;
+
+  Real max_time, total_time;
+  comm.all_reduce(PE::max(), &step_time, 1, &max_time);
+  comm.all_reduce(PE::plus(), &step_time, 1, &total_time);
+  if(total_time <= 0.)
+    return;
+
+  const Real imbalance = max_time / (total_time / static_cast<Real>(comm.size())) - 1.;
+  properties()["imbalance"] = imbalance;
+  CFdebug << "Load imbalance for " << uri().path() << ": " << imbalance << CFendl;
+
+  if(imbalance > options().value<Real>("imbalance_threshold"))
+  {
+    CFinfo << "Load imbalance of " << imbalance * 100. << "% exceeds the threshold, repartitioning" << CFendl;
+    repartition();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void DynamicLoadBalance::repartition()
+{
+  Mesh& mesh = this->mesh();
+
+  // Make the measured work of the monitored actions available to the partitioner
+  std::vector<URI> action_uris;
+  boost_foreach(const Handle<solver::Action>& action, monitored_actions())
+    action_uris.push_back(action->uri());
+  m_store_costs->options().set("actions", action_uris);
+  m_store_costs->execute();
+
+  // The transformers each raise mesh_changed, which is delayed until the mesh is consistent again
+  mesh.block_mesh_changed(true);
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.RemoveGhostElements", "remove_ghosts")->transform(mesh);
+
+  boost::shared_ptr<MeshTransformer> load_balance = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance", "load_balance");
+  load_balance->options().set("vertex_weights", options().value<std::string>("vertex_weights"));
+  Handle<Component> partitioner = load_balance->get_child("partitioner");
+  if(is_not_null(partitioner) && partitioner->options().check("approach"))
+    partitioner->options().set("approach", std::string("REPARTITION"));
+  load_balance->transform(mesh);
+
+  // Comm patterns and linear systems were built for the old distribution. The fields only keep a handle to
+  // the comm pattern of their dictionary, so they are added to a new one.
+  boost_foreach(Dictionary& dict, find_components_recursively<Dictionary>(mesh))
+  {
+    if(is_not_null(dict.get_child("CommPattern")))
+      dict.remove_component("CommPattern");
+    boost_foreach(Field& field, find_components<Field>(dict))
+      field.parallelize();
+  }
+  if(is_not_null(m_solver))
+  {
+    boost_foreach(math::LSS::System& lss, find_components_recursively<math::LSS::System>(*m_solver))
+    {
+      if(lss.is_created())
+        lss.destroy();
+    }
+  }
+
+  mesh.block_mesh_changed(false);
+  mesh.raise_mesh_changed();
+
+  properties()["nb_repartitions"] = properties().value<Uint>("nb_repartitions") + 1u;
+
+  // Restart the measurement for the new distribution
+  m_previous_time = monitored_time();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
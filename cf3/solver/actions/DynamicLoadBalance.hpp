@@ -0,0 +1,71 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_DynamicLoadBalance_hpp
+#define cf3_solver_actions_DynamicLoadBalance_hpp
+
+#include "solver/Action.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+class StoreMeasuredCosts;
+
+/// Repartition the mesh during a run when the work is no longer balanced between the processes.
+///
+/// Every check_interval executions, the time spent by the monitored timed actions since the previous check is
+/// compared between processes. If the slowest process exceeds the average by more than imbalance_threshold,
+/// the measured costs are stored in the mesh metadata and the mesh is load balanced again using these costs,
+/// with the Zoltan REPARTITION approach if available. Fields move along with the nodes. Afterwards, the comm patterns
+/// are rebuilt for all fields, the linear systems of the solver (if configured) are discarded, and a single
+/// mesh_changed event lets the solver rebuild them.
+/// By default, the leaf solver actions below the parent of this component are monitored.
+class solver_actions_API DynamicLoadBalance : public solver::Action {
+
+public: // functions
+  /// Contructor
+  /// @param name of the component
+  DynamicLoadBalance ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~DynamicLoadBalance() {}
+
+  /// Get the class name
+  static std::string type_name () { return "DynamicLoadBalance"; }
+
+  /// execute the action
+  virtual void execute ();
+
+  /// Repartition the mesh, regardless of the imbalance
+  void repartition();
+
+private:
+  /// The monitored actions
+  std::vector< Handle<solver::Action> > monitored_actions();
+
+  /// Total time spent in the monitored actions on this process
+  Real monitored_time();
+
+  Handle<StoreMeasuredCosts> m_store_costs;
+
+  Uint m_nb_executions;
+
+  /// Value of monitored_time() at the previous check
+  Real m_previous_time;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
+
+#endif // cf3_solver_actions_DynamicLoadBalance_hpp
@@ -27,6 +27,7 @@
 #include "solver/actions/Probe.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/InterpolationMatrix.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/PointInterpolator.hpp"
 
@@ -127,6 +128,11 @@ void Probe::execute()
 //  std::cout << PE::Comm::instance().rank() << ":  elem_comp = " << elem_comp << std::endl;
 //  std::cout << PE::Comm::instance().rank() << ":  glb_idx = " << glb_idx << std::endl;
 
+  InterpolationMatrix interpolation;
+  if (found)
+    interpolation.add_row(m_points,m_weights);
+
+  std::vector<Uint> vars;
   boost_foreach (const Handle<Field>& field, m_dict->fields())
   {
 
@@ -135,14 +141,10 @@ void Probe::execute()
 
     if (found)
     {
-      for(Uint v=0; v<interpolated.size(); ++v)
-      {
-        interpolated[v]=0.;
-        for(Uint i=0; i<m_points.size(); ++i)
-        {
-          interpolated[v] += field->array()[m_points[i]][v] * m_weights[i];
-        }
-      }
+      vars.resize(field->row_size());
+      for(Uint v=0; v<vars.size(); ++v)
+        vars[v]=v;
+      interpolation.apply(*field,vars,interpolated);
     }
 
     PE::Comm::instance().broadcast(interpolated,interpolated,found_on_proc);
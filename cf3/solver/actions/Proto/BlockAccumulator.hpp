@@ -18,6 +18,7 @@
 #include "math/LSS/System.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
 #include "math/LSS/Matrix.hpp"
+#include "math/LSS/StaticCondensation.hpp"
 
 #include "LSSWrapper.hpp"
 #include "Terminals.hpp"
@@ -76,6 +77,21 @@ inline void do_assign_op_matrix(boost::proto::tag::plus_assign, math::LSS::Matri
   lss_matrix.add_values(block_accumulator);
 }
 
+/// Element matrices with condensed interior nodes are stored by the static condensation instead of being added to the matrix
+/// @return true if the block was handled by the static condensation
+inline bool do_condense_op_matrix(boost::proto::tag::plus_assign, math::LSS::StaticCondensation& condensation, const math::LSS::BlockAccumulator& block_accumulator)
+{
+  return condensation.add_values(block_accumulator);
+}
+
+/// Assignment can't be condensed, since the element matrix is not complete
+inline bool do_condense_op_matrix(boost::proto::tag::assign, math::LSS::StaticCondensation& condensation, const math::LSS::BlockAccumulator& block_accumulator)
+{
+  if(condensation.contains_interior_node(block_accumulator.indices))
+    throw common::NotSupported(FromHere(), "Element matrices with condensed interior nodes can only be added to the system matrix");
+  return false;
+}
+
 /// Translate tag to operator
 inline void do_assign_op_rhs(boost::proto::tag::assign, math::LSS::Vector& lss_rhs, const math::LSS::BlockAccumulator& block_accumulator)
 {
@@ -125,7 +141,9 @@ struct BlockAssignmentOp<SystemMatrixTag, OpTagT>
         block_accumulator.mat(block_row, block_col) = rhs(row, col);
       }
     }
-    do_assign_op_matrix(OpTagT(), lss.matrix(), block_accumulator);
+    math::LSS::StaticCondensation* condensation = lss.lss().static_condensation().get();
+    if(is_null(condensation) || !do_condense_op_matrix(OpTagT(), *condensation, block_accumulator))
+      do_assign_op_matrix(OpTagT(), lss.matrix(), block_accumulator);
   }
 };
 
@@ -7,6 +7,7 @@
 #ifndef cf3_solver_actions_Proto_DirichletBC_hpp
 #define cf3_solver_actions_Proto_DirichletBC_hpp
 
+#include <boost/proto/context.hpp>
 #include <boost/proto/core.hpp>
 
 #include "math/MatrixTypes.hpp"
@@ -30,12 +31,12 @@ struct DirichletBCTag
 /// Used to create placeholders for a Dirichlet condition
 typedef LSSWrapper<DirichletBCTag> DirichletBC;
 
-/// Helper function for assignment
+/// Helper function for assignment. The condition is queued, and applied for all nodes at once by ApplyQueuedDirichlet after the loop
 inline void assign_dirichlet(math::LSS::System& lss, const Real new_value, const Real old_value, const int node_idx, const Uint offset)
 {
   if(node_idx < 0)
     return;
-  lss.dirichlet(node_idx, offset, new_value - old_value, true);
+  lss.queue_dirichlet(node_idx, offset, new_value - old_value);
 }
 
 /// Overload for vector types
@@ -45,9 +46,21 @@ inline void assign_dirichlet(math::LSS::System& lss, const NewT& new_value, cons
   if(node_idx < 0)
     return;
   for(Uint i = 0; i != OldT::RowsAtCompileTime; ++i)
-    lss.dirichlet(node_idx, offset+i, new_value[i] - old_value[i], true);
+    lss.queue_dirichlet(node_idx, offset+i, new_value[i] - old_value[i]);
 }
 
+/// Applies the conditions queued by the Dirichlet BC terminals in an expression, in one batch per linear system
+struct ApplyQueuedDirichlet
+  : boost::proto::callable_context< ApplyQueuedDirichlet, boost::proto::null_context >
+{
+  typedef void result_type;
+
+  void operator()(boost::proto::tag::terminal, LSSWrapperImpl<DirichletBCTag>& bc)
+  {
+    bc.lss().apply_queued_dirichlet(true);
+  }
+};
+
 /// Sets whole-variable dirichlet BC, allowing the use of a complete vector as value
 struct DirichletBCSetter :
   boost::proto::transform<DirichletBCSetter>
@@ -7,6 +7,10 @@
 #ifndef cf3_solver_actions_Proto_ElementData_hpp
 #define cf3_solver_actions_Proto_ElementData_hpp
 
+#include <algorithm>
+#include <limits>
+
+#include <boost/array.hpp>
 #include <boost/fusion/algorithm/iteration/for_each.hpp>
 #include <boost/fusion/adapted/mpl.hpp>
 #include <boost/fusion/mpl.hpp>
@@ -20,6 +24,7 @@
 #include <boost/mpl/transform.hpp>
 #include <boost/mpl/vector_c.hpp>
 
+#include "common/BasicExceptions.hpp"
 #include "common/Component.hpp"
 #include "common/FindComponents.hpp"
 
@@ -34,6 +39,7 @@
 #include "mesh/Dictionary.hpp"
 #include "mesh/ElementData.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/StructuredBlocks.hpp"
 
 #include "ElementMatrix.hpp"
 #include "ElementOperations.hpp"
@@ -83,25 +89,68 @@ public:
   /// Return type of the value() method
   typedef const ValueT& ValueResultT;
 
+  /// Node indices of an element
+  typedef boost::array<Uint, EtypeT::nb_nodes> NodeIndicesT;
+
   /// We store nodes as a fixed-size Eigen matrix, so we need to make sure alignment is respected
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   GeometricSupport(const mesh::Elements& elements) :
     m_coordinates(elements.geometry_fields().coordinates()),
-    m_connectivity(elements.geometry_space().connectivity())
+    m_connectivity(elements.geometry_space().connectivity()),
+    m_structured(mesh::StructuredBlocks::find(elements)),
+    m_element_idx(std::numeric_limits<Uint>::max()),
+    m_lattice(0),
+    m_lattice_nx(0),
+    m_lattice_nxy(0)
   {
+    if(is_not_null(m_structured) && m_structured->nb_element_nodes() != EtypeT::nb_nodes)
+      m_structured.reset();
+    if(is_null(m_structured) && !mesh::StructuredBlocks::has_connectivity(m_connectivity))
+      throw common::SetupError(FromHere(), "Elements " + elements.uri().path() + " have neither a connectivity nor a usable structured description");
   }
 
   /// Update nodes for the current element and set the connectivity for the passed block accumulator
   void set_element(const Uint element_idx)
   {
+    if(is_null(m_structured) || element_idx >= m_structured->nb_elements())
+    {
+      // Unstructured elements, or overlap elements appended after the structured blocks
+      const common::Table<Uint>::ConstRow row = m_connectivity[element_idx];
+      std::copy(row.begin(), row.end(), m_element_nodes.begin());
+      mesh::fill(m_nodes, m_coordinates, m_element_nodes);
+    }
+    else if(element_idx == m_element_idx + 1 && m_structured->continues_row(element_idx))
+    {
+      // In a structured block, the next element starts at the next lattice point and the previous element shares
+      // a face, so only the nodes of the opposite face are read
+      ++m_lattice;
+      m_structured->lattice_element_nodes(m_lattice, m_lattice_nx, m_lattice_nxy, m_element_nodes);
+      const Uint nb_shared = m_structured->nb_row_shared_nodes();
+      const Uint* current = m_structured->row_shared_current();
+      const Uint* previous = m_structured->row_shared_previous();
+      const Uint* new_nodes = m_structured->row_new_nodes();
+      for(Uint i = 0; i != nb_shared; ++i)
+        m_nodes.row(current[i]) = m_nodes.row(previous[i]);
+      for(Uint i = 0; i != nb_shared; ++i)
+      {
+        const common::Table<Real>::ConstRow coords = m_coordinates[m_element_nodes[new_nodes[i]]];
+        for(Uint j = 0; j != EtypeT::dimension; ++j)
+          m_nodes(new_nodes[i], j) = coords[j];
+      }
+    }
+    else
+    {
+      m_lattice = m_structured->element_lattice(element_idx, m_lattice_nx, m_lattice_nxy);
+      m_structured->lattice_element_nodes(m_lattice, m_lattice_nx, m_lattice_nxy, m_element_nodes);
+      mesh::fill(m_nodes, m_coordinates, m_element_nodes);
+    }
     m_element_idx = element_idx;
-    mesh::fill(m_nodes, m_coordinates, m_connectivity[element_idx]);
   }
 
   void update_block_connectivity(math::LSS::BlockAccumulator& block_accumulator)
   {
-    block_accumulator.neighbour_indices(m_connectivity[m_element_idx]);
+    block_accumulator.neighbour_indices(m_element_nodes);
   }
 
   /// Reference to the current nodes
@@ -110,10 +159,16 @@ public:
     return m_nodes;
   }
 
-  /// Connectivity data for the current element
-  common::Table<Uint>::ConstRow element_connectivity() const
+  /// Connectivity data for the current element. For structured blocks, this is computed from the lattice
+  const NodeIndicesT& element_connectivity() const
   {
-    return m_connectivity[m_element_idx];
+    return m_element_nodes;
+  }
+
+  /// The geometry connectivity table, which may be empty for structured blocks
+  const common::Table<Uint>& connectivity_table() const
+  {
+    return m_connectivity;
   }
 
   Real volume() const
@@ -231,9 +286,20 @@ private:
   /// Connectivity table
   const common::Table<Uint>& m_connectivity;
 
+  /// Lattice structure of the elements, if they were created as structured blocks
+  Handle<mesh::StructuredBlocks const> m_structured;
+
   /// Index for the current element
   Uint m_element_idx;
 
+  /// Node indices for the current element
+  NodeIndicesT m_element_nodes;
+
+  /// Lattice entry of the first node of the current element and the lattice strides of its block, for structured blocks
+  const Uint* m_lattice;
+  Uint m_lattice_nx;
+  Uint m_lattice_nxy;
+
   /// Temp storage for non-scalar results
   mutable typename EtypeT::SF::ValueT m_sf;
   mutable typename EtypeT::CoordsT m_eval_result;
@@ -360,9 +426,12 @@ public:
     m_field(find_field(elements, placeholder.field_tag())),
     m_connectivity(get_connectivity(placeholder.field_tag(), elements)),
     m_support(support),
+    m_support_nodes(&m_connectivity == &support.connectivity_table() ? support.element_connectivity().data() : 0),
     offset(m_field.descriptor().offset(placeholder.name())),
     m_need_sync(false)
   {
+    if(m_support_nodes == 0 && !mesh::StructuredBlocks::has_connectivity(m_connectivity))
+      throw common::SetupError(FromHere(), "Variable " + placeholder.name() + " has no connectivity in elements " + elements.uri().path());
   }
   
   ~EtypeTVariableData()
@@ -377,16 +446,26 @@ public:
     }
   }
 
-  /// Update nodes for the current element
+  /// Update nodes for the current element. The support must be set to the element first.
   void set_element(const Uint element_idx)
   {
     m_element_idx = element_idx;
-    mesh::fill(m_element_values, m_field, m_connectivity[element_idx], offset);
+    if(m_support_nodes != 0)
+    {
+      // Same nodes as the geometry, possibly computed from a structured lattice
+      std::copy(m_support_nodes, m_support_nodes + EtypeT::nb_nodes, m_element_nodes.begin());
+    }
+    else
+    {
+      const common::Table<Uint>::ConstRow row = m_connectivity[element_idx];
+      std::copy(row.begin(), row.end(), m_element_nodes.begin());
+    }
+    mesh::fill(m_element_values, m_field, m_element_nodes, offset);
   }
 
-  const common::Table<Uint>::ConstRow element_connectivity() const
+  const boost::array<Uint, EtypeT::nb_nodes>& element_connectivity() const
   {
-    return m_connectivity[m_element_idx];
+    return m_element_nodes;
   }
 
   /// Reference to the geometric support
@@ -413,7 +492,7 @@ public:
   template<typename NodeValsT>
   void add_nodal_values(const NodeValsT& vals)
   {
-    const mesh::Connectivity::ConstRow conn = m_connectivity[m_element_idx];
+    const boost::array<Uint, EtypeT::nb_nodes>& conn = m_element_nodes;
     for(Uint i = 0; i != dimension; ++i)
     {
       m_element_values.col(i) += vals.template block<EtypeT::nb_nodes, 1>(i*EtypeT::nb_nodes, 0);
@@ -427,7 +506,7 @@ public:
   template<typename NodeValsT>
   void add_nodal_values_component(const NodeValsT& vals, const Uint component_idx)
   {
-    const mesh::Connectivity::ConstRow conn = m_connectivity[m_element_idx];
+    const boost::array<Uint, EtypeT::nb_nodes>& conn = m_element_nodes;
     for(Uint i = 0; i != EtypeT::nb_nodes; ++i)
     {
       m_element_values(i, component_idx) += vals[i];
@@ -513,8 +592,14 @@ private:
   /// Gemetric support
   const SupportT& m_support;
 
+  /// Node indices of the support, if the variable uses the geometry connectivity
+  const Uint* m_support_nodes;
+
   Uint m_element_idx;
 
+  /// Node indices of the current element
+  boost::array<Uint, EtypeT::nb_nodes> m_element_nodes;
+
   /// Cached data
   mutable typename EtypeT::SF::ValueT m_sf;
   mutable typename EtypeT::SF::GradientT m_mapped_gradient_matrix;
@@ -537,7 +622,8 @@ public:
   typedef ElementBased<Dim> EtypeT;
 
   /// Type of returned value
-  typedef Eigen::Map< Eigen::Matrix<Real, 1, Dim> > ValueResultT;
+  /// The stride between components depends on the layout of the field
+  typedef Eigen::Map< Eigen::Matrix<Real, 1, Dim>, Eigen::Unaligned, Eigen::InnerStride<> > ValueResultT;
 
   /// Data type for the geometric support
   typedef GeometricSupport<SupportEtypeT> SupportT;
@@ -565,7 +651,7 @@ public:
 
   ValueResultT value() const
   {
-    return ValueResultT(&m_field[m_field_idx][offset]);
+    return ValueResultT(&m_field[m_field_idx][offset], Eigen::InnerStride<>(m_field.array().strides()[1]));
   }
 
   typedef typename SupportEtypeT::MappedCoordsT MappedCoordsT;
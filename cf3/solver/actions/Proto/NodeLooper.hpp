@@ -132,6 +132,10 @@ struct NodeLooperDim
 
     // Wrap things up so that we can store the intermediate product results
     do_run(WrapExpression()(m_expr, 0, node_data), node_data, *dict);
+
+    // Dirichlet conditions are collected during the loop, and applied here for all nodes at once
+    ApplyQueuedDirichlet apply_dirichlet;
+    boost::proto::eval(m_expr, apply_dirichlet);
   }
 
 private:
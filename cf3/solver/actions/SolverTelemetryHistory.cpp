@@ -0,0 +1,89 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+
+#include "math/LSS/SolutionStrategy.hpp"
+
+#include "solver/History.hpp"
+#include "solver/actions/SolverTelemetryHistory.hpp"
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < SolverTelemetryHistory, common::Action, LibActions > SolverTelemetryHistory_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+SolverTelemetryHistory::SolverTelemetryHistory ( const std::string& name ) :
+  Action(name),
+  m_save_entry(true)
+{
+  options().add("solution_strategy", m_solution_strategy)
+      .pretty_name("Solution Strategy")
+      .description("Solution strategy to get the telemetry from")
+      .link_to(&m_solution_strategy)
+      .mark_basic();
+
+  options().add("history", m_history)
+      .pretty_name("History")
+      .description("History component that receives the telemetry")
+      .link_to(&m_history)
+      .mark_basic();
+
+  options().add("prefix", m_prefix)
+      .pretty_name("Prefix")
+      .description("Prefix for the names of the history variables. If empty, the name of the parent of the solution strategy (i.e. the linear system) is used.")
+      .link_to(&m_prefix);
+
+  options().add("save_entry", m_save_entry)
+      .pretty_name("Save Entry")
+      .description("Save the history entry after setting the telemetry variables. Disable this if other variables are added to the same entry afterwards.")
+      .link_to(&m_save_entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void SolverTelemetryHistory::execute()
+{
+  if(is_null(m_solution_strategy))
+    throw SetupError(FromHere(), "No solution strategy configured for " + uri().path());
+
+  if(is_null(m_history))
+    throw SetupError(FromHere(), "No history configured for " + uri().path());
+
+  if(m_solution_strategy->solve_count() == 0)
+  {
+    CFwarn << "No solves recorded yet by " << m_solution_strategy->uri().path() << CFendl;
+    return;
+  }
+
+  std::string prefix = m_prefix;
+  if(prefix.empty())
+    prefix = (is_null(m_solution_strategy->parent()) ? m_solution_strategy->name() : m_solution_strategy->parent()->name()) + "_";
+  const std::vector<std::string>& columns = math::LSS::SolutionStrategy::telemetry_columns();
+  const Table<Real>::ConstRow last_solve = (*m_solution_strategy->telemetry())[m_solution_strategy->last_telemetry_row()];
+  const Uint nb_columns = columns.size();
+  for(Uint i = 0; i != nb_columns; ++i)
+    m_history->set(prefix + columns[i], last_solve[i]);
+
+  if(m_save_entry)
+    m_history->save_entry();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
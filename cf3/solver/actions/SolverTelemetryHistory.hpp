@@ -0,0 +1,54 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_SolverTelemetryHistory_hpp
+#define cf3_solver_actions_SolverTelemetryHistory_hpp
+
+#include "common/Action.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math { namespace LSS { class SolutionStrategy; } }
+namespace solver {
+  class History;
+namespace actions {
+
+/// Copies the telemetry of the last solve of a linear system solution strategy into a History component.
+/// The variables are named after the telemetry columns of the strategy, prefixed with the configured prefix.
+class solver_actions_API SolverTelemetryHistory : public common::Action {
+
+public: // functions
+  /// Contructor
+  /// @param name of the component
+  SolverTelemetryHistory ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~SolverTelemetryHistory() {}
+
+  /// Get the class name
+  static std::string type_name () { return "SolverTelemetryHistory"; }
+
+  /// execute the action
+  virtual void execute ();
+
+private: // data
+
+  Handle<math::LSS::SolutionStrategy> m_solution_strategy;
+  Handle<History> m_history;
+  std::string m_prefix;
+  bool m_save_entry;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
+
+#endif // cf3_solver_actions_SolverTelemetryHistory_hpp
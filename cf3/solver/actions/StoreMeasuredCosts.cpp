@@ -0,0 +1,175 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <map>
+
+#include "common/Builder.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/TimedComponent.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshPartitioner.hpp"
+#include "mesh/Region.hpp"
+
+#include "solver/Action.hpp"
+#include "solver/actions/StoreMeasuredCosts.hpp"
+
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < StoreMeasuredCosts, common::Action, LibActions > StoreMeasuredCosts_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Sum of the estimated cost of all elements below the given component
+  Real estimated_cost(const Component& root)
+  {
+    Real result = 0.;
+    boost_foreach(const Entities& entities, find_components_recursively<Entities>(root))
+      result += MeshPartitioner::estimated_cost(entities) * static_cast<Real>(entities.size());
+    return result;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+StoreMeasuredCosts::StoreMeasuredCosts ( const std::string& name ) : common::Action(name)
+{
+  options().add("actions", std::vector<URI>())
+      .pretty_name("Actions")
+      .description("Timed actions whose time is stored. If empty, all leaf solver actions below the parent of this component are used")
+      .mark_basic();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void StoreMeasuredCosts::execute()
+{
+  std::vector< Handle<solver::Action> > actions;
+  const std::vector<URI> action_uris = options().value< std::vector<URI> >("actions");
+  if(action_uris.empty())
+  {
+    if(is_null(parent()))
+      throw SetupError(FromHere(), "No actions configured for " + uri().path());
+    // Only the leaf actions, since the time of an action that contains other actions includes theirs
+    boost_foreach(solver::Action& action, find_components_recursively<solver::Action>(*parent()))
+    {
+      if(is_null(find_component_ptr_recursively<solver::Action>(action)))
+        actions.push_back(action.handle<solver::Action>());
+    }
+  }
+  else
+  {
+    boost_foreach(const URI& action_uri, action_uris)
+    {
+      Handle<solver::Action> action(access_component(action_uri));
+      if(is_null(action))
+        throw SetupError(FromHere(), "Component at " + action_uri.path() + " is not a solver action");
+      actions.push_back(action);
+    }
+  }
+
+  // Local total time and estimated cost of every action, in the same order on all processes.
+  // Actions without timings or regions contribute nothing, but keep their place in the arrays.
+  const Uint nb_actions = actions.size();
+  std::vector<Real> times(nb_actions, 0.), costs(nb_actions, 0.);
+  Handle<Mesh> mesh;
+  bool has_timings = false;
+  for(Uint i = 0; i != nb_actions; ++i)
+  {
+    solver::Action& action = *actions[i];
+    TimedComponent* timed_action = dynamic_cast<TimedComponent*>(&action);
+    if(is_null(timed_action) || action.regions().empty())
+      continue;
+
+    if(is_null(mesh))
+      mesh = find_parent_component_ptr<Mesh>(*action.regions().front());
+
+    timed_action->store_timings();
+    if(!action.properties().check("timer_mean"))
+      continue;
+
+    has_timings = true;
+    times[i] = action.properties().value<Real>("timer_mean") * static_cast<Real>(action.properties().value<Uint>("timer_count"));
+    boost_foreach(const Handle<Region>& region, action.regions())
+      costs[i] += detail::estimated_cost(*region);
+  }
+
+  // All processes take part in the reductions, a process without timings contributes zeros
+  Real mesh_cost = has_timings ? detail::estimated_cost(mesh->topology()) : 0.;
+
+  if(PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+  {
+    std::vector<Real> local_times(times), local_costs(costs);
+    PE::Comm::instance().all_reduce(PE::plus(), local_times, times);
+    PE::Comm::instance().all_reduce(PE::plus(), local_costs, costs);
+    const Real local_mesh_cost = mesh_cost;
+    PE::Comm::instance().all_reduce(PE::plus(), &local_mesh_cost, 1, &mesh_cost);
+  }
+
+  if(is_null(mesh))
+  {
+    CFwarn << "No timed actions with regions found for " << uri().path() << ", no costs stored" << CFendl;
+    return;
+  }
+
+  // Time per unit of estimated cost, averaged over the whole mesh
+  Real total_time = 0.;
+  boost_foreach(const Real time, times)
+    total_time += time;
+  if(total_time <= 0. || mesh_cost <= 0.)
+    return;
+  const Real reference = total_time / mesh_cost;
+
+  // Time per unit of estimated cost for each region, summed over the actions that operate on it
+  std::map<std::string, Real> region_factors;
+  for(Uint i = 0; i != nb_actions; ++i)
+  {
+    if(costs[i] <= 0.)
+      continue;
+    boost_foreach(const Handle<Region>& region, actions[i]->regions())
+      region_factors[MeshPartitioner::measured_cost_key(*region)] += times[i] / costs[i] / reference;
+  }
+
+  // Replace the costs from a previous measurement
+  MeshMetadata& metadata = mesh->metadata();
+  std::vector<std::string> old_keys;
+  for(PropertyList::const_iterator it = metadata.properties().begin(); it != metadata.properties().end(); ++it)
+  {
+    if(it->first.find("measured_cost:") == 0)
+      old_keys.push_back(it->first);
+  }
+  boost_foreach(const std::string& key, old_keys)
+    metadata.properties().erase(key);
+
+  for(std::map<std::string, Real>::const_iterator it = region_factors.begin(); it != region_factors.end(); ++it)
+  {
+    metadata[it->first] = it->second;
+    CFdebug << "Stored " << it->first << " = " << it->second << CFendl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
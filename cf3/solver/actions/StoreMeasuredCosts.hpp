@@ -0,0 +1,51 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_StoreMeasuredCosts_hpp
+#define cf3_solver_actions_StoreMeasuredCosts_hpp
+
+#include "common/Action.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+/// Store the time spent by timed actions in the metadata of the mesh they operate on, so a later
+/// partitioning with vertex_weights = Measured can balance the measured work instead of the estimated work.
+///
+/// For each region that is looped over by one of the actions, the measured time per unit of estimated
+/// element cost is stored (see MeshPartitioner::measured_cost_key), relative to the average over the whole mesh.
+/// Timings are summed over all processes, so every process stores the same values. All processes must execute
+/// this action together, also those without timings.
+class solver_actions_API StoreMeasuredCosts : public common::Action {
+
+public: // functions
+  /// Contructor
+  /// @param name of the component
+  StoreMeasuredCosts ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~StoreMeasuredCosts() {}
+
+  /// Get the class name
+  static std::string type_name () { return "StoreMeasuredCosts"; }
+
+  /// execute the action
+  virtual void execute ();
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
+
+#endif // cf3_solver_actions_StoreMeasuredCosts_hpp
@@ -55,6 +55,11 @@ WriteRestartFile::WriteRestartFile ( const std::string& name ) :
     .pretty_name("Time")
     .description("Time component, used to extract timing and iteration information")
     .mark_basic();
+
+  options().add("asynchronous", false)
+    .pretty_name("Asynchronous")
+    .description("Write the field data in the background, so the simulation can continue while the file is compressed and written")
+    .mark_basic();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +67,13 @@ WriteRestartFile::WriteRestartFile ( const std::string& name ) :
 void WriteRestartFile::execute()
 {
   common::PE::Comm& comm = common::PE::Comm::instance();
+
+  // Complete the file started on the previous call
+  if(is_not_null(m_data_writer))
+  {
+    m_data_writer->close();
+    m_data_writer.reset();
+  }
   
   std::vector< Handle<mesh::Field> > fields = options().value< std::vector< Handle<mesh::Field> > >("fields");
   if(fields.empty())
@@ -84,8 +96,10 @@ void WriteRestartFile::execute()
   
   const common::URI out_file_path = options().value<common::URI>("file");
   const common::URI binfile = out_file_path.base_path() / (out_file_path.base_name() + ".cfbinxml");
-  boost::shared_ptr<common::BinaryDataWriter> data_writer = common::allocate_component<common::BinaryDataWriter>("DataWriter");
-  data_writer->options().set("file", binfile);
+  const bool asynchronous = options().value<bool>("asynchronous");
+  m_data_writer = common::allocate_component<common::BinaryDataWriter>("DataWriter");
+  m_data_writer->options().set("file", binfile);
+  m_data_writer->options().set("asynchronous", asynchronous);
   
   common::XML::XmlDoc xml_doc("1.0", "ISO-8859-1");
   common::XML::XmlNode restart_node = xml_doc.add_node("restart");
@@ -105,11 +119,17 @@ void WriteRestartFile::execute()
     boost::replace_first(relative_path, base_path, "");
     cf3_assert(relative_path.size() == field->uri().path().size() - base_path.size());
     field_node.set_attribute("path", relative_path);
-    field_node.set_attribute("index", common::to_str(data_writer->append_data(*field)));
+    field_node.set_attribute("index", common::to_str(m_data_writer->append_data(*field)));
   }
 
   if(comm.rank() == 0)
     common::XML::to_file(xml_doc, out_file_path);
+
+  if(!asynchronous)
+  {
+    m_data_writer->close();
+    m_data_writer.reset();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -13,12 +13,15 @@
 /////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
+namespace common { class BinaryDataWriter; }
 namespace solver {
 namespace actions {
 
 ///////////////////////////////////////////////////////////////////////////////////////
 
 /// Write out a restartfile, designed to be loaded into an already-created mesh
+/// In asynchronous mode, the field data is compressed and written in the background. The binary file
+/// is completed at the start of the next execution, when this component is destroyed or when MPI is finalized.
 class solver_actions_API WriteRestartFile : public common::Action
 {
 public: // functions
@@ -34,6 +37,10 @@ public: // functions
 
   /// execute the action
   virtual void execute ();
+
+private:
+  /// Writer for the binary data that is still being written in the background, in asynchronous mode
+  boost::shared_ptr<common::BinaryDataWriter> m_data_writer;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,8 @@
 #include <QStringList>
 #include <QVariant>
 
+#include <algorithm>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -17,6 +19,7 @@
 
 #include "common/BoostAnyConversion.hpp"
 #include "common/CF.hpp"
+#include "common/Foreach.hpp"
 #include "common/Signal.hpp"
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
@@ -86,7 +89,8 @@ CNode::CNode( const std::string & name, const QString & component_type, Type typ
     m_component_type( component_type ),
     m_type( type ),
     m_listing_content( false ),
-    m_is_root( false )
+    m_is_root( false ),
+    m_nb_remote_children( 0 )
 {
   m_content_listed = is_local_component();
   m_mutex = new QMutex();
@@ -449,6 +453,38 @@ void CNode::list_child_paths( QStringList & list,
 
 ////////////////////////////////////////////////////////////////////////////
 
+Uint CNode::nb_listed_children() const
+{
+  QMutexLocker locker(m_mutex);
+
+  Uint count = 0;
+  boost_foreach( const CNode& child, find_components<CNode>(*this) )
+  {
+    if( !child.is_local_component() )
+      ++count;
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+Uint CNode::listed_depth() const
+{
+  QMutexLocker locker(m_mutex);
+
+  Uint depth = 0;
+  boost_foreach( const CNode& child, find_components<CNode>(*this) )
+  {
+    if( !child.is_local_component() )
+      depth = std::max( depth, child.listed_depth() + 1 );
+  }
+
+  return depth;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 void CNode::add_node(boost::shared_ptr< CNode > node)
 {
   QMutexLocker locker(m_mutex);
@@ -662,6 +698,13 @@ boost::shared_ptr< CNode > CNode::create_from_xml_recursive( XmlNode & node,
     child.content = child.content->next_sibling();
   }
 
+  // The server only sets the child count if it did not list all children
+  rapidxml::xml_attribute<>* nb_children_attr = node.content->first_attribute("nb_children");
+  if( nb_children_attr != nullptr )
+    root_node->set_nb_remote_children( from_str<Uint>( nb_children_attr->value() ) );
+  else
+    root_node->set_nb_remote_children( root_node->nb_listed_children() );
+
   return root_node;
 }
 
@@ -683,6 +726,17 @@ void CNode::request_signal_signature(const QString & name)
 
 void CNode::reply_update_tree(SignalArgs & node)
 {
+  // Recent servers tell which listing changed, so only that part is fetched again
+  if( node.has_map( Protocol::Tags::key_options() ) )
+  {
+    SignalOptions options( node );
+    if( options.check("path") )
+    {
+      NTree::global()->update_subtree( options.value<URI>("path") );
+      return;
+    }
+  }
+
   NTree::global()->update_tree();
 }
 
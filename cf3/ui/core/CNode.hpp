@@ -194,6 +194,37 @@ namespace core {
       return m_is_root;
     }
 
+    /// Gives the number of children of the remote component. This can be more
+    /// than the number of listed children if the tree was listed partially.
+    /// @return Returns the number of remote children.
+    Uint nb_remote_children() const
+    {
+      return m_nb_remote_children;
+    }
+
+    /// Sets the number of children of the remote component.
+    /// @param count The number of children, as reported by the server.
+    void set_nb_remote_children( Uint count )
+    {
+      m_nb_remote_children = count;
+    }
+
+    /// Counts the remote children that were listed so far.
+    /// @return Returns the number of children that are not local components.
+    Uint nb_listed_children() const;
+
+    /// Indicates whether the server reported children that were not listed yet.
+    /// @return Returns @c true if more children can be fetched from the server.
+    bool has_pending_children() const
+    {
+      return m_nb_remote_children > nb_listed_children();
+    }
+
+    /// Gives the number of levels of remote components that are listed below
+    /// this node.
+    /// @return Returns 0 if no remote child is listed.
+    Uint listed_depth() const;
+
     /// Sets node properties
     /// @param node Node containing the options
     void set_properties( const common::SignalArgs & node );
@@ -375,6 +406,9 @@ namespace core {
     /// If @c true, this component is a NRoot object.
     bool m_is_root;
 
+    /// Number of children of the remote component.
+    Uint m_nb_remote_children;
+
   private: // data
 
     /// Component type name.
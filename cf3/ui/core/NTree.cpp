@@ -6,10 +6,16 @@
 
 #include <QMutex>
 
+#include <algorithm>
+
 #include "rapidxml/rapidxml.hpp"
 
+#include "common/Foreach.hpp"
 #include "common/Signal.hpp"
 #include "common/FindComponents.hpp"
+#include "common/StringConversion.hpp"
+
+#include "common/XML/SignalOptions.hpp"
 
 #include "ui/core/TreeThread.hpp"
 #include "ui/core/NetworkQueue.hpp"
@@ -31,6 +37,12 @@ namespace cf3 {
 namespace ui {
 namespace core {
 
+namespace
+{
+  /// Number of children requested at once when the tree is browsed
+  const Uint TREE_PAGE_SIZE = 100;
+}
+
 /////////////////////////////////////////////////////////////////////////
 
 NTree::NTree(Handle< NRoot > rootNode)
@@ -565,6 +577,42 @@ int NTree::rowCount(const QModelIndex & parent) const
 
 ////////////////////////////////////////////////////////////////////////////
 
+bool NTree::hasChildren(const QModelIndex & parent) const
+{
+  if( rowCount(parent) > 0 )
+    return true;
+
+  return canFetchMore(parent);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+bool NTree::canFetchMore(const QModelIndex & parent) const
+{
+  TreeNode * tree_node = this->index_to_tree_node(parent);
+
+  return is_not_null(tree_node) && tree_node->node()->has_pending_children();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void NTree::fetchMore(const QModelIndex & parent)
+{
+  if( !canFetchMore(parent) )
+    return;
+
+  Handle< CNode > node = index_to_node(parent);
+  URI path = node->is_root() ? URI(SERVER_ROOT_PATH) : node->uri();
+
+  // views ask again until the rows arrive, the page was already requested
+  if( m_pending_listings.contains( path.path().c_str() ) )
+    return;
+
+  request_listing( path, 1, node->nb_listed_children(), TREE_PAGE_SIZE );
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 int NTree::columnCount(const QModelIndex & parent) const
 {
 
@@ -596,56 +644,17 @@ void NTree::list_tree_reply(SignalArgs & args)
 
   try
   {
-    Handle< NRoot > tree_root = m_root_node->node()->castTo<NRoot>();
-    boost::shared_ptr< CNode > root_node = CNode::create_from_xml(args.main_map.content.content->first_node());
-    ComponentIterator<CNode> it = component_begin<CNode>(*root_node->root());
-    ComponentIterator<CNode> root_end = component_end<CNode>(*root_node->root());
+    URI sender_path( args.node.attribute_value("sender") );
     URI currentIndexPath;
 
+    m_pending_listings.remove( sender_path.path().c_str() );
+
     if(m_current_index.isValid())
     {
       currentIndexPath = index_to_tree_node(m_current_index)->node()->uri();
     }
 
-    //
-    // rename the root
-    //
-    tree_root->rename(root_node->name());
-    tree_root->rename(root_node->name());
-
-    //
-    // remove old nodes
-    //
-    ComponentIterator<CNode> itRem = component_begin<CNode>(*tree_root);
-    ComponentIterator<CNode> tree_root_end = component_end<CNode>(*tree_root);
-
-    QList<std::string> list_to_remove;
-    QList<std::string>::iterator itList;
-
-    for( ; itRem != tree_root_end ; itRem++)
-    {
-      if(!itRem->is_local_component() && !itRem->is_root() )
-        list_to_remove << itRem->name();
-    }
-
-    itList = list_to_remove.begin();
-
-    for( ; itList != list_to_remove.end() ; itList++)
-    {
-      tree_root->access_component_checked(*itList)->handle<CNode>()->about_to_be_removed();
-      tree_root->remove_component(*itList);
-    }
-
-    //
-    // add the new nodes
-    //
-
-    std::vector<std::string> names_to_add;
-    names_to_add.reserve(root_node->count_children());
-    for( ; it != root_end ; it++)
-      names_to_add.push_back(it.get()->name());
-    BOOST_FOREACH(const std::string& name, names_to_add)
-      tree_root->add_component( root_node->remove_component(name) );
+    merge_subtree_reply( args, sender_path );
 
     // child count may have changed, ask the root TreeNode to update its internal data
     m_root_node->update_child_list();
@@ -673,10 +682,35 @@ void NTree::list_tree_reply(SignalArgs & args)
 
 ////////////////////////////////////////////////////////////////////////////
 
+void NTree::update_subtree(const URI & path)
+{
+  URI listed_path( path );
+  Handle< CNode > node = node_by_path( listed_path );
+
+  // the listing that changed may be below a part of the tree that was not fetched yet
+  while( is_null(node.get()) && !listed_path.path().empty() && listed_path.path() != SERVER_ROOT_PATH )
+  {
+    listed_path = listed_path.base_path();
+    node = node_by_path( listed_path );
+  }
+
+  if( is_null(node.get()) )
+    return;
+
+  const Uint depth = std::max( Uint(1), node->listed_depth() );
+  const Uint limit = std::max( TREE_PAGE_SIZE, node->nb_listed_children() );
+
+  request_listing( node->is_root() ? URI(SERVER_ROOT_PATH) : node->uri(), depth, 0, limit );
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 void NTree::clear_tree()
 {
   beginResetModel();
 
+  m_pending_listings.clear();
+
   //QMutexLocker locker(m_mutex);
 
   Handle< NRoot > treeRoot = m_root_node->node()->castTo<NRoot>();
@@ -741,8 +775,11 @@ void NTree::content_listed(Handle< Component > node)
 
 void NTree::update_tree()
 {
-  SignalFrame frame("list_tree", CLIENT_TREE_PATH, SERVER_ROOT_PATH);
-  NetworkQueue::global()->send( frame );
+  // refresh everything that was loaded, and at least the first two levels
+  Handle< CNode > root = m_root_node->node();
+  const Uint depth = std::max( Uint(2), root->listed_depth() );
+
+  request_listing( SERVER_ROOT_PATH, depth, 0, 0 );
 }
 
 /*============================================================================
@@ -751,6 +788,100 @@ void NTree::update_tree()
 
 ============================================================================*/
 
+void NTree::request_listing(const URI & path, Uint depth, Uint offset, Uint limit)
+{
+  SignalOptions options;
+
+  options.add( "depth", depth );
+  options.add( "offset", offset );
+  options.add( "limit", limit );
+
+  SignalFrame frame = options.create_frame( "list_tree", CLIENT_TREE_PATH, path );
+
+  m_pending_listings.insert( path.path().c_str() );
+  NetworkQueue::global()->send( frame );
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void NTree::merge_subtree_reply(SignalArgs & args, const URI & path)
+{
+  Handle< CNode > target = node_by_path( path );
+
+  // the component was removed on our side in the meantime
+  if( is_null(target.get()) )
+    return;
+
+  XmlNode listing( args.main_map.content.content->first_node() );
+  boost::shared_ptr< CNode > reply_node = CNode::create_from_xml( listing );
+
+  if( is_null(reply_node.get()) )
+    return;
+
+  if( target->is_root() )
+    target->rename( reply_node->name() );
+
+  const Uint offset = listing.content->first_attribute("offset") != nullptr ?
+      from_str<Uint>( listing.attribute_value("offset") ) : 0;
+
+  //
+  // remove the nodes that do not exist anymore, this is only known if the
+  // listing starts at the first child
+  //
+  if( offset == 0 )
+  {
+    QList<std::string> list_to_remove;
+
+    boost_foreach( const CNode & child, find_components<CNode>(*target) )
+    {
+      if( !child.is_local_component() && !child.is_root()
+          && is_null( reply_node->get_child(child.name()).get() ) )
+        list_to_remove << child.name();
+    }
+
+    BOOST_FOREACH( const std::string & name, list_to_remove )
+    {
+      target->access_component_checked(name)->handle<CNode>()->about_to_be_removed();
+      target->remove_node( name.c_str() );
+    }
+  }
+
+  //
+  // add or replace the listed nodes
+  //
+  std::vector<std::string> names_to_add;
+  names_to_add.reserve( reply_node->count_children() );
+  boost_foreach( const CNode & child, find_components<CNode>(*reply_node) )
+    names_to_add.push_back( child.name() );
+
+  BOOST_FOREACH( const std::string & name, names_to_add )
+  {
+    boost::shared_ptr< CNode > new_node =
+        boost::static_pointer_cast< CNode >( reply_node->remove_component(name) );
+    Handle< CNode > old_node( target->get_child(name) );
+
+    if( is_not_null(old_node.get()) )
+    {
+      // a node that was not expanded in the reply keeps what was loaded before
+      if( new_node->nb_listed_children() == 0 && new_node->nb_remote_children() != 0
+          && old_node->nb_listed_children() != 0 )
+      {
+        old_node->set_nb_remote_children( new_node->nb_remote_children() );
+        continue;
+      }
+
+      old_node->about_to_be_removed();
+      target->remove_node( name.c_str() );
+    }
+
+    target->add_node( new_node );
+  }
+
+  target->set_nb_remote_children( reply_node->nb_remote_children() );
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 void NTree::build_node_path_recursive(const QModelIndex & index, QString & path) const
 {
 
@@ -11,6 +11,7 @@
 
 #include <QAbstractItemModel>
 #include <QMap>
+#include <QSet>
 #include <QStringList>
 
 #include "ui/core/CNode.hpp"
@@ -225,6 +226,21 @@ namespace core {
     /// @return Returns the row count (number of children) of a given parent.
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
 
+    /// @brief Implementation of @c QAbstractItemModel::hasChildren().
+
+    /// A node also has children if the server reported children that were
+    /// not listed yet, so the view can offer to expand it.
+    virtual bool hasChildren(const QModelIndex & parent = QModelIndex()) const;
+
+    /// @brief Implementation of @c QAbstractItemModel::canFetchMore().
+    /// @return Returns @c true if the node has children that were not listed yet.
+    virtual bool canFetchMore(const QModelIndex & parent) const;
+
+    /// @brief Implementation of @c QAbstractItemModel::fetchMore().
+
+    /// Requests the next page of children of the node from the server.
+    virtual void fetchMore(const QModelIndex & parent);
+
     /// @brief Implementation of @c QAbstractItemModel::columnCount().
     /// @return Always returns 1.
     virtual int columnCount(const QModelIndex & parent = QModelIndex()) const;
@@ -300,6 +316,14 @@ namespace core {
     /// @param node New tree
     void list_tree_reply(cf3::common::SignalArgs & node);
 
+    /// @brief Requests a new listing of a part of the tree.
+
+    /// The nearest node that exists in the client tree is listed again, as
+    /// deep and with as many children as it is currently listed (at least one
+    /// level and one page).
+    /// @param path Path of the server component whose listing changed.
+    void update_subtree(const cf3::common::URI & path);
+
     /// @} END Signals
 
     void content_listed(Handle< Component > node);
@@ -361,6 +385,22 @@ namespace core {
     /// @brief Mutex to control concurrent access.
     QMutex * m_mutex;
 
+    /// @brief Paths of the components for which a listing was requested and
+    /// no reply arrived yet
+    QSet<QString> m_pending_listings;
+
+    /// @brief Sends a list_tree request for a part of the tree
+    /// @param path Path of the component to list
+    /// @param depth Number of levels to list below the component (0 for all)
+    /// @param offset Index of the first child to list
+    /// @param limit Maximum number of children to list (0 for all)
+    void request_listing(const cf3::common::URI & path, Uint depth, Uint offset, Uint limit);
+
+    /// @brief Merges the reply to a list_tree request for a subtree
+    /// @param node The reply frame
+    /// @param path Path of the component that was listed
+    void merge_subtree_reply(cf3::common::SignalArgs & node, const cf3::common::URI & path);
+
     /// @brief Converts an index to a tree node
 
     /// @param index Node index to convert
@@ -13,6 +13,9 @@
 #include "cf3/common/Log.hpp"
 #include "cf3/common/Core.hpp"
 #include "cf3/common/Environment.hpp"
+#include "cf3/common/Table.hpp"
+#include "cf3/physics/Variables.hpp"
+#include "cf3/physics/lineuler/LinEuler2D.hpp"
 #include "cf3/physics/lineuler/lineuler2d/Functions.hpp"
 
 using namespace std;
@@ -105,6 +108,82 @@ BOOST_AUTO_TEST_CASE( Test_LinEuler2d_riemann )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( Test_LinEuler2D_batched_variables )
+{
+  Handle<physics::LinEuler::LinEuler2D> model = Core::instance().root().create_component<physics::LinEuler::LinEuler2D>("LinEuler2D");
+  boost::shared_ptr<physics::Variables> vars = model->create_variables("Cons2D", "solution_vars");
+  std::auto_ptr<physics::Properties> p = model->create_properties();
+  std::auto_ptr<physics::Properties> p_batch = model->create_properties();
+
+  const Uint nb_points = 5;
+  const Uint ndim = 2;
+  const Uint neqs = 4;
+  Table<Real>& coords = *Core::instance().root().create_component< Table<Real> >("coords");
+  Table<Real>& sol = *Core::instance().root().create_component< Table<Real> >("sol");
+  Table<Real>& converted = *Core::instance().root().create_component< Table<Real> >("converted");
+  coords.set_row_size(ndim); coords.resize(nb_points);
+  sol.set_row_size(neqs); sol.resize(nb_points);
+  converted.set_row_size(neqs); converted.resize(nb_points);
+
+  std::vector<Real> directions(nb_points*ndim);
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    coords[i][XX] = 0.1*i;
+    coords[i][YY] = 0.2*i;
+    for(Uint j = 0; j != neqs; ++j)
+      sol[i][j] = 0.1*(i+1) + 0.05*j;
+    directions[i*ndim+XX] = std::cos(0.3*i);
+    directions[i*ndim+YY] = std::sin(0.3*i);
+  }
+
+  // Skip the first point, to check the offset of the output
+  const Uint begin = 1;
+  const Uint nb_batch = nb_points - begin;
+  std::vector<Real> flux(nb_batch*neqs*ndim), dir_flux(nb_batch*neqs), evalues(nb_batch*neqs), Rv(nb_batch*neqs*neqs), Lv(nb_batch*neqs*neqs), evalues_structure(nb_batch*neqs);
+  vars->flux_batch(coords, sol, begin, nb_points, *p_batch, &flux[0]);
+  vars->flux_batch(coords, sol, begin, nb_points, &directions[begin*ndim], *p_batch, &dir_flux[0]);
+  vars->flux_jacobian_eigen_values_batch(coords, sol, begin, nb_points, &directions[begin*ndim], *p_batch, &evalues[0]);
+  vars->flux_jacobian_eigen_structure_batch(coords, sol, begin, nb_points, &directions[begin*ndim], *p_batch, &Rv[0], &Lv[0], &evalues_structure[0]);
+  vars->convert_batch(coords, sol, begin, nb_points, *p_batch, *vars, converted);
+
+  RealVector coord(ndim), sol_vec(neqs), direction(ndim), point_flux(neqs), point_evalues(neqs);
+  RealMatrix grad = RealMatrix::Zero(neqs, ndim), point_flux_mat(neqs, ndim), point_Rv(neqs, neqs), point_Lv(neqs, neqs);
+  for(Uint i = begin; i != nb_points; ++i)
+  {
+    const Uint b = i - begin;
+    for(Uint j = 0; j != ndim; ++j) { coord[j] = coords[i][j]; direction[j] = directions[i*ndim+j]; }
+    for(Uint j = 0; j != neqs; ++j) sol_vec[j] = sol[i][j];
+    vars->compute_properties(coord, sol_vec, grad, *p);
+
+    vars->flux(*p, point_flux_mat);
+    for(Uint d = 0; d != ndim; ++d)
+      for(Uint j = 0; j != neqs; ++j)
+        BOOST_CHECK_EQUAL(flux[b*neqs*ndim + d*neqs + j], point_flux_mat(j, d));
+
+    vars->flux(*p, direction, point_flux);
+    vars->flux_jacobian_eigen_values(*p, direction, point_evalues);
+    for(Uint j = 0; j != neqs; ++j)
+    {
+      BOOST_CHECK_EQUAL(dir_flux[b*neqs + j], point_flux[j]);
+      BOOST_CHECK_EQUAL(evalues[b*neqs + j], point_evalues[j]);
+      BOOST_CHECK_EQUAL(converted[i][j], sol[i][j]);
+    }
+
+    vars->flux_jacobian_eigen_structure(*p, direction, point_Rv, point_Lv, point_evalues);
+    for(Uint j = 0; j != neqs; ++j)
+    {
+      BOOST_CHECK_EQUAL(evalues_structure[b*neqs + j], point_evalues[j]);
+      for(Uint k = 0; k != neqs; ++k)
+      {
+        BOOST_CHECK_EQUAL(Rv[b*neqs*neqs + k*neqs + j], point_Rv(j, k));
+        BOOST_CHECK_EQUAL(Lv[b*neqs*neqs + k*neqs + j], point_Lv(j, k));
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -10,11 +10,13 @@
 #include "common/Builder.hpp"
 #include <common/List.hpp>
 #include <common/PropertyList.hpp>
+#include "common/StringConversion.hpp"
 
 #include "math/VariableManager.hpp"
 #include "math/VariablesDescriptor.hpp"
 
 #include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
 
 #include "mesh/Domain.hpp"
 #include "mesh/Mesh.hpp"
@@ -103,6 +105,10 @@ LSSAction::LSSAction(const std::string& name) :
     .pretty_name("Blocked System")
     .description("Store the linear system internally as a set of blocks grouped per variable, rather than keeping the variables per node");
 
+  options().add("static_condensation", false)
+    .pretty_name("Static Condensation")
+    .description("Eliminate the nodes that are interior to a single element (such as the bubble node of LagrangeP2B elements) from the linear system. Takes effect when the LSS is created.");
+
   options().add("matrix_builder", "cf3.math.LSS.TrilinosFEVbrMatrix")
     .pretty_name("Matrix Builder")
     .description("Builder to use when creating the LSS")
@@ -244,6 +250,14 @@ void LSSAction::on_regions_set()
 
     do_create_lss(comm_pattern, descriptor, node_connectivity, starting_indices, periodic_links_nodes_vec, periodic_links_active_vec);
 
+    if(options().value<bool>("static_condensation"))
+    {
+      std::vector<Uint> interior_nodes;
+      find_interior_nodes(m_loop_regions, *used_node_map, interior_nodes);
+      CFdebug << "Condensing " << interior_nodes.size() << " element-interior nodes" << CFendl;
+      m_implementation->m_lss->set_static_condensation(interior_nodes);
+    }
+
     CFdebug << "Finished creating LSS" << CFendl;
     configure_option_recursively(solver::Tags::regions(), options().option(solver::Tags::regions()).value());
     configure_option_recursively("lss", m_implementation->m_lss);
@@ -323,6 +337,42 @@ void LSSAction::set_solution_tag(const std::string& tag)
   properties().set("solution_tag", tag);
 }
 
+namespace detail
+{
+  // Solution field and node map for bulk transfers between the LSS and the mesh
+  Field& transfer_field(Dictionary& dictionary, const std::string& tag, math::LSS::Vector& vector)
+  {
+    Handle<Field> field = find_component_ptr_with_tag<Field>(dictionary, tag);
+    if(is_null(field))
+      throw SetupError(FromHere(), "No field with tag " + tag + " found in dictionary " + dictionary.uri().path());
+    if(field->row_size() != vector.neq())
+      throw SetupError(FromHere(), "Field " + field->uri().path() + " has row size " + to_str(field->row_size()) + ", but LSS vector " + vector.uri().path() + " has " + to_str(vector.neq()) + " equations");
+    return *field;
+  }
+
+  const List<int>::ListT* transfer_node_map(LSS::System& lss)
+  {
+    Handle< List<int> > used_node_map(lss.get_child("used_node_map"));
+    return is_null(used_node_map) ? nullptr : &used_node_map->array();
+  }
+}
+
+void LSSAction::field_to_vector(LSS::Vector& vector)
+{
+  if(is_null(m_dictionary) || is_null(m_implementation->m_lss))
+    throw SetupError(FromHere(), "Dictionary and LSS must be set before transferring data for " + uri().path());
+  Field& field = detail::transfer_field(*m_dictionary, solution_tag(), vector);
+  vector.set_block(field.array(), detail::transfer_node_map(*m_implementation->m_lss), 0, 0, field.row_size());
+}
+
+void LSSAction::vector_to_field(LSS::Vector& vector)
+{
+  if(is_null(m_dictionary) || is_null(m_implementation->m_lss))
+    throw SetupError(FromHere(), "Dictionary and LSS must be set before transferring data for " + uri().path());
+  Field& field = detail::transfer_field(*m_dictionary, solution_tag(), vector);
+  vector.get_block(field.array(), detail::transfer_node_map(*m_implementation->m_lss), 0, 0, field.row_size());
+}
+
 void LSSAction::on_initial_conditions_set(InitialConditions& initial_conditions)
 {
 }
@@ -25,7 +25,7 @@
 #include "LibUFEM.hpp"
 
 namespace cf3 {
-  namespace mesh { class Dictionary; }
+  namespace mesh { class Dictionary; class Field; }
 
 
 namespace UFEM {
@@ -65,6 +65,12 @@ public: // functions
   /// Set the tag used to keep track of what field stores the solution to the LSS
   void set_solution_tag(const std::string& tag);
 
+  /// Copy the field with the solution tag into the given LSS vector, in a single pass over the nodes used by the LSS
+  void field_to_vector(math::LSS::Vector& vector);
+
+  /// Copy the given LSS vector into the field with the solution tag, in a single pass over the nodes used by the LSS
+  void vector_to_field(math::LSS::Vector& vector);
+
 private:
   class Implementation;
   boost::scoped_ptr<Implementation> m_implementation;
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <map>
 #include <set>
 
 #include "common/FindComponents.hpp"
@@ -16,6 +17,7 @@
 #include "mesh/Field.hpp"
 #include "mesh/Functions.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/ElementType.hpp"
 #include "mesh/Space.hpp"
 
 #include "UFEM/SparsityBuilder.hpp"
@@ -191,6 +193,53 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
   return used_nodes_ptr;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void find_interior_nodes(const std::vector< Handle<Region> >& regions, const List<int>& used_node_map, std::vector<Uint>& interior_nodes)
+{
+  interior_nodes.clear();
+
+  // Number of elements using each node, and the nodes that are on no face of the element using them
+  std::map<Uint, Uint> nb_node_elements;
+  std::set<Uint> faceless_nodes;
+  BOOST_FOREACH(const Handle<Region>& region, regions)
+  {
+    BOOST_FOREACH(const Entities& elements, find_components_recursively_with_filter<Entities>(*region, IsElementsVolume()))
+    {
+      const ElementType& etype = elements.element_type();
+      const Uint nb_elem_nodes = etype.nb_nodes();
+      std::vector<bool> on_face(nb_elem_nodes, false);
+      for(Uint face = 0; face != etype.nb_faces(); ++face)
+      {
+        BOOST_FOREACH(const Uint face_node, etype.faces().nodes_range(face))
+        {
+          on_face[face_node] = true;
+        }
+      }
+
+      const Connectivity& connectivity = elements.geometry_space().connectivity();
+      const Uint nb_elems = connectivity.size();
+      for(Uint elem = 0; elem != nb_elems; ++elem)
+      {
+        for(Uint i = 0; i != nb_elem_nodes; ++i)
+        {
+          const int lss_idx = used_node_map[connectivity[elem][i]];
+          cf3_assert(lss_idx >= 0);
+          ++nb_node_elements[lss_idx];
+          if(!on_face[i])
+            faceless_nodes.insert(lss_idx);
+        }
+      }
+    }
+  }
+
+  BOOST_FOREACH(const Uint node, faceless_nodes)
+  {
+    if(nb_node_elements[node] == 1)
+      interior_nodes.push_back(node);
+  }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
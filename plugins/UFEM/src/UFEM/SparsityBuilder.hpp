@@ -31,6 +31,11 @@ namespace UFEM {
 /// Size is number of nodes + 1, so the last item is the size of node_connectivity
 UFEM_API boost::shared_ptr< common::List< Uint > > build_sparsity(const std::vector< Handle<mesh::Region> >& regions, const mesh::Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, common::List<Uint>& gids, common::List<Uint>& ranks, common::List<int>& used_node_map);
 
+/// Find the LSS indices of the nodes that are interior to a single element, i.e. not on any face of the element and used by no other element.
+/// These are the candidates for static condensation, such as the bubble node of LagrangeP2B elements.
+/// @param used_node_map Mapping from dictionary node to LSS index, as built by build_sparsity
+UFEM_API void find_interior_nodes(const std::vector< Handle<mesh::Region> >& regions, const common::List<int>& used_node_map, std::vector<Uint>& interior_nodes);
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 } // UFEM
@@ -4,15 +4,21 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <Epetra_CrsMatrix.h>
+#include <Epetra_Import.h>
+#include <Epetra_Vector.h>
 #include <EpetraExt_MatrixMatrix.h>
 
 #include <Thyra_describeLinearOp.hpp>
 
 #include "common/Builder.hpp"
+#include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Option.hpp"
 #include "common/OptionList.hpp"
+#include "common/StringConversion.hpp"
 
 #include "math/LSS/System.hpp"
 #include "math/LSS/Trilinos/ThyraOperator.hpp"
@@ -44,177 +50,82 @@ common::ComponentBuilder < PressureSystem, common::ActionDirector, LibUFEM > Pre
 PressureSystem::PressureSystem(const std::string& name) :
   LSSActionUnsteady(name)
 {
+  options().add("full_operator", false)
+    .pretty_name("Full Operator")
+    .description("Assemble the full pressure operator, including the product of the divergence, the inverse lumped mass matrix and the gradient, instead of the simplified laplacian. Must be set before the LSS is created.")
+    .mark_basic();
 }
 
 PressureSystem::~PressureSystem()
 {
 }
 
-void PressureSystem::do_create_lss(common::PE::CommPattern &cp, const math::VariablesDescriptor &vars, std::vector<Uint> &node_connectivity, std::vector<Uint> &starting_indices, const std::vector<Uint> &periodic_links_nodes, const std::vector<bool> &periodic_links_active)
+bool PressureSystem::full_operator() const
 {
-  // Due to simplification, no special sparsity is needed for the pressure LSS
-  LSSActionUnsteady::do_create_lss(cp, vars, node_connectivity, starting_indices, periodic_links_nodes, periodic_links_active);
+  return is_not_null(get_child("AssemblySystem"));
 }
 
-class PressureSystemAssembly : public solver::Action
+void PressureSystem::do_create_lss(common::PE::CommPattern &cp, const math::VariablesDescriptor &vars, std::vector<Uint> &node_connectivity, std::vector<Uint> &starting_indices, const std::vector<Uint> &periodic_links_nodes, const std::vector<bool> &periodic_links_active)
 {
-public:
-  PressureSystemAssembly(const std::string& name) :
-    solver::Action(name),
-    u("Velocity", "navier_stokes_u_solution"),
-    p("Pressure", "navier_stokes_p_solution"),
-    u_adv("AdvectionVelocity", "linearized_velocity"),
-    nu_eff("EffectiveViscosity", "navier_stokes_viscosity"),
-    theta(0.5)
-  {
-    options().add("pressure_lss_action", m_pressure_lss_action)
-      .pretty_name("Pressure LSS Action")
-      .description("LSS action for the pressure system")
-      .link_to(&m_pressure_lss_action);
+  if(is_not_null(get_child("AssemblySystem")))
+    remove_component("AssemblySystem");
 
-    options().add("theta", theta)
-      .pretty_name("Theta")
-      .description("Theta parameter for the theta scheme")
-      .link_to(&theta);
+  if(!options().value<bool>("full_operator"))
+  {
+    // Due to simplification, no special sparsity is needed for the pressure LSS
+    LSSActionUnsteady::do_create_lss(cp, vars, node_connectivity, starting_indices, periodic_links_nodes, periodic_links_active);
+    return;
   }
 
-  static std::string type_name () { return "PressureSystemAssembly"; }
+  const Uint nb_nodes = starting_indices.size()-1;
+  cf3_assert(starting_indices.back() == node_connectivity.size());
 
-  virtual void execute()
+  // Follow periodic links to the node that is actually stored in the matrix
+  std::vector<Uint> resolved(nb_nodes);
+  for(Uint i = 0; i != nb_nodes; ++i)
   {
-    if(is_null(m_pressure_lss_action))
-      throw common::SetupError(FromHere(), "pressure_lss_action not set for PressureSystemAssembly " + uri().string());
-
-    Handle<math::LSS::System> p_lss(m_pressure_lss_action->get_child("LSS"));
-    cf3_assert(is_not_null(p_lss));
-
-    p_lss->reset(0.);
-
-    // Assemble simplified pressure matrix
-#ifdef CF3_UFEM_ENABLE_TRIAGS
-    assemble_pp<mesh::LagrangeP1::Triag2D>(m_pressure_lss_action->system_matrix);
-#endif
-#ifdef CF3_UFEM_ENABLE_QUADS
-    assemble_pp<mesh::LagrangeP1::Quad2D>(m_pressure_lss_action->system_matrix);
-#endif
-#ifdef CF3_UFEM_ENABLE_TETRAS
-    assemble_pp<mesh::LagrangeP1::Tetra3D>(m_pressure_lss_action->system_matrix);
-#endif
-#ifdef CF3_UFEM_ENABLE_HEXAS
-    assemble_pp<mesh::LagrangeP1::Hexa3D>(m_pressure_lss_action->system_matrix);
-#endif
-#ifdef CF3_UFEM_ENABLE_PRISMS
-    assemble_pp<mesh::LagrangeP1::Prism3D>(m_pressure_lss_action->system_matrix);
-#endif
+    Uint target_node = i;
+    while(!periodic_links_active.empty() && periodic_links_active[target_node])
+      target_node = periodic_links_nodes[target_node];
+    resolved[i] = target_node;
   }
 
-  template<typename ElementT>
-  void assemble_pp(const SystemMatrix& mat)
+  // Neighbours of each resolved node, merging the rows of periodic nodes
+  std::vector< std::vector<Uint> > neighbours(nb_nodes);
+  for(Uint i = 0; i != nb_nodes; ++i)
   {
-    const Real u_ref = physical_model().options().value<Real>("reference_velocity");
-    for_each_element<ElementT>(group
-    (
-      _A = _0,
-      compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
-      element_quadrature( _A(p, p) += transpose(nabla(p)) * nabla(p) ),
-      mat += lit(theta) * (lit(tau_ps) + lit(m_pressure_lss_action->dt())) *_A
-    ));
+    std::vector<Uint>& row = neighbours[resolved[i]];
+    for(Uint j = starting_indices[i]; j != starting_indices[i+1]; ++j)
+      row.push_back(resolved[node_connectivity[j]]);
   }
-
-private:
-  // Helper function to loop over all regions
-  template<typename ElementT, typename ExprT>
-  void for_each_element(const ExprT& expr)
+  for(Uint i = 0; i != nb_nodes; ++i)
   {
-    BOOST_FOREACH(const Handle<mesh::Region> region, m_loop_regions)
-    {
-      solver::actions::Proto::for_each_element< boost::mpl::vector1<ElementT> >(*region, expr);
-    }
+    std::sort(neighbours[i].begin(), neighbours[i].end());
+    neighbours[i].erase(std::unique(neighbours[i].begin(), neighbours[i].end()), neighbours[i].end());
   }
 
-  Handle<LSSActionUnsteady> m_pressure_lss_action;
-
-  /// The velocity solution field
-  FieldVariable<0, VectorField> u;
-  /// The pressure solution field
-  FieldVariable<1, ScalarField> p;
-  /// The linearized advection velocity
-  FieldVariable<2, VectorField> u_adv;
-  /// Effective viscosity field
-  FieldVariable<3, ScalarField> nu_eff;
-
-  Real tau_ps, tau_su, tau_bulk;
-  Real theta;
-};
-
-common::ComponentBuilder < PressureSystemAssembly, common::Action, LibUFEM > PressureSystemAssembly_Builder;
-
-} // UFEM
-} // cf3
-
-/*
-
-namespace cf3 {
-namespace UFEM {
-
-using namespace solver::actions::Proto;
-using boost::proto::lit;
-
-common::ComponentBuilder < PressureSystem, common::ActionDirector, LibUFEM > PressureSystem_Builder;
-
-PressureSystem::PressureSystem(const std::string& name) :
-  LSSActionUnsteady(name)
-{
-}
-
-PressureSystem::~PressureSystem()
-{
-}
-
-void PressureSystem::do_create_lss(common::PE::CommPattern &cp, const math::VariablesDescriptor &vars, std::vector<Uint> &node_connectivity, std::vector<Uint> &starting_indices, const std::vector<Uint> &periodic_links_nodes, const std::vector<bool> &periodic_links_active)
-{
-  const Uint nb_nodes = starting_indices.size()-1;
-  cf3_assert(starting_indices.back() == node_connectivity.size());
-
+  // The product sparsity connects each node to the neighbours of its neighbours. The original entries are kept as well,
+  // so the pattern is a superset of the element sparsity also when periodic links are present.
   std::vector<Uint> new_node_connectivity; new_node_connectivity.reserve(node_connectivity.size()*4);
   std::vector<Uint> new_starting_indices; new_starting_indices.reserve(nb_nodes+1);
   new_starting_indices.push_back(0);
+  std::vector<Uint> row;
   for(Uint i = 0; i != nb_nodes; ++i)
   {
-    std::set<Uint> row_set;
-    const Uint row_begin = starting_indices[i];
-    const Uint row_end = starting_indices[i+1];
-    for(Uint j = row_begin; j != row_end; ++j)
+    row.assign(node_connectivity.begin() + starting_indices[i], node_connectivity.begin() + starting_indices[i+1]);
+    BOOST_FOREACH(const Uint neighbour, neighbours[resolved[i]])
     {
-      Uint target_node = node_connectivity[j];
-      while(!periodic_links_active.empty() && periodic_links_active[target_node])
-        target_node = periodic_links_nodes[target_node];
-      row_set.insert(target_node);
-    }
-    for(Uint j = 0; j != nb_nodes; ++j)
-    {
-      const Uint col_begin = starting_indices[j];
-      const Uint col_end = starting_indices[j+1];
-      for(Uint k = col_begin; k != col_end; ++k)
-      {
-        Uint target_node = node_connectivity[k];
-        while(!periodic_links_active.empty() && periodic_links_active[target_node])
-          target_node = periodic_links_nodes[target_node];
-        if(row_set.count(node_connectivity[k]) != 0 || row_set.count(target_node) != 0)
-        {
-          new_node_connectivity.push_back(j);
-          break;
-        }
-      }
+      row.insert(row.end(), neighbours[neighbour].begin(), neighbours[neighbour].end());
     }
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+    new_node_connectivity.insert(new_node_connectivity.end(), row.begin(), row.end());
     new_starting_indices.push_back(new_node_connectivity.size());
   }
 
   // Use the updated sparsity for the LSS
   LSSActionUnsteady::do_create_lss(cp, vars, new_node_connectivity, new_starting_indices, periodic_links_nodes, periodic_links_active);
 
-  Handle<math::LSS::System> lss(get_child("LSS"));
-
   // We also create a matrix that contains the original sparsity to do the assembly
   Handle<math::LSS::System> assembly_system = create_component<math::LSS::System>("AssemblySystem");
   assembly_system->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
@@ -230,7 +141,9 @@ public:
     p("Pressure", "navier_stokes_p_solution"),
     u_adv("AdvectionVelocity", "linearized_velocity"),
     nu_eff("EffectiveViscosity", "navier_stokes_viscosity"),
-    theta(0.5)
+    theta(0.5),
+    m_cached_product_matrix(nullptr),
+    m_cached_assembly_matrix(nullptr)
   {
     options().add("pressure_lss_action", m_pressure_lss_action)
       .pretty_name("Pressure LSS Action")
@@ -253,148 +166,254 @@ public:
     Handle<math::LSS::System> p_lss(m_pressure_lss_action->get_child("LSS"));
     cf3_assert(is_not_null(p_lss));
 
-    Handle<math::LSS::TrilinosCrsMatrix> p_crs_mat(p_lss->matrix());
-    cf3_assert(is_not_null(p_crs_mat));
-
-    // Matrix used for the assembly
-    Handle<math::LSS::System> assembly_system(m_pressure_lss_action->get_child("AssemblySystem"));
-    cf3_assert(is_not_null(assembly_system));
-    Handle<math::LSS::TrilinosCrsMatrix> assembly_crs_mat(assembly_system->matrix());
-    cf3_assert(is_not_null(assembly_crs_mat));
-    Epetra_CrsMatrix& assembly_matrix = *assembly_crs_mat->epetra_matrix();
-    assembly_matrix.PutScalar(0.);
-    Epetra_CrsMatrix assembly_storage(assembly_matrix);
-
-#ifdef CF3_UFEM_ENABLE_QUADS
-    assemble_mass_matrix<mesh::LagrangeP1::Quad2D>();
-#endif
-#ifdef CF3_UFEM_ENABLE_TRIAGS
-    assemble_mass_matrix<mesh::LagrangeP1::Triag2D>();
-#endif
-
-    // Compute the reciprocal of the lumped mass matrix
-    Handle<math::LSS::TrilinosVector> trilinos_rhs(p_lss->rhs());
-    Epetra_Vector& mass_mat_lumped = *trilinos_rhs->epetra_vector();
-    if(mass_mat_lumped.Reciprocal(mass_mat_lumped) != 0)
-      throw common::BadValue(FromHere(), "Error computing mass matrix inverse");
-
-    // Borrow the used node lists for the assembly
-    p_lss->get_child("GIDs")->move_to(*assembly_system);
-    p_lss->get_child("Ranks")->move_to(*assembly_system);
-    p_lss->get_child("used_node_map")->move_to(*assembly_system);
+    p_lss->reset(0.);
 
-    SystemMatrix proto_matrix(*assembly_system);
+    Handle<PressureSystem> pressure_system(m_pressure_lss_action);
+    if(is_not_null(pressure_system) && pressure_system->full_operator())
+    {
+      assemble_full_operator(*p_lss);
+      return;
+    }
 
-    // This one has the right sparsity for the product result:
-    Epetra_CrsMatrix& sum_result = *p_crs_mat->epetra_matrix();
-    sum_result.PutScalar(0.);
-    Epetra_CrsMatrix product_result(sum_result);
+    // Assemble simplified pressure matrix
+    assemble(SimplifiedLaplacian, 0, m_pressure_lss_action->system_matrix);
+  }
 
-    const int dim = m_physical_model->ndim();
-    for(int i = 0; i != dim; ++i)
-    {
-      assembly_matrix.PutScalar(0.);
-      // Assemble the PU matrix
-#ifdef CF3_UFEM_ENABLE_QUADS
-      assemble_pu<mesh::LagrangeP1::Quad2D>(i, proto_matrix);
-#endif
+private:
+  /// The terms that are assembled by loops over the elements
+  enum AssemblyStageT
+  {
+    SimplifiedLaplacian,
+    LumpedMass,
+    Gradient,
+    Divergence,
+    Laplacian
+  };
+
+  /// Assemble the given stage for all enabled element types
+  template<typename MatrixT>
+  void assemble(const AssemblyStageT stage, const int i, MatrixT& mat)
+  {
 #ifdef CF3_UFEM_ENABLE_TRIAGS
-    assemble_pu<mesh::LagrangeP1::Triag2D>(i, proto_matrix);
+    assemble_stage<mesh::LagrangeP1::Triag2D>(stage, i, mat);
 #endif
-
-      // Store the result
-      EpetraExt::MatrixMatrix::Add(assembly_matrix, false, 1., assembly_storage, 0.);
-
-      assembly_matrix.PutScalar(0.);
-      // Assemble the up matrix
 #ifdef CF3_UFEM_ENABLE_QUADS
-      assemble_up<mesh::LagrangeP1::Quad2D>(i, proto_matrix);
+    assemble_stage<mesh::LagrangeP1::Quad2D>(stage, i, mat);
 #endif
-#ifdef CF3_UFEM_ENABLE_TRIAGS
-    assemble_up<mesh::LagrangeP1::Triag2D>(i, proto_matrix);
+#ifdef CF3_UFEM_ENABLE_TETRAS
+    assemble_stage<mesh::LagrangeP1::Tetra3D>(stage, i, mat);
 #endif
-
-      assembly_storage.RightScale(mass_mat_lumped);
-      EpetraExt::MatrixMatrix::Multiply(assembly_storage, false, assembly_matrix, false, product_result);
-      EpetraExt::MatrixMatrix::Add(product_result, false, 1., sum_result, 1.);
-    }
-
-    assembly_matrix.PutScalar(0.);
-    // Assemble pressure laplacian part
-#ifdef CF3_UFEM_ENABLE_QUADS
-    assemble_pp<mesh::LagrangeP1::Quad2D>(proto_matrix);
+#ifdef CF3_UFEM_ENABLE_HEXAS
+    assemble_stage<mesh::LagrangeP1::Hexa3D>(stage, i, mat);
 #endif
-#ifdef CF3_UFEM_ENABLE_TRIAGS
-    assemble_pp<mesh::LagrangeP1::Triag2D>(proto_matrix);
+#ifdef CF3_UFEM_ENABLE_PRISMS
+    assemble_stage<mesh::LagrangeP1::Prism3D>(stage, i, mat);
 #endif
+  }
 
-    EpetraExt::MatrixMatrix::Add(assembly_matrix, false, 1., sum_result, 1.);
-
-    assembly_system->get_child("GIDs")->move_to(*p_lss);
-    assembly_system->get_child("Ranks")->move_to(*p_lss);
-    assembly_system->get_child("used_node_map")->move_to(*p_lss);
-
-    m_pressure_lss_action->remove_component("AssemblySystem");
+  template<typename ElementT>
+  void assemble_stage(const AssemblyStageT stage, const int i, const SystemMatrix& mat)
+  {
+    const Real u_ref = physical_model().options().value<Real>("reference_velocity");
+    switch(stage)
+    {
+    case SimplifiedLaplacian:
+      for_each_element<ElementT>(group
+      (
+        _A = _0,
+        compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
+        element_quadrature( _A(p, p) += transpose(nabla(p)) * nabla(p) ),
+        mat += lit(theta) * (lit(tau_ps) + lit(m_pressure_lss_action->dt())) *_A
+      ));
+      break;
+    case Gradient:
+      for_each_element<ElementT>(group
+      (
+        _A = _0, _T = _0,
+        compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
+        element_quadrature
+        (
+          _T(p, p) += tau_ps * transpose(nabla(p)[i]) * N(p),
+          _A(p, p) += transpose(N(p)) * nabla(p)[i]
+        ),
+        mat += _T + lit(m_pressure_lss_action->dt()) * _A
+      ));
+      break;
+    case Divergence:
+      for_each_element<ElementT>(group
+      (
+        _A = _0,
+        element_quadrature
+        (
+          _A(p, p) += -lit(theta)*transpose(nabla(p)[i]) * N(p)
+        ),
+        mat += _A
+      ));
+      break;
+    case Laplacian:
+      for_each_element<ElementT>(group
+      (
+        _A = _0,
+        compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
+        element_quadrature( _A(p, p) += transpose(nabla(p)) * nabla(p) ),
+        mat += -lit(tau_ps)*_A
+      ));
+      break;
+    default:
+      cf3_assert(false);
+    }
   }
 
   template<typename ElementT>
-  void assemble_mass_matrix()
+  void assemble_stage(const AssemblyStageT stage, const int, const SystemRHS& rhs)
   {
+    cf3_assert(stage == LumpedMass);
     for_each_element<ElementT>(group
     (
       _A = _0,
       element_quadrature( _A(p, p) += transpose(N(p)) * N(p) ),
       lump(_A),
-      m_pressure_lss_action->system_rhs += diagonal(_A)
+      rhs += diagonal(_A)
     ));
   }
 
-  template<typename ElementT>
-  void assemble_pu(const int i, SystemMatrix& mat)
+  /// Assemble sum_i(D_i*Ml^-1*G_i) + L. The product sparsity was computed when the LSS was created, and the positions of the
+  /// products in it are computed on the first call only, so later calls only recompute the values.
+  void assemble_full_operator(math::LSS::System& p_lss)
   {
-    const Real u_ref = physical_model().options().value<Real>("reference_velocity");
-    for_each_element<ElementT>(group
-    (
-      _A = _0, _T = _0,
-      compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
-      element_quadrature
-      (
-        _T(p, p) += tau_ps * transpose(nabla(p)[i]) * N(p),
-        _A(p, p) += transpose(N(p)) * nabla(p)[i]
-      ),
-      mat += _T + lit(m_pressure_lss_action->dt()) * _A
-    ));
+    Handle<math::LSS::TrilinosCrsMatrix> p_crs_mat(p_lss.matrix());
+    if(is_null(p_crs_mat))
+      throw common::SetupError(FromHere(), "The full pressure operator requires a TrilinosCrsMatrix for the pressure LSS");
+
+    // Matrix used for the assembly
+    Handle<math::LSS::System> assembly_system(m_pressure_lss_action->get_child("AssemblySystem"));
+    cf3_assert(is_not_null(assembly_system));
+    Handle<math::LSS::TrilinosCrsMatrix> assembly_crs_mat(assembly_system->matrix());
+    cf3_assert(is_not_null(assembly_crs_mat));
+    Epetra_CrsMatrix& assembly_matrix = *assembly_crs_mat->epetra_matrix();
+
+    // This one has the right sparsity for the product result
+    Epetra_CrsMatrix& sum_result = *p_crs_mat->epetra_matrix();
+
+    // Recompute the product positions if the systems were (re)created
+    const bool new_systems = m_cached_product_matrix != &sum_result || m_cached_assembly_matrix != &assembly_matrix;
+    if(new_systems)
+    {
+      m_gradient_storage = Teuchos::rcp(new Epetra_CrsMatrix(assembly_matrix));
+      m_cached_product_matrix = &sum_result;
+      m_cached_assembly_matrix = &assembly_matrix;
+    }
+
+    // Borrow the used node lists for the assembly
+    p_lss.get_child("GIDs")->move_to(*assembly_system);
+    p_lss.get_child("Ranks")->move_to(*assembly_system);
+    p_lss.get_child("used_node_map")->move_to(*assembly_system);
+
+    SystemMatrix assembly_proto_matrix(*assembly_system);
+    SystemRHS assembly_proto_rhs(*assembly_system);
+
+    // Compute the reciprocal of the lumped mass matrix, stored in the assembly RHS
+    assembly_system->reset(0.);
+    assemble(LumpedMass, 0, assembly_proto_rhs);
+    Handle<math::LSS::TrilinosVector> assembly_rhs(assembly_system->rhs());
+    Epetra_Vector& mass_mat_lumped_inv = *assembly_rhs->epetra_vector();
+    if(mass_mat_lumped_inv.Reciprocal(mass_mat_lumped_inv) != 0)
+      throw common::BadValue(FromHere(), "Error computing mass matrix inverse");
+
+    const int dim = physical_model().ndim();
+    for(int i = 0; i != dim; ++i)
+    {
+      // Assemble the PU matrix and store the result
+      assembly_matrix.PutScalar(0.);
+      assemble(Gradient, i, assembly_proto_matrix);
+      EpetraExt::MatrixMatrix::Add(assembly_matrix, false, 1., *m_gradient_storage, 0.);
+      m_gradient_storage->RightScale(mass_mat_lumped_inv);
+
+      // Assemble the UP matrix
+      assembly_matrix.PutScalar(0.);
+      assemble(Divergence, i, assembly_proto_matrix);
+
+      if(new_systems && i == 0)
+        compute_product_positions(*m_gradient_storage, assembly_matrix, sum_result);
+      add_product(*m_gradient_storage, assembly_matrix, sum_result);
+    }
+
+    // Assemble pressure laplacian part
+    assembly_matrix.PutScalar(0.);
+    assemble(Laplacian, 0, assembly_proto_matrix);
+    EpetraExt::MatrixMatrix::Add(assembly_matrix, false, 1., sum_result, 1.);
+
+    assembly_system->get_child("GIDs")->move_to(p_lss);
+    assembly_system->get_child("Ranks")->move_to(p_lss);
+    assembly_system->get_child("used_node_map")->move_to(p_lss);
   }
 
-  template<typename ElementT>
-  void assemble_up(const int i, SystemMatrix& mat)
+  /// Compute the position in the result row of each product G(r,k)*D(k,c), in the order add_product visits them.
+  /// The rows of D for the ghost columns of G are imported, and the import is kept for the later value updates.
+  void compute_product_positions(const Epetra_CrsMatrix& gradient, const Epetra_CrsMatrix& divergence, const Epetra_CrsMatrix& result)
   {
-    const Real u_ref = physical_model().options().value<Real>("reference_velocity");
-    for_each_element<ElementT>(group
-    (
-      _A = _0,
-      element_quadrature
-      (
-        _A(p, p) += -lit(theta)*transpose(nabla(p)[i]) * N(p)
-      ),
-      mat += _A
-    ));
+    m_divergence_import = Teuchos::rcp(new Epetra_Import(gradient.ColMap(), divergence.RowMap()));
+    m_divergence_rows = Teuchos::rcp(new Epetra_CrsMatrix(Copy, gradient.ColMap(), 0));
+    TRILINOS_THROW(m_divergence_rows->Import(divergence, *m_divergence_import, Insert));
+    TRILINOS_THROW(m_divergence_rows->FillComplete(divergence.DomainMap(), divergence.RangeMap()));
+
+    m_product_positions.clear();
+    std::vector< std::pair<int, int> > result_columns;
+    for(int row = 0; row != gradient.NumMyRows(); ++row)
+    {
+      cf3_assert(gradient.GRID(row) == result.GRID(row));
+
+      // Global column of each entry in the result row, sorted for the lookup
+      int nb_result_entries; double* result_values; int* result_indices;
+      TRILINOS_THROW(result.ExtractMyRowView(row, nb_result_entries, result_values, result_indices));
+      result_columns.clear();
+      for(int e = 0; e != nb_result_entries; ++e)
+        result_columns.push_back(std::make_pair(result.GCID(result_indices[e]), e));
+      std::sort(result_columns.begin(), result_columns.end());
+
+      int nb_gradient_entries; double* gradient_values; int* gradient_indices;
+      TRILINOS_THROW(gradient.ExtractMyRowView(row, nb_gradient_entries, gradient_values, gradient_indices));
+      for(int g = 0; g != nb_gradient_entries; ++g)
+      {
+        int nb_divergence_entries; double* divergence_values; int* divergence_indices;
+        TRILINOS_THROW(m_divergence_rows->ExtractMyRowView(gradient_indices[g], nb_divergence_entries, divergence_values, divergence_indices));
+        for(int d = 0; d != nb_divergence_entries; ++d)
+        {
+          const std::pair<int, int> column(m_divergence_rows->GCID(divergence_indices[d]), 0);
+          std::vector< std::pair<int, int> >::const_iterator found = std::lower_bound(result_columns.begin(), result_columns.end(), column);
+          if(found == result_columns.end() || found->first != column.first)
+            throw common::SetupError(FromHere(), "Entry (" + common::to_str(result.GRID(row)) + ", " + common::to_str(column.first) + ") of the full pressure operator is not in the pressure matrix sparsity");
+          m_product_positions.push_back(found->second);
+        }
+      }
+    }
   }
 
-  template<typename ElementT>
-  void assemble_pp(SystemMatrix& mat)
+  /// Add the product gradient*divergence to the values of result, using the positions from compute_product_positions
+  void add_product(const Epetra_CrsMatrix& gradient, const Epetra_CrsMatrix& divergence, Epetra_CrsMatrix& result)
   {
-    const Real u_ref = physical_model().options().value<Real>("reference_velocity");
-    for_each_element<ElementT>(group
-    (
-      _A = _0,
-      compute_tau(u, nu_eff, u_ref, lit(tau_ps), lit(tau_su), lit(tau_bulk)),
-      element_quadrature( _A(p, p) += transpose(nabla(p)) * nabla(p) ),
-      mat += -lit(tau_ps)*_A
-    ));
+    // The imported rows have a fixed structure, so this only replaces their values
+    TRILINOS_THROW(m_divergence_rows->Import(divergence, *m_divergence_import, Insert));
+
+    std::vector<int>::const_iterator position = m_product_positions.begin();
+    for(int row = 0; row != gradient.NumMyRows(); ++row)
+    {
+      int nb_result_entries; double* result_values; int* result_indices;
+      TRILINOS_THROW(result.ExtractMyRowView(row, nb_result_entries, result_values, result_indices));
+      int nb_gradient_entries; double* gradient_values; int* gradient_indices;
+      TRILINOS_THROW(gradient.ExtractMyRowView(row, nb_gradient_entries, gradient_values, gradient_indices));
+      for(int g = 0; g != nb_gradient_entries; ++g)
+      {
+        int nb_divergence_entries; double* divergence_values; int* divergence_indices;
+        TRILINOS_THROW(m_divergence_rows->ExtractMyRowView(gradient_indices[g], nb_divergence_entries, divergence_values, divergence_indices));
+        const Real gradient_value = gradient_values[g];
+        for(int d = 0; d != nb_divergence_entries; ++d, ++position)
+          result_values[*position] += gradient_value * divergence_values[d];
+      }
+    }
+    cf3_assert(position == m_product_positions.end());
   }
 
-private:
   // Helper function to loop over all regions
   template<typename ElementT, typename ExprT>
   void for_each_element(const ExprT& expr)
@@ -418,10 +437,20 @@ private:
 
   Real tau_ps, tau_su, tau_bulk;
   Real theta;
+
+  /// Work matrix for the full operator, with the sparsity of the assembly matrix
+  Teuchos::RCP<Epetra_CrsMatrix> m_gradient_storage;
+  /// Rows of the divergence matrix for each column of the gradient matrix, and the import that fills them
+  Teuchos::RCP<Epetra_CrsMatrix> m_divergence_rows;
+  Teuchos::RCP<Epetra_Import> m_divergence_import;
+  /// Position in the pressure matrix row of each term of the product
+  std::vector<int> m_product_positions;
+  /// The matrices the product positions were computed for
+  const Epetra_CrsMatrix* m_cached_product_matrix;
+  const Epetra_CrsMatrix* m_cached_assembly_matrix;
 };
 
 common::ComponentBuilder < PressureSystemAssembly, common::Action, LibUFEM > PressureSystemAssembly_Builder;
 
 } // UFEM
 } // cf3
-*/
@@ -16,7 +16,9 @@ namespace cf3 {
 namespace solver { class Time; }
 namespace UFEM {
 
-/// Builds the pressure system matrix
+/// Builds the pressure system matrix.
+/// If the option full_operator is true, the LSS gets the sparsity of the product D*Ml^-1*G, which is computed once when the LSS is created.
+/// An "AssemblySystem" child LSS with the original element sparsity is then also created, to assemble the factors of the product.
 class UFEM_API PressureSystem : public LSSActionUnsteady
 {
 public: // functions
@@ -30,6 +32,9 @@ public: // functions
   /// Get the class name
   static std::string type_name () { return "PressureSystem"; }
 
+  /// True if the full operator is used, i.e. if the LSS has the product sparsity
+  bool full_operator() const;
+
 private:
   virtual void do_create_lss(common::PE::CommPattern &cp, const math::VariablesDescriptor &vars, std::vector<Uint> &node_connectivity, std::vector<Uint> &starting_indices, const std::vector<Uint> &periodic_links_nodes, const std::vector<bool> &periodic_links_active);
 };
@@ -228,6 +228,29 @@ private:
 
 ComponentBuilder < InnerLoop, common::Action, LibUFEM > InnerLoop_builder;
 
+/// Copy the current velocity and pressure fields to the LSS solution vectors, using a bulk transfer for each system
+struct SetSolutionFromFields : solver::Action
+{
+  SetSolutionFromFields ( const string& name ) : solver::Action(name)
+  {
+  }
+
+  static std::string type_name() { return "SetSolutionFromFields"; }
+
+  void execute()
+  {
+    cf3_assert(is_not_null(u_lss_action));
+    cf3_assert(is_not_null(p_lss_action));
+    u_lss_action->field_to_vector(*Handle<math::LSS::System>(u_lss_action->get_child("LSS"))->solution());
+    p_lss_action->field_to_vector(*Handle<math::LSS::System>(p_lss_action->get_child("LSS"))->solution());
+  }
+
+  Handle<LSSAction> u_lss_action;
+  Handle<LSSAction> p_lss_action;
+};
+
+ComponentBuilder < SetSolutionFromFields, common::Action, LibUFEM > SetSolutionFromFields_builder;
+
 /// Initialize inner loop data
 struct SetupInnerLoopData : solver::Action
 {
@@ -348,8 +371,10 @@ NavierStokesSemiImplicit::NavierStokesSemiImplicit(const std::string& name) :
   m_u_lss->options().set("disabled_actions", std::vector<std::string>(1, "BC")); // Disabled because we execute it from the inner loop
 
   // Copy the current solution to the solution vectors
-  create_component<ProtoAction>("SetSolution")->set_expression(nodes_expression(group(m_u_lss->solution(u) = u, m_p_lss->solution(p) = p)));
-  get_child("SetSolution")->add_tag(detail::my_tag());
+  Handle<SetSolutionFromFields> set_solution = create_component<SetSolutionFromFields>("SetSolution");
+  set_solution->u_lss_action = m_u_lss;
+  set_solution->p_lss_action = Handle<LSSAction>(m_p_lss);
+  set_solution->add_tag(detail::my_tag());
   
   // Solve the systems iteratively
   m_inner_loop = create_component<InnerLoop>("InnerLoop");
@@ -0,0 +1,258 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test the full operator of the semi-implicit pressure system"
+
+#include <boost/test/unit_test.hpp>
+
+#include <Epetra_CrsMatrix.h>
+#include <Epetra_Vector.h>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/Trilinos/TrilinosCrsMatrix.hpp"
+#include "math/LSS/Trilinos/TrilinosVector.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Region.hpp"
+
+#include "solver/ModelUnsteady.hpp"
+#include "solver/Time.hpp"
+
+#include "solver/actions/Proto/ElementLooper.hpp"
+#include "solver/actions/Proto/ProtoAction.hpp"
+#include "solver/actions/Proto/Expression.hpp"
+
+#include "UFEM/LSSActionUnsteady.hpp"
+#include "UFEM/ParsedFunctionExpression.hpp"
+#include "UFEM/Solver.hpp"
+#include "UFEM/SUPG.hpp"
+#include "UFEM/ns_semi_implicit/PressureSystem.hpp"
+
+using namespace cf3;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+using namespace cf3::solver::actions::Proto;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+using boost::proto::lit;
+
+typedef boost::mpl::vector1<mesh::LagrangeP1::Quad2D> AllowedElementsT;
+
+/// Computes the action of the pressure operator from its separately assembled factors, without forming the product
+struct MatrixFreePressureOperator
+{
+  MatrixFreePressureOperator(UFEM::LSSActionUnsteady& lss_action, Region& topology, const Real u_ref, const Real theta) :
+    u("Velocity", "navier_stokes_u_solution"),
+    p("Pressure", "navier_stokes_p_solution"),
+    nu_eff("EffectiveViscosity", "navier_stokes_viscosity"),
+    m_lss_action(lss_action),
+    m_topology(topology),
+    m_u_ref(u_ref),
+    m_theta(theta)
+  {
+  }
+
+  /// y = sum_i(D_i*(Ml^-1*(G_i*x))) + L*x
+  void apply(const Epetra_Vector& x, Epetra_Vector& y)
+  {
+    math::LSS::System& lss = *m_lss_action.get_child("LSS")->handle<math::LSS::System>();
+    Epetra_CrsMatrix& matrix = *Handle<math::LSS::TrilinosCrsMatrix>(lss.matrix())->epetra_matrix();
+    const Epetra_Vector& lumped_mass = *Handle<math::LSS::TrilinosVector>(lss.rhs())->epetra_vector();
+    const Real dt = m_lss_action.dt();
+
+    lss.reset(0.);
+    for_each_element<AllowedElementsT>(m_topology, group
+    (
+      _A = _0,
+      element_quadrature( _A(p, p) += transpose(N(p)) * N(p) ),
+      lump(_A),
+      m_lss_action.system_rhs += diagonal(_A)
+    ));
+
+    Epetra_Vector gradient_x(x.Map());
+    Epetra_Vector divergence_x(x.Map());
+    y.PutScalar(0.);
+    for(int i = 0; i != 2; ++i)
+    {
+      lss.matrix()->reset(0.);
+      for_each_element<AllowedElementsT>(m_topology, group
+      (
+        _A = _0, _T = _0,
+        compute_tau(u, nu_eff, lit(m_u_ref), lit(tau_ps), lit(tau_su), lit(tau_bulk)),
+        element_quadrature
+        (
+          _T(p, p) += tau_ps * transpose(nabla(p)[i]) * N(p),
+          _A(p, p) += transpose(N(p)) * nabla(p)[i]
+        ),
+        m_lss_action.system_matrix += _T + lit(dt) * _A
+      ));
+      BOOST_REQUIRE_EQUAL(matrix.Apply(x, gradient_x), 0);
+      BOOST_REQUIRE_EQUAL(gradient_x.ReciprocalMultiply(1., lumped_mass, gradient_x, 0.), 0);
+
+      lss.matrix()->reset(0.);
+      for_each_element<AllowedElementsT>(m_topology, group
+      (
+        _A = _0,
+        element_quadrature( _A(p, p) += -lit(m_theta)*transpose(nabla(p)[i]) * N(p) ),
+        m_lss_action.system_matrix += _A
+      ));
+      BOOST_REQUIRE_EQUAL(matrix.Apply(gradient_x, divergence_x), 0);
+      y.Update(1., divergence_x, 1.);
+    }
+
+    lss.matrix()->reset(0.);
+    for_each_element<AllowedElementsT>(m_topology, group
+    (
+      _A = _0,
+      compute_tau(u, nu_eff, lit(m_u_ref), lit(tau_ps), lit(tau_su), lit(tau_bulk)),
+      element_quadrature( _A(p, p) += transpose(nabla(p)) * nabla(p) ),
+      m_lss_action.system_matrix += -lit(tau_ps)*_A
+    ));
+    BOOST_REQUIRE_EQUAL(matrix.Apply(x, divergence_x), 0);
+    y.Update(1., divergence_x, 1.);
+  }
+
+  FieldVariable<0, VectorField> u;
+  FieldVariable<1, ScalarField> p;
+  FieldVariable<2, ScalarField> nu_eff;
+
+  Real tau_ps, tau_su, tau_bulk;
+
+  UFEM::LSSActionUnsteady& m_lss_action;
+  Region& m_topology;
+  const Real m_u_ref;
+  const Real m_theta;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( PressureFullOperatorSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( FullOperatorMatchesMatrixFreeAction )
+{
+  const Real theta = 0.5;
+  const Real u_ref = 1.;
+
+  ModelUnsteady& model = *Core::instance().root().create_component<ModelUnsteady>("Model");
+  Domain& domain = model.create_domain("Domain");
+  physics::PhysModel& physical_model = model.create_physics("cf3.UFEM.NavierStokesPhysics");
+  physical_model.options().set("density", 1.);
+  physical_model.options().set("dynamic_viscosity", 0.1);
+  physical_model.options().set("reference_velocity", u_ref);
+  UFEM::Solver& solver = *model.create_component<UFEM::Solver>("Solver");
+
+  // The tested system, with the product sparsity
+  Handle<UFEM::PressureSystem> pressure_action(solver.add_unsteady_solver("cf3.UFEM.PressureSystem"));
+  pressure_action->set_solution_tag("navier_stokes_p_solution");
+  pressure_action->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+  pressure_action->options().set("full_operator", true);
+
+  // System with the element sparsity, to assemble the factors of the product
+  Handle<UFEM::LSSActionUnsteady> factors_action(solver.add_unsteady_solver("cf3.UFEM.LSSActionUnsteady"));
+  factors_action->set_solution_tag("navier_stokes_p_solution");
+  factors_action->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+
+  // Fields used by the assembly
+  FieldVariable<0, VectorField> u("Velocity", "navier_stokes_u_solution");
+  FieldVariable<1, ScalarField> p("Pressure", "navier_stokes_p_solution");
+  FieldVariable<2, VectorField> u_adv("AdvectionVelocity", "linearized_velocity");
+  FieldVariable<3, ScalarField> nu_eff("EffectiveViscosity", "navier_stokes_viscosity");
+  PhysicsConstant nu("kinematic_viscosity");
+
+  std::vector<std::string> velocity_functions(2);
+  velocity_functions[0] = "1+y";
+  velocity_functions[1] = "x*y";
+  boost::shared_ptr<UFEM::ParsedFunctionExpression> velocity_init = allocate_component<UFEM::ParsedFunctionExpression>("InitializeVelocity");
+  velocity_init->set_expression(nodes_expression(u = velocity_init->vector_function()));
+  velocity_init->options().set("value", velocity_functions);
+  Handle<common::ActionDirector> ic(solver.get_child("InitialConditions"));
+  *ic << velocity_init << create_proto_action("InitializeFields", nodes_expression(group(u_adv = u, nu_eff = nu, p = 0.)));
+  *pressure_action << create_proto_action("PressureVariable", nodes_expression(p = 0.));
+  *factors_action << create_proto_action("PressureVariable", nodes_expression(p = 0.));
+  boost::shared_ptr<ProtoAction> change_viscosity = create_proto_action("ChangeViscosity", nodes_expression(nu_eff = 3.*nu));
+  solver.add_component(change_viscosity);
+
+  Handle<common::Action> pressure_assembly(solver.create_component("PressureAssembly", "cf3.UFEM.PressureSystemAssembly"));
+  pressure_assembly->options().set("pressure_lss_action", pressure_action);
+  pressure_assembly->options().set("theta", theta);
+  pressure_assembly->options().set("physical_model", physical_model.handle<physics::PhysModel>());
+
+  // A distorted mesh, so the gradients differ per element
+  boost::shared_ptr<MeshGenerator> create_rectangle = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "create_rectangle");
+  create_rectangle->options().set("mesh", domain.uri()/"Mesh");
+  create_rectangle->options().set("lengths", std::vector<Real>(2, 1.));
+  create_rectangle->options().set("nb_cells", std::vector<Uint>(2, 6u));
+  Mesh& mesh = create_rectangle->generate();
+  Field& coordinates = mesh.geometry_fields().coordinates();
+  for(Uint i = 0; i != coordinates.size(); ++i)
+    coordinates[i][XX] += 0.05*coordinates[i][XX]*coordinates[i][YY];
+
+  Time& time = model.create_time();
+  time.options().set("time_step", 0.1);
+
+  solver.configure_option_recursively("regions", std::vector<URI>(1, mesh.topology().uri()));
+  solver.create_fields();
+  ic->execute();
+
+  BOOST_CHECK(pressure_action->full_operator());
+  math::LSS::System& pressure_lss = *pressure_action->get_child("LSS")->handle<math::LSS::System>();
+  const Epetra_CrsMatrix& full_operator = *Handle<math::LSS::TrilinosCrsMatrix>(pressure_lss.matrix())->epetra_matrix();
+
+  MatrixFreePressureOperator matrix_free(*factors_action, mesh.topology(), u_ref, theta);
+
+  // The second pass only refreshes the values, with a different viscosity
+  for(Uint pass = 0; pass != 2; ++pass)
+  {
+    if(pass == 1)
+      change_viscosity->execute();
+
+    pressure_assembly->execute();
+
+    Epetra_Vector x(full_operator.DomainMap());
+    x.Random();
+    Epetra_Vector y_full(full_operator.RangeMap());
+    Epetra_Vector y_matrix_free(full_operator.RangeMap());
+    BOOST_REQUIRE_EQUAL(full_operator.Apply(x, y_full), 0);
+    matrix_free.apply(x, y_matrix_free);
+
+    double y_norm;
+    y_matrix_free.NormInf(&y_norm);
+    BOOST_CHECK(y_norm > 0.);
+    for(int i = 0; i != y_full.MyLength(); ++i)
+      BOOST_CHECK_SMALL(y_full[i] - y_matrix_free[i], 1e-10*y_norm);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  common::PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
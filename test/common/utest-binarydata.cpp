@@ -9,6 +9,8 @@
 
 #include <iostream>
 
+#include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
 #include <boost/mpl/if.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/random/mersenne_twister.hpp>
@@ -22,6 +24,9 @@
 #include "common/OptionList.hpp"
 #include "common/Table.hpp"
 
+#include "common/XML/FileOperations.hpp"
+#include "common/XML/XmlDoc.hpp"
+
 #include "common/PE/Comm.hpp"
 #include <common/Environment.hpp>
 
@@ -173,6 +178,237 @@ BOOST_AUTO_TEST_CASE( ReadBinaryData )
   BOOST_CHECK_EQUAL(empty_real_table.row_size(), 8);
 }
 
+BOOST_AUTO_TEST_CASE( AsynchronousBinaryData )
+{
+  common::Component& group = *common::Core::instance().root().create_component("AsyncGroup", "cf3.common.Group");
+
+  common::Table<Real>& real_table = *group.create_component< common::Table<Real> >("RealTable");
+  real_table.set_row_size(real_table_cols);
+  real_table.resize(real_table_size);
+  fill_table(real_table);
+
+  common::Table<Real>& reference_table = *group.create_component< common::Table<Real> >("ReferenceTable");
+  reference_table.set_row_size(real_table_cols);
+  reference_table.resize(real_table_size);
+  reference_table.array() = real_table.array();
+
+  common::BinaryDataWriter& writer = *group.create_component<common::BinaryDataWriter>("Writer");
+  writer.options().set("file", common::URI("binary_data_async.cfbinxml"));
+  writer.options().set("asynchronous", true);
+
+  writer.append_data(real_table);
+
+  // The writer works on a snapshot, so changing the data now must not affect the file
+  fill_table(real_table);
+  writer.append_data(real_table);
+
+  writer.close();
+
+  common::BinaryDataReader& reader = *group.create_component<common::BinaryDataReader>("Reader");
+  reader.options().set("file", common::URI("binary_data_async.cfbinxml"));
+
+  common::Table<Real>& read_table = *group.create_component< common::Table<Real> >("ReadTable");
+  reader.read_table(read_table, 0);
+  BOOST_CHECK(read_table.array() == reference_table.array());
+  reader.read_table(read_table, 1);
+  BOOST_CHECK(read_table.array() == real_table.array());
+}
+
+BOOST_AUTO_TEST_CASE( ChunkedRowAccess )
+{
+  common::Component& group = *common::Core::instance().root().create_component("ChunkedGroup", "cf3.common.Group");
+
+  common::Table<Real>& real_table = *group.create_component< common::Table<Real> >("RealTable");
+  real_table.set_row_size(real_table_cols);
+  real_table.resize(real_table_size);
+  fill_table(real_table);
+
+  common::List<Uint>& int_list = *group.create_component< common::List<Uint> >("IntList");
+  int_list.resize(int_list_size);
+  fill_list(int_list);
+
+  const std::vector<std::string> codecs = boost::assign::list_of("zlib")("none");
+  BOOST_FOREACH(const std::string& codec, codecs)
+  {
+    const common::URI file("binary_data_chunked_" + codec + ".cfbinxml");
+    common::BinaryDataWriter& writer = *group.create_component<common::BinaryDataWriter>("Writer_" + codec);
+    writer.options().set("file", file);
+    writer.options().set("codec", codec);
+    writer.options().set("compression_level", 1u);
+    writer.options().set("chunk_size", 1000u); // not a multiple of the row size
+    writer.options().set("nb_threads", 3u);
+    writer.append_data(real_table);
+    writer.append_data(int_list);
+    writer.close();
+
+    common::BinaryDataReader& reader = *group.create_component<common::BinaryDataReader>("Reader_" + codec);
+    reader.options().set("nb_threads", 2u);
+    reader.options().set("file", file);
+
+    common::Table<Real>& read_table = *group.create_component< common::Table<Real> >("ReadTable_" + codec);
+    reader.read_table(read_table, 0);
+    BOOST_CHECK(read_table.array() == real_table.array());
+
+    // Ranges within a chunk, crossing chunk boundaries and up to the end of the block
+    const Uint first_rows[] = {0, 3, 10, 15, real_table_size-7};
+    const Uint nb_rows[] = {1, 5, 500, 1, 7};
+    for(Uint i = 0; i != 5; ++i)
+    {
+      reader.read_table_rows(read_table, 0, first_rows[i], nb_rows[i]);
+      BOOST_CHECK_EQUAL(read_table.size(), nb_rows[i]);
+      BOOST_CHECK_EQUAL(read_table.row_size(), real_table.row_size());
+      for(Uint row = 0; row != nb_rows[i]; ++row)
+      {
+        for(Uint col = 0; col != real_table.row_size(); ++col)
+          BOOST_CHECK_EQUAL(read_table[row][col], real_table[first_rows[i]+row][col]);
+      }
+    }
+
+    common::List<Uint>& read_list = *group.create_component< common::List<Uint> >("ReadList_" + codec);
+    reader.read_list_rows(read_list, 1, 250, 1000);
+    BOOST_CHECK_EQUAL(read_list.size(), 1000);
+    for(Uint i = 0; i != 1000; ++i)
+      BOOST_CHECK_EQUAL(read_list[i], int_list[250+i]);
+
+    BOOST_CHECK_THROW(reader.read_list_rows(read_list, 1, int_list_size, 1), common::BadValue);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( EmptyBlockOnRoot )
+{
+  common::Component& group = *common::Core::instance().root().create_component("EmptyRootGroup", "cf3.common.Group");
+
+  // The root rank has no rows, so its chunk size in rows differs from the other ranks
+  const Uint nb_rows = rank == 0 ? 0 : 1000 + 10*rank;
+  common::Table<Real>& real_table = *group.create_component< common::Table<Real> >("RealTable");
+  real_table.set_row_size(real_table_cols);
+  real_table.resize(nb_rows);
+  fill_table(real_table);
+
+  const common::URI file("binary_data_empty_root.cfbinxml");
+  common::BinaryDataWriter& writer = *group.create_component<common::BinaryDataWriter>("Writer");
+  writer.options().set("file", file);
+  writer.options().set("chunk_size", 1000u);
+  writer.options().set("asynchronous", true);
+  writer.append_data(real_table);
+  writer.close();
+
+  common::BinaryDataReader& reader = *group.create_component<common::BinaryDataReader>("Reader");
+  reader.options().set("file", file);
+
+  common::Table<Real>& read_table = *group.create_component< common::Table<Real> >("ReadTable");
+  reader.read_table(read_table, 0);
+  BOOST_CHECK_EQUAL(read_table.size(), nb_rows);
+  BOOST_CHECK(read_table.array() == real_table.array());
+
+  if(nb_rows != 0)
+  {
+    // Crosses several chunks of 15 rows
+    reader.read_table_rows(read_table, 0, 100, 50);
+    BOOST_CHECK_EQUAL(read_table.size(), 50);
+    for(Uint row = 0; row != 50; ++row)
+    {
+      for(Uint col = 0; col != real_table_cols; ++col)
+        BOOST_CHECK_EQUAL(read_table[row][col], real_table[100+row][col]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ColumnMajorTable )
+{
+  common::Component& group = *common::Core::instance().root().create_component("ColumnMajorGroup", "cf3.common.Group");
+
+  common::Table<Real>& real_table = *group.create_component< common::Table<Real> >("RealTable");
+  real_table.set_row_size(real_table_cols);
+  real_table.resize(real_table_size);
+  fill_table(real_table);
+
+  // Changing the storage order keeps the contents, and each column becomes contiguous
+  common::Table<Real>& column_table = *group.create_component< common::Table<Real> >("ColumnTable");
+  column_table.set_row_size(real_table_cols);
+  column_table.resize(real_table_size);
+  column_table.array() = real_table.array();
+  BOOST_CHECK(column_table.is_row_major());
+  column_table.set_row_major(false);
+  BOOST_CHECK(!column_table.is_row_major());
+  BOOST_CHECK(column_table.array() == real_table.array());
+  BOOST_CHECK_EQUAL(column_table.array().data()[real_table_size], real_table[0][1]);
+  column_table.resize(real_table_size+1);
+  BOOST_CHECK(!column_table.is_row_major());
+  BOOST_CHECK_EQUAL(column_table[real_table_size-1][real_table_cols-1], real_table[real_table_size-1][real_table_cols-1]);
+  column_table.resize(real_table_size);
+
+  // The file contents don't depend on the storage order
+  common::BinaryDataWriter& writer = *group.create_component<common::BinaryDataWriter>("Writer");
+  writer.options().set("file", common::URI("binary_data_column_major.cfbinxml"));
+  writer.append_data(column_table);
+  writer.append_data(real_table);
+  writer.close();
+
+  common::BinaryDataReader& reader = *group.create_component<common::BinaryDataReader>("Reader");
+  reader.options().set("file", common::URI("binary_data_column_major.cfbinxml"));
+
+  common::Table<Real>& read_table = *group.create_component< common::Table<Real> >("ReadTable");
+  reader.read_table(read_table, 0);
+  BOOST_CHECK(read_table.is_row_major());
+  BOOST_CHECK(read_table.array() == real_table.array());
+
+  common::Table<Real>& read_column_table = *group.create_component< common::Table<Real> >("ReadColumnTable");
+  read_column_table.set_row_major(false);
+  reader.read_table(read_column_table, 1);
+  BOOST_CHECK(!read_column_table.is_row_major());
+  BOOST_CHECK(read_column_table.array() == real_table.array());
+
+  reader.read_table_rows(read_column_table, 0, 10, 5);
+  for(Uint row = 0; row != 5; ++row)
+  {
+    for(Uint col = 0; col != real_table_cols; ++col)
+      BOOST_CHECK_EQUAL(read_column_table[row][col], real_table[10+row][col]);
+  }
+}
+
+// Must be the last test, since it finalizes MPI
+BOOST_AUTO_TEST_CASE( AsynchronousWriterOpenAtFinalize )
+{
+  common::Component& group = *common::Core::instance().root().create_component("FinalizeGroup", "cf3.common.Group");
+
+  common::Table<Real>& real_table = *group.create_component< common::Table<Real> >("RealTable");
+  real_table.set_row_size(real_table_cols);
+  real_table.resize(real_table_size);
+  fill_table(real_table);
+
+  // Left open, as WriteRestartFile does in asynchronous mode
+  const common::URI file("binary_data_finalize.cfbinxml");
+  common::BinaryDataWriter& writer = *group.create_component<common::BinaryDataWriter>("Writer");
+  writer.options().set("file", file);
+  writer.options().set("asynchronous", true);
+  writer.append_data(real_table);
+  writer.append_data(real_table);
+
+  const Uint nb_procs = common::PE::Comm::instance().size();
+  common::PE::Comm::instance().finalize();
+
+  // The index must list both blocks of every rank
+  if(rank == 0)
+  {
+    boost::shared_ptr<common::XML::XmlDoc> doc = common::XML::parse_file(file);
+    common::XML::XmlNode nodes(doc->content->first_node("cfbinary")->first_node("nodes"));
+    Uint nb_nodes = 0;
+    for(common::XML::XmlNode node(nodes.content->first_node("node")); node.is_valid(); node.content = node.content->next_sibling("node"))
+    {
+      Uint nb_blocks = 0;
+      for(common::XML::XmlNode block(node.content->first_node("block")); block.is_valid(); block.content = block.content->next_sibling("block"))
+      {
+        BOOST_CHECK(common::from_str<Uint>(block.attribute_value("end")) > common::from_str<Uint>(block.attribute_value("begin")));
+        ++nb_blocks;
+      }
+      BOOST_CHECK_EQUAL(nb_blocks, 2);
+      ++nb_nodes;
+    }
+    BOOST_CHECK_EQUAL(nb_nodes, nb_procs);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
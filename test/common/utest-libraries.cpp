@@ -0,0 +1,102 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::Libraries"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+#include "common/Libraries.hpp"
+#include "common/Library.hpp"
+#include "common/LibCommon.hpp"
+#include "common/PropertyList.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( LibrariesSuite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Initiate )
+{
+  Core::instance().initiate(boost::unit_test::framework::master_test_suite().argc,
+                            boost::unit_test::framework::master_test_suite().argv);
+
+  // Linked libraries are timed when they are initiated
+  Handle<LibCommon> lib_common = Core::instance().libraries().library<LibCommon>();
+  BOOST_CHECK(lib_common->is_initiated());
+  BOOST_CHECK(lib_common->properties().check("initiate_time"));
+}
+
+BOOST_AUTO_TEST_CASE( LibraryInFile )
+{
+  Libraries& libraries = Core::instance().libraries();
+  Handle<Library> lib_common(libraries.library<LibCommon>());
+
+  BOOST_CHECK(libraries.library_in_file("/some/path/libcoolfluid_common.so") == lib_common);
+  BOOST_CHECK(libraries.library_in_file("coolfluid_common") == lib_common);
+  BOOST_CHECK(is_null(libraries.library_in_file("libcoolfluid_nonexistent.so")));
+}
+
+BOOST_AUTO_TEST_CASE( BuilderIndex )
+{
+  Libraries& libraries = Core::instance().libraries();
+
+  {
+    boost::filesystem::ofstream index_file("utest-libraries.idx");
+    index_file << "# builder library_file\n";
+    index_file << "cf3.nonexistent.Dummy /nonexistent/libcoolfluid_nonexistent.so\n";
+    index_file << "\n";
+    index_file << "cf3.nonexistent.OtherDummy /nonexistent/libcoolfluid_nonexistent.so\n";
+  }
+  libraries.read_builder_index(URI("utest-libraries.idx", URI::Scheme::FILE));
+
+  BOOST_CHECK(libraries.is_indexed("coolfluid_nonexistent"));
+  BOOST_CHECK(libraries.is_indexed("/other/path/libcoolfluid_nonexistent.so"));
+  BOOST_CHECK(!libraries.is_indexed("coolfluid_common"));
+
+  // The indexed file doesn't exist, so loading fails without searching further
+  BOOST_CHECK(is_null(libraries.autoload_library_with_builder("cf3.nonexistent.Dummy")));
+
+  // Only plugins loaded from a file are written, so the index of this test is empty
+  libraries.write_builder_index(URI("utest-libraries-written.idx", URI::Scheme::FILE));
+  boost::filesystem::ifstream written("utest-libraries-written.idx");
+  std::string line;
+  Uint nb_builders = 0;
+  while(std::getline(written, line))
+  {
+    if(!line.empty() && line[0] != '#')
+      ++nb_builders;
+  }
+  BOOST_CHECK_EQUAL(nb_builders, 0u);
+}
+
+BOOST_AUTO_TEST_CASE( MalformedIndex )
+{
+  {
+    boost::filesystem::ofstream index_file("utest-libraries-malformed.idx");
+    index_file << "cf3.nonexistent.Dummy\n";
+  }
+  BOOST_CHECK_THROW(Core::instance().libraries().read_builder_index(URI("utest-libraries-malformed.idx", URI::Scheme::FILE)), FileFormatError);
+  BOOST_CHECK_THROW(Core::instance().libraries().read_builder_index(URI("utest-libraries-missing.idx", URI::Scheme::FILE)), FileSystemError);
+}
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  Core::instance().terminate();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,102 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::AccountedComponent"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/AccountedComponent.hpp"
+#include "common/Core.hpp"
+#include "common/DynTable.hpp"
+#include "common/Group.hpp"
+#include "common/List.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Table.hpp"
+
+#include "common/PE/CommPattern.hpp"
+#include "common/XML/SignalFrame.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( MemoryAccountingSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( DataComponents )
+{
+  Group& group = *Core::instance().root().create_component<Group>("MemoryGroup");
+
+  Table<Real>& table = *group.create_component< Table<Real> >("Table");
+  table.set_row_size(3);
+  table.resize(100);
+  BOOST_CHECK_EQUAL(table.memory_bytes(), 300. * sizeof(Real));
+
+  Group& sub_group = *group.create_component<Group>("SubGroup");
+  List<Uint>& list = *sub_group.create_component< List<Uint> >("List");
+  list.resize(50);
+  BOOST_CHECK_EQUAL(list.memory_bytes(), 50. * sizeof(Uint));
+
+  DynTable<Uint>& dyn_table = *sub_group.create_component< DynTable<Uint> >("DynTable");
+  dyn_table.resize(2);
+  dyn_table[0].resize(4);
+  dyn_table[1].resize(6);
+  // The rows themselves and the values they allocated
+  BOOST_CHECK_EQUAL(dyn_table.memory_bytes(), 2. * sizeof(std::vector<Uint>) + 10. * sizeof(Uint));
+
+  // A new pattern has one free local index and a send and receive count for the single CPU
+  PE::CommPattern& comm_pattern = *sub_group.create_component<PE::CommPattern>("CommPattern");
+  const Real empty_pattern_bytes = sizeof(Uint) + 2. * sizeof(int);
+  BOOST_CHECK_EQUAL(comm_pattern.memory_bytes(), empty_pattern_bytes);
+  comm_pattern.isUpdatable().resize(64);
+  BOOST_CHECK_EQUAL(comm_pattern.memory_bytes(), empty_pattern_bytes + 8.);
+
+  // Totals are aggregated up the tree
+  const Real sub_group_total = list.memory_bytes() + dyn_table.memory_bytes() + comm_pattern.memory_bytes();
+  const Real total = store_memory_usage(group);
+  BOOST_CHECK_EQUAL(total, table.memory_bytes() + sub_group_total);
+  BOOST_CHECK_EQUAL(group.properties().value<Real>("memory_total"), total);
+  BOOST_CHECK_EQUAL(sub_group.properties().value<Real>("memory_total"), sub_group_total);
+  BOOST_CHECK_EQUAL(table.properties().value<Real>("memory_bytes"), table.memory_bytes());
+  BOOST_CHECK(!sub_group.properties().check("memory_bytes"));
+
+  // Freed data is no longer counted
+  table.resize(0);
+  BOOST_CHECK_EQUAL(store_memory_usage(group), sub_group_total);
+
+  print_memory_tree(group);
+
+  // The signal stores the same properties
+  XML::SignalFrame frame("store_memory_usage", group.uri(), group.uri());
+  group.call_signal("store_memory_usage", frame);
+  BOOST_CHECK_EQUAL(group.properties().value<Real>("memory_total"), sub_group_total);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( HighWaterMark )
+{
+  const Real high_water = OSystem::instance().layer()->memory_high_water();
+  BOOST_CHECK(high_water > 0.);
+
+  // The high-water mark never decreases
+  {
+    std::vector<char> buffer(50*1024*1024, 1);
+    BOOST_CHECK(buffer.back() == 1);
+  }
+  BOOST_CHECK(OSystem::instance().layer()->memory_high_water() >= high_water);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
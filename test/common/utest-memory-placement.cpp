@@ -0,0 +1,187 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::MemoryPlacement"
+
+#include <algorithm>
+#include <numeric>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/List.hpp"
+#include "common/MemoryPlacement.hpp"
+#include "common/Table.hpp"
+#include "common/ThreadPool.hpp"
+
+#ifdef CF3_OS_LINUX
+extern "C"
+{
+  #include <sys/syscall.h>
+  #include <unistd.h>
+}
+#endif
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// NUMA node of the calling thread, or -1 if it is not known
+int current_node()
+{
+#if defined(CF3_OS_LINUX) && defined(__NR_getcpu)
+  unsigned cpu, node;
+  if(syscall(__NR_getcpu, &cpu, &node, 0) == 0)
+    return node;
+#endif
+  return -1;
+}
+
+/// Store the node of the thread that processes each row
+void record_nodes(std::vector<int>& nodes, const Uint begin, const Uint end)
+{
+  const int node = current_node();
+  for(Uint i = begin; i != end; ++i)
+    nodes[i] = node;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MemoryPlacementFixture
+{
+  MemoryPlacementFixture()
+  {
+    // Place even small tables, using several threads independent of the test machine
+    MemoryPlacement::instance().set_first_touch(true);
+    MemoryPlacement::instance().set_huge_pages(true);
+    MemoryPlacement::instance().set_min_bytes(0);
+    ThreadPool::instance().set_pin_threads(true);
+    ThreadPool::instance().set_nb_threads(4);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( MemoryPlacementSuite, MemoryPlacementFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( TableRowsAreZeroAndKept )
+{
+  Table<Real>& table = *Core::instance().root().create_component< Table<Real> >("Table");
+  table.set_row_size(5);
+  table.resize(10);
+  for(Uint i = 0; i != table.size(); ++i)
+    for(Uint j = 0; j != table.row_size(); ++j)
+      table[i][j] = i*10 + j;
+
+  // Growing keeps the existing rows, and the placed new rows are zero
+  table.resize(100000);
+  for(Uint i = 0; i != 10; ++i)
+    for(Uint j = 0; j != table.row_size(); ++j)
+      BOOST_CHECK_EQUAL(table[i][j], i*10 + j);
+
+  Real sum = 0.;
+  for(Uint i = 10; i != table.size(); ++i)
+    for(Uint j = 0; j != table.row_size(); ++j)
+      sum += std::abs(table[i][j]);
+  BOOST_CHECK_EQUAL(sum, 0.);
+}
+
+BOOST_AUTO_TEST_CASE( ListAndBuffer )
+{
+  List<Uint>& list = *Core::instance().root().create_component< List<Uint> >("List");
+  list.resize(50000);
+  list[0] = 1;
+  list.resize(100000);
+  BOOST_CHECK_EQUAL(list[0], 1);
+  BOOST_CHECK_EQUAL(std::accumulate(list.array().begin(), list.array().end(), 0u), 1u);
+
+  Table<Uint>& table = *Core::instance().root().create_component< Table<Uint> >("BufferedTable");
+  table.set_row_size(2);
+  {
+    Table<Uint>::Buffer buffer = table.create_buffer(1000);
+    std::vector<Uint> row(2);
+    for(Uint i = 0; i != 20000; ++i)
+    {
+      row[0] = i;
+      row[1] = 2*i;
+      buffer.add_row(row);
+    }
+  }
+  BOOST_CHECK_EQUAL(table.size(), 20000);
+  for(Uint i = 0; i != table.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(table[i][0], i);
+    BOOST_CHECK_EQUAL(table[i][1], 2*i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( BlocksAreOnTheNodeOfTheirThread )
+{
+  Table<Real>& table = *Core::instance().root().create_component< Table<Real> >("PlacedTable");
+  table.set_row_size(64);
+  table.resize(1000);
+  table.resize(20000);
+
+  // A later static loop over all rows processes each block on the thread that placed it
+  ThreadPool& pool = ThreadPool::instance();
+  std::vector<int> nodes(table.size(), -2);
+  pool.parallel_for(0, table.size(), boost::bind(record_nodes, boost::ref(nodes), _1, _2), ThreadPool::STATIC);
+
+  const std::size_t page = MemoryPlacement::page_size();
+  const std::size_t row_bytes = table.row_size()*sizeof(Real);
+  const std::size_t data = reinterpret_cast<std::size_t>(table.memory_data());
+  const Uint nb_blocks = pool.nb_threads();
+  for(Uint t = 0; t != nb_blocks; ++t)
+  {
+    // Whole pages of the new rows in the block
+    const Uint begin_row = std::max(1000u, t*table.size()/nb_blocks);
+    const Uint end_row = (t+1)*table.size()/nb_blocks;
+    const std::size_t first = (data + begin_row*row_bytes + page - 1) / page * page;
+    const std::size_t last = (data + end_row*row_bytes) / page * page;
+    if(first >= last || nodes[begin_row] < 0)
+      continue;
+
+    const std::vector<Uint> pages = MemoryPlacement::instance().pages_per_node(reinterpret_cast<const void*>(first), last - first);
+    if(pages.empty())
+      continue;
+    BOOST_REQUIRE(static_cast<Uint>(nodes[begin_row]) < pages.size());
+    BOOST_CHECK_EQUAL(pages[nodes[begin_row]], (last - first) / page);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Vector )
+{
+  std::vector<Real> vector(10, 1.);
+  vector.resize(200000);
+  place_new_rows(vector, 10);
+  BOOST_CHECK_EQUAL(std::accumulate(vector.begin(), vector.end(), 0.), 10.);
+}
+
+BOOST_AUTO_TEST_CASE( PageReport )
+{
+  const Table<Real>& table = *Core::instance().root().get_child("Table")->handle< Table<Real> >();
+  const std::size_t bytes = table.memory_bytes();
+  const std::vector<Uint> pages = MemoryPlacement::instance().pages_per_node(table.memory_data(), bytes);
+
+  // The query is not available everywhere, but if it is all pages are touched by now
+  if(!pages.empty())
+  {
+    const Uint nb_pages = std::accumulate(pages.begin(), pages.end(), 0u);
+    BOOST_CHECK(nb_pages >= bytes / MemoryPlacement::page_size());
+    BOOST_CHECK(nb_pages <= bytes / MemoryPlacement::page_size() + 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
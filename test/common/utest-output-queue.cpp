@@ -0,0 +1,79 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::OutputQueue"
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/OutputQueue.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void append_value(std::vector<Uint>& values, const Uint value)
+{
+  values.push_back(value);
+}
+
+void failing_task()
+{
+  throw FileSystemError(FromHere(), "disk full");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( OutputQueueSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( TasksRunInOrder )
+{
+  OutputQueue& queue = OutputQueue::instance();
+  queue.set_max_pending(2);
+
+  // Only the I/O thread touches values until wait() returns
+  std::vector<Uint> values;
+  for(Uint i = 0; i != 100; ++i)
+  {
+    queue.push(boost::bind(append_value, boost::ref(values), i));
+    BOOST_CHECK(queue.nb_pending() <= 2);
+  }
+
+  queue.wait();
+  BOOST_CHECK_EQUAL(queue.nb_pending(), 0);
+
+  BOOST_CHECK_EQUAL(values.size(), 100);
+  for(Uint i = 0; i != 100; ++i)
+    BOOST_CHECK_EQUAL(values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE( FailuresAreReported )
+{
+  OutputQueue& queue = OutputQueue::instance();
+  queue.push(failing_task);
+  BOOST_CHECK_THROW(queue.wait(), FileSystemError);
+
+  // The error is reported only once
+  BOOST_CHECK_NO_THROW(queue.wait());
+}
+
+BOOST_AUTO_TEST_CASE( BadMaxPending )
+{
+  BOOST_CHECK_THROW(OutputQueue::instance().set_max_pending(0), BadValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,9 @@
 #include "common/Log.hpp"
 #include "common/OptionT.hpp"
 #include "common/Group.hpp"
+#include "common/StringConversion.hpp"
+
+#include "rapidxml/rapidxml.hpp"
 
 #include "common/XML/SignalOptions.hpp"
 
@@ -122,6 +125,60 @@ BOOST_AUTO_TEST_CASE( simple_signal )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( paged_list_tree )
+{
+  boost::shared_ptr<Group> root = allocate_component<Group>("root");
+  Group& parent = *root->create_component<Group>("parent");
+  for(Uint i = 0; i != 5; ++i)
+    parent.create_component<Group>("child" + to_str(i))->create_component<Group>("grandchild");
+
+  // one level below the root, the children of parent are not listed
+  SignalOptions shallow_options;
+  shallow_options.add("depth", 1u);
+  SignalFrame shallow_frame = shallow_options.create_frame("list_tree", "/", "/");
+  root->signal_list_tree(shallow_frame);
+
+  XmlNode shallow_root(shallow_frame.get_reply().main_map.content.content->first_node());
+  XmlNode shallow_parent(shallow_root.content->first_node("node"));
+  BOOST_CHECK(shallow_root.content->first_attribute("nb_children") == nullptr);
+  BOOST_CHECK_EQUAL(shallow_parent.attribute_value("name"), std::string("parent"));
+  BOOST_CHECK_EQUAL(shallow_parent.attribute_value("nb_children"), std::string("5"));
+  BOOST_CHECK(shallow_parent.content->first_node("node") == nullptr);
+
+  // second page of two children of parent, without the grandchildren
+  SignalOptions page_options;
+  page_options.add("depth", 1u);
+  page_options.add("offset", 2u);
+  page_options.add("limit", 2u);
+  SignalFrame page_frame = page_options.create_frame("list_tree", "/", "/parent");
+  parent.signal_list_tree(page_frame);
+
+  XmlNode page_root(page_frame.get_reply().main_map.content.content->first_node());
+  BOOST_CHECK_EQUAL(page_root.attribute_value("nb_children"), std::string("5"));
+  BOOST_CHECK_EQUAL(page_root.attribute_value("offset"), std::string("2"));
+
+  std::vector<std::string> names;
+  for(rapidxml::xml_node<>* child = page_root.content->first_node("node"); child != nullptr; child = child->next_sibling("node"))
+  {
+    names.push_back(child->first_attribute("name")->value());
+    BOOST_CHECK_EQUAL(std::string(child->first_attribute("nb_children")->value()), "1");
+    BOOST_CHECK(child->first_node("node") == nullptr);
+  }
+  BOOST_REQUIRE_EQUAL(names.size(), 2u);
+  BOOST_CHECK_EQUAL(names[0], "child2");
+  BOOST_CHECK_EQUAL(names[1], "child3");
+
+  // without options, everything is listed
+  SignalFrame full_frame("list_tree", "/", "/");
+  root->signal_list_tree(full_frame);
+  XmlNode full_root(full_frame.get_reply().main_map.content.content->first_node());
+  BOOST_CHECK(full_root.content->first_attribute("nb_children") == nullptr);
+  XmlNode full_child(full_root.content->first_node("node")->first_node("node"));
+  BOOST_CHECK(full_child.content->first_node("node") != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,206 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::ThreadPool"
+
+#include <functional>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/ThreadPool.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Count the visits of each index. Each index is visited by a single thread, so no locking is needed.
+void count_visits(std::vector<Uint>& visits, const Uint begin, const Uint end)
+{
+  for(Uint i = begin; i != end; ++i)
+    ++visits[i];
+}
+
+Real sum_range(const Uint begin, const Uint end)
+{
+  Real result = 0.;
+  for(Uint i = begin; i != end; ++i)
+    result += static_cast<Real>(i);
+  return result;
+}
+
+/// Runs a nested parallel loop, as an Action executed from a task would
+void nested_loop(std::vector<Uint>& visits)
+{
+  ThreadPool::instance().parallel_for(0, visits.size(), boost::bind(count_visits, boost::ref(visits), _1, _2), ThreadPool::DYNAMIC, 3);
+}
+
+/// Store the index of the thread that processes each item
+void record_thread_index(std::vector<Uint>& thread_indices, const Uint begin, const Uint end)
+{
+  for(Uint i = begin; i != end; ++i)
+    thread_indices[i] = ThreadPool::instance().thread_index();
+}
+
+/// Store the id of the thread that runs a task
+void record_thread_id(boost::thread::id& id)
+{
+  id = boost::this_thread::get_id();
+}
+
+/// Run tasks that record their thread in a group and wait for them
+void run_recording_group(std::vector<boost::thread::id>& ids)
+{
+  ThreadPool::TaskGroup group;
+  for(Uint i = 0; i != ids.size(); ++i)
+    group.run(boost::bind(record_thread_id, boost::ref(ids[i])));
+  group.wait();
+}
+
+void failing_range(const Uint begin, const Uint end)
+{
+  if(begin <= 42 && 42 < end)
+    throw BadValue(FromHere(), "bad item");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( ThreadPoolSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Resize )
+{
+  ThreadPool& pool = ThreadPool::instance();
+  BOOST_CHECK_THROW(pool.set_nb_threads(0), BadValue);
+
+  // Use several threads, independent of the test machine
+  pool.set_nb_threads(4);
+  BOOST_CHECK_EQUAL(pool.nb_threads(), 4);
+  BOOST_CHECK_EQUAL(pool.nb_used_threads(2), 2);
+  BOOST_CHECK_EQUAL(pool.nb_used_threads(100, 3), 3);
+  BOOST_CHECK_EQUAL(pool.nb_used_threads(0), 1);
+}
+
+BOOST_AUTO_TEST_CASE( ParallelForSchedules )
+{
+  ThreadPool& pool = ThreadPool::instance();
+  const ThreadPool::Schedule schedules[] = { ThreadPool::STATIC, ThreadPool::DYNAMIC, ThreadPool::WORK_STEALING };
+  const Uint grain_sizes[] = { 0, 1, 7 };
+  for(Uint s = 0; s != 3; ++s)
+  {
+    for(Uint g = 0; g != 3; ++g)
+    {
+      std::vector<Uint> visits(1003, 0);
+      pool.parallel_for(1, visits.size(), boost::bind(count_visits, boost::ref(visits), _1, _2), schedules[s], grain_sizes[g]);
+      BOOST_CHECK_EQUAL(visits[0], 0);
+      for(Uint i = 1; i != visits.size(); ++i)
+        BOOST_CHECK_EQUAL(visits[i], 1);
+    }
+  }
+
+  // Empty range
+  std::vector<Uint> visits;
+  pool.parallel_for(0, 0, boost::bind(count_visits, boost::ref(visits), _1, _2));
+}
+
+BOOST_AUTO_TEST_CASE( ParallelReduce )
+{
+  const Real sum = ThreadPool::instance().parallel_reduce(0, 1000, boost::function<Real (const Uint, const Uint)>(sum_range), 1., std::plus<Real>());
+  BOOST_CHECK_EQUAL(sum, 1. + 999.*1000./2.);
+}
+
+BOOST_AUTO_TEST_CASE( NestedTaskGroups )
+{
+  // More groups than threads, so tasks wait on loops that need the other threads
+  std::vector< std::vector<Uint> > visits(10, std::vector<Uint>(100, 0));
+  ThreadPool::TaskGroup group;
+  for(Uint i = 0; i != visits.size(); ++i)
+    group.run(boost::bind(nested_loop, boost::ref(visits[i])));
+  group.wait();
+
+  for(Uint i = 0; i != visits.size(); ++i)
+    for(Uint j = 0; j != visits[i].size(); ++j)
+      BOOST_CHECK_EQUAL(visits[i][j], 1);
+}
+
+BOOST_AUTO_TEST_CASE( StaticBlocksPerThread )
+{
+  ThreadPool& pool = ThreadPool::instance();
+  pool.set_nb_threads(4);
+  BOOST_CHECK_EQUAL(pool.thread_index(), 0);
+
+  // Block 0 runs on the caller, block t on worker t, every time
+  std::vector<Uint> thread_indices(1000, 99);
+  for(Uint repeat = 0; repeat != 20; ++repeat)
+  {
+    pool.parallel_for(0, thread_indices.size(), boost::bind(record_thread_index, boost::ref(thread_indices), _1, _2), ThreadPool::STATIC);
+    for(Uint i = 0; i != thread_indices.size(); ++i)
+      BOOST_CHECK_EQUAL(thread_indices[i], i / 250);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( WaitRunsOnlyOwnGroup )
+{
+  // Without workers, each waiter has to run the tasks of its own group, and only those
+  ThreadPool& pool = ThreadPool::instance();
+  pool.set_nb_threads(1);
+
+  std::vector<boost::thread::id> main_ids(200);
+  std::vector<boost::thread::id> other_ids(200);
+  boost::thread other_thread(boost::bind(run_recording_group, boost::ref(other_ids)));
+  run_recording_group(main_ids);
+  other_thread.join();
+
+  for(Uint i = 0; i != main_ids.size(); ++i)
+    BOOST_CHECK(main_ids[i] == boost::this_thread::get_id());
+  for(Uint i = 0; i != other_ids.size(); ++i)
+    BOOST_CHECK(other_ids[i] != boost::this_thread::get_id());
+
+  pool.set_nb_threads(4);
+}
+
+BOOST_AUTO_TEST_CASE( FailuresAreReported )
+{
+  ThreadPool& pool = ThreadPool::instance();
+  BOOST_CHECK_THROW(pool.parallel_for(0, 100, failing_range, ThreadPool::DYNAMIC, 1), ParallelError);
+
+  // The pool is still usable after a failure
+  std::vector<Uint> visits(100, 0);
+  pool.parallel_for(0, visits.size(), boost::bind(count_visits, boost::ref(visits), _1, _2), ThreadPool::WORK_STEALING, 1);
+  for(Uint i = 0; i != visits.size(); ++i)
+    BOOST_CHECK_EQUAL(visits[i], 1);
+}
+
+BOOST_AUTO_TEST_CASE( Statistics )
+{
+  // The counts below depend on the number of threads, so don't rely on an earlier test case to set it
+  ThreadPool& pool = ThreadPool::instance();
+  pool.set_nb_threads(4);
+  pool.reset_statistics();
+  BOOST_CHECK_EQUAL(pool.statistics().nb_loops, 0);
+
+  std::vector<Uint> visits(1000, 0);
+  pool.parallel_for(0, visits.size(), boost::bind(count_visits, boost::ref(visits), _1, _2), ThreadPool::STATIC);
+
+  const ThreadPool::Statistics statistics = pool.statistics();
+  BOOST_CHECK_EQUAL(statistics.nb_loops, 1);
+  BOOST_CHECK_EQUAL(statistics.nb_tasks, 4);
+  BOOST_CHECK_EQUAL(statistics.busy_time.size(), 4);
+  BOOST_CHECK(statistics.utilization() >= 0.);
+  BOOST_CHECK(statistics.utilization() <= 1.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
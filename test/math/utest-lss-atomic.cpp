@@ -17,6 +17,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "common/Log.hpp"
+#include "common/PropertyList.hpp"
 #include "math/LSS/System.hpp"
 #include "math/VariablesDescriptor.hpp"
 
@@ -958,6 +959,12 @@ BOOST_AUTO_TEST_CASE( solve_system )
     if (cp.isUpdatable()[i/neq])
       BOOST_CHECK_CLOSE( vals[i], refvals[gid[i/neq]*neq], 1e-8);
 
+  // the true residual and the relative residual reported by the solver are kept apart
+  const common::PropertyList& telemetry = sys->solution_strategy()->properties();
+  BOOST_CHECK_CLOSE(telemetry.value<Real>("final_residual"), sys->solution_strategy()->compute_residual(), 1e-8);
+  BOOST_CHECK(telemetry.value<Real>("final_relative_residual") >= 0.);
+  BOOST_CHECK_EQUAL(telemetry.value< std::vector<Real> >("residuals").size(), 1u);
+
 }
 
 ////////////////////////////////////////////////////////////////////////////////
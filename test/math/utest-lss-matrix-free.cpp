@@ -0,0 +1,296 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the matrix-free operator of cf3::math::LSS"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+#include <boost/assign/std/vector.hpp>
+
+#include "common/Action.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/System.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace boost::assign;
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Assembles a (non-symmetric) 1D operator on two line elements, and a RHS of ones.
+/// Optionally applies a symmetric dirichlet condition on one node afterwards, as the boundary conditions of a solver do.
+class LineAssembly : public common::Action
+{
+public:
+  LineAssembly(const std::string& name) : common::Action(name), apply_dirichlet(false), dirichlet_node(0)
+  {
+  }
+
+  static std::string type_name() { return "LineAssembly"; }
+
+  void execute()
+  {
+    BlockAccumulator acc;
+    acc.resize(2, 1);
+    acc.mat << 2., -1., -0.5, 1.;
+    acc.rhs.setConstant(1.);
+    for(Uint e = 0; e != 2; ++e)
+    {
+      acc.indices[0] = e;
+      acc.indices[1] = e+1;
+      system->matrix()->add_values(acc);
+      system->rhs()->add_rhs_values(acc);
+    }
+
+    if(apply_dirichlet)
+      system->matrix()->symmetric_dirichlet(dirichlet_node, 0, 10., *system->rhs());
+  }
+
+  Handle<LSS::System> system;
+  bool apply_dirichlet;
+  Uint dirichlet_node;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LSSMatrixFreeFixture
+{
+  /// common setup for each test case
+  LSSMatrixFreeFixture() :
+    irank(0),
+    nproc(1),
+    neq(1)
+  {
+    if (common::PE::Comm::instance().is_initialized())
+    {
+      nproc=common::PE::Comm::instance().size();
+      irank=common::PE::Comm::instance().rank();
+      BOOST_CHECK_EQUAL(nproc,2);
+    }
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// create a test commpattern
+  void build_commpattern(common::PE::CommPattern& cp)
+  {
+    if (irank==0)
+    {
+      gid += 0,1,2;
+      rank_updatable += 0,0,1;
+    } else {
+      gid += 1,2,3;
+      rank_updatable += 0,1,1;
+    }
+    cp.insert("gid",gid,1,false);
+    cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),rank_updatable);
+  }
+
+  /// build a system using the given matrix, and assemble it using a new LineAssembly action
+  boost::shared_ptr<LSS::System> build_system(const std::string& matrix_builder, common::PE::CommPattern& cp, const bool dirichlet_in_action = false)
+  {
+    std::vector<Uint> node_connectivity;
+    std::vector<Uint> starting_indices;
+    node_connectivity += 0,1,0,1,2,1,2;
+    starting_indices += 0,2,5,7;
+
+    boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+    sys->options().option("matrix_builder").change_value(matrix_builder);
+    sys->create(cp,neq,node_connectivity,starting_indices);
+
+    boost::shared_ptr<LineAssembly> assembly = common::allocate_component<LineAssembly>("assembly");
+    assembly->system = Handle<LSS::System>(sys);
+    // Global node 1 is owned by rank 0 and a ghost on rank 1
+    assembly->apply_dirichlet = dirichlet_in_action;
+    assembly->dirichlet_node = irank == 0 ? 1 : 0;
+    actions.push_back(assembly);
+
+    if(matrix_builder == "cf3.math.LSS.TrilinosMatrixFree")
+      sys->matrix()->options().set("operator_action", Handle<common::Action>(assembly));
+
+    sys->reset();
+    assembly->execute();
+
+    return sys;
+  }
+
+  /// Compare the owned entries of two vectors
+  void check_owned_values(LSS::Vector& a, LSS::Vector& b)
+  {
+    for(Uint i = 0; i != gid.size(); ++i)
+    {
+      if(rank_updatable[i] != static_cast<Uint>(irank))
+        continue;
+      Real a_val, b_val;
+      a.get_value(i, 0, a_val);
+      b.get_value(i, 0, b_val);
+      BOOST_CHECK_CLOSE(a_val, b_val, 1e-12);
+    }
+  }
+
+  /// Compare A*x for both systems, with x = gid+1
+  void check_products(LSS::System& free_sys, LSS::System& crs_sys)
+  {
+    Handle<LSS::Vector> x(free_sys.solution());
+    Handle<LSS::Vector> free_y(free_sys.create_component("y", "cf3.math.LSS.TrilinosVector"));
+    Handle<LSS::Vector> crs_y(crs_sys.create_component("y", "cf3.math.LSS.TrilinosVector"));
+    x->clone_to(*free_y);
+    x->clone_to(*crs_y);
+
+    for(Uint i = 0; i != gid.size(); ++i)
+      x->set_value(i, 0, static_cast<Real>(gid[i]+1));
+
+    free_y->reset(1.);
+    crs_y->reset(1.);
+    free_sys.matrix()->apply(free_y, Handle<LSS::Vector const>(x), 2., 3.);
+    crs_sys.matrix()->apply(crs_y, Handle<LSS::Vector const>(x), 2., 3.);
+    check_owned_values(*free_y, *crs_y);
+
+    free_sys.remove_component("y");
+    crs_sys.remove_component("y");
+  }
+
+  /// Compare the owned diagonal entries
+  void check_diagonals(LSS::System& free_sys, LSS::System& crs_sys)
+  {
+    for(Uint i = 0; i != gid.size(); ++i)
+    {
+      if(rank_updatable[i] != static_cast<Uint>(irank))
+        continue;
+      Real free_val, crs_val;
+      free_sys.matrix()->get_value(i, i, free_val);
+      crs_sys.matrix()->get_value(i, i, crs_val);
+      BOOST_CHECK_EQUAL(free_val, crs_val);
+    }
+  }
+
+  /// constructor builds
+  int irank;
+  int nproc;
+  int neq;
+  int m_argc;
+  char** m_argv;
+
+  /// commpattern builds
+  std::vector<Uint> gid;
+  std::vector<Uint> rank_updatable;
+
+  /// keeps the assembly actions alive
+  std::vector< boost::shared_ptr<LineAssembly> > actions;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( LSSMatrixFreeSuite, LSSMatrixFreeFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  common::PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),true);
+  CFinfo.setFilterRankZero(false);
+  common::Core::instance().environment().options().set("log_level", 4u);
+  common::Core::instance().environment().options().set("exception_backtrace", false);
+  common::Core::instance().environment().options().set("exception_outputs", false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_product )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+
+  boost::shared_ptr<LSS::System> free_sys = build_system("cf3.math.LSS.TrilinosMatrixFree", cp);
+  boost::shared_ptr<LSS::System> crs_sys = build_system("cf3.math.LSS.TrilinosCrsMatrix", cp);
+
+  check_diagonals(*free_sys, *crs_sys);
+  check_products(*free_sys, *crs_sys);
+
+  // The RHS assembled by the operator action must not change during a product
+  check_owned_values(*free_sys->rhs(), *crs_sys->rhs());
+
+  // Only the diagonal is stored
+  Real val;
+  BOOST_CHECK_THROW(free_sys->matrix()->get_value(1, 0, val), common::NotSupported);
+  BOOST_CHECK_THROW(free_sys->matrix()->set_value(0, 0, 1.), common::NotSupported);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_symmetric_dirichlet )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+
+  boost::shared_ptr<LSS::System> free_sys = build_system("cf3.math.LSS.TrilinosMatrixFree", cp);
+  boost::shared_ptr<LSS::System> crs_sys = build_system("cf3.math.LSS.TrilinosCrsMatrix", cp);
+
+  // Global node 1 is owned by rank 0 and a ghost on rank 1
+  const Uint bc_node = irank == 0 ? 1 : 0;
+  free_sys->matrix()->symmetric_dirichlet(bc_node, 0, 10., *free_sys->rhs());
+  crs_sys->matrix()->symmetric_dirichlet(bc_node, 0, 10., *crs_sys->rhs());
+
+  check_owned_values(*free_sys->rhs(), *crs_sys->rhs());
+  check_diagonals(*free_sys, *crs_sys);
+  check_products(*free_sys, *crs_sys);
+
+  // Plain dirichlet rows on top of that, on the last node
+  if(irank == 1)
+  {
+    free_sys->matrix()->set_row(2, 0, 1., 0.);
+    crs_sys->matrix()->set_row(2, 0, 1., 0.);
+  }
+  check_diagonals(*free_sys, *crs_sys);
+  check_products(*free_sys, *crs_sys);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_dirichlet_in_operator_action )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+
+  // The condition is applied again by each product pass, which must not disturb the product
+  boost::shared_ptr<LSS::System> free_sys = build_system("cf3.math.LSS.TrilinosMatrixFree", cp, true);
+  boost::shared_ptr<LSS::System> crs_sys = build_system("cf3.math.LSS.TrilinosCrsMatrix", cp, true);
+
+  check_owned_values(*free_sys->rhs(), *crs_sys->rhs());
+  check_diagonals(*free_sys, *crs_sys);
+  check_products(*free_sys, *crs_sys);
+  check_products(*free_sys, *crs_sys);
+  check_owned_values(*free_sys->rhs(), *crs_sys->rhs());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  CFinfo.setFilterRankZero(true);
+  common::PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
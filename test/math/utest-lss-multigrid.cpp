@@ -0,0 +1,239 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the multigrid solution strategy of cf3::math::LSS"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/Trilinos/MultigridStrategy.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Laplacian on a structured grid of n x n nodes, with a 5-point stencil and zero Dirichlet conditions on the boundary
+struct LSSMultigridFixture
+{
+  LSSMultigridFixture() :
+    n(30)
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  Uint node(const Uint i, const Uint j)
+  {
+    return i + j*n;
+  }
+
+  boost::shared_ptr<LSS::System> build_system(common::PE::CommPattern& cp, const std::string& krylov_solver, const std::string& smoother)
+  {
+    const Uint nb_nodes = n*n;
+    std::vector<Uint> gid(nb_nodes), rank_updatable(nb_nodes, 0);
+    for(Uint i = 0; i != nb_nodes; ++i)
+      gid[i] = i;
+    cp.insert("gid",gid,1,false);
+    cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),rank_updatable);
+
+    std::vector<Uint> node_connectivity, starting_indices;
+    starting_indices.push_back(0);
+    for(Uint j = 0; j != n; ++j)
+    {
+      for(Uint i = 0; i != n; ++i)
+      {
+        node_connectivity.push_back(node(i, j));
+        if(i != 0) node_connectivity.push_back(node(i-1, j));
+        if(i != n-1) node_connectivity.push_back(node(i+1, j));
+        if(j != 0) node_connectivity.push_back(node(i, j-1));
+        if(j != n-1) node_connectivity.push_back(node(i, j+1));
+        starting_indices.push_back(node_connectivity.size());
+      }
+    }
+
+    boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+    sys->options().option("matrix_builder").change_value(std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+    sys->options().option("solution_strategy").change_value(std::string("cf3.math.LSS.MultigridStrategy"));
+    sys->create(cp,1,node_connectivity,starting_indices);
+
+    Handle<common::Component> strategy = sys->solution_strategy();
+    strategy->options().set("coarse_size", 20u);
+    strategy->options().set("krylov_solver", krylov_solver);
+    strategy->options().set("smoother", smoother);
+
+    // Assemble the edge contributions
+    BlockAccumulator acc;
+    acc.resize(2, 1);
+    acc.mat << 1., -1., -1., 1.;
+    acc.rhs.setConstant(0.5);
+    for(Uint j = 0; j != n; ++j)
+    {
+      for(Uint i = 0; i != n; ++i)
+      {
+        acc.indices[0] = node(i, j);
+        if(i != n-1)
+        {
+          acc.indices[1] = node(i+1, j);
+          sys->add_values(acc);
+        }
+        if(j != n-1)
+        {
+          acc.indices[1] = node(i, j+1);
+          sys->add_values(acc);
+        }
+      }
+    }
+
+    for(Uint k = 0; k != n; ++k)
+    {
+      sys->dirichlet(node(k, 0), 0, 0., true);
+      sys->dirichlet(node(k, n-1), 0, 0., true);
+      if(k != 0 && k != n-1)
+      {
+        sys->dirichlet(node(0, k), 0, 0., true);
+        sys->dirichlet(node(n-1, k), 0, 0., true);
+      }
+    }
+
+    return sys;
+  }
+
+  void check_solution(LSS::System& sys)
+  {
+    MultigridStrategy& strategy = dynamic_cast<MultigridStrategy&>(*sys.solution_strategy());
+
+    BOOST_CHECK_EQUAL(strategy.nb_levels(), 0u);
+    sys.solve();
+
+    // The hierarchy coarsens down to the requested size
+    BOOST_CHECK(strategy.nb_levels() > 2);
+    BOOST_CHECK_EQUAL(strategy.level_size(0), n*n);
+    for(Uint i = 1; i != strategy.nb_levels(); ++i)
+      BOOST_CHECK(strategy.level_size(i) < strategy.level_size(i-1));
+    BOOST_CHECK(strategy.level_size(strategy.nb_levels()-1) <= 20u);
+
+    BOOST_CHECK_SMALL(strategy.compute_residual(), 1e-5);
+
+    // Telemetry for the solve
+    BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("solve_count"), 1u);
+    BOOST_CHECK_EQUAL(strategy.properties().value<Uint>("preconditioner_rebuilds"), 1u);
+    BOOST_CHECK(strategy.properties().value<Uint>("iterations") > 0);
+    BOOST_CHECK(strategy.properties().value<Real>("solve_time") >= 0.);
+    BOOST_CHECK_EQUAL(strategy.solve_count(), 1u);
+    BOOST_CHECK_EQUAL(strategy.last_telemetry_row(), 0u);
+    BOOST_CHECK_CLOSE(strategy.properties().value<Real>("final_residual"), strategy.compute_residual(), 1e-8);
+    BOOST_CHECK_EQUAL(strategy.telemetry()->row_size(), SolutionStrategy::telemetry_columns().size());
+
+    // The solution is symmetric about the grid center
+    Real a, b;
+    sys.solution()->get_value(node(3, 7), 0, a);
+    sys.solution()->get_value(node(7, 3), 0, b);
+    BOOST_CHECK(a > 0.);
+    BOOST_CHECK_CLOSE(a, b, 1e-4);
+    sys.solution()->get_value(node(n-4, n-8), 0, b);
+    BOOST_CHECK_CLOSE(a, b, 1e-4);
+  }
+
+  const Uint n;
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( LSSMultigridSuite, LSSMultigridFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  common::PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),true);
+  common::Core::instance().environment().options().set("log_level", 4u);
+  common::Core::instance().environment().options().set("exception_backtrace", false);
+  common::Core::instance().environment().options().set("exception_outputs", false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( cg_gauss_seidel )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> sys = build_system(*cp_ptr, "CG", "GaussSeidel");
+  check_solution(*sys);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( gmres_jacobi )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> sys = build_system(*cp_ptr, "GMRES", "Jacobi");
+  sys->solution_strategy()->options().set("smoother_sweeps", 2u);
+  check_solution(*sys);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( single_precision )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> reference = build_system(*cp_ptr, "CG", "GaussSeidel");
+  reference->solve();
+
+  // Single precision cycle with both outer solvers, which must give the double precision result
+  const std::string krylov_solvers[] = { "CG", "FGMRES" };
+  for(Uint i = 0; i != 2; ++i)
+  {
+    boost::shared_ptr<common::PE::CommPattern> single_cp = common::allocate_component<common::PE::CommPattern>("commpattern");
+    boost::shared_ptr<LSS::System> sys = build_system(*single_cp, krylov_solvers[i], "GaussSeidel");
+    sys->solution_strategy()->options().set("single_precision", true);
+    check_solution(*sys);
+
+    for(Uint j = 1; j != n-1; ++j)
+    {
+      Real single_value, reference_value;
+      sys->solution()->get_value(node(j, n/2), 0, single_value);
+      reference->solution()->get_value(node(j, n/2), 0, reference_value);
+      BOOST_CHECK_CLOSE(single_value, reference_value, 1e-3);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( unsupported_settings )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> sys = build_system(*cp_ptr, "CG", "ILU");
+  BOOST_CHECK_THROW(sys->solve(), common::BadValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  common::PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,208 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for static condensation in cf3::math::LSS"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+#include <boost/assign/std/vector.hpp>
+
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "math/LSS/StaticCondensation.hpp"
+#include "math/LSS/System.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace boost::assign;
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Two quadratic line elements of length 1, for -u'' = 1. Nodes 1 and 3 are the midpoints.
+struct LSSStaticCondensationFixture
+{
+  LSSStaticCondensationFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  boost::shared_ptr<LSS::System> build_system(common::PE::CommPattern& cp)
+  {
+    std::vector<Uint> gid, rank_updatable;
+    gid += 0,1,2,3,4;
+    rank_updatable += 0,0,0,0,0;
+    cp.insert("gid",gid,1,false);
+    cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),rank_updatable);
+
+    std::vector<Uint> node_connectivity, starting_indices;
+    node_connectivity += 0,1,2, 0,1,2, 0,1,2,3,4, 2,3,4, 2,3,4;
+    starting_indices += 0,3,6,11,14,17;
+
+    boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+    sys->options().option("matrix_builder").change_value(std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+    sys->create(cp,1,node_connectivity,starting_indices);
+
+    std::vector<Uint> interior_nodes;
+    interior_nodes += 1,3;
+    sys->set_static_condensation(interior_nodes);
+
+    return sys;
+  }
+
+  /// Add the element matrices, with the midpoint as last node
+  void assemble(LSS::System& sys)
+  {
+    BlockAccumulator acc;
+    acc.resize(3, 1);
+    acc.mat << 7., 1., -8.,
+               1., 7., -8.,
+              -8., -8., 16.;
+    acc.mat /= 3.;
+    acc.rhs << 1., 1., 4.;
+    acc.rhs /= 6.;
+    acc.sol.setZero();
+
+    acc.indices[0] = 0; acc.indices[1] = 2; acc.indices[2] = 1;
+    sys.add_values(acc);
+    acc.indices[0] = 2; acc.indices[1] = 4; acc.indices[2] = 3;
+    sys.add_values(acc);
+  }
+
+  Real matrix_value(LSS::System& sys, const Uint row, const Uint col)
+  {
+    Real result;
+    sys.matrix()->get_value(col, row, result);
+    return result;
+  }
+
+  Real vector_value(LSS::Vector& vec, const Uint row)
+  {
+    Real result;
+    vec.get_value(row, 0, result);
+    return result;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( LSSStaticCondensationSuite, LSSStaticCondensationFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  common::PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),true);
+  common::Core::instance().environment().options().set("log_level", 4u);
+  common::Core::instance().environment().options().set("exception_backtrace", false);
+  common::Core::instance().environment().options().set("exception_outputs", false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( condense_and_recover )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> sys = build_system(*cp_ptr);
+  assemble(*sys);
+
+  StaticCondensation& condensation = *sys->static_condensation();
+  BOOST_CHECK_EQUAL(condensation.nb_elements(), 2u);
+  BOOST_CHECK(condensation.is_pending());
+
+  // Nothing was added to the matrix yet
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 2, 2), 0.);
+
+  condensation.condense(*sys->matrix(), *sys->rhs());
+  BOOST_CHECK(!condensation.is_pending());
+
+  // Condensing the quadratic element gives the linear element matrix and load vector
+  BOOST_CHECK_CLOSE(matrix_value(*sys, 0, 0), 1., 1e-12);
+  BOOST_CHECK_CLOSE(matrix_value(*sys, 0, 2), -1., 1e-12);
+  BOOST_CHECK_CLOSE(matrix_value(*sys, 2, 2), 2., 1e-12);
+  BOOST_CHECK_CLOSE(matrix_value(*sys, 4, 2), -1., 1e-12);
+  BOOST_CHECK_CLOSE(matrix_value(*sys, 4, 4), 1., 1e-12);
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 1, 1), 1.);
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 3, 3), 1.);
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 1, 0), 0.);
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 2, 1), 0.);
+  BOOST_CHECK_EQUAL(matrix_value(*sys, 3, 4), 0.);
+
+  BOOST_CHECK_CLOSE(vector_value(*sys->rhs(), 0), 0.5, 1e-12);
+  BOOST_CHECK_CLOSE(vector_value(*sys->rhs(), 2), 1., 1e-12);
+  BOOST_CHECK_CLOSE(vector_value(*sys->rhs(), 4), 0.5, 1e-12);
+  BOOST_CHECK_EQUAL(vector_value(*sys->rhs(), 1), 0.);
+  BOOST_CHECK_EQUAL(vector_value(*sys->rhs(), 3), 0.);
+
+  // For a linear boundary solution, the midpoints get the quadratic bump h^2/8
+  sys->solution()->set_value(0, 0, 0.);
+  sys->solution()->set_value(2, 0, 1.);
+  sys->solution()->set_value(4, 0, 2.);
+  condensation.recover(*sys->solution());
+  BOOST_CHECK_CLOSE(vector_value(*sys->solution(), 1), 0.625, 1e-12);
+  BOOST_CHECK_CLOSE(vector_value(*sys->solution(), 3), 1.625, 1e-12);
+
+  // Interior nodes can only be added
+  BlockAccumulator acc;
+  acc.resize(3, 1);
+  acc.reset();
+  acc.indices[0] = 0; acc.indices[1] = 2; acc.indices[2] = 1;
+  BOOST_CHECK_THROW(sys->set_values(acc), common::NotSupported);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( solve_condensed )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  boost::shared_ptr<LSS::System> sys = build_system(*cp_ptr);
+  sys->solution_strategy()->access_component("Parameters")->options().set("preconditioner_type", std::string("None"));
+
+  // Assemble twice, checking that the reset also clears the stored element matrices
+  assemble(*sys);
+  sys->reset();
+  assemble(*sys);
+
+  // The dirichlet conditions trigger the condensation
+  sys->dirichlet(0, 0, 0.);
+  sys->dirichlet(4, 0, 0.);
+  BOOST_CHECK(!sys->static_condensation()->is_pending());
+
+  sys->solve();
+
+  // The quadratic solution x*(2-x)/2 is exact at the nodes
+  BOOST_CHECK_SMALL(vector_value(*sys->solution(), 0), 1e-10);
+  BOOST_CHECK_CLOSE(vector_value(*sys->solution(), 1), 0.375, 1e-6);
+  BOOST_CHECK_CLOSE(vector_value(*sys->solution(), 2), 0.5, 1e-6);
+  BOOST_CHECK_CLOSE(vector_value(*sys->solution(), 3), 0.375, 1e-6);
+  BOOST_CHECK_SMALL(vector_value(*sys->solution(), 4), 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  common::PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 #include <boost/assign/std/vector.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include "common/BasicExceptions.hpp"
 #include "common/Log.hpp"
 #include "math/LSS/System.hpp"
 #include "math/VariablesDescriptor.hpp"
@@ -101,6 +102,50 @@ struct LSSSymmetricDirichletFixture
     sys.create(cp,neq,node_connectivity,starting_indices);
   }
 
+  /// Check the result of applying a value of 10 to the boundary node of each rank
+  void check_system(LSS::System& sys)
+  {
+    Real val;
+    if(irank == 0)
+    {
+      sys.matrix()->get_value(0, 0, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+      sys.matrix()->get_value(1, 0, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys.matrix()->get_value(0, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys.matrix()->get_value(1, 1, val);
+      BOOST_CHECK_EQUAL(val, 1.);
+      sys.matrix()->get_value(2, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+
+      sys.rhs()->get_value(0, val);
+      BOOST_CHECK_EQUAL(val, -10.);
+      sys.rhs()->get_value(1, val);
+      BOOST_CHECK_EQUAL(val, 10.);
+    }
+    else
+    {
+      sys.matrix()->get_value(0, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys.matrix()->get_value(1, 1, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+      sys.matrix()->get_value(2, 1, val);
+      BOOST_CHECK_EQUAL(val, 1.);
+      sys.matrix()->get_value(1, 2, val);
+      BOOST_CHECK_EQUAL(val, 1.);
+      sys.matrix()->get_value(2, 2, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+
+      sys.rhs()->get_value(0, val);
+      BOOST_CHECK_EQUAL(val, 10.);
+      sys.rhs()->get_value(1, val);
+      BOOST_CHECK_EQUAL(val, -10.);
+      sys.rhs()->get_value(2, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+    }
+  }
+
   /// main solver selector
   std::string solvertype;
   std::string matrix_builder;
@@ -166,45 +211,37 @@ BOOST_AUTO_TEST_CASE( test_complete_system )
 
   sys->rhs()->print_native(std::cout);
 
+  check_system(*sys);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_batched_system )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*sys,cp);
+
+  sys->matrix()->set_row(0, 0, 2, 1);
+  sys->matrix()->set_row(1, 0, 2, 1);
+  sys->matrix()->set_row(2, 0, 2, 1);
+
+  // Apply through the queue, which uses the batched dirichlet function
+  sys->queue_dirichlet(irank == 0 ? 1 : 0, 0, 10.);
+  BOOST_CHECK_THROW(sys->solve(), common::SetupError);
+  sys->apply_queued_dirichlet(true);
+  check_system(*sys);
+
   Real val;
-  if(irank == 0)
-  {
-    sys->matrix()->get_value(0, 0, val);
-    BOOST_CHECK_EQUAL(val, 2.);
-    sys->matrix()->get_value(1, 0, val);
-    BOOST_CHECK_EQUAL(val, 0.);
-    sys->matrix()->get_value(0, 1, val);
-    BOOST_CHECK_EQUAL(val, 0.);
-    sys->matrix()->get_value(1, 1, val);
-    BOOST_CHECK_EQUAL(val, 1.);
-    sys->matrix()->get_value(2, 1, val);
-    BOOST_CHECK_EQUAL(val, 0.);
-
-    sys->rhs()->get_value(0, val);
-    BOOST_CHECK_EQUAL(val, -10.);
-    sys->rhs()->get_value(1, val);
-    BOOST_CHECK_EQUAL(val, 10.);
-  }
-  else
-  {
-    sys->matrix()->get_value(0, 1, val);
-    BOOST_CHECK_EQUAL(val, 0.);
-    sys->matrix()->get_value(1, 1, val);
-    BOOST_CHECK_EQUAL(val, 2.);
-    sys->matrix()->get_value(2, 1, val);
-    BOOST_CHECK_EQUAL(val, 1.);
-    sys->matrix()->get_value(1, 2, val);
-    BOOST_CHECK_EQUAL(val, 1.);
-    sys->matrix()->get_value(2, 2, val);
-    BOOST_CHECK_EQUAL(val, 2.);
-
-    sys->rhs()->get_value(0, val);
-    BOOST_CHECK_EQUAL(val, 10.);
-    sys->rhs()->get_value(1, val);
-    BOOST_CHECK_EQUAL(val, -10.);
-    sys->rhs()->get_value(2, val);
-    BOOST_CHECK_EQUAL(val, 0.);
-  }
+  sys->solution()->get_value(irank == 0 ? 1 : 0, 0, val);
+  BOOST_CHECK_EQUAL(val, 10.);
+
+  // The queue is empty now, so this must not change anything
+  sys->apply_queued_dirichlet(true);
+  check_system(*sys);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
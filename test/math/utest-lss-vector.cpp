@@ -10,6 +10,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 #include <boost/test/unit_test.hpp>
@@ -101,6 +103,21 @@ struct LSSAtomicFixture
     sys.create(cp,neq,node_connectivity,starting_indices);
   }
 
+  /// check that all entries of a vector, including the ghosts, have the expected value
+  void check_all_values(LSS::Vector& v, const Real expected)
+  {
+    const Uint nb_blocks = v.blockrow_size();
+    for(Uint i = 0; i != nb_blocks; ++i)
+    {
+      for(Uint j = 0; j != static_cast<Uint>(neq); ++j)
+      {
+        Real val;
+        v.get_value(i, j, val);
+        BOOST_CHECK_CLOSE(val, expected, 1e-12);
+      }
+    }
+  }
+
   /// main solver selector
   std::string solvertype;
   std::string matrix_builder;
@@ -315,6 +332,126 @@ BOOST_AUTO_TEST_CASE( test_scale )
   }
 }
 
+BOOST_AUTO_TEST_CASE( test_get_set_block )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  neq = 2;
+  build_system(*sys,cp);
+
+  Handle<LSS::Vector> sol(sys->solution());
+  sol->reset(0.);
+  const Uint nb_blocks = sol->blockrow_size();
+
+  // Table rows are the block rows in reverse order, with an extra unused row at the end
+  boost::multi_array<int, 1> node_map(boost::extents[nb_blocks+1]);
+  boost::multi_array<Real, 2> table(boost::extents[nb_blocks+1][3]);
+  for(Uint i = 0; i != nb_blocks; ++i)
+  {
+    node_map[i] = nb_blocks - 1 - i;
+    for(Uint j = 0; j != 3; ++j)
+      table[i][j] = 10.*i + j;
+  }
+  node_map[nb_blocks] = -1;
+
+  // Columns 1 and 2 go to equations 0 and 1
+  sol->set_block(table, &node_map, 1, 0, 2);
+  for(Uint i = 0; i != nb_blocks; ++i)
+  {
+    for(Uint j = 0; j != 2; ++j)
+    {
+      Real val;
+      sol->get_value(nb_blocks - 1 - i, j, val);
+      BOOST_CHECK_EQUAL(val, 10.*i + j + 1);
+    }
+  }
+
+  // Equation 1 back to column 0, without node map
+  boost::multi_array<Real, 2> result(boost::extents[nb_blocks][1]);
+  sol->get_block(result, nullptr, 0, 1, 1);
+  for(Uint i = 0; i != nb_blocks; ++i)
+    BOOST_CHECK_EQUAL(result[i][0], 10.*(nb_blocks - 1 - i) + 2);
+
+  // Round trip through a column-major table, as used by fields with the SoA layout
+  boost::multi_array<Real, 2> soa_table(boost::extents[nb_blocks+1][3], boost::fortran_storage_order());
+  for(Uint i = 0; i != nb_blocks+1; ++i)
+    for(Uint j = 0; j != 3; ++j)
+      soa_table[i][j] = 10.*i + j;
+  sol->set_block(soa_table, &node_map, 1, 0, 2);
+  for(Uint i = 0; i != nb_blocks; ++i)
+  {
+    for(Uint j = 0; j != 2; ++j)
+    {
+      Real val;
+      sol->get_value(nb_blocks - 1 - i, j, val);
+      BOOST_CHECK_EQUAL(val, 10.*i + j + 1);
+    }
+  }
+
+  boost::multi_array<Real, 2> soa_result(boost::extents[nb_blocks+1][3], boost::fortran_storage_order());
+  std::fill(soa_result.data(), soa_result.data() + soa_result.num_elements(), -1.);
+  sol->get_block(soa_result, &node_map, 1, 0, 2);
+  for(Uint i = 0; i != nb_blocks; ++i)
+  {
+    BOOST_CHECK_EQUAL(soa_result[i][0], -1.);
+    BOOST_CHECK_EQUAL(soa_result[i][1], 10.*i + 1);
+    BOOST_CHECK_EQUAL(soa_result[i][2], 10.*i + 2);
+  }
+  for(Uint j = 0; j != 3; ++j)
+    BOOST_CHECK_EQUAL(soa_result[nb_blocks][j], -1.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_fused_operations )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*sys,cp);
+
+  Handle<LSS::Vector> x(sys->solution());
+  Handle<LSS::Vector> y(sys->rhs());
+  Handle<LSS::Vector> w(sys->create_component("w", "cf3.math.LSS.TrilinosVector"));
+  x->clone_to(*w);
+
+  x->reset(2.);
+  y->reset(3.);
+
+  w->waxpby(2., *x, -1., *y);
+  check_all_values(*w, 1.);
+
+  w->axpby(*x, 3., 2.);
+  check_all_values(*w, 8.);
+
+  w->multiply(*x, *y);
+  check_all_values(*w, 6.);
+
+  w->divide(*w, *x);
+  check_all_values(*w, 3.);
+
+  // Ghost entries must not be counted: there are 7 nodes in total
+  w->reset(1.);
+  const Real global_size = 7.*neq;
+  BOOST_CHECK_CLOSE(w->dot(*w), global_size, 1e-12);
+
+  std::vector<LSS::Vector const*> others;
+  others.push_back(x.get());
+  others.push_back(y.get());
+  std::vector<Real> dots;
+  w->dot(others, dots);
+  BOOST_REQUIRE_EQUAL(dots.size(), 2u);
+  BOOST_CHECK_CLOSE(dots[0], 2.*global_size, 1e-12);
+  BOOST_CHECK_CLOSE(dots[1], 3.*global_size, 1e-12);
+  BOOST_CHECK_CLOSE(x->dot(*y), 6.*global_size, 1e-12);
+  BOOST_CHECK_CLOSE(y->norm2(), 3.*std::sqrt(global_size), 1e-12);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_CASE( finalize_mpi )
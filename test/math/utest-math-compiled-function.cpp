@@ -0,0 +1,217 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::math::CompiledFunction"
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "math/CompiledFunction.hpp"
+#include "math/Consts.hpp"
+#include "math/VectorialFunction.hpp"
+
+using namespace cf3;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CompiledFunctionFixture
+{
+  CompiledFunctionFixture() :
+    variables(boost::assign::list_of("x")("y")),
+    nb_points(150)
+  {
+    // More points than the batch size, and not a multiple of it
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      points.push_back(static_cast<Real>(i % 37) / 37. - 0.3);
+      points.push_back(static_cast<Real>(i % 53) / 53. + 0.01);
+    }
+  }
+
+  /// Compare the compiled function with FunctionParser on all points
+  void check_with_function_parser(const std::string& function)
+  {
+    BOOST_TEST_MESSAGE("Checking " << function);
+    CompiledFunction compiled;
+    compiled.add_constant("pi", Consts::pi());
+    compiled.compile(std::vector<std::string>(1, function), variables);
+
+    FunctionParser parser;
+    parser.AddConstant("pi", Consts::pi());
+    parser.Parse(function, "x,y");
+    BOOST_CHECK_EQUAL(parser.GetParseErrorType(), FunctionParser::FP_NO_ERROR);
+
+    std::vector<Real> results(nb_points);
+    compiled.evaluate(&points[0], 2, &results[0], 1, nb_points);
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      const Real expected = parser.Eval(&points[2*i]);
+      BOOST_CHECK_SMALL(results[i] - expected, 1e-12 * (1. + std::abs(expected)));
+    }
+  }
+
+  const std::vector<std::string> variables;
+  const Uint nb_points;
+  std::vector<Real> points;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Evaluate the points [begin, end) of a shared function, as a loop body for the thread pool
+void evaluate_range(const CompiledFunction& compiled, const std::vector<Real>& points, std::vector<Real>& results, const Uint nb_outputs, const Uint begin, const Uint end)
+{
+  compiled.evaluate(&points[2*begin], 2, &results[nb_outputs*begin], nb_outputs, end - begin);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( CompiledFunctionSuite, CompiledFunctionFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( same_as_function_parser )
+{
+  check_with_function_parser("sqrt(x*x + y*y)");
+  check_with_function_parser("x^2 + 2*y - 3");
+  check_with_function_parser("-x^2 + 2^-y");
+  check_with_function_parser("x^3/(1 + y^-1)");
+  check_with_function_parser("x%0.3 + int(y*3)");
+  check_with_function_parser("max(x,y) - min(x,y) + atan2(y,x) + hypot(x,y)");
+  check_with_function_parser("!(x > 0.5) | y = y");
+  check_with_function_parser("(x < y) + (x <= y) + (x >= y) + (x != y)");
+  check_with_function_parser("if(x < 0.5 & y > 0.2, sin(pi*x), cos(y)*exp(-x))");
+  check_with_function_parser("abs(x - y)*pow(y, 1.5) + cbrt(x) + log2(1 + y) + floor(x) + ceil(y)");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( constant_folding )
+{
+  CompiledFunction compiled;
+  compiled.add_constant("pi", Consts::pi());
+  compiled.compile(boost::assign::list_of("2*pi + 1")("if(1, x, log(-1))")("x*(1+2)"), variables);
+
+  BOOST_CHECK_EQUAL(compiled.nb_functions(), 3u);
+  BOOST_CHECK_EQUAL(compiled.nb_instructions(), 1u);
+
+  std::vector<Real> vars = boost::assign::list_of(2.)(3.);
+  RealVector result(3);
+  compiled.evaluate(vars, result);
+  BOOST_CHECK_CLOSE(result[0], 2.*Consts::pi() + 1., 1e-12);
+  BOOST_CHECK_EQUAL(result[1], 2.);
+  BOOST_CHECK_EQUAL(result[2], 6.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( lazy_if )
+{
+  // The branch that is not taken is never evaluated, so the square root of negative numbers is not computed
+  CompiledFunction compiled(std::vector<std::string>(1, "if(x > 0, sqrt(x), -1)"), variables);
+  std::vector<Real> results(nb_points);
+  compiled.evaluate(&points[0], 2, &results[0], 1, nb_points);
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    const Real x = points[2*i];
+    BOOST_CHECK_EQUAL(results[i], x > 0. ? std::sqrt(x) : -1.);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( errors )
+{
+  CompiledFunction compiled;
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "x +"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "x + z"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "min(x)"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "real(x)"), variables), common::NotSupported);
+  BOOST_CHECK(!compiled.is_compiled());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( numbers )
+{
+  CompiledFunction compiled;
+  compiled.compile(boost::assign::list_of("1.5e2 + x")(".5E-1")("2.")("3e+1*x"), variables);
+  std::vector<Real> vars = boost::assign::list_of(2.)(3.);
+  RealVector result(4);
+  compiled.evaluate(vars, result);
+  BOOST_CHECK_EQUAL(result[0], 152.);
+  BOOST_CHECK_EQUAL(result[1], 0.05);
+  BOOST_CHECK_EQUAL(result[2], 2.);
+  BOOST_CHECK_EQUAL(result[3], 60.);
+
+  // strtod also reads these, but FunctionParser does not
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "0x10"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "0x1p3 + x"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "inf"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "x + nan"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "1e"), variables), common::ParsingFailed);
+  BOOST_CHECK_THROW(compiled.compile(std::vector<std::string>(1, "."), variables), common::ParsingFailed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( shared_between_threads )
+{
+  // The second function needs more registers than fit on the stack for a whole batch
+  std::string long_function = "0";
+  for(Uint i = 1; i != 100; ++i)
+    long_function += "+sin(x*" + common::to_str(i) + ")*y";
+  std::vector<std::string> functions = boost::assign::list_of(std::string("x*y+if(x<0,y,-y)"))(long_function);
+
+  CompiledFunction compiled;
+  compiled.compile(functions, variables);
+  BOOST_CHECK_GT(compiled.nb_registers(), CompiledFunction::max_stack_registers / CompiledFunction::batch_size);
+
+  std::vector<Real> expected(2*nb_points);
+  compiled.evaluate(&points[0], 2, &expected[0], 2, nb_points);
+
+  common::ThreadPool& pool = common::ThreadPool::instance();
+  const Uint nb_threads = pool.nb_threads();
+  pool.set_nb_threads(4);
+  for(Uint repeat = 0; repeat != 20; ++repeat)
+  {
+    std::vector<Real> results(2*nb_points, 0.);
+    pool.parallel_for(0, nb_points, boost::bind(&evaluate_range, boost::cref(compiled), boost::cref(points), boost::ref(results), 2u, _1, _2), common::ThreadPool::DYNAMIC, 3);
+    BOOST_CHECK(results == expected);
+  }
+  pool.set_nb_threads(nb_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( vectorial_function_batch )
+{
+  VectorialFunction function("[x*y][sin(pi*x)+y]", "x,y");
+  BOOST_CHECK(function.is_compiled());
+
+  std::vector<Real> results(2*nb_points);
+  function.evaluate_batch(&points[0], 2, &results[0], 2, nb_points);
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    const std::vector<Real> vars(points.begin() + 2*i, points.begin() + 2*i + 2);
+    const RealVector& expected = function(vars);
+    BOOST_CHECK_EQUAL(results[2*i], expected[0]);
+    BOOST_CHECK_EQUAL(results[2*i+1], expected[1]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,11 @@
 #include "mesh/Domain.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/StructuredBlocks.hpp"
 
 using namespace cf3;
 using namespace cf3::common;
@@ -93,6 +98,96 @@ BOOST_AUTO_TEST_CASE( Grid2D )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( StructuredBlocks2D )
+{
+  Domain& domain = *Core::instance().root().get_child("domain")->handle<Domain>();
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("structured_blocks");
+
+  (*blocks.create_points(2, 6)) << 0. << -1.
+                                << 1. << -1.
+                                << 0. <<  0.
+                                << 1. <<  0.
+                                << 0. <<  1.
+                                << 1. <<  1.;
+
+  (*blocks.create_blocks(2)) << 0 << 1 << 3 << 2
+                             << 2 << 3 << 5 << 4;
+
+  (*blocks.create_block_subdivisions()) << 4 << 3
+                                        << 4 << 2;
+
+  (*blocks.create_block_gradings()) << 1. << 1. << 1. << 1.
+                                    << 1. << 1. << 1. << 1.;
+
+  *blocks.create_patch("left", 2) << 2 << 0 << 4 << 2;
+  *blocks.create_patch("right", 2) << 1 << 3 << 3 << 5;
+  *blocks.create_patch("top", 1) << 5 << 4;
+  *blocks.create_patch("bottom", 1) << 0 << 1;
+
+  Mesh& unstructured_mesh = *domain.create_component<Mesh>("unstructured_mesh");
+  blocks.create_mesh(unstructured_mesh);
+
+  blocks.options().set("structured_blocks", true);
+  Mesh& structured_mesh = *domain.create_component<Mesh>("structured_mesh");
+  blocks.create_mesh(structured_mesh);
+
+  const Elements& unstructured_elements = find_component<Elements>(*unstructured_mesh.topology().get_child("interior"));
+  const Elements& structured_elements = find_component<Elements>(*structured_mesh.topology().get_child("interior"));
+
+  BOOST_CHECK(is_null(StructuredBlocks::find(unstructured_elements)));
+  Handle<StructuredBlocks const> lattice = StructuredBlocks::find(structured_elements);
+  BOOST_REQUIRE(is_not_null(lattice));
+  BOOST_CHECK_EQUAL(lattice->nb_blocks(), 2u);
+  BOOST_CHECK_EQUAL(lattice->nb_elements(), 20u);
+  BOOST_CHECK_EQUAL(lattice->first_element(1), 12u);
+
+  // The connectivity computed from the lattice is the same as the unstructured one
+  const Connectivity& unstructured_conn = unstructured_elements.geometry_space().connectivity();
+  const Connectivity& structured_conn = structured_elements.geometry_space().connectivity();
+  BOOST_REQUIRE_EQUAL(structured_conn.size(), unstructured_conn.size());
+  Uint nb_row_continuations = 0;
+  for(Uint elem = 0; elem != structured_conn.size(); ++elem)
+  {
+    std::vector<Uint> nodes(4);
+    lattice->element_nodes(elem, nodes);
+    for(Uint i = 0; i != 4; ++i)
+    {
+      BOOST_CHECK_EQUAL(structured_conn[elem][i], unstructured_conn[elem][i]);
+      BOOST_CHECK_EQUAL(nodes[i], structured_conn[elem][i]);
+    }
+
+    // Elements continuing a row share the nodes with the previous element
+    if(lattice->continues_row(elem))
+    {
+      ++nb_row_continuations;
+      for(Uint i = 0; i != lattice->nb_row_shared_nodes(); ++i)
+        BOOST_CHECK_EQUAL(structured_conn[elem][lattice->row_shared_current()[i]], structured_conn[elem-1][lattice->row_shared_previous()[i]]);
+    }
+  }
+  BOOST_CHECK_EQUAL(nb_row_continuations, 15u);
+
+  // Without the stored connectivity, the elements keep their count and the lattice gives the nodes
+  blocks.options().set("keep_connectivity", false);
+  Mesh& lattice_mesh = *domain.create_component<Mesh>("lattice_mesh");
+  blocks.create_mesh(lattice_mesh);
+  const Elements& lattice_elements = find_component<Elements>(*lattice_mesh.topology().get_child("interior"));
+  const Connectivity& lattice_conn = lattice_elements.geometry_space().connectivity();
+  BOOST_CHECK_EQUAL(lattice_elements.size(), 20u);
+  BOOST_CHECK_EQUAL(lattice_conn.row_size(), 0u);
+  BOOST_CHECK(!StructuredBlocks::has_connectivity(lattice_conn));
+  BOOST_CHECK(StructuredBlocks::has_connectivity(structured_conn));
+  BOOST_REQUIRE(is_not_null(StructuredBlocks::find(lattice_elements)));
+
+  Connectivity& restored_conn = *lattice_mesh.create_component<Connectivity>("restored_connectivity");
+  StructuredBlocks::find(lattice_elements)->fill_connectivity(restored_conn);
+  BOOST_REQUIRE_EQUAL(restored_conn.size(), unstructured_conn.size());
+  for(Uint elem = 0; elem != restored_conn.size(); ++elem)
+    for(Uint i = 0; i != 4; ++i)
+      BOOST_CHECK_EQUAL(restored_conn[elem][i], unstructured_conn[elem][i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,227 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmarks for the mesh kernels"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/BlockMesh/BlockData.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/InterpolationMatrix.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+#include "Tools/Testing/Benchmark.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Arguments: x_segs y_segs z_segs nb_threads
+struct MeshBenchmarkFixture
+{
+  MeshBenchmarkFixture() :
+    root(Core::instance().root()),
+    benchmarks(BenchmarkRegistry::instance())
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    cf3_assert(argc == 5);
+    x_segs = boost::lexical_cast<Uint>(argv[1]);
+    y_segs = boost::lexical_cast<Uint>(argv[2]);
+    z_segs = boost::lexical_cast<Uint>(argv[3]);
+    nb_threads = boost::lexical_cast<Uint>(argv[4]);
+  }
+
+  /// Number of volume elements on this CPU
+  static Real nb_elements(const Mesh& mesh)
+  {
+    Real result = 0.;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      result += elements.size();
+    }
+    return result;
+  }
+
+  static void write_mesh(MeshWriter* writer, const Mesh* mesh, const URI file)
+  {
+    writer->write_from_to(*mesh, file);
+  }
+
+  /// Read into a new mesh, so each repetition starts from scratch
+  static void read_mesh(MeshReader* reader, const URI file)
+  {
+    Handle<Component> previous = Core::instance().root().get_child("ReadMesh");
+    if(is_not_null(previous))
+      Core::instance().root().remove_component(*previous);
+    reader->read_mesh_into(file, *Core::instance().root().create_component<Mesh>("ReadMesh"));
+  }
+
+  static void transform(MeshTransformer* transformer, Mesh* mesh)
+  {
+    transformer->transform(*mesh);
+  }
+
+  static void synchronize(Field* field)
+  {
+    field->synchronize();
+  }
+
+  static void interpolate(const InterpolationMatrix* matrix, const Field* source, const std::vector<Uint>* vars, std::vector<Real>* result, const Uint nb_threads)
+  {
+    matrix->apply(*source, *vars, *result, nb_threads);
+  }
+
+  Component& root;
+  BenchmarkRegistry& benchmarks;
+
+  Uint x_segs;
+  Uint y_segs;
+  Uint z_segs;
+  Uint nb_threads;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( MeshBenchmarkSuite, MeshBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Initialize )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  benchmarks.parameters()["x_segs"] = common::to_str(x_segs);
+  benchmarks.parameters()["y_segs"] = common::to_str(y_segs);
+  benchmarks.parameters()["z_segs"] = common::to_str(z_segs);
+  benchmarks.parameters()["element"] = "Hexa3D";
+}
+
+BOOST_AUTO_TEST_CASE( GenerateMesh )
+{
+  Mesh& mesh = *root.create_component<Mesh>("GeneratedMesh");
+  BlockMesh::BlockArrays& blocks = *root.create_component<BlockMesh::BlockArrays>("Blocks");
+  Tools::MeshGeneration::create_channel_3d(blocks, 12., 0.5, 6., x_segs, y_segs/2, z_segs, 0.1);
+  blocks.partition_blocks(PE::Comm::instance().size(), XX);
+  blocks.options().set("overlap", 0u);
+
+  const Real nb_elems = static_cast<Real>(x_segs*(y_segs/2)*2*z_segs) / static_cast<Real>(PE::Comm::instance().size());
+  benchmarks.run("mesh_generation", boost::bind(&BlockMesh::BlockArrays::create_mesh, &blocks, boost::ref(mesh)), nb_elems, "elements");
+}
+
+BOOST_AUTO_TEST_CASE( WriteMesh )
+{
+  Mesh& mesh = *root.get_child("GeneratedMesh")->handle<Mesh>();
+  boost::shared_ptr<MeshWriter> writer = build_component_abstract_type<MeshWriter>("cf3.mesh.cf3mesh.Writer", "Writer");
+  benchmarks.run("mesh_write", boost::bind(&write_mesh, writer.get(), &mesh, URI("ptest-mesh-benchmarks.cf3mesh")), nb_elements(mesh), "elements", 3);
+}
+
+BOOST_AUTO_TEST_CASE( ReadMesh )
+{
+  boost::shared_ptr<MeshReader> reader = build_component_abstract_type<MeshReader>("cf3.mesh.cf3mesh.Reader", "Reader");
+  const Real nb_elems = nb_elements(*root.get_child("GeneratedMesh")->handle<Mesh>());
+  benchmarks.run("mesh_read", boost::bind(&read_mesh, reader.get(), URI("ptest-mesh-benchmarks.cf3mesh")), nb_elems, "elements", 3);
+}
+
+BOOST_AUTO_TEST_CASE( GlobalNumbering )
+{
+  Mesh& mesh = *root.get_child("ReadMesh")->handle<Mesh>();
+  boost::shared_ptr<MeshTransformer> numbering = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering", "GlobalNumbering");
+  benchmarks.run("global_numbering", boost::bind(&transform, numbering.get(), &mesh), nb_elements(mesh), "elements");
+}
+
+BOOST_AUTO_TEST_CASE( BuildFaces )
+{
+  // Building the faces changes the mesh, so this is timed only once
+  Mesh& mesh = *root.get_child("ReadMesh")->handle<Mesh>();
+  boost::shared_ptr<MeshTransformer> build_faces = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.BuildFaces", "BuildFaces");
+  benchmarks.run("build_faces", boost::bind(&transform, build_faces.get(), &mesh), nb_elements(mesh), "elements");
+}
+
+BOOST_AUTO_TEST_CASE( HaloSync )
+{
+  Mesh& mesh = *root.get_child("GeneratedMesh")->handle<Mesh>();
+  boost::shared_ptr<MeshTransformer> grow_overlap = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GrowOverlap", "GrowOverlap");
+  grow_overlap->transform(mesh);
+
+  Field& field = mesh.geometry_fields().create_field("halo", "a,b,c,d,e");
+  field.parallelize();
+
+  Real nb_ghosts = 0.;
+  for(Uint i = 0; i != field.size(); ++i)
+  {
+    field[i][0] = PE::Comm::instance().rank();
+    if(mesh.geometry_fields().is_ghost(i))
+      nb_ghosts += 1.;
+  }
+
+  benchmarks.run("halo_sync", boost::bind(&synchronize, &field), nb_ghosts * field.row_size(), "values", 10);
+
+  // Each row holds the rank of its owner
+  for(Uint i = 0; i != field.size(); ++i)
+    BOOST_CHECK_EQUAL(field[i][0], mesh.geometry_fields().rank()[i]);
+}
+
+BOOST_AUTO_TEST_CASE( InterpolationSpMV )
+{
+  // Interpolate the coordinates to the element centroids, as a sparse matrix times dense block product
+  Mesh& mesh = *root.get_child("GeneratedMesh")->handle<Mesh>();
+  const Field& coordinates = mesh.geometry_fields().coordinates();
+
+  InterpolationMatrix matrix;
+  BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+  {
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    const Uint nb_nodes = connectivity.row_size();
+    const std::vector<Real> weights(nb_nodes, 1. / static_cast<Real>(nb_nodes));
+    std::vector<Uint> points(nb_nodes);
+    for(Uint elem = 0; elem != connectivity.size(); ++elem)
+    {
+      std::copy(connectivity[elem].begin(), connectivity[elem].end(), points.begin());
+      matrix.add_row(points, weights);
+    }
+  }
+
+  std::vector<Uint> vars;
+  for(Uint i = 0; i != coordinates.row_size(); ++i)
+    vars.push_back(i);
+  std::vector<Real> result;
+
+  benchmarks.run("interpolation_spmv", boost::bind(&interpolate, &matrix, &coordinates, &vars, &result, nb_threads), matrix.nb_nonzeros(), "nonzeros", 10, nb_threads);
+}
+
+BOOST_AUTO_TEST_CASE( WriteResults )
+{
+  benchmarks.write_json();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +80,42 @@ BOOST_AUTO_TEST_CASE( test_FieldManager )
   BOOST_CHECK_THROW(field_manager.create_field(tag, mesh.geometry_fields()), SetupError);
 }
 
+BOOST_AUTO_TEST_CASE( FieldLayout )
+{
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("layout_mesh");
+  Tools::MeshGeneration::create_rectangle(mesh, 1., 1., 5, 5);
+
+  Field& field = mesh.geometry_fields().create_field("layout_field", "a, b, c");
+  BOOST_CHECK(field.is_row_major());
+  const Uint nb_rows = field.size();
+  for(Uint i = 0; i != nb_rows; ++i)
+    for(Uint j = 0; j != 3; ++j)
+      field[i][j] = 10.*i + j;
+
+  field.options().set("layout", std::string("SoA"));
+  BOOST_CHECK(!field.is_row_major());
+
+  // Same values through all accessors, with contiguous columns
+  Field::Ref col = field.col(1);
+  BOOST_CHECK_EQUAL(&col(1,0), &col(0,0) + 1);
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    BOOST_CHECK_EQUAL(col(i,0), 10.*i + 1.);
+    BOOST_CHECK_EQUAL(field.row(i)[2], 10.*i + 2.);
+    BOOST_CHECK_EQUAL(field.vector(i)[1], 10.*i + 1.);
+    BOOST_CHECK_EQUAL(field.ref()(i,2), 10.*i + 2.);
+  }
+
+  // Resizing keeps the layout
+  field.resize(nb_rows + 1);
+  BOOST_CHECK(!field.is_row_major());
+  BOOST_CHECK_EQUAL(field[nb_rows-1][2], 10.*(nb_rows-1) + 2.);
+
+  field.options().set("layout", std::string("AoS"));
+  BOOST_CHECK(field.is_row_major());
+  BOOST_CHECK_EQUAL(field.row(nb_rows-1)[1], 10.*(nb_rows-1) + 1.);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::InterpolationMatrix"
+
+#include <boost/assign/list_of.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "mesh/InterpolationMatrix.hpp"
+#include "mesh/Interpolator.hpp"
+
+using namespace boost::assign;
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+//////////////////////////////////////////////////////////////////////////////
+
+struct InterpolationMatrixFixture
+{
+  InterpolationMatrixFixture() :
+    source(allocate_component< Table<Real> >("source"))
+  {
+    source->set_row_size(3);
+    source->resize(nb_source);
+    for(Uint i = 0; i != nb_source; ++i)
+      for(Uint j = 0; j != 3; ++j)
+        (*source)[i][j] = 10.*i + j;
+
+    // Row r interpolates between source points r and r+1, with weights 0.25 and 0.75
+    for(Uint r = 0; r != nb_source-1; ++r)
+      matrix.add_row(list_of(r)(r+1), list_of(0.25)(0.75));
+  }
+
+  /// Expected value for row r and column j
+  Real expected(const Uint r, const Uint j) const
+  {
+    return 0.25*(10.*r + j) + 0.75*(10.*(r+1) + j);
+  }
+
+  static const Uint nb_source = 100;
+  boost::shared_ptr< Table<Real> > source;
+  InterpolationMatrix matrix;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( InterpolationMatrixSuite, InterpolationMatrixFixture )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Structure )
+{
+  BOOST_CHECK_EQUAL(matrix.nb_rows(), nb_source-1);
+  BOOST_CHECK_EQUAL(matrix.nb_nonzeros(), 2*(nb_source-1));
+  BOOST_CHECK_EQUAL(matrix.row_offsets().back(), matrix.nb_nonzeros());
+
+  std::vector<Uint> points(2, 0u);
+  std::vector<Real> weights(1, 1.);
+  BOOST_CHECK_THROW(matrix.add_row(points, weights), BadValue);
+
+  matrix.clear();
+  BOOST_CHECK_EQUAL(matrix.nb_rows(), 0u);
+  BOOST_CHECK_EQUAL(matrix.nb_nonzeros(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE( ApplyContiguous )
+{
+  std::vector<Uint> vars = list_of(1)(2);
+  std::vector<Real> result;
+  matrix.apply(*source, vars, result);
+  BOOST_CHECK_EQUAL(result.size(), matrix.nb_rows()*vars.size());
+  for(Uint r = 0; r != matrix.nb_rows(); ++r)
+    for(Uint v = 0; v != vars.size(); ++v)
+      BOOST_CHECK_CLOSE(result[r*vars.size()+v], expected(r, vars[v]), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( ApplyPermuted )
+{
+  std::vector<Uint> vars = list_of(2)(0);
+  std::vector<Real> result;
+  matrix.apply(*source, vars, result);
+  for(Uint r = 0; r != matrix.nb_rows(); ++r)
+    for(Uint v = 0; v != vars.size(); ++v)
+      BOOST_CHECK_CLOSE(result[r*vars.size()+v], expected(r, vars[v]), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( ApplyThreadedRange )
+{
+  std::vector<Uint> vars = list_of(0)(1)(2);
+  const Uint begin_row = 7;
+  const Uint end_row = 90;
+  std::vector<Real> result((end_row-begin_row)*vars.size(), -1.);
+  matrix.apply(*source, vars, &result[0], begin_row, end_row, 4);
+  for(Uint r = begin_row; r != end_row; ++r)
+    for(Uint v = 0; v != vars.size(); ++v)
+      BOOST_CHECK_CLOSE(result[(r-begin_row)*vars.size()+v], expected(r, vars[v]), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( ApplyWholePool )
+{
+  ThreadPool& pool = ThreadPool::instance();
+  const Uint nb_threads = pool.nb_threads();
+  pool.set_nb_threads(4);
+
+  // The Interpolator uses the whole pool for its stored weights by default
+  boost::shared_ptr<Interpolator> interpolator = allocate_component<Interpolator>("interpolator");
+  const Uint interpolator_threads = interpolator->options().value<Uint>("nb_threads");
+  BOOST_CHECK_EQUAL(interpolator_threads, 0u);
+
+  std::vector<Uint> vars = list_of(0)(1)(2);
+  std::vector<Real> result;
+  matrix.apply(*source, vars, result, interpolator_threads);
+  BOOST_CHECK_EQUAL(result.size(), matrix.nb_rows()*vars.size());
+  for(Uint r = 0; r != matrix.nb_rows(); ++r)
+    for(Uint v = 0; v != vars.size(); ++v)
+      BOOST_CHECK_CLOSE(result[r*vars.size()+v], expected(r, vars[v]), 1e-12);
+
+  pool.set_nb_threads(nb_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,8 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for zoltan load balancing library"
 
+#include <algorithm>
+
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
@@ -28,6 +30,7 @@
 #include "mesh/MeshReader.hpp"
 #include "mesh/MeshWriter.hpp"
 #include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshMetadata.hpp"
 #include "mesh/MeshPartitioner.hpp"
 #include "mesh/MeshTransformer.hpp"
 
@@ -266,6 +269,85 @@ BOOST_AUTO_TEST_CASE( MeshPartitioner_test_quadtriag )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( object_weights )
+{
+  boost::shared_ptr< MeshGenerator > meshgenerator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","weights_generator");
+  meshgenerator->options().set("mesh",URI("//rect_weights"));
+  std::vector<Uint> nb_cells(2);  nb_cells[0] = 3;   nb_cells[1] = 2;
+  std::vector<Real> lengths(2);   lengths[0]  = nb_cells[0];  lengths[1]  = nb_cells[1];
+  meshgenerator->options().set("nb_cells",nb_cells);
+  meshgenerator->options().set("lengths",lengths);
+  meshgenerator->options().set("bdry",false);
+  Mesh& mesh = meshgenerator->generate();
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(mesh);
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalConnectivity","glb_connectivity")->transform(mesh);
+
+  // P1 quads: 4 DOF and 2x2 quadrature points
+  Uint nb_elements = 0;
+  boost_foreach(const Entities& entities, mesh.topology().elements_range())
+  {
+    BOOST_CHECK_EQUAL(MeshPartitioner::estimated_cost(entities), 16.);
+    nb_elements += entities.size();
+  }
+
+  // Measured costs are relative to the estimate, and add up over the enclosing regions
+  mesh.metadata()[MeshPartitioner::measured_cost_key(mesh.topology())] = 0.5;
+  mesh.metadata()[MeshPartitioner::measured_cost_key(*mesh.topology().get_child("interior"))] = 1.;
+  BOOST_CHECK_EQUAL(MeshPartitioner::measured_cost_key(mesh.topology()), std::string("measured_cost:/topology"));
+
+  const std::string weight_types[] = { "Uniform", "ElementType", "Measured" };
+  const Real element_weights[] = { 1., 16., 24. };
+  for(Uint i = 0; i != 3; ++i)
+  {
+    boost::shared_ptr< MeshPartitioner > p = boost::dynamic_pointer_cast<MeshPartitioner>(build_component_abstract_type<MeshTransformer>("cf3.mesh.zoltan.Partitioner","partitioner"));
+    p->options().set("vertex_weights", weight_types[i]);
+    p->initialize(mesh);
+    BOOST_CHECK_EQUAL(p->has_object_weights(), i != 0);
+
+    const Uint rank = PE::Comm::instance().rank();
+    std::vector<Real> weights(p->nb_objects_owned_by_part(rank));
+    p->list_of_object_weights_in_part(rank, weights);
+    BOOST_CHECK_EQUAL(static_cast<Uint>(std::count(weights.begin(), weights.end(), element_weights[i])), i == 0 ? static_cast<Uint>(weights.size()) : nb_elements);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( repartition_approach )
+{
+  boost::shared_ptr< MeshGenerator > meshgenerator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","approach_generator");
+  meshgenerator->options().set("mesh",URI("//rect_approach"));
+  std::vector<Uint> nb_cells(2);  nb_cells[0] = 8;   nb_cells[1] = 4;
+  std::vector<Real> lengths(2);   lengths[0]  = nb_cells[0];  lengths[1]  = nb_cells[1];
+  meshgenerator->options().set("nb_cells",nb_cells);
+  meshgenerator->options().set("lengths",lengths);
+  meshgenerator->options().set("bdry",false);
+  Mesh& mesh = meshgenerator->generate();
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(mesh);
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalConnectivity","glb_connectivity")->transform(mesh);
+
+  boost::shared_ptr< MeshPartitioner > p = boost::dynamic_pointer_cast<MeshPartitioner>(build_component_abstract_type<MeshTransformer>("cf3.mesh.zoltan.Partitioner","partitioner"));
+  BOOST_CHECK_EQUAL(p->options().value<std::string>("approach"), std::string("PARTITION"));
+  p->options().set("graph_package", std::string("PHG"));
+  p->options().set("approach", std::string("REPARTITION"));
+  p->initialize(mesh);
+  p->partition_graph();
+  p->migrate();
+
+  // Repartitioning the current distribution keeps every element, and leaves no part empty
+  Uint nb_elements = 0;
+  boost_foreach(const Entities& entities, mesh.topology().elements_range())
+    nb_elements += entities.size();
+  Uint total_elements = 0;
+  PE::Comm::instance().all_reduce(PE::plus(), &nb_elements, 1, &total_elements);
+  BOOST_CHECK_EQUAL(total_elements, nb_cells[0]*nb_cells[1]);
+  BOOST_CHECK(nb_elements != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   PE::Comm::instance().finalize();
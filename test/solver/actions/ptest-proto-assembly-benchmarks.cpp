@@ -0,0 +1,249 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmarks for element assembly, SpMV and restart I/O"
+
+#include <set>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Action.hpp"
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/Vector.hpp"
+
+#include "mesh/BlockMesh/BlockData.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/FieldManager.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/LagrangeP1/Hexa3D.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
+#include "mesh/LagrangeP1/Triag2D.hpp"
+
+#include "physics/PhysModel.hpp"
+
+#include "solver/Model.hpp"
+#include "solver/Tags.hpp"
+#include "solver/Time.hpp"
+
+#include "solver/actions/ReadRestartFile.hpp"
+#include "solver/actions/WriteRestartFile.hpp"
+
+#include "solver/actions/Proto/ElementLooper.hpp"
+#include "solver/actions/Proto/Expression.hpp"
+#include "solver/actions/Proto/Functions.hpp"
+#include "solver/actions/Proto/ProtoAction.hpp"
+#include "solver/actions/Proto/Terminals.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+#include "Tools/Testing/Benchmark.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+using namespace cf3::solver::actions::Proto;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Arguments: x_segs y_segs z_segs. The 2D meshes use x_segs by y_segs*z_segs elements, to get the same number of elements as the 3D mesh.
+struct ProtoAssemblyBenchmarkFixture
+{
+  ProtoAssemblyBenchmarkFixture() :
+    root(Core::instance().root()),
+    benchmarks(BenchmarkRegistry::instance())
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    cf3_assert(argc == 4);
+    x_segs = boost::lexical_cast<Uint>(argv[1]);
+    y_segs = boost::lexical_cast<Uint>(argv[2]);
+    z_segs = boost::lexical_cast<Uint>(argv[3]);
+  }
+
+  /// Create a model with an empty mesh, named after the element type
+  Mesh& create_mesh(const std::string& element_name)
+  {
+    Model& model = *root.create_component<Model>(element_name);
+    model.create_physics("cf3.physics.DynamicModel");
+    return *model.create_domain("Domain").create_component<Mesh>("mesh");
+  }
+
+  /// Assemble the Laplacian over all elements into a linear system, and time the product of the resulting matrix with a vector
+  template<typename ElementT>
+  void run_benchmarks(Mesh& mesh)
+  {
+    Model& model = *Handle<Model>(mesh.parent()->parent());
+    benchmarks.parameters()["element"] = ElementT::type_name();
+
+    // Node connectivity, for the sparsity of the matrix
+    const Uint nb_nodes = mesh.geometry_fields().size();
+    std::vector< std::set<Uint> > connectivity_sets(nb_nodes);
+    Real nb_elems = 0.;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      const Connectivity& connectivity = elements.geometry_space().connectivity();
+      nb_elems += connectivity.size();
+      for(Uint elem = 0; elem != connectivity.size(); ++elem)
+      {
+        BOOST_FOREACH(const Uint node_a, connectivity[elem])
+        {
+          connectivity_sets[node_a].insert(connectivity[elem].begin(), connectivity[elem].end());
+        }
+      }
+    }
+    std::vector<Uint> node_connectivity;
+    std::vector<Uint> starting_indices(1, 0);
+    BOOST_FOREACH(const std::set<Uint>& nodes, connectivity_sets)
+    {
+      starting_indices.push_back(starting_indices.back() + nodes.size());
+      node_connectivity.insert(node_connectivity.end(), nodes.begin(), nodes.end());
+    }
+
+    Handle<math::LSS::System> lss = model.create_component<math::LSS::System>("LSS");
+    lss->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+    lss->create(mesh.geometry_fields().comm_pattern(), 1, node_connectivity, starting_indices);
+
+    FieldVariable<0, ScalarField> T("T", "scalar");
+    SystemMatrix matrix(*lss);
+
+    Handle<ProtoAction> assembly = model.create_component<ProtoAction>("Assembly");
+    assembly->set_expression(elements_expression
+    (
+      boost::mpl::vector1<ElementT>(),
+      group
+      (
+        _A = _0,
+        element_quadrature(_A(T,T) += transpose(nabla(T)) * nabla(T)),
+        matrix += _A
+      )
+    ));
+    assembly->options().set("physical_model", model.physics().handle<physics::PhysModel>());
+    assembly->options().set(solver::Tags::regions(), std::vector<URI>(1, mesh.topology().uri()));
+
+    Handle<FieldManager> field_manager = model.create_component<FieldManager>("FieldManager");
+    field_manager->options().set("variable_manager", model.physics().variable_manager().handle<math::VariableManager>());
+    field_manager->create_field("scalar", mesh.geometry_fields());
+
+    benchmarks.run("assembly", boost::bind(&assemble, lss.get(), assembly.get()), nb_elems, "elements", 5);
+
+    lss->solution()->reset(1.);
+    benchmarks.run("spmv", boost::bind(&spmv, lss.get()), node_connectivity.size(), "nonzeros", 10);
+  }
+
+  /// Assemble into a zeroed matrix, so every repetition produces the same matrix. The reset is part of the timing.
+  static void assemble(math::LSS::System* lss, common::Action* assembly)
+  {
+    lss->matrix()->reset(0.);
+    assembly->execute();
+  }
+
+  static void spmv(math::LSS::System* lss)
+  {
+    lss->matrix()->apply(lss->rhs(), Handle<math::LSS::Vector const>(lss->solution()));
+  }
+
+  Component& root;
+  BenchmarkRegistry& benchmarks;
+
+  Uint x_segs;
+  Uint y_segs;
+  Uint z_segs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ProtoAssemblyBenchmarkSuite, ProtoAssemblyBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Initialize )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  benchmarks.parameters()["x_segs"] = common::to_str(x_segs);
+  benchmarks.parameters()["y_segs"] = common::to_str(y_segs);
+  benchmarks.parameters()["z_segs"] = common::to_str(z_segs);
+}
+
+BOOST_AUTO_TEST_CASE( Triag2D )
+{
+  Mesh& mesh = create_mesh("Triag2D");
+  Tools::MeshGeneration::create_rectangle_tris(mesh, 1., 1., x_segs, y_segs*z_segs);
+  run_benchmarks<LagrangeP1::Triag2D>(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( Quad2D )
+{
+  Mesh& mesh = create_mesh("Quad2D");
+  Tools::MeshGeneration::create_rectangle(mesh, 1., 1., x_segs, y_segs*z_segs);
+  run_benchmarks<LagrangeP1::Quad2D>(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( Hexa3D )
+{
+  Mesh& mesh = create_mesh("Hexa3D");
+  BlockMesh::BlockArrays& blocks = *mesh.parent()->create_component<BlockMesh::BlockArrays>("Blocks");
+  Tools::MeshGeneration::create_channel_3d(blocks, 12., 0.5, 6., x_segs, y_segs/2, z_segs, 0.1);
+  blocks.create_mesh(mesh);
+  run_benchmarks<LagrangeP1::Hexa3D>(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( RestartIO )
+{
+  Model& model = *root.get_child("Hexa3D")->handle<Model>();
+  Mesh& mesh = *model.domain().get_child("mesh")->handle<Mesh>();
+  Handle<Time> time = model.create_component<Time>("Time");
+
+  Handle<Field> coordinates = mesh.geometry_fields().coordinates().handle<Field>();
+  Handle<Field> scalar = find_component_ptr_recursively_with_name<Field>(mesh, "scalar");
+  std::vector< Handle<Field> > fields;
+  fields.push_back(coordinates);
+  fields.push_back(scalar);
+  const Real nb_bytes = (coordinates->size()*coordinates->row_size() + scalar->size()*scalar->row_size()) * sizeof(Real);
+
+  const URI restart_file("ptest-proto-assembly-benchmarks.cf3restart");
+  Handle<WriteRestartFile> writer = model.create_component<WriteRestartFile>("WriteRestartFile");
+  writer->options().set("fields", fields);
+  writer->options().set("file", restart_file);
+  writer->options().set(solver::Tags::time(), time);
+  benchmarks.run("restart_write", boost::bind(&common::Action::execute, writer.get()), nb_bytes, "bytes", 3);
+
+  Handle<ReadRestartFile> reader = model.create_component<ReadRestartFile>("ReadRestartFile");
+  reader->options().set("mesh", mesh.handle<Mesh>());
+  reader->options().set("file", restart_file);
+  reader->options().set(solver::Tags::time(), time);
+  benchmarks.run("restart_read", boost::bind(&common::Action::execute, reader.get()), nb_bytes, "bytes", 3);
+}
+
+BOOST_AUTO_TEST_CASE( WriteResults )
+{
+  benchmarks.write_json();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
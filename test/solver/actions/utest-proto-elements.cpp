@@ -16,15 +16,20 @@
 
 #include "math/MatrixTypes.hpp"
 #include "math/Consts.hpp"
+#include "math/Defs.hpp"
 
 #include "mesh/Domain.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
 #include "mesh/MeshWriter.hpp"
 #include "mesh/ElementData.hpp"
 #include "mesh/FieldManager.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/StructuredBlocks.hpp"
 
 #include "mesh/Integrators/Gauss.hpp"
 #include "mesh/ElementTypes.hpp"
@@ -236,6 +241,86 @@ BOOST_AUTO_TEST_CASE( ProtoVectorElementField )
   writer.execute();
 }
 
+/// Two stacked graded blocks, optionally as structured blocks
+void create_two_blocks(Mesh& mesh, const bool structured, const bool keep_connectivity)
+{
+  BlockMesh::BlockArrays& blocks = *mesh.create_component<BlockMesh::BlockArrays>("blocks");
+
+  *blocks.create_points(2, 6) << 0. << 0. << 2. << 0. << 0. << 1. << 2. << 1. << 0. << 3. << 2. << 3.;
+  *blocks.create_blocks(2) << 0 << 1 << 3 << 2 << 2 << 3 << 5 << 4;
+  *blocks.create_block_subdivisions() << 5 << 3 << 5 << 4;
+  *blocks.create_block_gradings() << 0.5 << 0.5 << 2. << 2. << 0.5 << 0.5 << 0.5 << 0.5;
+
+  *blocks.create_patch("bottom", 1) << 0 << 1;
+  *blocks.create_patch("right", 2) << 1 << 3 << 3 << 5;
+  *blocks.create_patch("top", 1) << 5 << 4;
+  *blocks.create_patch("left", 2) << 4 << 2 << 2 << 0;
+
+  blocks.options().set("structured_blocks", structured);
+  blocks.options().set("keep_connectivity", keep_connectivity);
+  blocks.create_mesh(mesh);
+
+  // Start from the coordinates, so the assembly also depends on the nodal values read for each element
+  Field& result = mesh.geometry_fields().create_field("result", "Result[v]");
+  result.add_tag("result");
+  const Field& coords = mesh.geometry_fields().coordinates();
+  for(Uint i = 0; i != result.size(); ++i)
+  {
+    result[i][XX] = coords[i][XX];
+    result[i][YY] = coords[i][XX]*coords[i][YY];
+  }
+}
+
+// Assembly through the structured lattice gives the same result as through the connectivity
+BOOST_AUTO_TEST_CASE( StructuredBlocksAssembly )
+{
+  Component& root = Core::instance().root();
+  Mesh& unstructured_mesh = *root.create_component<Mesh>("unstructured_mesh");
+  Mesh& structured_mesh = *root.create_component<Mesh>("structured_mesh");
+  Mesh& lattice_mesh = *root.create_component<Mesh>("lattice_mesh");
+  create_two_blocks(unstructured_mesh, false, true);
+  create_two_blocks(structured_mesh, true, true);
+  create_two_blocks(lattice_mesh, true, false);
+
+  // Only the lattice is stored for the elements of the last mesh
+  const Elements& lattice_elements = find_component<Elements>(*lattice_mesh.topology().get_child("interior"));
+  BOOST_REQUIRE(is_not_null(StructuredBlocks::find(lattice_elements)));
+  BOOST_CHECK(!StructuredBlocks::has_connectivity(lattice_elements.geometry_space().connectivity()));
+  BOOST_CHECK_EQUAL(lattice_elements.size(), 35u);
+
+  FieldVariable<0, VectorField> R("Result", "result");
+  Mesh* meshes[3] = { &unstructured_mesh, &structured_mesh, &lattice_mesh };
+  Real volumes[3] = { 0., 0., 0. };
+  for(Uint i = 0; i != 3; ++i)
+  {
+    for_each_element< boost::mpl::vector1<LagrangeP1::Quad2D> >
+    (
+      *meshes[i]->topology().get_child("interior")->handle<Region>(),
+      group
+      (
+        R[_i] += nabla(R, gauss_points_1)[_i],
+        boost::proto::lit(volumes[i]) += volume
+      )
+    );
+  }
+
+  BOOST_CHECK_CLOSE(volumes[0], 6., 1e-8);
+  BOOST_CHECK_CLOSE(volumes[1], volumes[0], 1e-8);
+  BOOST_CHECK_CLOSE(volumes[2], volumes[0], 1e-8);
+
+  const Field& reference = find_component_with_tag<Field>(unstructured_mesh.geometry_fields(), "result");
+  for(Uint i = 1; i != 3; ++i)
+  {
+    const Field& result = find_component_with_tag<Field>(meshes[i]->geometry_fields(), "result");
+    BOOST_REQUIRE_EQUAL(result.size(), reference.size());
+    for(Uint node = 0; node != result.size(); ++node)
+    {
+      BOOST_CHECK_CLOSE(result[node][XX], reference[node][XX], 1e-10);
+      BOOST_CHECK_CLOSE(result[node][YY], reference[node][YY], 1e-10);
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
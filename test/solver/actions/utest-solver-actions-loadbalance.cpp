@@ -0,0 +1,222 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for dynamic load balancing"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Action.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Group.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/TimedComponent.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/Defs.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshPartitioner.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+
+#include "solver/Action.hpp"
+#include "solver/actions/DynamicLoadBalance.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Action that reports a fixed time per execution, three times higher on rank 0
+class UnbalancedWork : public solver::Action, public TimedComponent
+{
+public:
+  UnbalancedWork(const std::string& name) : solver::Action(name), m_count(0)
+  {
+  }
+
+  static std::string type_name() { return "UnbalancedWork"; }
+
+  virtual void execute()
+  {
+    ++m_count;
+  }
+
+  virtual void store_timings()
+  {
+    properties()["timer_mean"] = PE::Comm::instance().rank() == 0 ? 3. : 1.;
+    properties()["timer_count"] = m_count;
+  }
+
+private:
+  Uint m_count;
+};
+
+/// Action that only has timings on rank 0
+class RootOnlyWork : public solver::Action, public TimedComponent
+{
+public:
+  RootOnlyWork(const std::string& name) : solver::Action(name)
+  {
+  }
+
+  static std::string type_name() { return "RootOnlyWork"; }
+
+  virtual void execute()
+  {
+  }
+
+  virtual void store_timings()
+  {
+    if(PE::Comm::instance().rank() != 0)
+      return;
+    properties()["timer_mean"] = 2.;
+    properties()["timer_count"] = 5u;
+  }
+};
+
+#ifdef CF3_ENABLE_COMPONENT_TIMING
+namespace cf3 {
+namespace common {
+// UnbalancedWork and RootOnlyWork report their own timings
+template<>
+struct is_timeable<UnbalancedWork> : boost::false_type
+{
+  typedef boost::false_type type;
+};
+template<>
+struct is_timeable<RootOnlyWork> : boost::false_type
+{
+  typedef boost::false_type type;
+};
+}
+}
+#endif
+
+/// Value of the test field at the given coordinates
+Real field_value(const Field& coordinates, const Uint i)
+{
+  return coordinates[i][XX] + 100.*coordinates[i][YY];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( DynamicLoadBalanceSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  Core::instance().initiate(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK(PE::Comm::instance().size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE( RepartitionOnImbalance )
+{
+  boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "generator");
+  generator->options().set("mesh", URI("//mesh"));
+  generator->options().set("nb_cells", std::vector<Uint>(2, 16u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  Mesh& mesh = generator->generate();
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance", "load_balance")->transform(mesh);
+
+  Dictionary& geometry = mesh.geometry_fields();
+  Field& field = geometry.create_field("solution", "u");
+  field.parallelize();
+  for(Uint i = 0; i != field.size(); ++i)
+    field[i][0] = field_value(geometry.coordinates(), i);
+
+  Group& group = *Core::instance().root().create_component<Group>("Actions");
+  UnbalancedWork& work = *group.create_component<UnbalancedWork>("Work");
+  work.options().set("mesh", mesh.handle<Mesh>());
+  work.options().set("regions", std::vector<URI>(1, mesh.topology().uri()));
+
+  DynamicLoadBalance& balancer = *group.create_component<DynamicLoadBalance>("DynamicLoadBalance");
+  balancer.options().set("mesh", mesh.handle<Mesh>());
+  balancer.options().set("check_interval", 2u);
+
+  for(Uint i = 0; i != 2; ++i)
+  {
+    work.execute();
+    balancer.execute();
+  }
+
+  // Rank 0 takes three times longer: max / average - 1 = 3 / 2 - 1 on 2 processes
+  const Real nb_procs = static_cast<Real>(PE::Comm::instance().size());
+  BOOST_CHECK_CLOSE(balancer.properties().value<Real>("imbalance"), 3. / ((3. + nb_procs - 1.) / nb_procs) - 1., 1e-8);
+  BOOST_CHECK_EQUAL(balancer.properties().value<Uint>("nb_repartitions"), 1u);
+
+  // The field moved along with the nodes
+  Field& coordinates = geometry.coordinates();
+  BOOST_CHECK_EQUAL(field.size(), coordinates.size());
+  Uint nb_ghosts = 0;
+  for(Uint i = 0; i != field.size(); ++i)
+  {
+    BOOST_CHECK_CLOSE(field[i][0], field_value(coordinates, i), 1e-8);
+    if(geometry.is_ghost(i))
+    {
+      field[i][0] = -1.;
+      ++nb_ghosts;
+    }
+  }
+  BOOST_CHECK(nb_ghosts != 0);
+
+  // Synchronization uses the new distribution
+  field.synchronize();
+  for(Uint i = 0; i != field.size(); ++i)
+    BOOST_CHECK_CLOSE(field[i][0], field_value(coordinates, i), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( StoreCostsWithTimingsOnOneRank )
+{
+  boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "costs_generator");
+  generator->options().set("mesh", URI("//costs_mesh"));
+  generator->options().set("nb_cells", std::vector<Uint>(2, 8u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  Mesh& mesh = generator->generate();
+  const std::string key = MeshPartitioner::measured_cost_key(mesh.topology());
+
+  Group& group = *Core::instance().root().create_component<Group>("CostActions");
+  RootOnlyWork& work = *group.create_component<RootOnlyWork>("Work");
+  work.options().set("mesh", mesh.handle<Mesh>());
+  work.options().set("regions", std::vector<URI>(1, mesh.topology().uri()));
+  common::Action& store_costs = *group.create_component("StoreMeasuredCosts", "cf3.solver.actions.StoreMeasuredCosts")->handle<common::Action>();
+
+  // All ranks join the reductions, and get the factor of the only measurement
+  store_costs.execute();
+  BOOST_REQUIRE(mesh.metadata().check(key));
+  BOOST_CHECK_CLOSE(mesh.metadata().properties().value<Real>(key), 1., 1e-8);
+
+  // Ranks without any timed region skip storing the costs after the reductions
+  mesh.metadata().properties().erase(key);
+  if(PE::Comm::instance().rank() != 0)
+    work.options().set("regions", std::vector<URI>());
+  store_costs.execute();
+  BOOST_CHECK_EQUAL(mesh.metadata().check(key), PE::Comm::instance().rank() == 0);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -21,6 +21,10 @@
 #include "common/Environment.hpp"
 #include "common/Group.hpp"
 #include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Table.hpp"
+
+#include "math/LSS/SolutionStrategy.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/MeshWriter.hpp"
@@ -41,6 +45,8 @@
 #include "solver/actions/LoopOperation.hpp"
 #include "solver/actions/ComputeVolume.hpp"
 #include "solver/actions/ComputeArea.hpp"
+#include "solver/actions/SolverTelemetryHistory.hpp"
+#include "solver/History.hpp"
 
 using namespace boost::assign;
 
@@ -264,6 +270,59 @@ BOOST_AUTO_TEST_CASE ( test_ForAllElementsT )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE ( test_SolverTelemetryHistory )
+{
+  Component& root = Core::instance().root();
+  Group& lss = *root.create_component<Group>("lss");
+  boost::shared_ptr<math::LSS::SolutionStrategy> strategy_ptr = build_component_abstract_type<math::LSS::SolutionStrategy>("cf3.math.LSS.EmptyStrategy", "SolutionStrategy");
+  lss.add_component(strategy_ptr);
+  math::LSS::SolutionStrategy& strategy = *strategy_ptr;
+  strategy.options().set("telemetry_capacity", 3u);
+
+  Handle<History> history = root.create_component<History>("telemetry_history");
+  history->options().set("logging", false);
+
+  Handle<SolverTelemetryHistory> telemetry_history = root.create_component<SolverTelemetryHistory>("SolverTelemetryHistory");
+  telemetry_history->options().set("solution_strategy", strategy.handle<math::LSS::SolutionStrategy>());
+  telemetry_history->options().set("history", history);
+
+  // Nothing to copy before the first solve
+  telemetry_history->execute();
+  BOOST_CHECK(!history->properties().check("lss_solve_count"));
+
+  for(Uint i = 0; i != 5; ++i)
+  {
+    strategy.solve();
+    telemetry_history->execute();
+    BOOST_CHECK_EQUAL(history->properties().value<Real>("lss_solve_count"), static_cast<Real>(i+1));
+  }
+
+  // The telemetry table keeps the last 3 solves in a ring
+  const Table<Real>& telemetry = *strategy.telemetry();
+  BOOST_CHECK_EQUAL(strategy.solve_count(), 5u);
+  BOOST_CHECK_EQUAL(telemetry.size(), 3u);
+  BOOST_CHECK_EQUAL(strategy.last_telemetry_row(), 1u);
+  BOOST_CHECK_EQUAL(telemetry[0][0], 4.);
+  BOOST_CHECK_EQUAL(telemetry[1][0], 5.);
+  BOOST_CHECK_EQUAL(telemetry[2][0], 3.);
+
+  // The empty strategy knows no residuals
+  BOOST_CHECK_EQUAL(history->properties().value<Real>("lss_iterations"), 0.);
+  BOOST_CHECK_EQUAL(history->properties().value<Real>("lss_final_residual"), -1.);
+  BOOST_CHECK_EQUAL(history->properties().value<Real>("lss_final_relative_residual"), -1.);
+  BOOST_CHECK(strategy.properties().value< std::vector<Real> >("residuals").empty());
+
+  // One entry per execution
+  history->flush();
+  BOOST_CHECK_EQUAL(history->table()->size(), 5u);
+
+  root.remove_component("SolverTelemetryHistory");
+  root.remove_component("telemetry_history");
+  root.remove_component("lss");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# Compare benchmark results written by cf3::Tools::Testing::BenchmarkRegistry against a stored baseline.
+# Usage: compare-benchmarks.py [--tolerance 0.1] baseline current
+# baseline and current are either single JSON files or directories containing them (e.g. the directory
+# set in CF3_BENCHMARK_OUTPUT when running the performance tests). The exit code is 1 if any benchmark
+# is slower than the baseline by more than the tolerance, or if a benchmark of the baseline is missing from
+# the current results, so this can be used as a gate before deploying.
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+def load_results(path):
+  files = []
+  if os.path.isdir(path):
+    files = [os.path.join(path, f) for f in sorted(os.listdir(path)) if f.endswith('.json')]
+  else:
+    files = [path]
+
+  results = {}
+  for filename in files:
+    with open(filename) as f:
+      data = json.load(f)
+    for benchmark in data['benchmarks']:
+      params = ', '.join('%s=%s' % (k, v) for k, v in sorted(benchmark['parameters'].items()))
+      key = '%s: %s [%s] ranks=%d threads=%d' % (data['module'], benchmark['name'], params, benchmark['nb_ranks'], benchmark['nb_threads'])
+      results[key] = benchmark
+  return results
+
+parser = argparse.ArgumentParser(description='Compare benchmark results against a baseline')
+parser.add_argument('baseline', help='baseline JSON file or directory')
+parser.add_argument('current', help='current JSON file or directory')
+parser.add_argument('--tolerance', type=float, default=0.1, help='allowed relative increase of the minimum time (default 0.1)')
+parser.add_argument('--metric', default='time_min', choices=['time_min', 'time_mean', 'time_max'], help='time used for the comparison')
+args = parser.parse_args()
+
+baseline = load_results(args.baseline)
+current = load_results(args.current)
+
+nb_regressions = 0
+nb_missing = 0
+for key in sorted(set(baseline.keys()) | set(current.keys())):
+  if key not in current:
+    print('MISSING     ', key)
+    nb_missing += 1
+    continue
+  if key not in baseline:
+    print('NEW         ', key, '%.4g s' % current[key][args.metric])
+    continue
+
+  old_time = baseline[key][args.metric]
+  new_time = current[key][args.metric]
+  ratio = new_time / old_time if old_time > 0. else 1.
+  if ratio > 1. + args.tolerance:
+    status = 'REGRESSION  '
+    nb_regressions += 1
+  elif ratio < 1. - args.tolerance:
+    status = 'IMPROVEMENT '
+  else:
+    status = 'OK          '
+
+  line = '%s %s: %.4g s -> %.4g s (%+.1f%%)' % (status, key, old_time, new_time, 100. * (ratio - 1.))
+  for counter in sorted(set(baseline[key]['counters'].keys()) & set(current[key]['counters'].keys())):
+    old_count = baseline[key]['counters'][counter]
+    if old_count > 0.:
+      line += ', %s %+.1f%%' % (counter, 100. * (current[key]['counters'][counter] / old_count - 1.))
+  print(line)
+
+if nb_regressions != 0:
+  print('%d benchmark(s) regressed by more than %.0f%%' % (nb_regressions, 100. * args.tolerance))
+if nb_missing != 0:
+  print('%d benchmark(s) of the baseline are missing' % nb_missing)
+if nb_regressions != 0 or nb_missing != 0:
+  sys.exit(1)